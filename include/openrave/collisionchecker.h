@@ -174,6 +174,7 @@ public:
     int options = 0; ///< mix of CO_X, the options that the CollisionReport was called with. It is overwritten by the options set on the collision checker writing the report
 
     dReal minDistance = 1e20; ///< minimum distance from last query, filled if CO_Distance option is set
+    bool bMinDistanceIsLowerBound = false; ///< true if the checker could only compute a lower bound of minDistance, for example from the convex hulls of meshes
     int16_t numWithinTol = 0; ///< number of objects within tolerance of this object, filled if CO_UseTolerance option is set
     uint8_t nKeepPrevious = 0; ///< if 1, will keep all previous data when resetting the collision checker. otherwise will reset
 };
@@ -263,6 +263,7 @@ public:
         \code
         DAE::getIOPlugin()->setOption(key,value).
         \endcode
+        Compiled scenes (.orscene, see \ref Save) are memory mapped and the bodies are constructed directly from their stored infos.
      */
     virtual bool Load(const std::string& filename, const AttributesList& atts = AttributesList()) = 0;
 
@@ -292,7 +293,7 @@ public:
 
     /** \brief Saves a scene depending on the filename extension. Default is in COLLADA format
 
-        \param filename the filename to save the results at. Use the suffix extension of the filename to figure out the type to save. Supports: "dae", "json", "msgpack"
+        \param filename the filename to save the results at. Use the suffix extension of the filename to figure out the type to save. Supports: "dae", "json", "msgpack", "orscene"
         \param options controls what to save
         \param atts attributes that refine further options. For collada-dom parsing, the options are passed through
         \code
@@ -301,6 +302,7 @@ public:
         Several default options are:
         - 'target' - the target body name of the options, if relevant
         - 'password' - the password/key to encrypt the data with, collada supports this through zae zip archives
+        - 'source' - for "orscene", the file the scene was loaded from. The compiled scene is rebuilt from it on Load whenever any file it depends on changes
         \throw openrave_exception Throw if failed to save anything
      */
     virtual void Save(const std::string& filename, SelectionOptions options=SO_Everything, const AttributesList& atts = AttributesList()) = 0;
@@ -260,6 +260,17 @@ public:
         SendJSONCommand(cmdname, input, output, output.GetAllocator());
     }
 
+    /** \brief Similar to \ref SendJSONCommand except the input and output are msgpack encoded.
+
+        Remote callers avoid converting to and from JSON text. The typed arrays of the input (see MsgPack::MSGPACK_EXT_TYPEDARRAY)
+        reach the command as views over pinput instead of rapidjson arrays, commands read them with MsgPack::LoadNumberArray or MsgPack::GetTypedArrayView.
+        This function should not be overridden by the user, therefore it isn't virtual.
+        \param pinput msgpack encoded input, has to stay valid until the call returns. If inputsize is 0, the input is null.
+        \param output set to the msgpack encoded output
+        \exception openrave_exception Throw if the command is not supported or msgpack support is not enabled.
+     */
+    void SendMsgPackCommand(const std::string& cmdname, const void* pinput, size_t inputsize, std::vector<char>& output);
+
     /** \brief serializes the interface
 
         The readable interfaces are also serialized within the tag, for example:
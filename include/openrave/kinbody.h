@@ -851,6 +851,9 @@ public:
 
         void serialize(std::ostream& o, int options) const;
 
+        /// \brief fast digest of \ref serialize, cached until one of the serialized fields changes, see \ref _InvalidateSerializationDigest. Only valid in-process.
+        uint64_t GetSerializationDigest() const;
+
         /// \brief sets a new collision mesh and notifies every registered callback about it
         void SetCollisionMesh(const TriMesh& mesh);
         /// \brief sets visible flag. if changed, notifies every registered callback about it.
@@ -957,8 +960,14 @@ public:
         }
 
 protected:
+        /// \brief has to be called by everything that changes the fields \ref serialize writes: the transform, type, render scale, geometry data, side walls and collision mesh of _info
+        inline void _InvalidateSerializationDigest() {
+            _nSerializationDigest = 0;
+        }
+
         boost::weak_ptr<Link> _parent;
-        KinBody::GeometryInfo _info; ///< geometry info
+        KinBody::GeometryInfo _info; ///< geometry info, see \ref _InvalidateSerializationDigest before modifying it
+        mutable uint64_t _nSerializationDigest = 0; ///< cached \ref GetSerializationDigest, 0 if it has to be recomputed
 #ifdef RAVE_PRIVATE
 #ifdef _MSC_VER
         friend class OpenRAVEXMLParser::LinkXMLReader;
@@ -1382,6 +1391,9 @@ public:
 
         void serialize(std::ostream& o, int options) const;
 
+        /// \brief fast digest of \ref serialize, uses the cached digests of the geometries. Only valid in-process.
+        uint64_t ComputeSerializationDigest(int options) const;
+
         /// \brief return a map of custom float parameters
         inline const std::map<std::string, std::vector<dReal> >& GetFloatParameters() const {
             return _info._mapFloatParameters;
@@ -1558,12 +1570,67 @@ public:
             }
         };
 
+        /// \brief A mimic equation reduced to a polynomial of the values in _vdofformat so it can be evaluated without the fparser interpreter.
+        ///
+        /// Only equations made of numbers, the joint variables, +, -, *, division by constants and small non-negative integer powers are compiled, which covers the common affine a*q+b couplings. Anything else is left to fparser.
+        class OPENRAVE_API CompiledEquation
+        {
+public:
+            /// \brief tries to reduce the equation to a polynomial.
+            ///
+            /// \param equation the equation with the joint names already converted to the variable names
+            /// \param vvariables the variable names, ordered the same way as the values passed to Eval
+            /// \return true if successful. If false, the equation is left invalid and fparser should be used.
+            bool Compile(const std::string& equation, const std::vector<std::string>& vvariables);
+
+            /// \brief invalidates the equation
+            void Reset();
+
+            inline bool IsValid() const {
+                return _nvariables >= 0;
+            }
+
+            /// \brief evaluates the polynomial at pvalues. Should only be called when IsValid() is true.
+            inline dReal Eval(const dReal* pvalues) const {
+                dReal fvalue = _fconstant;
+                if( _nvariables == 1 ) {
+                    for(size_t iterm = 0; iterm < _vcoeffs.size(); ++iterm) {
+                        dReal fterm = _vcoeffs[iterm];
+                        for(uint8_t iexp = 0; iexp < _vexponents[iterm]; ++iexp) {
+                            fterm *= pvalues[0];
+                        }
+                        fvalue += fterm;
+                    }
+                    return fvalue;
+                }
+                const uint8_t* pexponents = _vexponents.data();
+                for(size_t iterm = 0; iterm < _vcoeffs.size(); ++iterm) {
+                    dReal fterm = _vcoeffs[iterm];
+                    for(int ivar = 0; ivar < _nvariables; ++ivar, ++pexponents) {
+                        for(uint8_t iexp = 0; iexp < *pexponents; ++iexp) {
+                            fterm *= pvalues[ivar];
+                        }
+                    }
+                    fvalue += fterm;
+                }
+                return fvalue;
+            }
+
+private:
+            dReal _fconstant = 0; ///< the term with no variables
+            std::vector<dReal> _vcoeffs; ///< coefficient of every non-constant term
+            std::vector<uint8_t> _vexponents; ///< _vcoeffs.size()*_nvariables exponents, the exponent of each variable for every term
+            int _nvariables = -1; ///< number of variables the equation takes, -1 if the equation is not compiled
+        };
+
         /// @name automatically set
         //@{
         std::vector< DOFFormat > _vdofformat;         ///< the format of the values the equation takes order is important.
         std::vector<DOFHierarchy> _vmimicdofs;         ///< all dof indices that the equations depends on. DOFHierarchy::dofindex can repeat
         OpenRAVEFunctionParserRealPtr _posfn;
         std::vector<OpenRAVEFunctionParserRealPtr > _velfns, _accelfns;         ///< the velocity and acceleration partial derivatives with respect to each of the values in _vdofformat
+        CompiledEquation _poscompiled; ///< compiled _posfn, if valid it is used instead of _posfn
+        std::vector<CompiledEquation> _velcompiled, _accelcompiled; ///< compiled _velfns and _accelfns, same size as their fparser counterparts. Invalid entries fall back to fparser.
         //@}
     };
     typedef boost::shared_ptr<Mimic> MimicPtr;
@@ -3143,6 +3210,80 @@ private:
      */
     virtual void ComputeInverseDynamics(boost::array< std::vector<dReal>, 3>& doftorquecomponents, const std::vector<dReal>& dofaccelerations, const ForceTorqueMap& externalforcetorque=ForceTorqueMap()) const;
 
+    /** \brief Flat snapshot of the kinematics and inertial parameters of a body for computing inverse dynamics of arbitrary states without touching the body.
+
+        Uses the same Recursive Newton Euler conventions as \ref ComputeInverseDynamics, except that the base link does not move and there are no external forces.
+        Positions, velocities, and accelerations are passed in and the torques are written to caller storage, so the body state is never read or set.
+        The model does not reference the body, so several threads can use it at the same time as long as each thread has its own \ref Workspace.
+        Once a workspace has been used with a model, the computations do not allocate any memory.
+     */
+    class OPENRAVE_API InverseDynamicsModel
+    {
+public:
+        /// \brief per-thread scratch memory, indexed by link
+        class Workspace
+        {
+public:
+            std::vector<Transform> vlinktransforms;
+            std::vector<Vector> vlinearvelocities, vangularvelocities, vlinearaccelerations, vangularaccelerations; ///< of the link origins
+            std::vector<Vector> vcoms, vforces, vtorques; ///< global center of mass, and the force and torque about it that the link has to receive from its parent
+            std::vector<Vector> vjointaxes, vjointanchors; ///< global axis and anchor of every joint of the model
+        };
+
+        InverseDynamicsModel() : _nDOF(0) {
+        }
+
+        inline int GetDOF() const {
+            return _nDOF;
+        }
+
+        /** \brief computes the torques of one state
+
+            \param tbase the transform of the base link
+            \param pdofvalues GetDOF() dof values
+            \param pdofvelocities GetDOF() dof velocities, or NULL if all velocities are 0
+            \param pdofaccelerations GetDOF() dof accelerations, or NULL if all accelerations are 0
+            \param[out] pdoftorques GetDOF() output torques
+            \param externalforcetorque the external forces/torques acting on the links at their center of mass, like in \ref KinBody::ComputeInverseDynamics
+         */
+        void ComputeInverseDynamics(const Transform& tbase, const dReal* pdofvalues, const dReal* pdofvelocities, const dReal* pdofaccelerations, dReal* pdoftorques, Workspace& workspace, const ForceTorqueMap& externalforcetorque=ForceTorqueMap()) const;
+
+        /// \brief computes the torques of numsamples states. Every array holds the values of the samples one after the other, so sample i starts at i*GetDOF().
+        void ComputeInverseDynamicsBatch(const Transform& tbase, size_t numsamples, const dReal* pdofvalues, const dReal* pdofvelocities, const dReal* pdofaccelerations, dReal* pdoftorques, Workspace& workspace) const;
+
+private:
+        /// \brief one joint of the kinematics hierarchy
+        struct JointData
+        {
+            Transform tleft, tright; ///< internal hierarchy transforms
+            Vector vaxis; ///< internal hierarchy axis
+            int parentindex; ///< hierarchy parent link, -1 if the joint is attached to the environment in which case the base link is used as the parent
+            int childindex; ///< hierarchy child link
+            int dofindex; ///< -1 for passive joints, which do not receive any torque
+            bool bstatic; ///< if true, the child is rigidly attached to the parent with tleft
+            bool brevolute; ///< revolute or prismatic
+            dReal faxissign; ///< -1 if the hierarchy axis points opposite to Joint::GetAxis
+            dReal fcoulombfriction, fviscousfriction, frotorinertia; ///< from the electric motor info, frotorinertia is on the load side
+        };
+
+        std::vector<JointData> _vjoints; ///< in topological order
+        std::vector<dReal> _vlinkinertials; ///< 13 values per link: mass, local center of mass, and the 3x3 local inertia tensor about the center of mass in row-major order
+        std::vector<Transform> _vlinkbasetransforms; ///< transforms of the links relative to the base link when the model was extracted, used for the links that no joint moves
+        Vector _vgravity;
+        int _nDOF;
+
+        friend class KinBody;
+    };
+    typedef boost::shared_ptr<InverseDynamicsModel> InverseDynamicsModelPtr;
+    typedef boost::shared_ptr<InverseDynamicsModel const> InverseDynamicsModelConstPtr;
+
+    /** \brief Extracts the current kinematics, masses, and gravity into model.
+
+        \throw OpenRAVEException with ORE_NotImplemented if the body has closed loops, mimic joints, passive joints that are not static, or active joints that are not revolute or prismatic.
+        In that case use \ref ComputeInverseDynamics.
+     */
+    virtual void ExtractInverseDynamicsModel(InverseDynamicsModel& model) const;
+
     /** \brief Computes dynamic limits for acceleration and jerks, which are dynamically changing based on the given positions and velocities of the robot.
 
         Since not all robots supports dynamic limits, so this function should be overriden in the subclass.
@@ -3319,6 +3460,16 @@ private:
     /// \param linkIndices vector of link index. Each combination among them is set as adjacent links. elements have to be unique
     void SetAdjacentLinksCombinations(const std::vector<int>& linkIndices);
 
+    /// \brief sets link pairs whose self collision does not need to be checked, like pairs that never or always collide within the joint limits.
+    ///
+    /// The pairs are removed from \ref GetNonAdjacentLinks in addition to the adjacent links, so all collision checkers skip them for self collision.
+    /// Replaces the previously set pairs, and the pairs are cleared when the links of the body are destroyed.
+    /// \param linkIndices pairs of link indices, the order inside a pair does not matter. \see planningutils::ComputeLinkPairCollisionClasses
+    void SetDisabledCollisionLinkPairs(const std::vector<std::pair<int, int> >& linkIndices);
+
+    /// \brief returns the pairs set by \ref SetDisabledCollisionLinkPairs with first < second
+    void GetDisabledCollisionLinkPairs(std::vector<std::pair<int, int> >& linkIndices) const;
+
     inline ManageDataPtr GetManageData() const {
         return _pManageData;
     }
@@ -3337,6 +3488,19 @@ private:
         _nUpdateStampId += inc;
     }
 
+    /// \brief Returns the indices of the links that moved since updatestamp, if the only change of the body since then was one \ref SetDOFValues call.
+    ///
+    /// When the link transforms are consistent with the dof values, SetDOFValues only recomputes the links affected by the dofs whose values changed.
+    /// Users that cache link transforms, like collision checkers, can then update only these links.
+    /// \param updatestamp the value of \ref GetUpdateStamp when the user last synchronized with the body
+    /// \return the moved link indices, or NULL if they are not known in which case all links have to be considered moved
+    inline const std::vector<int>* GetLinksMovedSinceUpdateStamp(int updatestamp) const {
+        if( _nIncrementalFKPrevStamp == updatestamp && _nIncrementalFKStamp == _nUpdateStampId ) {
+            return &_vIncrementalFKMovedLinks;
+        }
+        return NULL;
+    }
+
     virtual void Clone(InterfaceBaseConstPtr preference, int cloningoptions);
 
     /// \brief Register a callback with the interface.
@@ -3358,6 +3522,12 @@ private:
     /// \return md5 hash string of kinematics/geometry
     virtual const std::string& GetKinematicsGeometryHash() const;
 
+    /// \brief A fast 64bit digest of the same kinematic, geometric and dynamic structure as \ref GetKinematicsGeometryHash.
+    ///
+    /// Only the geometries whose collision mesh changed are serialized again, so this is cheap to call after geometry changes.
+    /// The value is not stable across versions, so use it only for in-process comparisons and keep GetKinematicsGeometryHash for stored data.
+    uint64_t GetKinematicsGeometryDigest() const;
+
     /// \brief Sets the joint offsets so that the current configuration becomes the new zero state of the robot.
     ///
     /// When this function returns, the returned DOF values should be all zero for controllable joints.
@@ -3667,7 +3837,13 @@ protected:
     ///
     /// Assumes plink has _info initialized correctly, so will be initializing the other data depending on it.
     /// Can only be called before internal robot hierarchy is initialized.
-    void _InitAndAddLink(LinkPtr plink);
+    /// \param bGeometriesInitialized if true, the geometries of plink were already created by \ref _InitLinkGeometries
+    void _InitAndAddLink(LinkPtr plink, bool bGeometriesInitialized=false);
+
+    /// \brief creates the geometries of the links from their _info and tessellates the ones that do not have a collision mesh yet.
+    ///
+    /// Tessellation is independent for every geometry, so bodies with many geometries are tessellated on several threads.
+    void _InitLinkGeometries(const std::vector<LinkPtr>& vlinks);
 
     /// \brief initializes and adds a link to internal hierarchy.
     ///
@@ -3697,6 +3873,7 @@ protected:
     std::vector<JointPtr> _vPassiveJoints; ///< \see GetPassiveJoints()
     std::vector<int8_t> _vAdjacentLinks; ///< a vector of which links are connected to which if link i and j are connected and i < j, then value at (i + j * (j - 1) /2) is 1 where N is the number of links for the body
     std::vector<int8_t> _vForcedAdjacentLinks; ///< internally stores forced adjacent links. \see _vAdjacentLinks for internal representation
+    std::vector<int8_t> _vDisabledCollisionLinks; ///< link pairs removed from the non-adjacent links. \see SetDisabledCollisionLinkPairs, _vAdjacentLinks for internal representation
     std::list<KinBodyWeakPtr> _listAttachedBodies; ///< list of bodies that are directly attached to this body (can have duplicates)
 
     std::vector<Transform*> _vLinkTransformPointers; ///< holds a pointers to the Transform Link::_t  in _veclinks. Used for fast access fo the custom kinematics
@@ -3726,6 +3903,10 @@ protected:
 
     int _environmentBodyIndex; ///< \see GetEnvironmentBodyIndex
     mutable int _nUpdateStampId; ///< \see GetUpdateStamp
+    int _nFKUpdateStamp; ///< update stamp right after the last forward kinematics of SetDOFValues. While it is equal to _nUpdateStampId, the link transforms are consistent with the dof values and SetDOFValues can recompute only the affected links.
+    int _nIncrementalFKPrevStamp, _nIncrementalFKStamp; ///< update stamps before and after the last incremental SetDOFValues, \see GetLinksMovedSinceUpdateStamp
+    std::vector<int> _vIncrementalFKMovedLinks; ///< links recomputed by the last incremental SetDOFValues
+    std::vector<dReal> _vPrevDOFValuesCache; ///< cache
     uint32_t _nParametersChanged; ///< set of parameters that changed and need callbacks
     ManageDataPtr _pManageData;
     uint32_t _nHierarchyComputed; ///< 2 if the joint heirarchy and other cached information is computed. 1 if the hierarchy information is computing
@@ -3737,7 +3918,9 @@ protected:
     boost::shared_ptr<rapidjson::Document> _prAssociatedFileEntries; ///< files tag maintaining entries of data files associated with this object
     Transform _baseLinkInBodyTransform; ///< the transform of the base link in the body coordinate frame. The body transform returned is baselink->GetTransform() * _baseLinkInBodyTransform.inverse(). When setting a transform, the base link transform becomes body->GetTransform() * _baseLinkInBodyTransform
     Transform _invBaseLinkInBodyTransform; ///< _baseLinkInBodyTransform.inverse() for speedup
-    mutable std::string __hashKinematicsGeometryDynamics; ///< hash serializing kinematics, dynamics and geometry properties of the KinBody
+    mutable std::string __hashKinematicsGeometryDynamics; ///< hash serializing kinematics, dynamics and geometry properties of the KinBody, valid for __nKinematicsGeometryDynamicsHashDigest
+    mutable uint64_t __nKinematicsGeometryDynamicsDigest = 0; ///< \see GetKinematicsGeometryDigest, 0 if it has to be recomputed
+    mutable uint64_t __nKinematicsGeometryDynamicsHashDigest = 0; ///< the digest __hashKinematicsGeometryDynamics was computed for. If the structure did not change, the md5 is not recomputed
     int64_t _lastModifiedAtUS=0; ///< us, linux epoch, last modified time of the kinbody when it was originally loaded from the environment.
     int64_t _revisionId = 0; ///< the webstack revision for this loaded kinbody
 
@@ -2635,6 +2635,7 @@ OPENRAVE_API ConfigurationSpecification RaveGetAffineConfigurationSpecification(
 #include <openrave/sensorsystem.h>
 #include <openrave/viewer.h>
 #include <openrave/environment.h>
+#include <openrave/threadpool.h>
 
 namespace OpenRAVE {
 
@@ -2855,6 +2856,16 @@ OPENRAVE_API EnvironmentBasePtr RaveGetEnvironment(int id);
 /// \brief Return all the created OpenRAVE environments.
 OPENRAVE_API void RaveGetEnvironments(std::list<EnvironmentBasePtr>& listenvironments);
 
+/// \brief Returns the process wide \ref ThreadPool, creating it on first use.
+OPENRAVE_API ThreadPoolPtr RaveGetThreadPool();
+
+/// \brief Sets the number of worker threads of the process wide \ref ThreadPool.
+///
+/// The current pool is released and the next \ref RaveGetThreadPool creates a new one, its pending tasks are cancelled once nobody holds it anymore.
+/// \param numthreads if <= 0, uses the OPENRAVE_NUM_THREADS environment variable or the number of hardware threads
+/// \throw openrave_exception ORE_InvalidState when called from a worker thread of a pool
+OPENRAVE_API void RaveSetThreadPoolNumThreads(int numthreads);
+
 /// \brief Returns the current registered reader for the interface type/xmlid
 ///
 /// \throw openrave_exception Will throw with ORE_InvalidArguments if registered function could not be found.
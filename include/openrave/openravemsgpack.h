@@ -23,6 +23,9 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstring>
+#include <type_traits>
+#include <stdint.h>
 
 #include <rapidjson/document.h>
 
@@ -30,12 +33,95 @@ namespace OpenRAVE {
 
 namespace MsgPack {
 
+/// \brief msgpack extension type of typed numeric arrays.
+///
+/// The payload is one type character followed by the little-endian values: 'd' float64, 'f' float32, 'q' int64, 'i' int32.
+/// This matches the numpy type characters, so python clients can send msgpack.ExtType(16, b'd'+array.astype('<f8').tobytes()).
+/// In a rapidjson document, a typed array is an object {"__typedarray__": typecharacter, "data": raw bytes as string}.
+static const int8_t MSGPACK_EXT_TYPEDARRAY = 16;
+
+/// \brief read-only view of the values of a typed array, does not own the data
+class TypedArrayView
+{
+public:
+    TypedArrayView() : _pdata(NULL), _size(0), _typecode(0) {
+    }
+    TypedArrayView(const char* pdata, size_t size, char typecode) : _pdata(pdata), _size(size), _typecode(typecode) {
+    }
+
+    /// \brief number of values
+    inline size_t size() const {
+        return _size;
+    }
+
+    /// \brief type character, see \ref MSGPACK_EXT_TYPEDARRAY
+    inline char GetTypeCode() const {
+        return _typecode;
+    }
+
+    /// \brief the raw values, they are not aligned in general
+    inline const char* GetData() const {
+        return _pdata;
+    }
+
+    /// \brief value at index i converted to double
+    inline double operator[](size_t i) const {
+        switch(_typecode) {
+        case 'd': { double v; std::memcpy(&v, _pdata+i*sizeof(v), sizeof(v)); return v; }
+        case 'f': { float v; std::memcpy(&v, _pdata+i*sizeof(v), sizeof(v)); return v; }
+        case 'q': { int64_t v; std::memcpy(&v, _pdata+i*sizeof(v), sizeof(v)); return (double)v; }
+        case 'i': { int32_t v; std::memcpy(&v, _pdata+i*sizeof(v), sizeof(v)); return v; }
+        default: return 0;
+        }
+    }
+
+    /// \brief sets v to the values
+    template <typename T>
+    void CopyTo(std::vector<T>& v) const {
+        v.resize(_size);
+        if( _size > 0 && ((_typecode == 'd' && std::is_same<T, double>::value) || (_typecode == 'f' && std::is_same<T, float>::value)) ) {
+            std::memcpy(&v[0], _pdata, _size*sizeof(T));
+            return;
+        }
+        for(size_t i = 0; i < _size; ++i) {
+            v[i] = (T)(*this)[i];
+        }
+    }
+
+private:
+    const char* _pdata;
+    size_t _size;
+    char _typecode;
+};
+
+/// \brief returns the size in bytes of one value of a type character, 0 if the type is not supported
+OPENRAVE_API size_t GetTypedArrayElementSize(char typecode);
+
+/// \brief if value is a typed array, sets view to its values and returns true
+///
+/// A typed array is an object with exactly the two members "__typedarray__" and "data", objects with more members are not typed arrays.
+OPENRAVE_API bool GetTypedArrayView(const rapidjson::Value& value, TypedArrayView& view);
+
+/// \brief sets values from either a typed array or a regular array of numbers
+///
+/// \throw openrave_exception if value is neither
+OPENRAVE_API void LoadNumberArray(const rapidjson::Value& value, std::vector<double>& values);
+
+/// \brief sets value to a typed array of float64 holding a copy of values
+OPENRAVE_API void SetTypedArray(rapidjson::Value& value, const std::vector<double>& values, rapidjson::Document::AllocatorType& allocator);
+
+/// \brief serializes value, typed arrays are written as \ref MSGPACK_EXT_TYPEDARRAY extensions
 OPENRAVE_API void DumpMsgPack(const rapidjson::Value& value, std::ostream& os);
 OPENRAVE_API void DumpMsgPack(const rapidjson::Value& value, std::vector<char>& output);
 
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, const std::string& str);
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, std::istream& is);
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, const void* data, size_t size);
+
+/// \brief parses a msgpack buffer
+///
+/// \param bReferenceTypedArrays if true, the typed arrays of d point to data instead of holding a copy, so data has to outlive d
+OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, const void* data, size_t size, bool bReferenceTypedArrays);
 } // namespace MsgPack
 
 } // namespace OpenRAVE
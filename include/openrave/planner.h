@@ -632,6 +632,8 @@ public:
 public:
         PlannerProgress();
         int _iteration;
+        dReal _fSolutionCost; ///< for anytime planners, the cost of the best solution found so far. Negative if there is no solution yet.
+        std::vector<dReal> _vSolutionConfigs; ///< for anytime planners, the waypoints of the best solution found so far in the configuration space of the parameters.
     };
 
     PlannerBase(EnvironmentBasePtr penv);
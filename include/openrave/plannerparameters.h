@@ -733,11 +733,15 @@ typedef boost::shared_ptr<WorkspaceTrajectoryParameters const> WorkspaceTrajecto
 class OPENRAVE_API RRTParameters : public PlannerBase::PlannerParameters
 {
 public:
-    RRTParameters() : _minimumgoalpaths(1), _bProcessing(false) {
+    RRTParameters() : _minimumgoalpaths(1), _bLazyEdgeChecking(false), _bInformedSampling(true), _bProcessing(false) {
         _vXMLParameters.push_back("minimumgoalpaths");
+        _vXMLParameters.push_back("lazyedgechecking");
+        _vXMLParameters.push_back("informedsampling");
     }
 
     size_t _minimumgoalpaths; ///< minimum number of goals to connect to before exiting. the goal with the shortest path is returned.
+    bool _bLazyEdgeChecking; ///< if true, the trees only check the constraints of the new states when growing, and the edges are checked once they are part of a path connecting a start and a goal. Invalid edges are removed from the trees and growing continues. Used by BiRRT.
+    bool _bInformedSampling; ///< if true, once there is a solution only the states that can shorten it are sampled. If false, the whole space keeps being sampled like plain RRT*. Used by InformedRRTStar.
 
 protected:
     bool _bProcessing;
@@ -747,6 +751,8 @@ protected:
             return false;
         }
         O << "<minimumgoalpaths>" << _minimumgoalpaths << "</minimumgoalpaths>" << std::endl;
+        O << "<lazyedgechecking>" << _bLazyEdgeChecking << "</lazyedgechecking>" << std::endl;
+        O << "<informedsampling>" << _bInformedSampling << "</informedsampling>" << std::endl;
         if( !(options & 1) ) {
             O << _sExtraParameters << std::endl;
         }
@@ -764,7 +770,7 @@ protected:
         case PE_Ignore: return PE_Ignore;
         }
 
-        _bProcessing = name=="minimumgoalpaths";
+        _bProcessing = name=="minimumgoalpaths" || name=="lazyedgechecking" || name=="informedsampling";
         return _bProcessing ? PE_Support : PE_Pass;
     }
 
@@ -774,6 +780,12 @@ protected:
             if( name == "minimumgoalpaths") {
                 _ss >> _minimumgoalpaths;
             }
+            else if( name == "lazyedgechecking" ) {
+                _ss >> _bLazyEdgeChecking;
+            }
+            else if( name == "informedsampling" ) {
+                _ss >> _bInformedSampling;
+            }
             else {
                 RAVELOG_WARN(str(boost::format("unknown tag %s\n")%name));
             }
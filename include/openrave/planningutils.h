@@ -416,6 +416,34 @@ public:
  */
 OPENRAVE_API void GetDHParameters(std::vector<DHParameter>&vparameters, KinBodyConstPtr pbody);
 
+/// \brief how often a link pair collides over the joint space. \see ComputeLinkPairCollisionClasses
+enum LinkPairCollisionClass
+{
+    LPCC_Never = 0, ///< the pair did not collide in any sample
+    LPCC_Sometimes = 1, ///< the pair collided in some samples
+    LPCC_Always = 2, ///< the pair collided in all samples
+};
+
+/** \brief samples the joint space of the body in parallel and classifies every non-adjacent link pair by how often it collides.
+
+    The samples are split into numthreads shares that are checked on \ref RaveGetThreadPool, every share in its own clone of the environment, so the original environment is only locked while cloning.
+    Only the link pairs of the body are checked. Grabbed bodies are ignored, and all links are enabled in the clones.
+    Infinite joint limits are sampled in [-pi, pi]. Since the classification is statistical, a rare collision can be missed by too few samples.
+    \param[out] vpairclasses one entry for every non-adjacent link pair, the pair is encoded as index0|(index1<<16) with index0 < index1 like \ref KinBody::GetNonAdjacentLinks
+    \param numsamples number of random configurations within the joint limits
+    \param numthreads number of shares checked in parallel, if <= 0 uses the number of thread pool workers. Every share has its own seed, so the result only depends on numsamples and numthreads
+ */
+OPENRAVE_API void ComputeLinkPairCollisionClasses(KinBodyConstPtr pbody, std::vector< std::pair<int, LinkPairCollisionClass> >& vpairclasses, int numsamples=10000, int numthreads=0);
+
+/** \brief disables the self collision checking of the link pairs of the body that never or always collide, \see KinBody::SetDisabledCollisionLinkPairs
+
+    The classes are stored in the database directory keyed by \ref KinBody::GetKinematicsGeometryHash, and are only computed with \ref ComputeLinkPairCollisionClasses
+    if no stored result with at least numsamples samples exists.
+    \param busedatabase if false, always computes the classes and does not store them
+    \return the number of disabled link pairs
+ */
+OPENRAVE_API int SetDisabledCollisionLinkPairsFromSampling(KinBodyPtr pbody, int numsamples=10000, int numthreads=0, bool busedatabase=true);
+
 /** \brief dynamics and collision checking with linear interpolation
 
     For any joints with maxtorque > 0, uses KinBody::ComputeInverseDynamics to check if the necessary torque exceeds the max torque. Max torque is always called via GetMaxTorque
@@ -497,6 +525,8 @@ protected:
     std::vector<dReal> _doftorques, _dofaccelerations; ///< in body DOF space
     boost::shared_ptr<ConfigurationSpecification::SetConfigurationStateFn> _setvelstatefn;
     std::vector<dReal> _vfulldofdynamicaccelerationlimits, _vfulldofdynamicjerklimits, _vfulldofvalues, _vfulldofvelocities; ///< in body full DOF space. the size is GetDOF().
+    std::map<KinBodyPtr, KinBody::InverseDynamicsModelPtr> _mapinversedynamicsmodels; ///< models for checking the torques, extracted the first time a body is checked. Null if the body is not supported by the models.
+    KinBody::InverseDynamicsModel::Workspace _inversedynamicsworkspace;
 };
 
 typedef boost::shared_ptr<DynamicsCollisionConstraint> DynamicsCollisionConstraintPtr;
@@ -1415,6 +1415,8 @@ private:
         return OPENRAVE_KINBODY_HASH;
     }
     mutable std::string __hashrobotstructure;
+    mutable std::string __hashrobotstructurelast; ///< last computed robot structure hash, reused if __nRobotStructureDigest did not change
+    mutable uint64_t __nRobotStructureDigest = 0; ///< digest __hashrobotstructurelast was computed for
     mutable std::vector<dReal> _vTempRobotJoints;
 
 #ifdef RAVE_PRIVATE
@@ -0,0 +1,197 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/** \file threadpool.h
+    \brief Process wide task scheduler for parallel work.
+
+    Automatically included with \ref openrave.h
+ */
+#ifndef OPENRAVE_THREADPOOL_H
+#define OPENRAVE_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace OpenRAVE {
+
+class ThreadPool;
+class ThreadPoolTask;
+typedef boost::shared_ptr<ThreadPool> ThreadPoolPtr;
+typedef boost::shared_ptr<ThreadPoolTask> ThreadPoolTaskPtr;
+
+/// \brief counters of a \ref ThreadPool since it was created
+struct OPENRAVE_API ThreadPoolStatistics
+{
+    ThreadPoolStatistics() : numthreads(0), numsubmitted(0), numfinished(0), numfailed(0), numcancelled(0), numstolen(0), numpending(0), numclonescreated(0), numclonessynchronized(0) {
+    }
+
+    int numthreads; ///< number of worker threads
+    uint64_t numsubmitted; ///< tasks submitted
+    uint64_t numfinished; ///< tasks that ran to completion without throwing
+    uint64_t numfailed; ///< tasks that threw an exception
+    uint64_t numcancelled; ///< tasks cancelled before they started running
+    uint64_t numstolen; ///< tasks a worker took from the queue of another worker
+    uint64_t numpending; ///< tasks currently waiting to be run
+    uint64_t numclonescreated; ///< environment clones created for tasks with environment affinity
+    uint64_t numclonessynchronized; ///< times an existing clone was updated from its source environment
+};
+
+/// \brief handle of a task submitted to a \ref ThreadPool, used to wait for it, cancel it and get its exception
+class OPENRAVE_API ThreadPoolTask : public boost::noncopyable
+{
+public:
+    enum TaskState {
+        TS_Pending=0, ///< waiting in a queue
+        TS_Running=1,
+        TS_Finished=2, ///< ran to completion
+        TS_Failed=3, ///< the task threw, \ref Wait rethrows the exception
+        TS_Cancelled=4, ///< cancelled before it started running, the task never runs
+    };
+
+    ThreadPoolTask(const boost::function<void()>& fn);
+    virtual ~ThreadPoolTask();
+
+    /// \brief requests the task to be cancelled.
+    ///
+    /// A pending task is removed from scheduling and never runs. A running task keeps running, it can poll \ref ThreadPool::IsCancelRequested to stop early.
+    void Cancel();
+
+    /// \brief true if \ref Cancel was called
+    inline bool IsCancelRequested() const {
+        return _bCancelRequested;
+    }
+
+    inline TaskState GetState() const {
+        return (TaskState)_state.load();
+    }
+
+    /// \brief true if the task finished, failed or was cancelled
+    inline bool IsDone() const {
+        return GetState() >= TS_Finished;
+    }
+
+    /// \brief blocks until the task is done.
+    ///
+    /// When called from a worker thread of the pool, the thread runs other pending tasks while waiting, so tasks can wait on the tasks they submit.
+    /// \return true if the task ran, false if it was cancelled before running
+    /// \throw the exception thrown by the task
+    bool Wait();
+
+private:
+    /// \brief sets a finished state and wakes up the waiters
+    void _SetDone(TaskState state, std::exception_ptr exception=std::exception_ptr());
+
+    boost::function<void()> _fn;
+    std::atomic<int> _state; ///< TaskState
+    std::atomic<bool> _bCancelRequested;
+    std::exception_ptr _exception; ///< set when _state is TS_Failed
+    std::mutex _mutex; ///< protects _condition
+    std::condition_variable _condition; ///< notified when the task is done
+
+    friend class ThreadPool;
+};
+
+/** \brief Work stealing task scheduler.
+
+    Every worker thread owns a queue. Tasks submitted from a worker go to the back of its own queue and are run last in first out, tasks submitted
+    from other threads go to a shared queue. An idle worker takes from its own queue, then the shared queue, then steals from the front of the
+    queues of the other workers, so nested parallel work spreads over the threads without a central bottleneck.
+
+    Tasks can have affinity to an environment: every worker keeps one clone per source environment and cloning options, and passes it to the task,
+    so tasks never touch the source environment and the clone is reused by all later tasks on that worker. When the clone is synchronized, the
+    source environment is locked, so do not wait on such tasks while holding the lock of their source environment.
+
+    The process wide pool is returned by \ref RaveGetThreadPool. Its size is set with \ref RaveSetThreadPoolNumThreads or the OPENRAVE_NUM_THREADS
+    environment variable and defaults to the number of hardware threads.
+ */
+class OPENRAVE_API ThreadPool : public boost::noncopyable
+{
+public:
+    /// \param numthreads number of worker threads, if <= 0 uses the number of hardware threads
+    ThreadPool(int numthreads=0);
+
+    /// \brief cancels the pending tasks and joins the workers
+    virtual ~ThreadPool();
+
+    /// \brief schedules fn to be run on a worker thread
+    ThreadPoolTaskPtr Submit(const boost::function<void()>& fn);
+
+    /** \brief schedules fn to be run on a worker thread with the clone of penv owned by that worker
+
+        \param penv the source environment, the task never accesses it directly
+        \param cloningoptions \ref CloningOptions of the clone, clones of different options are kept separately
+        \param bSynchronize if true, the clone is updated from penv before the task runs, otherwise it is only created once per worker. Only pass false when the source environment does not change during the batch of tasks.
+     */
+    ThreadPoolTaskPtr SubmitWithEnvironment(EnvironmentBasePtr penv, int cloningoptions, const boost::function<void(EnvironmentBasePtr)>& fn, bool bSynchronize=true);
+
+    /** \brief calls fn(index) for every index in [0, num) and returns when all are done
+
+        The calling thread takes part in the work. Once any call throws, the remaining indices are skipped and the first exception is rethrown.
+        \param grainsize the minimum number of indices worth a task of its own, if num is not larger than it everything runs on the calling thread
+     */
+    void ParallelFor(size_t num, const boost::function<void(size_t)>& fn, size_t grainsize=1);
+
+    /// \brief cancels all pending tasks, running tasks are not affected
+    void CancelAll();
+
+    inline int GetNumThreads() const {
+        return (int)_vworkers.size();
+    }
+
+    ThreadPoolStatistics GetStatistics() const;
+
+    /// \brief true if the task running on the calling thread was asked to cancel. false when not called from a task.
+    static bool IsCancelRequested();
+
+    /// \brief true if the calling thread is a worker of any pool
+    static bool IsWorkerThread();
+
+private:
+    struct Worker;
+    typedef boost::shared_ptr<Worker> WorkerPtr;
+
+    void _Enqueue(const ThreadPoolTaskPtr& ptask);
+
+    /// \brief the worker of the calling thread, null if the thread does not belong to this pool
+    Worker* _GetCurrentWorker() const;
+
+    /// \brief pops the next task for pworker, pworker can be null when the calling thread does not belong to the pool
+    ThreadPoolTaskPtr _PopTask(Worker* pworker);
+
+    void _RunTask(const ThreadPoolTaskPtr& ptask);
+
+    void _WorkerThread(Worker* pworker);
+
+    /// \brief returns the clone of penv owned by pworker, creating or synchronizing it
+    EnvironmentBasePtr _GetWorkerClone(Worker* pworker, EnvironmentBasePtr penv, int cloningoptions, bool bSynchronize);
+
+    std::vector<WorkerPtr> _vworkers;
+    std::deque<ThreadPoolTaskPtr> _queuetasks; ///< tasks submitted from outside of the workers, protected by _mutex
+    mutable std::mutex _mutex;
+    std::condition_variable _condition; ///< notified when tasks are added or on shutdown
+    std::atomic<size_t> _numpending; ///< tasks in all the queues, incremented under _mutex so that sleeping workers do not miss it
+    bool _bShutdown; ///< protected by _mutex
+
+    std::atomic<uint64_t> _numsubmitted, _numfinished, _numfailed, _numcancelled, _numstolen, _numclonescreated, _numclonessynchronized;
+
+    friend class ThreadPoolTask;
+};
+
+} // end namespace OpenRAVE
+
+#endif
@@ -289,6 +289,19 @@ OPENRAVE_API std::string GetMD5HashString(const std::string& s);
 /// \brief compute the md5 hash of an array
 OPENRAVE_API std::string GetMD5HashString(const std::vector<uint8_t>& v);
 
+/// \brief compute a fast non-cryptographic 64bit hash (FNV-1a) of a string.
+///
+/// Only meant for in-process keys, use \ref GetMD5HashString for anything that is stored.
+OPENRAVE_API uint64_t GetFastHash(const std::string& s, uint64_t seed=0xcbf29ce484222325ULL);
+/// \brief compute a fast non-cryptographic 64bit hash (FNV-1a) of a memory block, pass the previous hash as seed to continue hashing
+OPENRAVE_API uint64_t GetFastHash(const uint8_t* pdata, size_t size, uint64_t seed=0xcbf29ce484222325ULL);
+
+/// \brief combines value into the hash seed, the result depends on the order of the combinations
+inline uint64_t CombineFastHash(uint64_t seed, uint64_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
 template<class T>
 inline T ClampOnRange(T value, T min, T max)
 {
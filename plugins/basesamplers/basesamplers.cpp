@@ -18,6 +18,7 @@
 
 #include "mt19937ar.h"
 #include "halton.h"
+#include "philox.h"
 #include "robotconfiguration.h"
 #include "bodyconfiguration.h"
 
@@ -25,6 +26,7 @@ BaseSamplersPlugin::BaseSamplersPlugin()
 {
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("MT19937");
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("Halton");
+    _interfaces[OpenRAVE::PT_SpaceSampler].push_back("Philox");
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("RobotConfiguration");
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("BodyConfiguration");
 }
@@ -41,6 +43,9 @@ OpenRAVE::InterfaceBasePtr BaseSamplersPlugin::CreateInterface(OpenRAVE::Interfa
         else if( interfacename == "halton" ) {
             return InterfaceBasePtr(new HaltonSampler(penv,sinput));
         }
+        else if( interfacename == "philox" ) {
+            return InterfaceBasePtr(new PhiloxSampler(penv,sinput));
+        }
         else if( interfacename == "robotconfiguration" ) {
             return InterfaceBasePtr(new RobotConfigurationSampler(penv,sinput));
         }
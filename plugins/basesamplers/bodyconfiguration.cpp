@@ -17,6 +17,7 @@
 #include "bodyconfiguration.h"
 
 #include <boost/bind/bind.hpp>
+#include <sstream>
 #include <string>
 
 using namespace boost::placeholders;
@@ -32,6 +33,8 @@ By default will sample the entire body space, can use 'SetDOFs' command to set a
 ";
     RegisterCommand("SetDOFs",boost::bind(&BodyConfigurationSampler::SetDOFsCommand,this,_1,_2),
                     "set new indices to sample from.");
+    RegisterCommand("SetStream",boost::bind(&BodyConfigurationSampler::SetStreamCommand,this,_1,_2),
+                    "Sets the stream id of the underlying sampler, switches to the counter-based 'philox' sampler if the current one has no streams. Call SetSeed afterwards.");
     std::string name;
     sinput >> name;
     _pbody = GetEnv()->GetKinBody(name);
@@ -95,6 +98,26 @@ int BodyConfigurationSampler::SampleSequence(std::vector<dReal>& samples, size_t
     return (int)num;
 }
 
+bool BodyConfigurationSampler::SetStreamCommand(std::ostream& sout, std::istream& sinput)
+{
+    uint32_t streamid = 0;
+    sinput >> streamid;
+    if( !sinput || !_psampler ) {
+        return false;
+    }
+    if( !_psampler->SupportsCommand("SetStream") ) {
+        SpaceSamplerBasePtr pstreamsampler = RaveCreateSpaceSampler(GetEnv(), "philox");
+        if( !pstreamsampler ) {
+            return false;
+        }
+        pstreamsampler->SetSpaceDOF(_psampler->GetDOF());
+        _psampler = pstreamsampler;
+    }
+    std::stringstream ssinput;
+    ssinput << "SetStream " << streamid;
+    return _psampler->SendCommand(sout, ssinput);
+}
+
 bool BodyConfigurationSampler::SetDOFsCommand(std::ostream& sout, std::istream& sinput)
 {
     std::vector<int> dofindices((std::istream_iterator<int>(sinput)), std::istream_iterator<int>());
@@ -37,6 +37,7 @@ public:
 protected:
 
     bool SetDOFsCommand(std::ostream& sout, std::istream& sinput);
+    bool SetStreamCommand(std::ostream& sout, std::istream& sinput);
 
     void _UpdateDOFs();
 
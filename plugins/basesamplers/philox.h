@@ -0,0 +1,249 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef SAMPLER_PHILOX
+#define SAMPLER_PHILOX
+
+#include <openrave/openrave.h>
+
+#include <algorithm>
+#include <boost/bind/bind.hpp>
+
+using namespace OpenRAVE;
+using namespace std;
+
+/// \brief Philox4x32-10 counter-based generator from "Parallel Random Numbers: As Easy as 1, 2, 3" (Salmon et al. 2011).
+///
+/// Every block of 4 values is a keyed bijection of its 64-bit block index, so the key (seed, stream id) selects one of 2^32 independent streams per seed
+/// and no state other than the block index has to be kept. Blocks are generated _nBufferBlocks at a time with the four counter words in separate arrays,
+/// the loops over the blocks have no dependencies between iterations so that the compiler can vectorize them.
+class PhiloxSampler : public SpaceSamplerBase
+{
+public:
+    PhiloxSampler(EnvironmentBasePtr penv,std::istream& sinput) : SpaceSamplerBase(penv), _seed(0), _streamid(0), _blockcounter(0), _bufferindex(_nBufferValues), _dof(1)
+    {
+        __description = ":Interface Author: Rosen Diankov\n\n\
+Philox4x32-10 counter-based sampler. Values are a keyed hash of their position in the stream, the key is the seed and a stream id so that parallel planners can give \
+every thread its own independent and reproducible stream of the same seed. When creating can pass the following parameters::\n\n\
+  Philox [seed] [stream id]\n\n\
+SetSeed restarts the current stream at the given seed, the stream id is kept until changed with the SetStream command.";
+        RegisterCommand("SetStream",boost::bind(&PhiloxSampler::_SetStreamCommand,this,boost::placeholders::_1,boost::placeholders::_2),
+                        "Sets the stream id and restarts the stream at the current seed. Streams with different ids are independent.");
+        RegisterCommand("GetStream",boost::bind(&PhiloxSampler::_GetStreamCommand,this,boost::placeholders::_1,boost::placeholders::_2),
+                        "Returns the seed, the stream id and the number of values already used from the stream.");
+        uint32_t seed = 0, streamid = 0;
+        if( sinput >> seed ) {
+            if( !(sinput >> streamid) ) {
+                streamid = 0;
+            }
+        }
+        else {
+            seed = 0;
+        }
+        _streamid = streamid;
+        SetSeed(seed);
+    }
+
+    void SetSeed(uint32_t seed) {
+        _seed = seed;
+        _blockcounter = 0;
+        _bufferindex = _nBufferValues;
+    }
+
+    void SetSpaceDOF(int dof) {
+        BOOST_ASSERT(dof > 0); _dof = dof;
+    }
+    int GetDOF() const {
+        return _dof;
+    }
+    int GetNumberOfValues() const {
+        return _dof;
+    }
+
+    bool Supports(SampleDataType type) const {
+        return true;
+    }
+
+    void GetLimits(std::vector<dReal>& vLowerLimit, std::vector<dReal>& vUpperLimit) const
+    {
+        vLowerLimit.resize(_dof);
+        vUpperLimit.resize(_dof);
+        for(int i = 0; i < _dof; ++i) {
+            vLowerLimit[i] = 0;
+            vUpperLimit[i] = 1;
+        }
+    }
+
+    void GetLimits(std::vector<uint32_t>& vLowerLimit, std::vector<uint32_t>& vUpperLimit) const
+    {
+        vLowerLimit.resize(_dof);
+        vUpperLimit.resize(_dof);
+        for(int i = 0; i < _dof; ++i) {
+            vLowerLimit[i] = 0;
+            vUpperLimit[i] = 0xffffffff;
+        }
+    }
+
+    int SampleSequence(std::vector<dReal>& samples, size_t num=1,IntervalType interval=IT_Closed)
+    {
+        dReal foffset = 0, fscale = 0;
+        _GetIntervalTransform(interval, foffset, fscale);
+        samples.resize(_dof*num);
+        size_t index = 0;
+        while( index < samples.size() ) {
+            if( _bufferindex >= _nBufferValues ) {
+                _GenerateBlocks();
+            }
+            // convert a whole run of the buffer at once
+            size_t count = std::min(samples.size()-index, _nBufferValues-_bufferindex);
+            dReal* psamples = &samples[index];
+            const uint32_t* pvalues = &_vbuffer[_bufferindex];
+            for(size_t i = 0; i < count; ++i) {
+                psamples[i] = ((dReal)pvalues[i] + foffset)*fscale;
+            }
+            index += count;
+            _bufferindex += count;
+        }
+        return (int)num;
+    }
+
+    dReal SampleSequenceOneReal(IntervalType interval=IT_Closed)
+    {
+        OPENRAVE_ASSERT_OP_FORMAT0(GetDOF(),==,1,"sample can only be 1 dof", ORE_InvalidState);
+        dReal foffset = 0, fscale = 0;
+        _GetIntervalTransform(interval, foffset, fscale);
+        return ((dReal)_NextUInt32() + foffset)*fscale;
+    }
+
+    int SampleSequence(std::vector<uint32_t>& samples, size_t num)
+    {
+        samples.resize(_dof*num);
+        size_t index = 0;
+        while( index < samples.size() ) {
+            if( _bufferindex >= _nBufferValues ) {
+                _GenerateBlocks();
+            }
+            size_t count = std::min(samples.size()-index, _nBufferValues-_bufferindex);
+            std::copy(_vbuffer+_bufferindex, _vbuffer+_bufferindex+count, samples.begin()+index);
+            index += count;
+            _bufferindex += count;
+        }
+        return (int)num;
+    }
+
+    virtual uint32_t SampleSequenceOneUInt32()
+    {
+        OPENRAVE_ASSERT_OP_FORMAT0(GetDOF(),==,1,"sample can only be 1 dof", ORE_InvalidState);
+        return _NextUInt32();
+    }
+
+private:
+    bool _SetStreamCommand(std::ostream& sout, std::istream& sinput)
+    {
+        uint32_t streamid = 0;
+        sinput >> streamid;
+        if( !sinput ) {
+            return false;
+        }
+        _streamid = streamid;
+        SetSeed(_seed);
+        return true;
+    }
+
+    bool _GetStreamCommand(std::ostream& sout, std::istream& sinput)
+    {
+        sout << _seed << " " << _streamid << " " << (_blockcounter*4 - (_nBufferValues - _bufferindex));
+        return !!sout;
+    }
+
+    /// \brief maps a 32-bit value x to the interval as (x+offset)*scale, same intervals as the mt19937 sampler
+    static void _GetIntervalTransform(IntervalType interval, dReal& foffset, dReal& fscale)
+    {
+        switch(interval) {
+        case IT_Open:
+            foffset = 0.5; fscale = 1/(dReal)4294967296.0;
+            break;
+        case IT_OpenStart:
+            foffset = 1; fscale = 1/(dReal)4294967296.0;
+            break;
+        case IT_OpenEnd:
+            foffset = 0; fscale = 1/(dReal)4294967296.0;
+            break;
+        case IT_Closed:
+            foffset = 0; fscale = 1/(dReal)4294967295.0;
+            break;
+        default:
+            throw OPENRAVE_EXCEPTION_FORMAT0("invalid interval", ORE_InvalidArguments);
+        }
+    }
+
+    inline uint32_t _NextUInt32()
+    {
+        if( _bufferindex >= _nBufferValues ) {
+            _GenerateBlocks();
+        }
+        return _vbuffer[_bufferindex++];
+    }
+
+    /// \brief fills _vbuffer with the next _nBufferBlocks blocks of the stream
+    void _GenerateBlocks()
+    {
+        uint32_t c0[_nBufferBlocks], c1[_nBufferBlocks], c2[_nBufferBlocks], c3[_nBufferBlocks];
+        for(size_t j = 0; j < _nBufferBlocks; ++j) {
+            uint64_t counter = _blockcounter + j;
+            c0[j] = (uint32_t)counter;
+            c1[j] = (uint32_t)(counter >> 32);
+            c2[j] = 0;
+            c3[j] = 0;
+        }
+
+        uint32_t k0 = _seed, k1 = _streamid;
+        for(int iround = 0; iround < 10; ++iround) {
+            for(size_t j = 0; j < _nBufferBlocks; ++j) {
+                uint64_t p0 = (uint64_t)0xD2511F53u*c0[j];
+                uint64_t p1 = (uint64_t)0xCD9E8D57u*c2[j];
+                uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[j] ^ k0;
+                uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[j] ^ k1;
+                c1[j] = (uint32_t)p1;
+                c3[j] = (uint32_t)p0;
+                c0[j] = n0;
+                c2[j] = n2;
+            }
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+
+        for(size_t j = 0; j < _nBufferBlocks; ++j) {
+            _vbuffer[4*j+0] = c0[j];
+            _vbuffer[4*j+1] = c1[j];
+            _vbuffer[4*j+2] = c2[j];
+            _vbuffer[4*j+3] = c3[j];
+        }
+        _blockcounter += _nBufferBlocks;
+        _bufferindex = 0;
+    }
+
+    static const size_t _nBufferBlocks = 64; ///< number of 4x32 blocks generated at once
+    static const size_t _nBufferValues = 4*_nBufferBlocks;
+
+    uint32_t _seed, _streamid; ///< the key of the stream
+    uint64_t _blockcounter; ///< index of the next block to generate
+    size_t _bufferindex; ///< next unused value of _vbuffer, _nBufferValues if the buffer is used up
+    uint32_t _vbuffer[_nBufferValues];
+    int _dof;
+};
+
+#endif
@@ -17,6 +17,7 @@
 #include "robotconfiguration.h"
 
 #include <boost/bind/bind.hpp>
+#include <sstream>
 #include <string>
 
 using namespace boost::placeholders;
@@ -32,6 +33,8 @@ If the robot active DOFs change, can use the 'TrackActiveSpace' command to autom
 ";
         RegisterCommand("TrackActiveSpace",boost::bind(&RobotConfigurationSampler::TrackActiveSpaceCommand,this,_1,_2),
                         "Enable/disable the automating updating of the active configuration space. Disabled by default.");
+        RegisterCommand("SetStream",boost::bind(&RobotConfigurationSampler::SetStreamCommand,this,_1,_2),
+                        "Sets the stream id of the underlying sampler, switches to the counter-based 'philox' sampler if the current one has no streams. Call SetSeed afterwards.");
         std::string robotname;
         sinput >> robotname;
         _probot = GetEnv()->GetRobot(robotname);
@@ -111,6 +114,26 @@ int RobotConfigurationSampler::SampleSequence(std::vector<dReal>& samples, size_
     return (int)num;
 }
 
+bool RobotConfigurationSampler::SetStreamCommand(std::ostream& sout, std::istream& sinput)
+{
+    uint32_t streamid = 0;
+    sinput >> streamid;
+    if( !sinput || !_psampler ) {
+        return false;
+    }
+    if( !_psampler->SupportsCommand("SetStream") ) {
+        SpaceSamplerBasePtr pstreamsampler = RaveCreateSpaceSampler(GetEnv(), "philox");
+        if( !pstreamsampler ) {
+            return false;
+        }
+        pstreamsampler->SetSpaceDOF(_psampler->GetDOF());
+        _psampler = pstreamsampler;
+    }
+    std::stringstream ssinput;
+    ssinput << "SetStream " << streamid;
+    return _psampler->SendCommand(sout, ssinput);
+}
+
 bool RobotConfigurationSampler::TrackActiveSpaceCommand(std::ostream& sout, std::istream& sinput)
 {
     bool btrack = false;
@@ -37,6 +37,7 @@ public:
 protected:
 
     bool TrackActiveSpaceCommand(std::ostream& sout, std::istream& sinput);
+    bool SetStreamCommand(std::ostream& sout, std::istream& sinput);
 
     Vector _SampleQuaternion();
 
@@ -15,6 +15,13 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bulletspace.h"
 
+#include <BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
+#include <BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h>
+#include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
+#include <BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h>
+#include <LinearMath/btAabbUtil2.h>
+#include <limits>
+
 class BulletCollisionChecker : public CollisionCheckerBase
 {
 private:
@@ -154,27 +161,6 @@ public:
         KinBody::LinkConstPtr _pcollink0, _pcollink1;
     };
 
-    class LinkAdjacentFilterCallback : public OpenRAVEFilterCallback
-    {
-public:
-        LinkAdjacentFilterCallback(KinBodyConstPtr pparent, const std::vector<int>& setadjacency) : OpenRAVEFilterCallback(), _pparent(pparent), _setadjacency(setadjacency) {
-        }
-
-        virtual bool CheckLinks(KinBody::LinkPtr plink0, KinBody::LinkPtr plink1) const
-        {
-            if(  plink0->GetParent() != _pparent ||plink1->GetParent() != _pparent ) {
-                return false;
-            }
-            // check if links are in adjacency list
-            int index0 = plink0->GetIndex();
-            int index1 = plink1->GetIndex();
-            return find(_setadjacency.begin(), _setadjacency.end(), index0|(index1<<16)) != _setadjacency.end() || find(_setadjacency.begin(), _setadjacency.end(), index1|(index0<<16)) != _setadjacency.end();
-        }
-
-        KinBodyConstPtr _pparent;
-        const std::vector<int>& _setadjacency;
-    };
-
     class KinBodyLinkFilterCallback : public OpenRAVEFilterCallback
     {
 public:
@@ -199,7 +185,7 @@ public:
     class btOpenraveDispatcher : public btCollisionDispatcher
     {
 public:
-        btOpenraveDispatcher(BulletCollisionChecker* pchecker, btCollisionConfiguration* collisionConfiguration) : btCollisionDispatcher(collisionConfiguration), _pchecker(pchecker) {
+        btOpenraveDispatcher(BulletCollisionChecker* pchecker, btCollisionConfiguration* collisionConfiguration) : btCollisionDispatcher(collisionConfiguration), _poverlapfilt(NULL), _pchecker(pchecker) {
         }
 
         // need special collision function
@@ -224,22 +210,84 @@ private:
         BulletCollisionChecker* _pchecker;
     };
 
-    class SetFilterScope
+    /// \brief collects the contacts of the pairs found by a targeted contactTest or contactPairTest query.
+    ///
+    /// The narrow phase is only run for the pairs that involve the queried link and pass the openrave filter, instead of every overlapping pair of the world.
+    class LinkContactResultCallback : public btCollisionWorld::ContactResultCallback
     {
 public:
-        SetFilterScope(boost::shared_ptr<btOpenraveDispatcher> dispatcher, btOverlappingPairCache* paircallback, btOverlapFilterCallback* filter) : _dispatcher(dispatcher), _paircallback(paircallback) {
-            _paircallback->setOverlapFilterCallback(filter);
-            _dispatcher->_poverlapfilt = filter;
+        struct LinkPairContacts
+        {
+            KinBody::LinkPtr plink0, plink1;
+            std::vector<CONTACT> contacts;
+        };
+
+        LinkContactResultCallback(KinBody::LinkPtr plink, const OpenRAVEFilterCallback* pfilter, bool bContacts) : btCollisionWorld::ContactResultCallback(), _plink(plink), _pfilter(pfilter), _bContacts(bContacts) {
         }
-        virtual ~SetFilterScope()
+
+        virtual bool needsCollision(btBroadphaseProxy* proxy0) const
         {
-            _paircallback->setOverlapFilterCallback(NULL);
-            _dispatcher->_poverlapfilt = NULL;
+            if( !btCollisionWorld::ContactResultCallback::needsCollision(proxy0) ) {
+                return false;
+            }
+            KinBody::LinkPtr plinkother = GetLinkFromProxy(proxy0);
+            if( plinkother == _plink || !plinkother->IsEnabled() ) {
+                return false;
+            }
+            return !_pfilter || _pfilter->CheckLinks(_plink, plinkother);
         }
 
+#if BT_BULLET_VERSION >= 281
+        virtual btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0, const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1)
+        {
+            return _AddResult(cp, colObj0Wrap->getCollisionObject(), colObj1Wrap->getCollisionObject());
+        }
+#else
+        virtual btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObject* colObj0, int partId0, int index0, const btCollisionObject* colObj1, int partId1, int index1)
+        {
+            return _AddResult(cp, colObj0, colObj1);
+        }
+#endif
+
+        std::vector<LinkPairContacts> _vpairs; ///< every link pair in contact, in the order they were found
+
 private:
-        boost::shared_ptr<btOpenraveDispatcher> _dispatcher;
-        btOverlappingPairCache* _paircallback;
+        btScalar _AddResult(btManifoldPoint& cp, const btCollisionObject* colObj0, const btCollisionObject* colObj1)
+        {
+            if( cp.getDistance() > 0 ) {
+                return 0; // within the contact threshold but not touching
+            }
+            KinBody::LinkPtr plink0 = GetLinkFromCollision(colObj0);
+            KinBody::LinkPtr plink1 = GetLinkFromCollision(colObj1);
+            LinkPairContacts* ppair = NULL;
+            FOREACH(itpair, _vpairs) {
+                if( itpair->plink0 == plink0 && itpair->plink1 == plink1 ) {
+                    ppair = &*itpair;
+                    break;
+                }
+            }
+            if( !ppair ) {
+                _vpairs.push_back(LinkPairContacts());
+                ppair = &_vpairs.back();
+                ppair->plink0 = plink0;
+                ppair->plink1 = plink1;
+            }
+            if( _bContacts ) {
+                btVector3 btp = cp.getPositionWorldOnB();
+                btVector3 btn = cp.m_normalWorldOnB;
+                Vector p(btp[0],btp[1],btp[2]), n(btn[0],btn[1],btn[2]);
+                dReal distance = cp.getDistance();
+                if( !!plink1 && plink1->ValidateContactNormal(p,n) ) {
+                    distance = -distance;
+                }
+                ppair->contacts.push_back(CONTACT(p, n, distance));
+            }
+            return 0;
+        }
+
+        KinBody::LinkPtr _plink;
+        const OpenRAVEFilterCallback* _pfilter;
+        bool _bContacts;
     };
 
     class AllRayResultCallback : public btCollisionWorld::RayResultCallback    //btCollisionWorld::ClosestRayResultCallback
@@ -296,65 +344,28 @@ public:
         return boost::dynamic_pointer_cast<BulletSpace::KinBodyInfo>(pbody->GetUserData("bulletcollision"));
     }
 
-    bool CheckCollisionP(btOverlapFilterCallback* poverlapfilt, CollisionReportPtr report)
+    /// \brief fills the report with the pairs found by a contact query and runs the collision callbacks
+    ///
+    /// \return true if a pair was accepted as a collision
+    bool _ProcessContacts(const LinkContactResultCallback& callback, CollisionReportPtr report)
     {
-        if( !!report ) {
-            report->Reset(_options);
+        if( callback._vpairs.size() == 0 ) {
+            return false;
         }
         const bool bUseCallbacks = !(_options & OpenRAVE::CO_IgnoreCallbacks) && GetEnv()->HasRegisteredCollisionCallbacks();
+        if( bUseCallbacks && !report ) {
+            report.reset(new CollisionReport());
+            report->Reset(_options);
+        }
         std::list<EnvironmentBase::CollisionCallbackFn> listcallbacks;
-
-        SetFilterScope filter(_dispatcher, _world->getPairCache(), poverlapfilt);
-        _world->performDiscreteCollisionDetection();
-
-        // for some reason this is necessary, or else collisions will start disappearing
-        _broadphase->calculateOverlappingPairs(_world->getDispatcher());
-
-        int numManifolds = _world->getDispatcher()->getNumManifolds();
-
-        for (int i=0; i<numManifolds; i++) {
-            btPersistentManifold* contactManifold = _world->getDispatcher()->getManifoldByIndexInternal(i);
-            int numContacts = contactManifold->getNumContacts();
-
-            const btCollisionObject* obA = static_cast<const btCollisionObject*>(contactManifold->getBody0());
-            const btCollisionObject* obB = static_cast<const btCollisionObject*>(contactManifold->getBody1());
-
-            KinBody::LinkPtr plink0 = GetLinkFromCollision(obA);
-            KinBody::LinkPtr plink1 = GetLinkFromCollision(obB);
-
-            if( numContacts == 0 ) {
-                continue;
-            }
-
-            if( bUseCallbacks && !report ) {
-                report.reset(new CollisionReport());
-                report->Reset(_options);
-            }
-
+        FOREACHC(itpair, callback._vpairs) {
             if( !!report ) {
-                //report->numCols = numContacts;
+                int icollision = report->AddLinkCollision(*itpair->plink0, *itpair->plink1);
                 report->minDistance = 0;
-                report->plink1 = plink0;
-                report->plink2 = plink1;
-
-                if( _options & OpenRAVE::CO_Contacts ) {
-                    report->contacts.reserve(numContacts);
-                    for (int j=0; j<numContacts; j++) {
-                        btManifoldPoint& pt = contactManifold->getContactPoint(j);
-                        btVector3 btp = pt.getPositionWorldOnB();
-                        btVector3 btn = pt.m_normalWorldOnB;
-                        Vector p(btp[0],btp[1],btp[2]), n(btn[0],btn[1],btn[2]);
-                        dReal distance = pt.m_distance1;
-                        if( !!plink1 && plink1->ValidateContactNormal(p,n) ) {
-                            distance = -distance;
-                        }
-                        report->contacts.push_back(CONTACT(p, n, distance));
-                    }
-                }
+                CollisionPairInfo& cpinfo = report->vCollisionInfos[icollision];
+                cpinfo.contacts.insert(cpinfo.contacts.end(), itpair->contacts.begin(), itpair->contacts.end());
             }
 
-            contactManifold->clearManifold();
-
             if( bUseCallbacks ) {
                 if( listcallbacks.size() == 0 ) {
                     GetEnv()->GetRegisteredCollisionCallbacks(listcallbacks);
@@ -363,27 +374,188 @@ public:
                 FOREACHC(itfn, listcallbacks) {
                     OpenRAVE::CollisionAction action = (*itfn)(report,false);
                     if( action != OpenRAVE::CA_DefaultAction ) {
-                        report->Reset();
+                        report->Reset(_options);
                         bDefaultAction = false;
                         break;
                     }
                 }
-
                 if( !bDefaultAction ) {
                     continue;
                 }
             }
+            return true;
+        }
+        return false;
+    }
+
+    /// \brief checks one link against the broadphase of the world, the narrow phase only runs on the pairs accepted by pfilter
+    bool _CheckLinkContacts(const BulletSpace::KinBodyInfo::LINK& linkinfo, const OpenRAVEFilterCallback* pfilter, CollisionReportPtr report)
+    {
+        LinkContactResultCallback callback(linkinfo.plink, pfilter, !!(_options & OpenRAVE::CO_Contacts));
+        _world->contactTest(linkinfo.obj.get(), callback);
+        return _ProcessContacts(callback, report);
+    }
+
+    /// \brief checks two specific links, the narrow phase only runs if their bounding boxes overlap
+    bool _CheckLinkPairContacts(const BulletSpace::KinBodyInfo::LINK& linkinfo0, const BulletSpace::KinBodyInfo::LINK& linkinfo1, CollisionReportPtr report)
+    {
+        if( !linkinfo0.plink->IsEnabled() || !linkinfo1.plink->IsEnabled() ) {
+            return false;
+        }
+        btVector3 vmin0, vmax0, vmin1, vmax1;
+        linkinfo0.obj->getCollisionShape()->getAabb(linkinfo0.obj->getWorldTransform(), vmin0, vmax0);
+        linkinfo1.obj->getCollisionShape()->getAabb(linkinfo1.obj->getWorldTransform(), vmin1, vmax1);
+        if( !TestAabbAgainstAabb2(vmin0, vmax0, vmin1, vmax1) ) {
+            return false;
+        }
+        LinkContactResultCallback callback(linkinfo0.plink, NULL, !!(_options & OpenRAVE::CO_Contacts));
+        _world->contactPairTest(linkinfo0.obj.get(), linkinfo1.obj.get(), callback);
+        return _ProcessContacts(callback, report);
+    }
+
+    /// \brief computes the distance between two links with GJK on their convex children.
+    ///
+    /// Mesh children are represented by their convex hull, so when the closest children include a hull the distance is only a lower bound of the distance between the links.
+    /// \param bLowerBound set to true in that case
+    dReal _ComputeLinkDistance(const BulletSpace::KinBodyInfo::LINK& linkinfo0, const BulletSpace::KinBodyInfo::LINK& linkinfo1, Vector& vclosest0, Vector& vclosest1, bool& bLowerBound)
+    {
+        bLowerBound = false;
+        dReal fmindist = std::numeric_limits<dReal>::infinity();
+        btVoronoiSimplexSolver simplexsolver;
+        btGjkEpaPenetrationDepthSolver penetrationsolver;
+        FOREACHC(itchild0, linkinfo0.vconvexchildren) {
+            FOREACHC(itchild1, linkinfo1.vconvexchildren) {
+                btGjkPairDetector gjk(itchild0->pshape, itchild1->pshape, &simplexsolver, &penetrationsolver);
+                btGjkPairDetector::ClosestPointInput input;
+                input.m_transformA = linkinfo0.obj->getWorldTransform()*itchild0->tlocal;
+                input.m_transformB = linkinfo1.obj->getWorldTransform()*itchild1->tlocal;
+                btPointCollector output;
+                gjk.getClosestPoints(input, output, NULL);
+                if( output.m_hasResult && output.m_distance < fmindist ) {
+                    fmindist = output.m_distance;
+                    bLowerBound = itchild0->bHull || itchild1->bHull;
+                    btVector3 vpointB = output.m_pointInWorld;
+                    btVector3 vpointA = vpointB + output.m_normalOnBInWorld*output.m_distance;
+                    vclosest0 = Vector(vpointA[0], vpointA[1], vpointA[2]);
+                    vclosest1 = Vector(vpointB[0], vpointB[1], vpointB[2]);
+                }
+            }
+        }
+        return fmindist;
+    }
 
-            // collision, so clear the rest and return
-            for (int j=i+1; j<numManifolds; j++) {
-                _world->getDispatcher()->getManifoldByIndexInternal(j)->clearManifold();
+    /// \brief updates report->minDistance with the distance between the two links if it is smaller
+    ///
+    /// The report then holds the two links and their closest points as its only pair, so that the distance, the pair and the contact always belong together.
+    /// Only called after the collision tests found nothing, so the report does not hold any collisions that could be overwritten unless it keeps previous data.
+    /// report->bMinDistanceIsLowerBound is set when the distance was computed from the convex hull of a mesh.
+    void _UpdateMinDistance(const BulletSpace::KinBodyInfo::LINK& linkinfo0, const BulletSpace::KinBodyInfo::LINK& linkinfo1, CollisionReportPtr report)
+    {
+        if( !report || !linkinfo0.plink->IsEnabled() || !linkinfo1.plink->IsEnabled() ) {
+            return;
+        }
+        Vector vclosest0, vclosest1;
+        bool bLowerBound = false;
+        dReal fdist = _ComputeLinkDistance(linkinfo0, linkinfo1, vclosest0, vclosest1, bLowerBound);
+        if( fdist < report->minDistance ) {
+            report->minDistance = fdist;
+            report->bMinDistanceIsLowerBound = bLowerBound;
+            if( report->nKeepPrevious & 1 ) {
+                // the pairs of the previous queries have to be kept, so there is no pair that belongs to the distance
+                return;
+            }
+            report->nNumValidCollisions = 0; // replace the pair of the previous minimum
+            int icollision = report->AddLinkCollision(*linkinfo0.plink, *linkinfo1.plink);
+            CollisionPairInfo& cpinfo = report->vCollisionInfos[icollision];
+            cpinfo.contacts.resize(1);
+            cpinfo.contacts[0].pos = vclosest0;
+            cpinfo.contacts[0].depth = -fdist;
+            dReal flength = RaveSqrt((vclosest1-vclosest0).lengthsqr3());
+            cpinfo.contacts[0].norm = flength > 0 ? (vclosest1-vclosest0)*(1/flength) : Vector(0,0,0);
+        }
+    }
+
+    /// \brief collects the enabled and active links of pbody and its attached bodies
+    void _GetBodyLinks(KinBodyConstPtr pbody, const CollisionFilterCallback& filter, std::vector<const BulletSpace::KinBodyInfo::LINK*>& vlinks)
+    {
+        vlinks.resize(0);
+        std::set<KinBodyPtr> setattached;
+        pbody->GetAttached(setattached);
+        FOREACHC(itattached, setattached) {
+            BulletSpace::KinBodyInfoPtr pinfo = GetCollisionInfo(*itattached);
+            FOREACHC(itlink, pinfo->vlinks) {
+                if( (*itlink)->plink->IsEnabled() && filter.IsActiveLink(*itattached, (*itlink)->plink->GetIndex()) ) {
+                    vlinks.push_back(itlink->get());
+                }
+            }
+        }
+    }
+
+    /// \brief computes the minimum distance between vlinks and every link of the environment accepted by the filter
+    void _ComputeDistance(const std::vector<const BulletSpace::KinBodyInfo::LINK*>& vlinks, const OpenRAVEFilterCallback& filter, CollisionReportPtr report)
+    {
+        if( !report ) {
+            return;
+        }
+        std::vector<KinBodyPtr> vbodies;
+        GetEnv()->GetBodies(vbodies);
+        FOREACHC(itbody, vbodies) {
+            BulletSpace::KinBodyInfoPtr pinfo = GetCollisionInfo(*itbody);
+            FOREACHC(itlink0, vlinks) {
+                FOREACHC(itlink1, pinfo->vlinks) {
+                    if( (*itlink0)->plink != (*itlink1)->plink && filter.CheckLinks((*itlink0)->plink, (*itlink1)->plink) ) {
+                        _UpdateMinDistance(**itlink0, **itlink1, report);
+                    }
+                }
             }
-            return true;
         }
+    }
 
+    boost::shared_ptr<BulletSpace::KinBodyInfo::LINK> _GetLinkInfo(KinBody::LinkConstPtr plink)
+    {
+        return GetCollisionInfo(plink->GetParent())->vlinks.at(plink->GetIndex());
+    }
+
+    /// \brief checks the non-adjacent link pairs of pbody with targeted pair tests. If plink is set, only the pairs containing it are checked.
+    bool _CheckSelfContacts(KinBodyConstPtr pbody, const std::vector<int>& nonadjacent, KinBody::LinkConstPtr plink, CollisionReportPtr report)
+    {
+        if( !!report ) {
+            report->Reset(_options);
+        }
+        BulletSpace::KinBodyInfoPtr pinfo = GetCollisionInfo(pbody);
+        FOREACHC(itset, nonadjacent) {
+            const BulletSpace::KinBodyInfo::LINK& linkinfo0 = *pinfo->vlinks.at(*itset&0xffff);
+            const BulletSpace::KinBodyInfo::LINK& linkinfo1 = *pinfo->vlinks.at(*itset>>16);
+            if( !!plink && linkinfo0.plink != plink && linkinfo1.plink != plink ) {
+                continue;
+            }
+            if( _CheckLinkPairContacts(linkinfo0, linkinfo1, report) ) {
+                return true;
+            }
+        }
+        if( _options & OpenRAVE::CO_Distance ) {
+            FOREACHC(itset, nonadjacent) {
+                const BulletSpace::KinBodyInfo::LINK& linkinfo0 = *pinfo->vlinks.at(*itset&0xffff);
+                const BulletSpace::KinBodyInfo::LINK& linkinfo1 = *pinfo->vlinks.at(*itset>>16);
+                if( !plink || linkinfo0.plink == plink || linkinfo1.plink == plink ) {
+                    _UpdateMinDistance(linkinfo0, linkinfo1, report);
+                }
+            }
+        }
         return false;
     }
 
+    /// \brief keeps the broadphase bounds of the synchronized links up to date since contactTest does not update them
+    void _SynchronizeCallback(BulletSpace::KinBodyInfoPtr pinfo)
+    {
+        if( !_world ) {
+            return;
+        }
+        FOREACHC(itlink, pinfo->vlinks) {
+            _world->updateSingleAabb((*itlink)->obj.get());
+        }
+    }
+
 public:
     BulletCollisionChecker(EnvironmentBasePtr penv, std::istream& sinput) : CollisionCheckerBase(penv), bulletspace(new BulletSpace(penv, GetCollisionInfo, false)), _options(0) {
         __description = ":Interface Author: Rosen Diankov\n\nCollision checker from the `Bullet Physics Package <http://bulletphysics.org>`";
@@ -403,6 +575,7 @@ public:
 
         if( !bulletspace->InitEnvironment(_world) )
             return false;
+        bulletspace->SetSynchronizationCallback(boost::bind(&BulletCollisionChecker::_SynchronizeCallback, this, _1));
 
         vector<KinBodyPtr> vbodies;
         GetEnv()->GetBodies(vbodies);
@@ -447,10 +620,6 @@ public:
     virtual bool SetCollisionOptions(int options)
     {
         _options = options;
-        if( options & CO_Distance ) {
-            //RAVELOG_WARN("bullet checker doesn't support CO_Distance\n");
-            return false;
-        }
 
         if( options & CO_Contacts ) {
             //setCollisionFlags btCollisionObject::CF_NO_CONTACT_RESPONSE - don't generate
@@ -469,11 +638,21 @@ public:
             return false;
         }
 
+        if( !!report ) {
+            report->Reset(_options);
+        }
         bulletspace->Synchronize();
 
         KinBodyFilterCallback kinbodycallback(shared_collisionchecker(),pbody);
-        if( CheckCollisionP(&kinbodycallback, report) ) {
-            return true;
+        std::vector<const BulletSpace::KinBodyInfo::LINK*> vlinks;
+        _GetBodyLinks(pbody, kinbodycallback, vlinks);
+        FOREACHC(itlink, vlinks) {
+            if( _CheckLinkContacts(**itlink, &kinbodycallback, report) ) {
+                return true;
+            }
+        }
+        if( _options & OpenRAVE::CO_Distance ) {
+            _ComputeDistance(vlinks, kinbodycallback, report);
         }
         return false;
     }
@@ -492,10 +671,23 @@ public:
         if( pbody1->IsAttached(pbody2) )
             return false;
 
+        if( !!report ) {
+            report->Reset(_options);
+        }
         bulletspace->Synchronize();
 
         KinBodyFilterCallback kinbodycallback(shared_collisionchecker(),pbody1,pbody2);
-        return CheckCollisionP(&kinbodycallback, report);
+        std::vector<const BulletSpace::KinBodyInfo::LINK*> vlinks;
+        _GetBodyLinks(pbody1, kinbodycallback, vlinks);
+        FOREACHC(itlink, vlinks) {
+            if( _CheckLinkContacts(**itlink, &kinbodycallback, report) ) {
+                return true;
+            }
+        }
+        if( _options & OpenRAVE::CO_Distance ) {
+            _ComputeDistance(vlinks, kinbodycallback, report);
+        }
+        return false;
     }
 
     virtual bool CheckCollision(KinBody::LinkConstPtr plink, CollisionReportPtr report)
@@ -505,11 +697,21 @@ public:
             return false;
         }
 
+        if( !!report ) {
+            report->Reset(_options);
+        }
         bulletspace->Synchronize();
 
         _linkcallback._pcollink0 = plink;
         _linkcallback._pcollink1.reset();
-        return CheckCollisionP(&_linkcallback, report);
+        std::vector<const BulletSpace::KinBodyInfo::LINK*> vlinks(1, _GetLinkInfo(plink).get());
+        if( _CheckLinkContacts(*vlinks[0], &_linkcallback, report) ) {
+            return true;
+        }
+        if( _options & OpenRAVE::CO_Distance ) {
+            _ComputeDistance(vlinks, _linkcallback, report);
+        }
+        return false;
     }
 
     virtual bool CheckCollision(KinBody::LinkConstPtr plink1, KinBody::LinkConstPtr plink2, CollisionReportPtr report)
@@ -523,10 +725,18 @@ public:
             return false;
         }
 
+        if( !!report ) {
+            report->Reset(_options);
+        }
         bulletspace->Synchronize();
-        _linkcallback._pcollink0 = plink1;
-        _linkcallback._pcollink1 = plink2;
-        return CheckCollisionP(&_linkcallback, report);
+        boost::shared_ptr<BulletSpace::KinBodyInfo::LINK> plinkinfo1 = _GetLinkInfo(plink1), plinkinfo2 = _GetLinkInfo(plink2);
+        if( _CheckLinkPairContacts(*plinkinfo1, *plinkinfo2, report) ) {
+            return true;
+        }
+        if( _options & OpenRAVE::CO_Distance ) {
+            _UpdateMinDistance(*plinkinfo1, *plinkinfo2, report);
+        }
+        return false;
     }
 
     virtual bool CheckCollision(KinBody::LinkConstPtr plink, KinBodyConstPtr pbody, CollisionReportPtr report)
@@ -541,12 +751,22 @@ public:
             return false;
         }
 
+        if( !!report ) {
+            report->Reset(_options);
+        }
         bulletspace->Synchronize();
 
         KinBodyLinkFilterCallback kinbodylinkcallback;
         kinbodylinkcallback._pcollink = plink;
         kinbodylinkcallback._pbody = pbody;
-        return CheckCollisionP(&kinbodylinkcallback, report);
+        std::vector<const BulletSpace::KinBodyInfo::LINK*> vlinks(1, _GetLinkInfo(plink).get());
+        if( _CheckLinkContacts(*vlinks[0], &kinbodylinkcallback, report) ) {
+            return true;
+        }
+        if( _options & OpenRAVE::CO_Distance ) {
+            _ComputeDistance(vlinks, kinbodylinkcallback, report);
+        }
+        return false;
     }
 
     virtual bool CheckCollision(KinBody::LinkConstPtr plink, const std::vector<KinBodyConstPtr>& vbodyexcluded, const std::vector<KinBody::LinkConstPtr>& vlinkexcluded, CollisionReportPtr report)
@@ -567,10 +787,26 @@ public:
             return false;
         }
 
+        if( !!report ) {
+            report->Reset(_options);
+        }
         bulletspace->Synchronize();
 
         KinBodyFilterExCallback kinbodyexcallback(shared_collisionchecker(),pbody,vbodyexcluded);
-        return CheckCollisionP(&kinbodyexcallback, report);
+        std::vector<const BulletSpace::KinBodyInfo::LINK*> vlinks;
+        _GetBodyLinks(pbody, kinbodyexcallback, vlinks);
+        FOREACHC(itlink, vlinks) {
+            if( find(vlinkexcluded.begin(), vlinkexcluded.end(), (*itlink)->plink) != vlinkexcluded.end() ) {
+                continue;
+            }
+            if( _CheckLinkContacts(**itlink, &kinbodyexcallback, report) ) {
+                return true;
+            }
+        }
+        if( _options & OpenRAVE::CO_Distance ) {
+            _ComputeDistance(vlinks, kinbodyexcallback, report);
+        }
+        return false;
     }
 
     virtual bool CheckCollision(const RAY& ray, KinBody::LinkConstPtr plink, CollisionReportPtr report)
@@ -783,16 +1019,24 @@ public:
         if( (_options&OpenRAVE::CO_ActiveDOFs) && pbody->IsRobot() ) {
             adjacentoptions |= KinBody::AO_ActiveDOFs;
         }
-        LinkAdjacentFilterCallback linkadjacent(pbody, pbody->GetNonAdjacentLinks(adjacentoptions));
+        const std::vector<int>& nonadjacent = pbody->GetNonAdjacentLinks(adjacentoptions);
         bulletspace->Synchronize(); // call after GetNonAdjacentLinks since it can modify the body, even though it is const!
-        bool bCollision = CheckCollisionP(&linkadjacent, report);
-        return bCollision;
+        return _CheckSelfContacts(pbody, nonadjacent, KinBody::LinkConstPtr(), report);
     }
 
     virtual bool CheckStandaloneSelfCollision(KinBody::LinkConstPtr plink, CollisionReportPtr report)
     {
-        // dummy
-        return CheckStandaloneSelfCollision(plink->GetParent(), report);
+        KinBodyConstPtr pbody = plink->GetParent();
+        if( !pbody->IsEnabled() ) {
+            return false;
+        }
+        int adjacentoptions = KinBody::AO_Enabled;
+        if( (_options&OpenRAVE::CO_ActiveDOFs) && pbody->IsRobot() ) {
+            adjacentoptions |= KinBody::AO_ActiveDOFs;
+        }
+        const std::vector<int>& nonadjacent = pbody->GetNonAdjacentLinks(adjacentoptions);
+        bulletspace->Synchronize();
+        return _CheckSelfContacts(pbody, nonadjacent, plink, report);
     }
 
     virtual void SetTolerance(dReal tolerance) {
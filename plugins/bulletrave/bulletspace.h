@@ -70,6 +70,17 @@ public:
             boost::shared_ptr<btCollisionShape> shape;
             list<boost::shared_ptr<btCollisionShape> > listchildren;
             list<boost::shared_ptr<btStridingMeshInterface> > listmeshes;
+            list<boost::shared_ptr<btConvexShape> > listconvexhulls; ///< convex hulls of the mesh children, only used for distance queries
+            /// \brief convex shape and local transform of a child of shape for distance queries
+            struct CONVEXCHILD
+            {
+                CONVEXCHILD(const btTransform& tlocal, btConvexShape* pshape, bool bHull) : tlocal(tlocal), pshape(pshape), bHull(bHull) {
+                }
+                btTransform tlocal;
+                btConvexShape* pshape;
+                bool bHull; ///< true if pshape is the convex hull of a mesh, distances to it are only lower bounds of the distances to the mesh
+            };
+            std::vector<CONVEXCHILD> vconvexchildren; ///< every child of shape, meshes are represented by their convex hull
 
             KinBody::LinkPtr plink;
             Transform tlocal;     /// local offset transform to account for inertias not aligned to axes
@@ -164,6 +175,7 @@ private:
             // add all the correct geometry objects
             FOREACHC(itgeom, (*itlink)->GetGeometries()) {
                 boost::shared_ptr<btCollisionShape> child;
+                boost::shared_ptr<btConvexShape> convexhull;
                 KinBody::Link::GeometryPtr geom = *itgeom;
                 switch(geom->GetType()) {
                 case GT_None:
@@ -219,6 +231,9 @@ private:
                             pgimpact->updateBound();
                             child.reset(pgimpact);
                             link->listmeshes.push_back(boost::shared_ptr<btStridingMeshInterface>(ptrimesh));
+                            // gimpact meshes are not convex, so distance queries use the hull of the same triangles
+                            convexhull.reset(new btConvexTriangleMeshShape(ptrimesh));
+                            convexhull->setMargin(fmargin);
                         }
                     }
                     break;
@@ -235,6 +250,13 @@ private:
                 link->listchildren.push_back(child);
                 child->setMargin(fmargin);     // need to set margin very small (we're not simulating anyway)
                 pshapeparent->addChildShape(GetBtTransform(geom->GetTransform()), child.get());
+                if( !!convexhull ) {
+                    link->listconvexhulls.push_back(convexhull);
+                    link->vconvexchildren.emplace_back(GetBtTransform(geom->GetTransform()), convexhull.get(), true);
+                }
+                else if( child->isConvex() ) {
+                    link->vconvexchildren.emplace_back(GetBtTransform(geom->GetTransform()), static_cast<btConvexShape*>(child.get()), false);
+                }
             }
 
             link->plink = *itlink;
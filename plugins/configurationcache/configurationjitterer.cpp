@@ -13,6 +13,9 @@
 // limitations under the License.
 #include <openraveplugindefs.h>
 
+#include <atomic>
+#include <deque>
+
 #ifdef OPENRAVE_HAS_LAPACK
 // for jacobians
 #include <boost/numeric/ublas/vector.hpp>
@@ -65,6 +68,11 @@ By default will sample the robot's active DOFs. Parameters part of the interface
     bias_dir is the workspace direction to bias the sampling in.\n\
     nullsampleprob, nullbiassampleprob, and deltasampleprob are in [0,1]\n\
  //");
+        RegisterCommand("SetNumThreads",boost::bind(&ConfigurationJitterer::SetNumThreadsCommand,this,_1,_2),
+                        "sets the number of workers checking jittered configurations in parallel on clones of the environment. 1 (default) checks them on the environment of the jitterer, 0 uses the number of threads of the thread pool. \
+The result is the same as the one of the serial check for the same seed.");
+        RegisterCommand("SetBatchSize",boost::bind(&ConfigurationJitterer::SetBatchSizeCommand,this,_1,_2),
+                        "sets the number of configurations generated before checking them in parallel, 0 (default) uses 4 per worker.");
         RegisterJSONCommand("GetFailuresCount", boost::bind(&ConfigurationJitterer::GetFailuresCountCommand, this, _1, _2, _3),
                             "Gets the numbers of failing jittered configurations from the latest call categorized based on the failure reasons.");
         RegisterJSONCommand("GetCurrentParameters", boost::bind(&ConfigurationJitterer::GetCurrentParametersCommand, this, _1, _2, _3),
@@ -142,11 +150,13 @@ By default will sample the robot's active DOFs. Parameters part of the interface
 
         // use for sampling, perturbations
         _curdof.resize(dof,0);
-        _newdof2.resize(dof);
         _deltadof.resize(dof);
         _deltadof2.resize(dof);
         _nRandomGeneratorSeed = 0;
         _nNumIterations = 0;
+        _nNumThreads = 1;
+        _nBatchSize = 0;
+        _pvrecordedsamples = NULL;
 
         _fulldof.resize(_probot->GetDOF(), 0);
 
@@ -169,11 +179,13 @@ By default will sample the robot's active DOFs. Parameters part of the interface
     }
 
     virtual ~ConfigurationJitterer(){
+        _DestroyWorkerContexts();
     }
 
     virtual void SetSeed(uint32_t seed) {
         _nRandomGeneratorSeed = seed;
         _nNumIterations = 0;
+        _replaysamples.clear();
         _ssampler->SetSeed(seed);
     }
 
@@ -335,6 +347,31 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         return !!sinput;
     }
 
+    bool SetNumThreadsCommand(std::ostream& sout, std::istream& sinput)
+    {
+        int numthreads = 1;
+        sinput >> numthreads;
+        if( !sinput || numthreads < 0 ) {
+            return false;
+        }
+        _nNumThreads = numthreads;
+        if( _nNumThreads == 1 ) {
+            _DestroyWorkerContexts();
+        }
+        return true;
+    }
+
+    bool SetBatchSizeCommand(std::ostream& sout, std::istream& sinput)
+    {
+        int batchsize = 0;
+        sinput >> batchsize;
+        if( !sinput || batchsize < 0 ) {
+            return false;
+        }
+        _nBatchSize = batchsize;
+        return true;
+    }
+
     virtual int SampleSequence(std::vector<dReal>& samples, size_t num=1,IntervalType interval=IT_Closed)
     {
         samples.resize(0);
@@ -364,6 +401,7 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         // have to reset the seed
         _ssampler->SetSeed(_nRandomGeneratorSeed);
         _nNumIterations = 0;
+        _replaysamples.clear();
         return SampleSequence(samples, num, interval);
     }
 
@@ -438,6 +476,8 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         orjson::SetJsonValueByKey(output, "jitterPerturbation", _perturbation, alloc);
         orjson::SetJsonValueByKey(output, "jitterNeighDistThresh", _neighdistthresh, alloc);
         orjson::SetJsonValueByKey(output, "resetIterationsOnSample", _bResetIterationsOnSample, alloc);
+        orjson::SetJsonValueByKey(output, "numThreads", _nNumThreads, alloc);
+        orjson::SetJsonValueByKey(output, "batchSize", _nBatchSize, alloc);
         if( !!_pmanip ) {
             orjson::SetJsonValueByKey(output, "manipName", _pmanip->GetName(), alloc);
             rapidjson::Value rTransform;
@@ -473,8 +513,6 @@ By default will sample the robot's active DOFs. Parameters part of the interface
     {
         RobotBase::RobotStateSaver robotsaver(_probot, KinBody::Save_LinkTransformation|KinBody::Save_ActiveDOF);
         _InitRobotState();
-        const dReal linkdistthresh = _linkdistthresh;
-        const dReal linkdistthresh2 = _linkdistthresh2;
 
         if( _bResetIterationsOnSample ) {
             _nNumIterations = 0;
@@ -584,9 +622,129 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         }
 
         BOOST_ASSERT(!_busebiasing || _vbiasdofdirection.size() > 0);
-        const boost::array<dReal, 3> rayincs = {{0.2, 0.5, 0.9}};
 
-        bool busebiasing = _busebiasing;
+        _sourcecontext.penv = GetEnv();
+        _sourcecontext.probot = _probot;
+        _sourcecontext.vlinks = _vLinks;
+        _sourcecontext.pmanip = _pmanip;
+        _sourcecontext.report = _report;
+
+        uint64_t starttime = utils::GetNanoPerformanceTime();
+        const int numworkers = _nNumThreads > 0 ? _nNumThreads : RaveGetThreadPool()->GetNumThreads();
+        if( numworkers > 1 ) {
+            if( _SampleParallel(vnewdof, interval, perturbations, numworkers) ) {
+                if( _bSetResultOnRobot ) {
+                    // have to release the saver so it does not restore the old configuration
+                    robotsaver.Release();
+                }
+                RAVELOG_DEBUG_FORMAT("env=%s, succeed iterations=%d with %d workers, computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, nLinkDistThreshRejections=%d",GetEnv()->GetNameId()%_nNumIterations%numworkers%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nLinkDistThreshRejections);
+                return 1;
+            }
+        }
+        else {
+            for(int iter = 0; iter < _maxiterations; ++iter) {
+                if( (iter%10) == 0 ) { // not sure what a good rate is...
+                    _CallStatusFunctions(iter);
+                }
+
+                if( !_GenerateCandidate(iter, interval, vnewdof) ) {
+                    continue;
+                }
+
+                if( _EvaluateCandidate(_sourcecontext, vnewdof, perturbations, iter, _counter) ) {
+                    // the last perturbation is 0, so state is already set to the correct jittered value
+                    if( IS_DEBUGLEVEL(Level_Verbose) ) {
+                        _probot->GetActiveDOFValues(vnewdof);
+                        stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
+                        ss << "env=" << GetEnv()->GetNameId() << ", jitter iter=" << iter << " ";
+#ifdef _DEBUG
+                        ss << "maxtrans=" << _sourcecontext.fmaxtransdist << " ";
+#endif
+                        for(size_t i = 0; i < vnewdof.size(); ++i ) {
+                            if( i > 0 ) {
+                                ss << "," << vnewdof[i];
+                            }
+                            else {
+                                ss << "jitteredvalues=[" << vnewdof[i];
+                            }
+                        }
+                        ss << "]";
+                        RAVELOG_VERBOSE(ss.str());
+                    }
+
+                    if( _bSetResultOnRobot ) {
+                        // have to release the saver so it does not restore the old configuration
+                        robotsaver.Release();
+                    }
+
+                    RAVELOG_DEBUG_FORMAT("env=%s, succeed iterations=%d, computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, nLinkDistThreshRejections=%d",GetEnv()->GetNameId()%iter%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nLinkDistThreshRejections);
+                    //RAVELOG_VERBOSE_FORMAT("succeed iterations=%d, cachehits=%d, cache size=%d, originaldist=%f, computation=%fs\n",iter%_cachehit%cache.GetNumNodes()%cache.ComputeDistance(_curdof, vnewdof)%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
+                    return 1;
+                }
+            }
+        }
+
+        RAVELOG_INFO_FORMAT("env=%s, failed iterations=%d (max=%d), computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, samesamples=%d, nLinkDistThreshRejections=%d", GetEnv()->GetNameId()%_nNumIterations%_maxiterations%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nSameSamples%_counter.nLinkDistThreshRejections);
+        //RAVELOG_WARN_FORMAT("failed iterations=%d, cachehits=%d, cache size=%d, jitter time=%fs", _maxiterations%_cachehit%cache.GetNumNodes()%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
+        return 0;
+    }
+
+protected:
+    /// \brief the robot and links that a candidate configuration is checked with, either of the environment of the jitterer or of a worker clone
+    struct EvaluationContext
+    {
+        EvaluationContext() : fmaxtransdist(0) {
+        }
+        EnvironmentBasePtr penv;
+        RobotBasePtr probot;
+        std::vector<KinBody::LinkPtr> vlinks; ///< corresponds to _vLinks
+        RobotBase::ManipulatorConstPtr pmanip; ///< corresponds to _pmanip
+        CollisionReportPtr report;
+        std::vector<dReal> vnewdof2; ///< perturbed configuration
+        dReal fmaxtransdist; ///< largest link displacement of the last evaluated candidate
+    };
+    typedef boost::shared_ptr<EvaluationContext> EvaluationContextPtr;
+
+    /// \brief configuration generated for a parallel batch and the state of the serial run right after generating it
+    struct JitterCandidate
+    {
+        JitterCandidate() : iter(0), nNumIterations(0), nsamplesend(0) {
+        }
+        std::vector<dReal> vdofvalues;
+        int iter;
+        uint32_t nNumIterations; ///< _nNumIterations after generating the candidate
+        size_t nsamplesend; ///< size of _vrecordedsamples after generating the candidate
+        FailureCounter generationcounter; ///< _counter after generating the candidate
+        FailureCounter evaluationcounter; ///< failures from evaluating the candidate
+    };
+
+    /// \brief draws the next value of _ssampler, first giving back the values left over from the last parallel batch
+    dReal _SampleOneReal(IntervalType interval=IT_Closed)
+    {
+        dReal f;
+        if( !_replaysamples.empty() && _replaysamples.front().first == interval ) {
+            f = _replaysamples.front().second;
+            _replaysamples.pop_front();
+        }
+        else {
+            // a different interval means the serial sequence diverged, so cannot give back the values anymore
+            _replaysamples.clear();
+            f = _ssampler->SampleSequenceOneReal(interval);
+        }
+        if( !!_pvrecordedsamples ) {
+            _pvrecordedsamples->emplace_back(interval, f);
+        }
+        return f;
+    }
+
+    /// \brief generates the configuration to check at iteration iter.
+    ///
+    /// Only uses _ssampler, _neighstatefn and the cache, so the sequence of candidates does not depend on the outcome of checking them.
+    /// \return false if the iteration does not produce a configuration to check
+    bool _GenerateCandidate(int iter, IntervalType interval, std::vector<dReal>& vnewdof)
+    {
+        const boost::array<dReal, 3> rayincs = {{0.2, 0.5, 0.9}};
+        const bool busebiasing = _busebiasing;
         const int nMaxIterRadiusThresh=_maxiterations/2;
         const dReal imaxiterations = 2.0/dReal(_maxiterations);
         const dReal fJitterLowerThresh=0.2, fJitterHigherThresh=0.8;
@@ -595,341 +753,432 @@ By default will sample the robot's active DOFs. Parameters part of the interface
             fBias = RaveSqrt(fBias);
         }
 
-        uint64_t starttime = utils::GetNanoPerformanceTime();
-        for(int iter = 0; iter < _maxiterations; ++iter) {
-            if( (iter%10) == 0 ) { // not sure what a good rate is...
-                _CallStatusFunctions(iter);
+        vnewdof.resize(GetDOF());
+        _nNumIterations++;
+        if( busebiasing && iter+((int)_nNumIterations-2) < (int)rayincs.size() ) {
+            int iray = iter+(_nNumIterations-2);
+            // start by checking samples directly above the current configuration
+            for (size_t j = 0; j < vnewdof.size(); ++j) {
+                vnewdof[j] = _curdof[j] + (rayincs.at(iray) * _vbiasdofdirection.at(j));
             }
-
-            _nNumIterations++;
-            if( busebiasing && iter+((int)_nNumIterations-2) < (int)rayincs.size() ) {
-                int iray = iter+(_nNumIterations-2);
-                // start by checking samples directly above the current configuration
-                for (size_t j = 0; j < vnewdof.size(); ++j) {
-                    vnewdof[j] = _curdof[j] + (rayincs.at(iray) * _vbiasdofdirection.at(j));
-                }
+        }
+        else {
+            // ramp of the jitter as iterations increase
+            dReal jitter = _maxjitter;
+            if( iter < nMaxIterRadiusThresh ) {
+                jitter = _maxjitter*dReal(iter+1)*imaxiterations;
             }
-            else {
-                // ramp of the jitter as iterations increase
-                dReal jitter = _maxjitter;
-                if( iter < nMaxIterRadiusThresh ) {
-                    jitter = _maxjitter*dReal(iter+1)*imaxiterations;
-                }
 
-                bool samplebiasdir = false;
-                bool samplenull = false;
-                bool sampledelta = false;
-                if (busebiasing && _ssampler->SampleSequenceOneReal() < _nullsampleprob)
-                {
-                    samplenull = true;
-                }
-                if (busebiasing && _ssampler->SampleSequenceOneReal() < _nullbiassampleprob) {
-                    samplebiasdir = true;
-                }
-                if( (!samplenull && !samplebiasdir) || _ssampler->SampleSequenceOneReal() < _deltasampleprob ) {
-                    sampledelta = true;
-                }
+            bool samplebiasdir = false;
+            bool samplenull = false;
+            bool sampledelta = false;
+            if (busebiasing && _SampleOneReal() < _nullsampleprob)
+            {
+                samplenull = true;
+            }
+            if (busebiasing && _SampleOneReal() < _nullbiassampleprob) {
+                samplebiasdir = true;
+            }
+            if( (!samplenull && !samplebiasdir) || _SampleOneReal() < _deltasampleprob ) {
+                sampledelta = true;
+            }
 
-                bool deltasuccess = false;
-                if( sampledelta ) {
-                    // check which third the sampled dof is in
-                    for(size_t j = 0; j < vnewdof.size(); ++j) {
-                        dReal f = 2*_ssampler->SampleSequenceOneReal(interval)-1; // f in [-1,1]
-                        if( RaveFabs(f) < fJitterLowerThresh ) {
-                            _deltadof[j] = 0;
-                        }
-                        else if( f < -fJitterHigherThresh ) {
-                            _deltadof[j] = -jitter;
-                        }
-                        else if( f > fJitterHigherThresh ) {
-                            _deltadof[j] = jitter;
-                        }
-                        else {
-                            _deltadof[j] = jitter*f;
-                        }
+            bool deltasuccess = false;
+            if( sampledelta ) {
+                // check which third the sampled dof is in
+                for(size_t j = 0; j < vnewdof.size(); ++j) {
+                    dReal f = 2*_SampleOneReal(interval)-1; // f in [-1,1]
+                    if( RaveFabs(f) < fJitterLowerThresh ) {
+                        _deltadof[j] = 0;
                     }
-                    deltasuccess = true;
-                }
-
-                if (!samplebiasdir && !samplenull && !deltasuccess) {
-                    _counter.nSameSamples++;
-                    continue;
-                }
-                // (lambda * biasdir) + (Nx) + delta + _curdofs
-                dReal fNullspaceMultiplier = linkdistthresh*2;
-                if( fNullspaceMultiplier <= 0 ) {
-                    fNullspaceMultiplier = fBias;
-                }
-                for (size_t k = 0; k < vnewdof.size(); ++k) {
-                    vnewdof[k] = _curdof[k];
-                    if (samplebiasdir) {
-                        vnewdof[k] += _ssampler->SampleSequenceOneReal() * _vbiasdofdirection[k];
+                    else if( f < -fJitterHigherThresh ) {
+                        _deltadof[j] = -jitter;
                     }
-                    if (samplenull) {
-                        for (size_t j = 0; j < _vbiasnullspace.size(); ++j) {
-                            dReal nullx = (_ssampler->SampleSequenceOneReal()*2-1)*fNullspaceMultiplier;
-                            vnewdof[k] += nullx * _vbiasnullspace[j][k];
-                        }
+                    else if( f > fJitterHigherThresh ) {
+                        _deltadof[j] = jitter;
                     }
-                    if (sampledelta) {
-                        vnewdof[k] += _deltadof[k];
+                    else {
+                        _deltadof[j] = jitter*f;
                     }
                 }
+                deltasuccess = true;
             }
 
-            // get new state
-            for(size_t j = 0; j < _deltadof.size(); ++j) {
-                if( vnewdof[j] > _upper.at(j) ) {
-                    vnewdof[j] = _upper.at(j);
+            if (!samplebiasdir && !samplenull && !deltasuccess) {
+                _counter.nSameSamples++;
+                return false;
+            }
+            // (lambda * biasdir) + (Nx) + delta + _curdofs
+            dReal fNullspaceMultiplier = _linkdistthresh*2;
+            if( fNullspaceMultiplier <= 0 ) {
+                fNullspaceMultiplier = fBias;
+            }
+            for (size_t k = 0; k < vnewdof.size(); ++k) {
+                vnewdof[k] = _curdof[k];
+                if (samplebiasdir) {
+                    vnewdof[k] += _SampleOneReal() * _vbiasdofdirection[k];
+                }
+                if (samplenull) {
+                    for (size_t j = 0; j < _vbiasnullspace.size(); ++j) {
+                        dReal nullx = (_SampleOneReal()*2-1)*fNullspaceMultiplier;
+                        vnewdof[k] += nullx * _vbiasnullspace[j][k];
+                    }
                 }
-                else if( vnewdof[j] < _lower.at(j) ) {
-                    vnewdof[j] = _lower.at(j);
+                if (sampledelta) {
+                    vnewdof[k] += _deltadof[k];
                 }
             }
+        }
 
-            // Compute a neighbor of _curdof that satisfies constraints. If _neighstatefn is not initialized, then the neighbor is vnewdof itself.
-            if( bConstraint ) {
-                // Obtain the delta dof values computed from the jittering above.
-                for(size_t idof = 0; idof < _deltadof.size(); ++idof) {
-                    _deltadof[idof] = vnewdof[idof] - _curdof[idof];
-                }
-                vnewdof = _curdof;
-                _probot->SetActiveDOFValues(vnewdof); // need to set robot configuration before calling _neighstatefn
-                if( _neighstatefn(vnewdof, _deltadof, 0) == NSS_Failed) {
-                    _counter.nNeighStateFailure++;
-                    continue;
-                }
+        // get new state
+        for(size_t j = 0; j < _deltadof.size(); ++j) {
+            if( vnewdof[j] > _upper.at(j) ) {
+                vnewdof[j] = _upper.at(j);
+            }
+            else if( vnewdof[j] < _lower.at(j) ) {
+                vnewdof[j] = _lower.at(j);
             }
+        }
 
-            if( !!_cache ) {
-                if( !!_cache->FindNearestNode(vnewdof, _neighdistthresh).first ) {
-                    _cachehit++;
-                    _counter.nCacheHitSamples++;
-                    continue;
-                }
+        // Compute a neighbor of _curdof that satisfies constraints. If _neighstatefn is not initialized, then the neighbor is vnewdof itself.
+        if( !!_neighstatefn ) {
+            // Obtain the delta dof values computed from the jittering above.
+            for(size_t idof = 0; idof < _deltadof.size(); ++idof) {
+                _deltadof[idof] = vnewdof[idof] - _curdof[idof];
+            }
+            vnewdof = _curdof;
+            _probot->SetActiveDOFValues(vnewdof); // need to set robot configuration before calling _neighstatefn
+            if( _neighstatefn(vnewdof, _deltadof, 0) == NSS_Failed) {
+                _counter.nNeighStateFailure++;
+                return false;
             }
+        }
 
-            //int ret = cache.InsertNode(vnewdof, CollisionReportPtr(), _neighdistthresh);
-            //BOOST_ASSERT(ret==1);
+        if( !!_cache ) {
+            if( !!_cache->FindNearestNode(vnewdof, _neighdistthresh).first ) {
+                _cachehit++;
+                _counter.nCacheHitSamples++;
+                return false;
+            }
+        }
 
-            _probot->SetActiveDOFValues(vnewdof);
-#ifdef _DEBUG
-            dReal fmaxtransdist = 0;
-#endif
-            bool bSuccess = true;
-            if( linkdistthresh > 0 ) {
-                for (size_t ilink = 0; ilink < _vLinkAABBs.size(); ++ilink) {
-                    // check for an elipse
-                    // L^2 (b*v)^2 + |v|^2|b|^4 - (b*v)^2 |b|^2 <= |b|^4 * L^2
-                    Transform tnewlink = _vLinks[ilink]->GetTransform();
-                    TransformMatrix projdelta = _vOriginalInvTransforms[ilink] * tnewlink;
-                    projdelta.m[0] -= 1;
-                    projdelta.m[5] -= 1;
-                    projdelta.m[10] -= 1;
-                    Vector projextents = _vLinkAABBs[ilink].extents;
-                    Vector projboxright(projdelta.m[0]*projextents.x, projdelta.m[4]*projextents.x, projdelta.m[8]*projextents.x);
-                    Vector projboxup(projdelta.m[1]*projextents.y, projdelta.m[5]*projextents.y, projdelta.m[9]*projextents.y);
-                    Vector projboxdir(projdelta.m[2]*projextents.z, projdelta.m[6]*projextents.z, projdelta.m[10]*projextents.z);
-                    Vector projboxpos = projdelta * _vLinkAABBs[ilink].pos;
-
-                    Vector b;
-                    if( busebiasing ) {
-                        b = _vOriginalInvTransforms[ilink].rotate(_vbiasdirection); // inside link coordinate system
-                    }
-                    else {
-                        // doesn't matter which vector we pick since it is just a sphere.
-                        b = Vector(0,0,linkdistthresh);
-                    }
+        //int ret = cache.InsertNode(vnewdof, CollisionReportPtr(), _neighdistthresh);
+        //BOOST_ASSERT(ret==1);
+        return true;
+    }
 
-                    dReal blength2 = b.lengthsqr3();
-                    dReal blength4 = blength2*blength2;
-                    dReal rhs = blength4 * linkdistthresh2;
-                    //dReal rhs = (b.lengthsqr3()) * linkdistthresh;
-                    dReal ellipdist = 0;
-                    // now figure out what is the max distance
-                    for(int ix = 0; ix < 2; ++ix) {
-                        Vector projvx = ix > 0 ? projboxpos + projboxright : projboxpos - projboxright;
-                        for(int iy = 0; iy < 2; ++iy) {
-                            Vector projvy = iy > 0 ? projvx + projboxup : projvx - projboxup;
-                            for(int iz = 0; iz < 2; ++iz) {
-                                Vector projvz = iz > 0 ? projvy + projboxdir : projvy - projboxdir;
-                                Vector v = projvz; // inside link coordinate system
-                                dReal bv = (v.dot3(b));
-                                dReal bv2 = bv*bv;
-                                dReal flen2 = (linkdistthresh2 - blength2) * bv2 + v.lengthsqr3()*blength4;
-
-                                if( ellipdist < flen2 ) {
-                                    ellipdist = flen2;
-#ifdef _DEBUG
-                                    fmaxtransdist = flen2;
-#endif
-                                    if (ellipdist > rhs) {
-                                        bSuccess = false;
-                                        break;
-                                    }
-                                }
-                            }
+    /// \brief checks the link displacement, tool constraints and collisions of vnewdof and its perturbations on the robot of context.
+    ///
+    /// Only reads the state of the jitterer, so workers can evaluate candidates concurrently on their own contexts.
+    /// \return true if vnewdof is accepted, the robot of context is then set to vnewdof
+    bool _EvaluateCandidate(EvaluationContext& context, const std::vector<dReal>& vnewdof, const std::vector<dReal>& perturbations, int iter, FailureCounter& counter) const
+    {
+        const dReal linkdistthresh = _linkdistthresh;
+        const dReal linkdistthresh2 = _linkdistthresh2;
+        const RobotBasePtr& probot = context.probot;
+        probot->SetActiveDOFValues(vnewdof);
+        context.fmaxtransdist = 0;
+        bool bSuccess = true;
+        if( linkdistthresh > 0 ) {
+            for (size_t ilink = 0; ilink < _vLinkAABBs.size(); ++ilink) {
+                // check for an elipse
+                // L^2 (b*v)^2 + |v|^2|b|^4 - (b*v)^2 |b|^2 <= |b|^4 * L^2
+                Transform tnewlink = context.vlinks[ilink]->GetTransform();
+                TransformMatrix projdelta = _vOriginalInvTransforms[ilink] * tnewlink;
+                projdelta.m[0] -= 1;
+                projdelta.m[5] -= 1;
+                projdelta.m[10] -= 1;
+                Vector projextents = _vLinkAABBs[ilink].extents;
+                Vector projboxright(projdelta.m[0]*projextents.x, projdelta.m[4]*projextents.x, projdelta.m[8]*projextents.x);
+                Vector projboxup(projdelta.m[1]*projextents.y, projdelta.m[5]*projextents.y, projdelta.m[9]*projextents.y);
+                Vector projboxdir(projdelta.m[2]*projextents.z, projdelta.m[6]*projextents.z, projdelta.m[10]*projextents.z);
+                Vector projboxpos = projdelta * _vLinkAABBs[ilink].pos;
+
+                Vector b;
+                if( _busebiasing ) {
+                    b = _vOriginalInvTransforms[ilink].rotate(_vbiasdirection); // inside link coordinate system
+                }
+                else {
+                    // doesn't matter which vector we pick since it is just a sphere.
+                    b = Vector(0,0,linkdistthresh);
+                }
 
-                            if (ellipdist > rhs) {
-                                bSuccess = false;
-                                break;
+                dReal blength2 = b.lengthsqr3();
+                dReal blength4 = blength2*blength2;
+                dReal rhs = blength4 * linkdistthresh2;
+                //dReal rhs = (b.lengthsqr3()) * linkdistthresh;
+                dReal ellipdist = 0;
+                // now figure out what is the max distance
+                for(int ix = 0; ix < 2; ++ix) {
+                    Vector projvx = ix > 0 ? projboxpos + projboxright : projboxpos - projboxright;
+                    for(int iy = 0; iy < 2; ++iy) {
+                        Vector projvy = iy > 0 ? projvx + projboxup : projvx - projboxup;
+                        for(int iz = 0; iz < 2; ++iz) {
+                            Vector projvz = iz > 0 ? projvy + projboxdir : projvy - projboxdir;
+                            Vector v = projvz; // inside link coordinate system
+                            dReal bv = (v.dot3(b));
+                            dReal bv2 = bv*bv;
+                            dReal flen2 = (linkdistthresh2 - blength2) * bv2 + v.lengthsqr3()*blength4;
+
+                            if( ellipdist < flen2 ) {
+                                ellipdist = flen2;
+                                context.fmaxtransdist = flen2;
+                                if (ellipdist > rhs) {
+                                    bSuccess = false;
+                                    break;
+                                }
                             }
                         }
+
                         if (ellipdist > rhs) {
                             bSuccess = false;
                             break;
                         }
                     }
-                    if( !bSuccess ) {
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                            ss << "dofvalues=[";
-                            for(size_t i = 0; i < vnewdof.size(); ++i ) {
-                                ss << vnewdof[i];
-                                if( i < vnewdof.size() - 1 ) {
-                                    ss << ", ";
-                                }
+                    if (ellipdist > rhs) {
+                        bSuccess = false;
+                        break;
+                    }
+                }
+                if( !bSuccess ) {
+                    if( IS_DEBUGLEVEL(Level_Verbose) ) {
+                        stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
+                        ss << "dofvalues=[";
+                        for(size_t i = 0; i < vnewdof.size(); ++i ) {
+                            ss << vnewdof[i];
+                            if( i < vnewdof.size() - 1 ) {
+                                ss << ", ";
                             }
-                            ss << "]";
-                            RAVELOG_VERBOSE_FORMAT("env=%s, link '%s' exceeded linkdisthresh=%e. ellipdist[%e] > rhs[%e], %s", GetEnv()->GetNameId()%_vLinks[ilink]->GetName()%_linkdistthresh%ellipdist%rhs%ss.str());
                         }
-                        break;
+                        ss << "]";
+                        RAVELOG_VERBOSE_FORMAT("env=%s, link '%s' exceeded linkdisthresh=%e. ellipdist[%e] > rhs[%e], %s", context.penv->GetNameId()%context.vlinks[ilink]->GetName()%_linkdistthresh%ellipdist%rhs%ss.str());
                     }
+                    break;
                 }
+            }
 
-                if (!bSuccess) {
-                    _counter.nLinkDistThreshRejections++;
-                    continue;
-                }
+            if (!bSuccess) {
+                counter.nLinkDistThreshRejections++;
+                return false;
             }
+        }
 
-            // check perturbation
-            bCollision = false;
-            bConstraintFailed = false;
-            FOREACH(itperturbation,perturbations) {
-                // Perturbation is added to a config to make sure that the config is not too close to collision and tool
-                // direction/position constraint boundaries. So we do not use _neighstatefn to compute perturbed
-                // configurations.
-                _newdof2 = vnewdof;
-                for(size_t idof = 0; idof < _newdof2.size(); ++idof) {
-                    _newdof2[idof] += *itperturbation;
-                    if( _newdof2[idof] > _upper.at(idof) ) {
-                        _newdof2[idof] = _upper.at(idof);
-                    }
-                    else if( _newdof2[idof] < _lower.at(idof) ) {
-                        _newdof2[idof] = _lower.at(idof);
-                    }
+        // check perturbation
+        std::vector<dReal>& vnewdof2 = context.vnewdof2;
+        FOREACHC(itperturbation,perturbations) {
+            // Perturbation is added to a config to make sure that the config is not too close to collision and tool
+            // direction/position constraint boundaries. So we do not use _neighstatefn to compute perturbed
+            // configurations.
+            vnewdof2 = vnewdof;
+            for(size_t idof = 0; idof < vnewdof2.size(); ++idof) {
+                vnewdof2[idof] += *itperturbation;
+                if( vnewdof2[idof] > _upper.at(idof) ) {
+                    vnewdof2[idof] = _upper.at(idof);
                 }
-                _probot->SetActiveDOFValues(_newdof2);
-                if( !!_pConstraintToolDirection ) {
-                    if( !_pConstraintToolDirection->IsInConstraints(_pmanip->GetTransform()) ) {
-                        bConstraintFailed = true;
-                        _counter.nConstraintToolDirFailure++;
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                            ss << "env=" << GetEnv()->GetNameId() << ", direction constraints failed, ";
-                            for(size_t i = 0; i < _newdof2.size(); ++i ) {
-                                if( i > 0 ) {
-                                    ss << "," << _newdof2[i];
-                                }
-                                else {
-                                    ss << "colvalues=[" << _newdof2[i];
-                                }
-                            }
-                            ss << "]; cosangle=" << _pConstraintToolDirection->ComputeCosAngle(_pmanip->GetTransform()) << "; quat=[" << _pmanip->GetTransform().rot.x << ", " << _pmanip->GetTransform().rot.y << ", " << _pmanip->GetTransform().rot.z << ", " << _pmanip->GetTransform().rot.w << "]";
-                            RAVELOG_VERBOSE(ss.str());
-                        }
-                        break;
-                    }
+                else if( vnewdof2[idof] < _lower.at(idof) ) {
+                    vnewdof2[idof] = _lower.at(idof);
                 }
-                if( !!_pConstraintToolPosition ) {
-                    if( !_pConstraintToolPosition->IsInConstraints(_pmanip->GetTransform()) ) {
-                        bConstraintFailed = true;
-                        _counter.nConstraintToolPositionFailure++;
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                            ss << "env=" << GetEnv()->GetNameId() << ", position constraints failed, ";
-                            for(size_t i = 0; i < _newdof2.size(); ++i ) {
-                                if( i > 0 ) {
-                                    ss << "," << _newdof2[i];
-                                }
-                                else {
-                                    ss << "colvalues=[" << _newdof2[i];
-                                }
+            }
+            probot->SetActiveDOFValues(vnewdof2);
+            if( !!_pConstraintToolDirection ) {
+                if( !_pConstraintToolDirection->IsInConstraints(context.pmanip->GetTransform()) ) {
+                    counter.nConstraintToolDirFailure++;
+                    if( IS_DEBUGLEVEL(Level_Verbose) ) {
+                        stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
+                        ss << "env=" << context.penv->GetNameId() << ", direction constraints failed, ";
+                        for(size_t i = 0; i < vnewdof2.size(); ++i ) {
+                            if( i > 0 ) {
+                                ss << "," << vnewdof2[i];
+                            }
+                            else {
+                                ss << "colvalues=[" << vnewdof2[i];
                             }
-                            ss << "]; trans=[" << _pmanip->GetTransform().trans.x << ", " << _pmanip->GetTransform().trans.y << ", " << _pmanip->GetTransform().trans.z << "]";
-                            RAVELOG_VERBOSE(ss.str());
                         }
-                        break;
+                        ss << "]; cosangle=" << _pConstraintToolDirection->ComputeCosAngle(context.pmanip->GetTransform()) << "; quat=[" << context.pmanip->GetTransform().rot.x << ", " << context.pmanip->GetTransform().rot.y << ", " << context.pmanip->GetTransform().rot.z << ", " << context.pmanip->GetTransform().rot.w << "]";
+                        RAVELOG_VERBOSE(ss.str());
                     }
+                    return false;
                 }
-
-                if( GetEnv()->CheckCollision(_probot, _report) ) {
-                    bCollision = true;
-                    _counter.nEnvCollisionFailure++;
-                }
-                if( !bCollision && _probot->CheckSelfCollision(_report)) {
-                    bCollision = true;
-                    _counter.nSelfCollisionFailure++;
-                }
-
-                if( bCollision ) {
+            }
+            if( !!_pConstraintToolPosition ) {
+                if( !_pConstraintToolPosition->IsInConstraints(context.pmanip->GetTransform()) ) {
+                    counter.nConstraintToolPositionFailure++;
                     if( IS_DEBUGLEVEL(Level_Verbose) ) {
                         stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                        ss << "env=" << _probot->GetEnv()->GetNameId() << ", iter=" << iter << "; collision failed, ";
-                        for(size_t i = 0; i < _newdof2.size(); ++i ) {
+                        ss << "env=" << context.penv->GetNameId() << ", position constraints failed, ";
+                        for(size_t i = 0; i < vnewdof2.size(); ++i ) {
                             if( i > 0 ) {
-                                ss << "," << _newdof2[i];
+                                ss << "," << vnewdof2[i];
                             }
                             else {
-                                ss << "colvalues=[" << _newdof2[i];
+                                ss << "colvalues=[" << vnewdof2[i];
                             }
                         }
-                        ss << "], report=" << _report->__str__();
+                        ss << "]; trans=[" << context.pmanip->GetTransform().trans.x << ", " << context.pmanip->GetTransform().trans.y << ", " << context.pmanip->GetTransform().trans.z << "]";
                         RAVELOG_VERBOSE(ss.str());
                     }
-                    break;
+                    return false;
                 }
             }
 
-            if( !bCollision && !bConstraintFailed ) {
-                // the last perturbation is 0, so state is already set to the correct jittered value
+            bool bCollision = false;
+            if( context.penv->CheckCollision(probot, context.report) ) {
+                bCollision = true;
+                counter.nEnvCollisionFailure++;
+            }
+            if( !bCollision && probot->CheckSelfCollision(context.report)) {
+                bCollision = true;
+                counter.nSelfCollisionFailure++;
+            }
+
+            if( bCollision ) {
                 if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                    _probot->GetActiveDOFValues(vnewdof);
                     stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                    ss << "env=" << GetEnv()->GetNameId() << ", jitter iter=" << iter << " ";
-#ifdef _DEBUG
-                    ss << "maxtrans=" << fmaxtransdist << " ";
-#endif
-                    for(size_t i = 0; i < vnewdof.size(); ++i ) {
+                    ss << "env=" << context.penv->GetNameId() << ", iter=" << iter << "; collision failed, ";
+                    for(size_t i = 0; i < vnewdof2.size(); ++i ) {
                         if( i > 0 ) {
-                            ss << "," << vnewdof[i];
+                            ss << "," << vnewdof2[i];
                         }
                         else {
-                            ss << "jitteredvalues=[" << vnewdof[i];
+                            ss << "colvalues=[" << vnewdof2[i];
                         }
                     }
-                    ss << "]";
+                    ss << "], report=" << context.report->__str__();
                     RAVELOG_VERBOSE(ss.str());
                 }
+                return false;
+            }
+        }
+        return true;
+    }
 
-                if( _bSetResultOnRobot ) {
-                    // have to release the saver so it does not restore the old configuration
-                    robotsaver.Release();
+    /// \brief runs the jitter iterations in batches: candidates are generated in order on this thread and checked on the worker clones.
+    ///
+    /// Generating a candidate does not depend on the checks of the previous ones, so the first accepted candidate of a batch in generation
+    /// order is the one the serial loop accepts. The workers take candidates in order and stop at the first accepted one, candidates after it
+    /// are not checked. The values drawn for the candidates after it are given back to the sampler, so consecutive calls match the serial run as well.
+    /// \return true if a candidate was accepted, it is set in vnewdof and on the robot
+    bool _SampleParallel(std::vector<dReal>& vnewdof, IntervalType interval, const std::vector<dReal>& perturbations, int numworkers)
+    {
+        const size_t batchsize = _nBatchSize > 0 ? (size_t)_nBatchSize : 4*(size_t)numworkers;
+        if( _vcandidates.size() < batchsize ) {
+            _vcandidates.resize(batchsize);
+        }
+        bool bSynchronized = false;
+        int iter = 0;
+        while( iter < _maxiterations ) {
+            _vrecordedsamples.resize(0);
+            _pvrecordedsamples = &_vrecordedsamples;
+            size_t numcandidates = 0;
+            try {
+                for(; iter < _maxiterations && numcandidates < batchsize; ++iter) {
+                    if( (iter%10) == 0 ) {
+                        _CallStatusFunctions(iter);
+                    }
+                    JitterCandidate& candidate = _vcandidates[numcandidates];
+                    if( _GenerateCandidate(iter, interval, candidate.vdofvalues) ) {
+                        candidate.iter = iter;
+                        candidate.nNumIterations = _nNumIterations;
+                        candidate.nsamplesend = _vrecordedsamples.size();
+                        candidate.generationcounter = _counter;
+                        ++numcandidates;
+                    }
                 }
+            }
+            catch(...) {
+                _pvrecordedsamples = NULL;
+                throw;
+            }
+            _pvrecordedsamples = NULL;
+            if( numcandidates == 0 ) {
+                continue;
+            }
 
-                RAVELOG_DEBUG_FORMAT("env=%s, succeed iterations=%d, computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, nLinkDistThreshRejections=%d",GetEnv()->GetNameId()%iter%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nLinkDistThreshRejections);
-                //RAVELOG_VERBOSE_FORMAT("succeed iterations=%d, cachehits=%d, cache size=%d, originaldist=%f, computation=%fs\n",iter%_cachehit%cache.GetNumNodes()%cache.ComputeDistance(_curdof, vnewdof)%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
-                return 1;
+            if( !bSynchronized ) {
+                _SynchronizeWorkerContexts(numworkers);
+                bSynchronized = true;
+            }
+
+            std::atomic<size_t> nextcandidate(0), acceptedcandidate(numcandidates);
+            RaveGetThreadPool()->ParallelFor(numworkers, [&](size_t iworker) {
+                EvaluationContext& context = *_vworkercontexts.at(iworker);
+                EnvironmentLock lockclone(context.penv->GetMutex());
+                for(size_t icandidate = nextcandidate++; icandidate < acceptedcandidate; icandidate = nextcandidate++) {
+                    JitterCandidate& candidate = _vcandidates[icandidate];
+                    candidate.evaluationcounter.Reset();
+                    if( _EvaluateCandidate(context, candidate.vdofvalues, perturbations, candidate.iter, candidate.evaluationcounter) ) {
+                        size_t previous = acceptedcandidate;
+                        while( icandidate < previous && !acceptedcandidate.compare_exchange_weak(previous, icandidate) ) {
+                        }
+                        break;
+                    }
+                }
+            });
+
+            const size_t naccepted = acceptedcandidate;
+            if( naccepted < numcandidates ) {
+                // every candidate before the accepted one was checked, so the counts are the ones of the serial run
+                const JitterCandidate& candidate = _vcandidates[naccepted];
+                _counter = candidate.generationcounter;
+                for(size_t icandidate = 0; icandidate < naccepted; ++icandidate) {
+                    _counter += _vcandidates[icandidate].evaluationcounter;
+                }
+                _nNumIterations = candidate.nNumIterations;
+                _replaysamples.insert(_replaysamples.begin(), _vrecordedsamples.begin()+candidate.nsamplesend, _vrecordedsamples.end());
+                vnewdof = candidate.vdofvalues;
+                _probot->SetActiveDOFValues(vnewdof);
+                RAVELOG_VERBOSE_FORMAT("env=%s, jitter accepted iter=%d, candidate %d of a batch of %d", GetEnv()->GetNameId()%candidate.iter%naccepted%numcandidates);
+                return true;
+            }
+            for(size_t icandidate = 0; icandidate < numcandidates; ++icandidate) {
+                _counter += _vcandidates[icandidate].evaluationcounter;
             }
         }
+        return false;
+    }
 
-        RAVELOG_INFO_FORMAT("env=%s, failed iterations=%d (max=%d), computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, samesamples=%d, nLinkDistThreshRejections=%d", GetEnv()->GetNameId()%_nNumIterations%_maxiterations%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nSameSamples%_counter.nLinkDistThreshRejections);
-        //RAVELOG_WARN_FORMAT("failed iterations=%d, cachehits=%d, cache size=%d, jitter time=%fs", _maxiterations%_cachehit%cache.GetNumNodes()%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
-        return 0;
+    /// \brief creates or synchronizes one clone of the environment per worker and maps the tracked links onto them
+    void _SynchronizeWorkerContexts(int numworkers)
+    {
+        while( (int)_vworkercontexts.size() > numworkers ) {
+            _vworkercontexts.back()->penv->Destroy();
+            _vworkercontexts.pop_back();
+        }
+        for(int iworker = 0; iworker < numworkers; ++iworker) {
+            if( iworker >= (int)_vworkercontexts.size() ) {
+                _vworkercontexts.push_back(EvaluationContextPtr(new EvaluationContext()));
+                _vworkercontexts.back()->penv = GetEnv()->CloneSelf(Clone_Bodies);
+                _vworkercontexts.back()->report.reset(new CollisionReport());
+            }
+            else {
+                _vworkercontexts[iworker]->penv->Clone(GetEnv(), Clone_Bodies);
+            }
+            EvaluationContext& context = *_vworkercontexts[iworker];
+            context.probot = context.penv->GetRobot(_probot->GetName());
+            OPENRAVE_ASSERT_FORMAT(!!context.probot, "env=%s, robot %s is not in the clone of worker %d", GetEnv()->GetNameId()%_probot->GetName()%iworker, ORE_InvalidState);
+            context.probot->SetActiveDOFs(_vActiveIndices, _nActiveAffineDOFs, _vActiveAffineAxis);
+            context.vlinks.resize(_vLinks.size());
+            for(size_t ilink = 0; ilink < _vLinks.size(); ++ilink) {
+                KinBodyPtr pclonebody = context.penv->GetKinBody(_vLinks[ilink]->GetParent()->GetName());
+                OPENRAVE_ASSERT_FORMAT(!!pclonebody, "env=%s, body %s is not in the clone of worker %d", GetEnv()->GetNameId()%_vLinks[ilink]->GetParent()->GetName()%iworker, ORE_InvalidState);
+                context.vlinks[ilink] = pclonebody->GetLinks().at(_vLinks[ilink]->GetIndex());
+            }
+            context.pmanip.reset();
+            if( !!_pmanip ) {
+                context.pmanip = context.probot->GetManipulator(_pmanip->GetName());
+            }
+        }
     }
 
-protected:
+    void _DestroyWorkerContexts()
+    {
+        FOREACH(itcontext, _vworkercontexts) {
+            if( !!(*itcontext)->penv ) {
+                (*itcontext)->penv->Destroy();
+            }
+        }
+        _vworkercontexts.clear();
+    }
 
     /// \brief extracts all used bodies from the configurationspecification and computes AABBs, transforms, and limits for links
     void _InitRobotState()
@@ -1130,7 +1379,7 @@ protected:
     dReal _perturbation; ///< Test with perturbations since very small changes in angles can produce collision inconsistencies
     dReal _linkdistthresh, _linkdistthresh2; ///< the maximum distance to allow a link to move. If 0, then will disable checking
 
-    std::vector<dReal> _curdof, _newdof2, _deltadof, _deltadof2, _vonesample;
+    std::vector<dReal> _curdof, _deltadof, _deltadof2, _vonesample;
     std::vector<dReal> _fulldof; ///< full robot dof values
 
     CacheTreePtr _cache; ///< caches the visisted configurations
@@ -1158,6 +1407,16 @@ protected:
     bool _bSetResultOnRobot; ///< if true, will set the final result on the robot DOF values
     bool _busebiasing; ///< if true will bias the end effector along a certain direction using the jacobian and nullspace.
     bool _bResetIterationsOnSample; ///< if true, when Sample or SampleSequence is called, will reset the _nNumIterations to 0. O
+
+    // parallel checking
+    int _nNumThreads; ///< number of workers checking the jittered configurations, 1 checks them serially on the environment of the jitterer, 0 uses the size of the thread pool
+    int _nBatchSize; ///< number of configurations generated per parallel batch, 0 uses 4 per worker
+    EvaluationContext _sourcecontext; ///< context of the environment of the jitterer
+    std::vector<EvaluationContextPtr> _vworkercontexts; ///< one clone of the environment per worker
+    std::vector<JitterCandidate> _vcandidates; ///< candidates of the current batch
+    std::vector< std::pair<IntervalType, dReal> > _vrecordedsamples; ///< values drawn from _ssampler for the current batch
+    std::vector< std::pair<IntervalType, dReal> >* _pvrecordedsamples; ///< if not NULL, _SampleOneReal records the drawn values in it
+    std::deque< std::pair<IntervalType, dReal> > _replaysamples; ///< values drawn for candidates after the accepted one of a batch, they are used before drawing new ones
 };
 
 SpaceSamplerBasePtr CreateConfigurationJitterer(EnvironmentBasePtr penv, std::istream& sinput)
@@ -98,6 +98,18 @@ struct FailureCounter
         nLinkDistThreshRejections = 0;
     }
 
+    inline FailureCounter& operator+=(const FailureCounter& r) {
+        nNeighStateFailure += r.nNeighStateFailure;
+        nConstraintToolDirFailure += r.nConstraintToolDirFailure;
+        nConstraintToolPositionFailure += r.nConstraintToolPositionFailure;
+        nEnvCollisionFailure += r.nEnvCollisionFailure;
+        nSelfCollisionFailure += r.nSelfCollisionFailure;
+        nSameSamples += r.nSameSamples;
+        nCacheHitSamples += r.nCacheHitSamples;
+        nLinkDistThreshRejections += r.nLinkDistThreshRejections;
+        return *this;
+    }
+
     void SaveToJson(rapidjson::Value& rFailureCounter, rapidjson::Document::AllocatorType& alloc) const
     {
         rFailureCounter.SetObject();
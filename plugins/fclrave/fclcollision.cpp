@@ -1,6 +1,7 @@
 #include "plugindefs.h"
 
 #include "fclcollision.h"
+#include "fclgeometrylod.h"
 
 namespace fclrave {
 
@@ -108,6 +109,12 @@ FCLCollisionChecker::FCLCollisionChecker(OpenRAVE::EnvironmentBasePtr penv, std:
     // TODO : Consider removing these which could be more harmful than anything else
     RegisterCommand("SetBroadphaseAlgorithm", boost::bind(&FCLCollisionChecker::SetBroadphaseAlgorithmCommand, this, _1, _2), "sets the broadphase algorithm (Naive, SaP, SSaP, IntervalTree, DynamicAABBTree, DynamicAABBTree_Array)");
     RegisterCommand("SetBVHRepresentation", boost::bind(&FCLCollisionChecker::_SetBVHRepresentation, this, _1, _2), "sets the Bouding Volume Hierarchy representation for meshes (AABB, OBB, OBBRSS, RSS, kIDS)");
+    RegisterCommand("SetTieredGeometryGroup", boost::bind(&FCLCollisionChecker::_SetTieredGeometryGroupCommand, this, _1, _2), "sets the geometry group with conservative coarse geometries that are checked before the link geometries, the link geometries are only checked if the coarse geometries collide. Empty disables it.");
+    RegisterCommand("SetLinkSphereTrees", boost::bind(&FCLCollisionChecker::_SetLinkSphereTreesCommand, this, _1, _2), "builds conservative sphere trees for all links that screen the link pairs before fcl is called: numspheres [margin=0.001]. numspheres is the maximum number of spheres per mesh, 0 disables them.");
+    RegisterCommand("SetMeshSharing", boost::bind(&FCLCollisionChecker::_SetMeshSharingCommand, this, _1, _2), "if 1, the BVH models of identical meshes are shared with all other environments of the process that enable it instead of each environment and clone building its own copy.");
+    RegisterCommand("GetMeshMemoryUsage", boost::bind(&FCLCollisionChecker::_GetMeshMemoryUsageCommand, this, _1, _2), "returns the bytes held by the BVH models of the meshes of all bodies and the number of distinct models, shared models are counted once.");
+    RegisterCommand("GenerateLODGeometryGroups", boost::bind(&FCLCollisionChecker::_GenerateLODGeometryGroupsCommand, this, _1, _2), "generates the geometry groups [prefix]hull, [prefix]spheres and [prefix]decimated for all links of a body: bodyname [prefix=lod_] [numspheres=8] [cellsize=0] [numthreads=0]");
+    RegisterCommand("SetLODCacheSize", boost::bind(&FCLCollisionChecker::_SetLODCacheSizeCommand, this, _1, _2), "sets the maximum number of meshes whose levels of detail are kept in the process-wide cache of GenerateLODGeometryGroups, the least recently used ones are evicted first. 0 clears and disables the cache.");
 
     RAVELOG_VERBOSE_FORMAT("FCLCollisionChecker %s created in env %d", _userdatakey%penv->GetId());
 
@@ -160,6 +167,9 @@ void FCLCollisionChecker::Clone(InterfaceBaseConstPtr preference, int cloningopt
     // We don't clone Kinbody's specific geometry group
     _fclspace->SetGeometryGroup(r->GetGeometryGroup());
     _fclspace->SetBVHRepresentation(r->GetBVHRepresentation());
+    _fclspace->SetTieredGeometryGroup(r->_fclspace->GetTieredGeometryGroup());
+    _fclspace->SetLinkSphereTrees(r->_fclspace->GetLinkSphereTreesNumSpheres(), r->_fclspace->GetLinkSphereTreesMargin());
+    _fclspace->SetMeshSharing(r->_fclspace->IsMeshSharing());
     _SetBroadphaseAlgorithm(r->GetBroadphaseAlgorithm());
 
     // We don't want to clone _bIsSelfCollisionChecker since a self collision checker can be created by cloning a environment collision checker
@@ -207,6 +217,79 @@ bool FCLCollisionChecker::_SetBVHRepresentation(ostream& sout, istream& sinput)
     return !!sinput;
 }
 
+bool FCLCollisionChecker::_SetTieredGeometryGroupCommand(ostream& sout, istream& sinput)
+{
+    std::string groupname;
+    sinput >> groupname;
+    _fclspace->SetTieredGeometryGroup(groupname);
+    return true;
+}
+
+bool FCLCollisionChecker::_SetLinkSphereTreesCommand(ostream& sout, istream& sinput)
+{
+    int numspheres = 0;
+    OpenRAVE::dReal fmargin = 0.001;
+    sinput >> numspheres;
+    if( !sinput ) {
+        return false;
+    }
+    sinput >> fmargin;
+    _fclspace->SetLinkSphereTrees(numspheres, fmargin);
+    return true;
+}
+
+bool FCLCollisionChecker::_SetMeshSharingCommand(ostream& sout, istream& sinput)
+{
+    int bShareMeshes = 0;
+    sinput >> bShareMeshes;
+    if( !sinput ) {
+        return false;
+    }
+    _fclspace->SetMeshSharing(!!bShareMeshes);
+    return true;
+}
+
+bool FCLCollisionChecker::_GetMeshMemoryUsageCommand(ostream& sout, istream& sinput)
+{
+    OpenRAVE::EnvironmentLock lock(GetEnv()->GetMutex());
+    size_t nummeshes = 0;
+    const size_t numbytes = _fclspace->GetMeshMemoryUsage(nummeshes);
+    sout << numbytes << " " << nummeshes;
+    return true;
+}
+
+bool FCLCollisionChecker::_GenerateLODGeometryGroupsCommand(ostream& sout, istream& sinput)
+{
+    std::string bodyname, prefix = "lod_";
+    int numspheres = 8, numthreads = 0;
+    OpenRAVE::dReal fcellsize = 0;
+    sinput >> bodyname;
+    if( !sinput ) {
+        return false;
+    }
+    sinput >> prefix >> numspheres >> fcellsize >> numthreads;
+
+    OpenRAVE::EnvironmentLock lock(GetEnv()->GetMutex());
+    KinBodyPtr pbody = GetEnv()->GetKinBody(bodyname);
+    if( !pbody ) {
+        throw OPENRAVE_EXCEPTION_FORMAT("env=%s, could not find body %s", GetEnv()->GetNameId()%bodyname, OpenRAVE::ORE_InvalidArguments);
+    }
+    GeometryLODGenerator generator(numspheres, fcellsize, numthreads);
+    generator.GenerateGeometryGroups(pbody, prefix);
+    return true;
+}
+
+bool FCLCollisionChecker::_SetLODCacheSizeCommand(ostream& sout, istream& sinput)
+{
+    size_t maxsize = 0;
+    sinput >> maxsize;
+    if( !sinput ) {
+        return false;
+    }
+    GeometryLODGenerator::SetMaxCacheSize(maxsize);
+    return true;
+}
+
 bool FCLCollisionChecker::InitEnvironment()
 {
     RAVELOG_VERBOSE(str(boost::format("FCL User data initializing %s in env %d") % _userdatakey % GetEnv()->GetId()));
@@ -878,6 +961,9 @@ bool FCLCollisionChecker::CheckNarrowPhaseCollision(fcl::CollisionObject *o1, fc
         }
 
         LinkInfoPtr pLINK1 = _fclspace->GetLinkInfo(*plink1), pLINK2 = _fclspace->GetLinkInfo(*plink2);
+        if( !_CheckLinkSphereTreesOverlap(pLINK1.get(), o1, pLINK2.get(), o2) || !_CheckTieredCoarseCollision(pLINK1.get(), o1, pLINK2.get(), o2) ) {
+            return false;
+        }
 
         //RAVELOG_VERBOSE_FORMAT("env=%d, link %s:%s with %s:%s", GetEnv()->GetId()%plink1->GetParent()->GetName()%plink1->GetName()%plink2->GetParent()->GetName()%plink2->GetName());
         FOREACH(itgeompair1, pLINK1->vgeoms) {
@@ -893,6 +979,9 @@ bool FCLCollisionChecker::CheckNarrowPhaseCollision(fcl::CollisionObject *o1, fc
     }
     else if( !!plink1 ) {
         LinkInfoPtr pLINK1 = _fclspace->GetLinkInfo(*plink1);
+        if( !_CheckLinkSphereTreesOverlap(pLINK1.get(), o1, NULL, o2) || !_CheckTieredCoarseCollision(pLINK1.get(), o1, NULL, o2) ) {
+            return false;
+        }
         FOREACH(itgeompair1, pLINK1->vgeoms) {
             if( itgeompair1->second->getAABB().overlap(o2->getAABB()) ) {
                 CheckNarrowPhaseGeomCollision(itgeompair1->second.get(), o2, pcb);
@@ -904,6 +993,9 @@ bool FCLCollisionChecker::CheckNarrowPhaseCollision(fcl::CollisionObject *o1, fc
     }
     else if( !!plink2 ) {
         LinkInfoPtr pLINK2 = _fclspace->GetLinkInfo(*plink2);
+        if( !_CheckLinkSphereTreesOverlap(NULL, o1, pLINK2.get(), o2) || !_CheckTieredCoarseCollision(NULL, o1, pLINK2.get(), o2) ) {
+            return false;
+        }
         FOREACH(itgeompair2, pLINK2->vgeoms) {
             if( itgeompair2->second->getAABB().overlap(o1->getAABB()) ) {
                 CheckNarrowPhaseGeomCollision(o1, itgeompair2->second.get(), pcb);
@@ -1152,6 +1244,63 @@ CollisionPair FCLCollisionChecker::MakeCollisionPair(fcl::CollisionObject* o1, f
 }
 #endif
 
+/// \brief returns false if the sphere trees of the links prove that the two sides cannot collide
+///
+/// Sides without a valid sphere tree are represented by the aabb of their collision object.
+static bool _CheckLinkSphereTreesOverlap(const FCLSpace::FCLKinBodyInfo::LinkInfo* plinkinfo1, fcl::CollisionObject* o1, const FCLSpace::FCLKinBodyInfo::LinkInfo* plinkinfo2, fcl::CollisionObject* o2)
+{
+    const bool bValid1 = !!plinkinfo1 && plinkinfo1->spheretree.IsValid();
+    const bool bValid2 = !!plinkinfo2 && plinkinfo2->spheretree.IsValid();
+    if( bValid1 && bValid2 ) {
+        return plinkinfo1->spheretree.Overlaps(plinkinfo2->spheretree);
+    }
+    else if( bValid1 ) {
+        return plinkinfo1->spheretree.Overlaps(o2->getAABB());
+    }
+    else if( bValid2 ) {
+        return plinkinfo2->spheretree.Overlaps(o1->getAABB());
+    }
+    return true;
+}
+
+/// \brief appends the objects to check for the tiered checking of one side
+static void _AppendTieredCollisionObjects(const FCLSpace::FCLKinBodyInfo::LinkInfo* plinkinfo, fcl::CollisionObject* pobject, std::vector<fcl::CollisionObject*>& vobjects)
+{
+    if( !plinkinfo ) {
+        vobjects.push_back(pobject);
+        return;
+    }
+    const std::vector<TransformCollisionPair>& vgeoms = plinkinfo->vcoarsegeoms.size() > 0 ? plinkinfo->vcoarsegeoms : plinkinfo->vgeoms;
+    FOREACHC(itgeompair, vgeoms) {
+        vobjects.push_back(itgeompair->second.get());
+    }
+}
+
+bool FCLCollisionChecker::_CheckTieredCoarseCollision(const FCLSpace::FCLKinBodyInfo::LinkInfo* plinkinfo1, fcl::CollisionObject* o1, const FCLSpace::FCLKinBodyInfo::LinkInfo* plinkinfo2, fcl::CollisionObject* o2)
+{
+    const bool bHasCoarse1 = !!plinkinfo1 && plinkinfo1->vcoarsegeoms.size() > 0;
+    const bool bHasCoarse2 = !!plinkinfo2 && plinkinfo2->vcoarsegeoms.size() > 0;
+    if( !bHasCoarse1 && !bHasCoarse2 ) {
+        return true; // nothing coarser than the geometries that are going to be checked anyway
+    }
+
+    _vTieredObjects1.resize(0);
+    _vTieredObjects2.resize(0);
+    _AppendTieredCollisionObjects(plinkinfo1, o1, _vTieredObjects1);
+    _AppendTieredCollisionObjects(plinkinfo2, o2, _vTieredObjects2);
+    FOREACHC(itobject1, _vTieredObjects1) {
+        FOREACHC(itobject2, _vTieredObjects2) {
+            if( (*itobject1)->getAABB().overlap((*itobject2)->getAABB()) ) {
+                _tieredResult.clear();
+                if( fcl::collide(*itobject1, *itobject2, _tieredRequest, _tieredResult) > 0 ) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
 LinkPair FCLCollisionChecker::MakeLinkPair(LinkConstPtr plink1, LinkConstPtr plink2)
 {
     if( plink1.get() < plink2.get() ) {
@@ -1192,6 +1341,18 @@ std::pair<FCLSpace::FCLKinBodyInfo::FCLGeometryInfo*, GeometryConstPtr> FCLColli
 {
     const std::shared_ptr<const fcl::CollisionGeometry>& collgeom = collObj.collisionGeometry();
     FCLSpace::FCLKinBodyInfo::FCLGeometryInfo* geom_raw = static_cast<FCLSpace::FCLKinBodyInfo::FCLGeometryInfo *>(collgeom->getUserData());
+    if( !geom_raw ) {
+        // shared meshes do not point back to a geometry, so find it from the position of the object in its link
+        const FCLSpace::FCLKinBodyInfo::LinkInfo* link_raw = static_cast<FCLSpace::FCLKinBodyInfo::LinkInfo *>(collObj.getUserData());
+        if( !!link_raw ) {
+            for(size_t igeom = 0; igeom < link_raw->vgeoms.size() && igeom < link_raw->vgeominfos.size(); ++igeom) {
+                if( link_raw->vgeoms[igeom].second.get() == &collObj ) {
+                    geom_raw = link_raw->vgeominfos[igeom].get();
+                    break;
+                }
+            }
+        }
+    }
     if( !!geom_raw ) {
         const GeometryConstPtr pgeom = geom_raw->GetGeometry();
         if( !pgeom ) {
@@ -155,6 +155,29 @@ public:
         return _fclspace->GetBVHRepresentation();
     }
 
+    /// Sets the geometry group whose conservative geometries are checked before the link geometries, empty disables it
+    /// e.g. "SetTieredGeometryGroup lod_hull"
+    bool _SetTieredGeometryGroupCommand(ostream& sout, istream& sinput);
+
+    /// Builds the sphere trees that screen the link pairs before fcl is called, see FCLSpace::SetLinkSphereTrees
+    /// e.g. "SetLinkSphereTrees 8 0.001"
+    bool _SetLinkSphereTreesCommand(ostream& sout, istream& sinput);
+
+    /// Shares the BVH models of identical meshes with the other environments that enable it, see FCLSpace::SetMeshSharing
+    /// e.g. "SetMeshSharing 1"
+    bool _SetMeshSharingCommand(ostream& sout, istream& sinput);
+
+    /// Returns the bytes held by the BVH models of the meshes and the number of distinct models, see FCLSpace::GetMeshMemoryUsage
+    bool _GetMeshMemoryUsageCommand(ostream& sout, istream& sinput);
+
+    /// Generates the level of detail geometry groups of a body, see GeometryLODGenerator
+    /// e.g. "GenerateLODGeometryGroups bodyname [prefix] [numspheres] [cellsize] [numthreads]"
+    bool _GenerateLODGeometryGroupsCommand(ostream& sout, istream& sinput);
+
+    /// Sets the maximum number of meshes whose levels of detail are cached by the process, see GeometryLODGenerator::SetMaxCacheSize
+    /// e.g. "SetLODCacheSize 0" clears and disables the cache
+    bool _SetLODCacheSizeCommand(ostream& sout, istream& sinput);
+
 
     bool InitEnvironment() override;
 
@@ -223,6 +246,12 @@ private:
     static CollisionPair MakeCollisionPair(fcl::CollisionObject* o1, fcl::CollisionObject* o2);
 #endif
 
+    /// \brief checks the coarse geometries of the tiered geometry group of the two objects
+    ///
+    /// Objects without coarse geometries use their link geometries, or themselves if they are not links.
+    /// \return false if the coarse geometries prove that the objects cannot collide
+    bool _CheckTieredCoarseCollision(const FCLSpace::FCLKinBodyInfo::LinkInfo* plinkinfo1, fcl::CollisionObject* o1, const FCLSpace::FCLKinBodyInfo::LinkInfo* plinkinfo2, fcl::CollisionObject* o2);
+
     static LinkPair MakeLinkPair(LinkConstPtr plink1, LinkConstPtr plink2);
     static LinkGeomPairs MakeLinkGeomPairs(LinkConstPtr plink1, LinkConstPtr plink2, GeometryConstPtr pgeom1, GeometryConstPtr pgeom2);
 
@@ -301,6 +330,9 @@ private:
     std::vector<fcl::Vec3f> _fclPointsCache;
     std::vector<fcl::Triangle> _fclTrianglesCache;
     std::vector<KinBodyPtr> _vCachedGrabbedBodies;
+    std::vector<fcl::CollisionObject*> _vTieredObjects1, _vTieredObjects2; ///< used by _CheckTieredCoarseCollision
+    fcl::CollisionRequest _tieredRequest; ///< only needs to know whether there is a contact
+    fcl::CollisionResult _tieredResult;
 
     std::vector<int> _attachedBodyIndicesCache;
 
@@ -0,0 +1,514 @@
+#include "fclgeometrylod.h"
+
+#include <atomic>
+#include <mutex>
+#include <numeric>
+
+#ifdef QHULL_FOUND
+
+extern "C"
+{
+#ifdef QHULL_USE_REENTRANT
+
+#include <libqhull_r/libqhull_r.h>
+#include <libqhull_r/mem_r.h>
+#include <libqhull_r/qset_r.h>
+#include <libqhull_r/geom_r.h>
+#include <libqhull_r/merge_r.h>
+#include <libqhull_r/poly_r.h>
+#include <libqhull_r/io_r.h>
+#include <libqhull_r/stat_r.h>
+
+#else
+
+#include <qhull/qhull.h>
+#include <qhull/mem.h>
+#include <qhull/qset.h>
+#include <qhull/geom.h>
+#include <qhull/merge.h>
+#include <qhull/poly.h>
+#include <qhull/io.h>
+#include <qhull/stat.h>
+
+#endif
+}
+
+#ifndef QHULL_USE_REENTRANT
+static std::mutex s_QhullMutex; ///< the non-reentrant qhull keeps its state in globals
+#endif
+
+#endif
+
+namespace fclrave {
+
+/// \brief levels of detail of one mesh in the process-wide cache
+struct MeshLODCacheEntry
+{
+    TriMesh mesh; ///< the processed mesh, compared on lookup since the key is only a hash
+    int numspheres;
+    dReal fcellsize;
+    GeometryLODGenerator::MeshLODsConstPtr pmeshlods;
+    uint64_t lastuse; ///< value of s_nMeshLODCacheUses at the last lookup, the least recently used entry is evicted first
+};
+
+static std::mutex s_mutexMeshLODCache;
+static std::map<uint64_t, MeshLODCacheEntry> s_mapMeshLODCache; ///< process-wide cache of the levels of detail, key is the hash of the mesh content and the parameters. protected by s_mutexMeshLODCache
+static size_t s_nMaxMeshLODCacheSize = 128; ///< maximum number of entries of s_mapMeshLODCache. protected by s_mutexMeshLODCache
+static uint64_t s_nMeshLODCacheUses = 0; ///< protected by s_mutexMeshLODCache
+
+/// \brief returns true if the fcl geometry created for the type is a mesh, the other types are already cheap primitives
+static bool _IsMeshGeometryType(OpenRAVE::GeometryType type)
+{
+    return type == OpenRAVE::GT_TriMesh || type == OpenRAVE::GT_Axial || type == OpenRAVE::GT_ConicalFrustum;
+}
+
+/// \brief appends the triangles of the box ab to mesh
+static void _AppendBoxMesh(const OpenRAVE::AABB& ab, TriMesh& mesh)
+{
+    static const int s_boxindices[36] = { 0,2,1, 1,2,3, 4,5,6, 5,7,6, 0,1,4, 1,5,4, 2,6,3, 3,6,7, 0,4,2, 2,4,6, 1,3,5, 3,7,5 };
+    const int offset = mesh.vertices.size();
+    for(int i = 0; i < 8; ++i) {
+        mesh.vertices.push_back(ab.pos + Vector((i&1) ? ab.extents.x : -ab.extents.x, (i&2) ? ab.extents.y : -ab.extents.y, (i&4) ? ab.extents.z : -ab.extents.z));
+    }
+    for(int i = 0; i < 36; ++i) {
+        mesh.indices.push_back(offset + s_boxindices[i]);
+    }
+}
+
+/// \brief returns the cached levels of detail of the mesh, null if they are not cached. s_mutexMeshLODCache has to be locked.
+static GeometryLODGenerator::MeshLODsConstPtr _FindCachedMeshLODs(uint64_t key, const TriMesh& mesh, int numspheres, dReal fcellsize)
+{
+    std::map<uint64_t, MeshLODCacheEntry>::iterator it = s_mapMeshLODCache.find(key);
+    if( it == s_mapMeshLODCache.end() || it->second.numspheres != numspheres || it->second.fcellsize != fcellsize || it->second.mesh != mesh ) {
+        return GeometryLODGenerator::MeshLODsConstPtr();
+    }
+    it->second.lastuse = ++s_nMeshLODCacheUses;
+    return it->second.pmeshlods;
+}
+
+/// \brief removes the least recently used entries until at most maxsize are left. s_mutexMeshLODCache has to be locked.
+static void _EvictCachedMeshLODs(size_t maxsize)
+{
+    while( s_mapMeshLODCache.size() > maxsize ) {
+        std::map<uint64_t, MeshLODCacheEntry>::iterator itoldest = s_mapMeshLODCache.begin();
+        for(std::map<uint64_t, MeshLODCacheEntry>::iterator it = s_mapMeshLODCache.begin(); it != s_mapMeshLODCache.end(); ++it) {
+            if( it->second.lastuse < itoldest->second.lastuse ) {
+                itoldest = it;
+            }
+        }
+        s_mapMeshLODCache.erase(itoldest);
+    }
+}
+
+/// \brief adds the levels of detail of the mesh to the cache, evicting the least recently used entry when it is full. s_mutexMeshLODCache has to be locked.
+static void _AddCachedMeshLODs(uint64_t key, const TriMesh& mesh, int numspheres, dReal fcellsize, GeometryLODGenerator::MeshLODsConstPtr pmeshlods)
+{
+    if( s_nMaxMeshLODCacheSize == 0 ) {
+        return;
+    }
+    if( s_mapMeshLODCache.find(key) == s_mapMeshLODCache.end() ) {
+        _EvictCachedMeshLODs(s_nMaxMeshLODCacheSize-1);
+    }
+    // a different mesh with the same key is replaced
+    MeshLODCacheEntry& entry = s_mapMeshLODCache[key];
+    entry.mesh = mesh;
+    entry.numspheres = numspheres;
+    entry.fcellsize = fcellsize;
+    entry.pmeshlods = pmeshlods;
+    entry.lastuse = ++s_nMeshLODCacheUses;
+}
+
+GeometryLODGenerator::GeometryLODGenerator(int numspheres, dReal fcellsize, int numthreads) : _numspheres(numspheres), _fcellsize(fcellsize), _numthreads(numthreads)
+{
+}
+
+void GeometryLODGenerator::GenerateGeometryGroups(KinBodyPtr pbody, const std::string& prefix)
+{
+    const std::vector<KinBody::LinkPtr>& vlinks = pbody->GetLinks();
+
+    // gather the meshes to process, identical meshes are only processed once
+    std::vector<const TriMesh*> vmeshes;
+    std::vector<uint64_t> vmeshkeys;
+    std::multimap<uint64_t, int> mapMeshIndices; ///< key of the mesh -> index into vmeshes, several if the keys of different meshes collide
+    std::vector< std::vector<int> > vvgeommeshindices(vlinks.size()); ///< for every geometry the index into vmeshes, -1 if not a mesh
+    for(size_t ilink = 0; ilink < vlinks.size(); ++ilink) {
+        const std::vector<KinBody::Link::GeometryPtr>& vgeometries = vlinks[ilink]->GetGeometries();
+        vvgeommeshindices[ilink].resize(vgeometries.size(), -1);
+        for(size_t igeom = 0; igeom < vgeometries.size(); ++igeom) {
+            const KinBody::Link::Geometry& geom = *vgeometries[igeom];
+            if( !_IsMeshGeometryType(geom.GetType()) || geom.GetCollisionMesh().indices.size() == 0 ) {
+                continue;
+            }
+            const TriMesh& mesh = geom.GetCollisionMesh();
+            const uint64_t key = _ComputeMeshKey(mesh);
+            // the key is only a hash, so only share the mesh if the contents are the same
+            std::pair<std::multimap<uint64_t, int>::iterator, std::multimap<uint64_t, int>::iterator> itrange = mapMeshIndices.equal_range(key);
+            std::multimap<uint64_t, int>::iterator it = itrange.first;
+            while( it != itrange.second && *vmeshes[it->second] != mesh ) {
+                ++it;
+            }
+            if( it == itrange.second ) {
+                it = mapMeshIndices.insert(std::make_pair(key, (int)vmeshes.size()));
+                vmeshes.push_back(&mesh);
+                vmeshkeys.push_back(key);
+            }
+            vvgeommeshindices[ilink][igeom] = it->second;
+        }
+    }
+
+    std::vector<MeshLODsConstPtr> vmeshlods(vmeshes.size());
+    {
+        std::lock_guard<std::mutex> lock(s_mutexMeshLODCache);
+        for(size_t imesh = 0; imesh < vmeshes.size(); ++imesh) {
+            vmeshlods[imesh] = _FindCachedMeshLODs(vmeshkeys[imesh], *vmeshes[imesh], _numspheres, _fcellsize);
+        }
+    }
+
+    // process the missing meshes on the thread pool, every task takes the next unprocessed mesh so that at most _numthreads meshes are processed at once
+    std::atomic<size_t> nextmeshindex(0);
+    std::atomic<int> numfailed(0);
+    // the workers and the calling thread
+    size_t numtasks = _numthreads > 0 ? _numthreads : RaveGetThreadPool()->GetNumThreads() + 1;
+    numtasks = std::min(numtasks, vmeshes.size());
+    RaveGetThreadPool()->ParallelFor(numtasks, [&](size_t) {
+        for(size_t imesh = nextmeshindex++; imesh < vmeshes.size(); imesh = nextmeshindex++) {
+            if( !!vmeshlods[imesh] ) {
+                continue;
+            }
+            try {
+                vmeshlods[imesh] = _ComputeMeshLODs(*vmeshes[imesh]);
+            }
+            catch(const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("env=%s, failed to compute levels of detail of a mesh of body %s: %s", pbody->GetEnv()->GetNameId()%pbody->GetName()%ex.what());
+                ++numfailed;
+            }
+        }
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutexMeshLODCache);
+        for(size_t imesh = 0; imesh < vmeshes.size(); ++imesh) {
+            if( !!vmeshlods[imesh] ) {
+                _AddCachedMeshLODs(vmeshkeys[imesh], *vmeshes[imesh], _numspheres, _fcellsize, vmeshlods[imesh]);
+            }
+        }
+    }
+
+    std::vector< std::vector<KinBody::GeometryInfoPtr> > vhullgeometries(vlinks.size()), vspheregeometries(vlinks.size()), vdecimatedgeometries(vlinks.size());
+    for(size_t ilink = 0; ilink < vlinks.size(); ++ilink) {
+        const std::vector<KinBody::Link::GeometryPtr>& vgeometries = vlinks[ilink]->GetGeometries();
+        for(size_t igeom = 0; igeom < vgeometries.size(); ++igeom) {
+            const KinBody::GeometryInfo& info = vgeometries[igeom]->GetInfo();
+            const int imesh = vvgeommeshindices[ilink][igeom];
+            if( imesh < 0 || !vmeshlods[imesh] ) {
+                KinBody::GeometryInfoPtr pinfo(new KinBody::GeometryInfo(info));
+                vhullgeometries[ilink].push_back(pinfo);
+                vspheregeometries[ilink].push_back(pinfo);
+                vdecimatedgeometries[ilink].push_back(pinfo);
+                continue;
+            }
+
+            const MeshLODs& meshlods = *vmeshlods[imesh];
+            KinBody::GeometryInfoPtr phullinfo(new KinBody::GeometryInfo());
+            phullinfo->_type = OpenRAVE::GT_TriMesh;
+            phullinfo->_name = info._name;
+            phullinfo->_t = info._t;
+            phullinfo->_vDiffuseColor = info._vDiffuseColor;
+            phullinfo->_meshcollision = meshlods.hull;
+            vhullgeometries[ilink].push_back(phullinfo);
+
+            KinBody::GeometryInfoPtr pdecimatedinfo(new KinBody::GeometryInfo(*phullinfo));
+            pdecimatedinfo->_meshcollision = meshlods.decimated;
+            vdecimatedgeometries[ilink].push_back(pdecimatedinfo);
+
+            FOREACHC(itsphere, meshlods.vspheres) {
+                KinBody::GeometryInfoPtr psphereinfo(new KinBody::GeometryInfo());
+                psphereinfo->_type = OpenRAVE::GT_Sphere;
+                psphereinfo->_name = info._name;
+                psphereinfo->_t = info._t * Transform(Vector(1,0,0,0), Vector(itsphere->x, itsphere->y, itsphere->z));
+                psphereinfo->_vGeomData.x = itsphere->w;
+                psphereinfo->_vDiffuseColor = info._vDiffuseColor;
+                vspheregeometries[ilink].push_back(psphereinfo);
+            }
+        }
+    }
+
+    if( numfailed > 0 ) {
+        RAVELOG_WARN_FORMAT("env=%s, body %s has %d meshes without levels of detail, using the original meshes for them", pbody->GetEnv()->GetNameId()%pbody->GetName()%numfailed);
+    }
+    RAVELOG_DEBUG_FORMAT("env=%s, generated geometry groups %s* of body %s from %d unique meshes", pbody->GetEnv()->GetNameId()%prefix%pbody->GetName()%vmeshes.size());
+    pbody->SetLinkGroupGeometries(prefix + "hull", vhullgeometries);
+    pbody->SetLinkGroupGeometries(prefix + "spheres", vspheregeometries);
+    pbody->SetLinkGroupGeometries(prefix + "decimated", vdecimatedgeometries);
+}
+
+GeometryLODGenerator::MeshLODsConstPtr GeometryLODGenerator::GetMeshLODs(const TriMesh& mesh)
+{
+    const uint64_t key = _ComputeMeshKey(mesh);
+    {
+        std::lock_guard<std::mutex> lock(s_mutexMeshLODCache);
+        MeshLODsConstPtr pmeshlods = _FindCachedMeshLODs(key, mesh, _numspheres, _fcellsize);
+        if( !!pmeshlods ) {
+            return pmeshlods;
+        }
+    }
+    MeshLODsConstPtr pmeshlods = _ComputeMeshLODs(mesh);
+    std::lock_guard<std::mutex> lock(s_mutexMeshLODCache);
+    _AddCachedMeshLODs(key, mesh, _numspheres, _fcellsize, pmeshlods);
+    return pmeshlods;
+}
+
+void GeometryLODGenerator::SetMaxCacheSize(size_t maxsize)
+{
+    std::lock_guard<std::mutex> lock(s_mutexMeshLODCache);
+    s_nMaxMeshLODCacheSize = maxsize;
+    _EvictCachedMeshLODs(s_nMaxMeshLODCacheSize);
+}
+
+void GeometryLODGenerator::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(s_mutexMeshLODCache);
+    s_mapMeshLODCache.clear();
+}
+
+bool GeometryLODGenerator::ComputeConvexHull(const TriMesh& mesh, TriMesh& hull)
+{
+    hull.vertices.resize(0);
+    hull.indices.resize(0);
+#ifdef QHULL_FOUND
+    if( mesh.vertices.size() < 4 ) {
+        return false;
+    }
+
+    std::vector<coordT> qpoints(3*mesh.vertices.size());
+    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
+        qpoints[3*i+0] = mesh.vertices[i].x;
+        qpoints[3*i+1] = mesh.vertices[i].y;
+        qpoints[3*i+2] = mesh.vertices[i].z;
+    }
+
+    boolT ismalloc = 0;
+    char flags[] = "qhull Qt"; // triangulated output
+
+#ifdef QHULL_USE_REENTRANT
+    qhT qh_qh;
+    qhT *qh= &qh_qh;
+    qh_zero(qh, stderr);
+    int exitcode = qh_new_qhull(qh, 3, mesh.vertices.size(), &qpoints[0], ismalloc, flags, NULL, stderr);
+#else
+    std::lock_guard<std::mutex> lock(s_QhullMutex);
+    int exitcode = qh_new_qhull(3, mesh.vertices.size(), &qpoints[0], ismalloc, flags, NULL, stderr);
+#endif
+    if( !exitcode ) {
+        std::vector<int> vnewindices(mesh.vertices.size(), -1);
+        facetT *facet;
+        vertexT *vertex, **vertexp;
+        FORALLfacets {
+            int ids[3];
+            int numvertices = 0;
+            FOREACHvertex_(facet->vertices) {
+                if( numvertices < 3 ) {
+#ifdef QHULL_USE_REENTRANT
+                    ids[numvertices] = qh_pointid(qh, vertex->point);
+#else
+                    ids[numvertices] = qh_pointid(vertex->point);
+#endif
+                }
+                ++numvertices;
+            }
+            if( numvertices != 3 || !facet->normal ) {
+                continue;
+            }
+            // qhull does not order the vertices, so orient the triangle with the facet normal
+            const Vector& v0 = mesh.vertices.at(ids[0]);
+            const Vector& v1 = mesh.vertices.at(ids[1]);
+            const Vector& v2 = mesh.vertices.at(ids[2]);
+            if( (v1-v0).cross(v2-v0).dot3(Vector(facet->normal[0], facet->normal[1], facet->normal[2])) < 0 ) {
+                std::swap(ids[1], ids[2]);
+            }
+            for(int j = 0; j < 3; ++j) {
+                if( vnewindices[ids[j]] < 0 ) {
+                    vnewindices[ids[j]] = hull.vertices.size();
+                    hull.vertices.push_back(mesh.vertices[ids[j]]);
+                }
+                hull.indices.push_back(vnewindices[ids[j]]);
+            }
+        }
+    }
+
+    int curlong, totlong;
+#ifdef QHULL_USE_REENTRANT
+    qh_freeqhull(qh, !qh_ALL);
+    qh_memfreeshort(qh, &curlong, &totlong);
+#else
+    qh_freeqhull(!qh_ALL);
+    qh_memfreeshort(&curlong, &totlong);
+#endif
+    if( exitcode ) {
+        hull.vertices.resize(0);
+        hull.indices.resize(0);
+        return false;
+    }
+    return hull.indices.size() > 0;
+#else
+    return false;
+#endif
+}
+
+void GeometryLODGenerator::ComputeBoundingSpheres(const TriMesh& mesh, int numspheres, std::vector<Vector>& vspheres)
+{
+    vspheres.resize(0);
+    const size_t numtriangles = mesh.indices.size()/3;
+    if( numtriangles == 0 || numspheres <= 0 ) {
+        return;
+    }
+
+    std::vector<Vector> vcenters(numtriangles);
+    for(size_t itri = 0; itri < numtriangles; ++itri) {
+        vcenters[itri] = (mesh.vertices.at(mesh.indices[3*itri]) + mesh.vertices.at(mesh.indices[3*itri+1]) + mesh.vertices.at(mesh.indices[3*itri+2]))*(1.0/3.0);
+    }
+    std::vector<size_t> vtriangles(numtriangles);
+    std::iota(vtriangles.begin(), vtriangles.end(), 0);
+
+    // ranges into vtriangles, always split the biggest one
+    std::vector< std::pair<size_t, size_t> > vranges(1, std::make_pair((size_t)0, numtriangles));
+    while( (int)vranges.size() < numspheres ) {
+        size_t ibiggest = 0;
+        for(size_t irange = 1; irange < vranges.size(); ++irange) {
+            if( vranges[irange].second - vranges[irange].first > vranges[ibiggest].second - vranges[ibiggest].first ) {
+                ibiggest = irange;
+            }
+        }
+        const size_t start = vranges[ibiggest].first, end = vranges[ibiggest].second;
+        if( end - start < 2 ) {
+            break;
+        }
+
+        Vector vmin = vcenters[vtriangles[start]], vmax = vmin;
+        for(size_t i = start+1; i < end; ++i) {
+            const Vector& v = vcenters[vtriangles[i]];
+            for(int j = 0; j < 3; ++j) {
+                vmin[j] = std::min(vmin[j], v[j]);
+                vmax[j] = std::max(vmax[j], v[j]);
+            }
+        }
+        int axis = 0;
+        for(int j = 1; j < 3; ++j) {
+            if( vmax[j] - vmin[j] > vmax[axis] - vmin[axis] ) {
+                axis = j;
+            }
+        }
+        const size_t middle = start + (end - start)/2;
+        std::nth_element(vtriangles.begin() + start, vtriangles.begin() + middle, vtriangles.begin() + end, [&](size_t itri0, size_t itri1) {
+            return vcenters[itri0][axis] < vcenters[itri1][axis];
+        });
+        vranges[ibiggest].second = middle;
+        vranges.emplace_back(middle, end);
+    }
+
+    vspheres.reserve(vranges.size());
+    FOREACHC(itrange, vranges) {
+        // the sphere contains all the vertices of the triangles, so it contains the triangles
+        Vector vmin = mesh.vertices.at(mesh.indices[3*vtriangles[itrange->first]]), vmax = vmin;
+        for(size_t i = itrange->first; i < itrange->second; ++i) {
+            for(int k = 0; k < 3; ++k) {
+                const Vector& v = mesh.vertices.at(mesh.indices[3*vtriangles[i]+k]);
+                for(int j = 0; j < 3; ++j) {
+                    vmin[j] = std::min(vmin[j], v[j]);
+                    vmax[j] = std::max(vmax[j], v[j]);
+                }
+            }
+        }
+        Vector vcenter = (vmin + vmax)*0.5;
+        dReal fradiussqr = 0;
+        for(size_t i = itrange->first; i < itrange->second; ++i) {
+            for(int k = 0; k < 3; ++k) {
+                fradiussqr = std::max(fradiussqr, (mesh.vertices.at(mesh.indices[3*vtriangles[i]+k]) - vcenter).lengthsqr3());
+            }
+        }
+        vcenter.w = OpenRAVE::RaveSqrt(fradiussqr);
+        vspheres.push_back(vcenter);
+    }
+}
+
+void GeometryLODGenerator::DecimateMesh(const TriMesh& mesh, dReal fcellsize, TriMesh& decimated)
+{
+    decimated.vertices.resize(0);
+    decimated.indices.resize(0);
+    if( mesh.vertices.size() == 0 ) {
+        return;
+    }
+    const OpenRAVE::AABB ab = mesh.ComputeAABB();
+    if( fcellsize <= 0 ) {
+        fcellsize = 0.1*std::max(ab.extents.x, std::max(ab.extents.y, ab.extents.z)); // 1/20 of the largest full extent
+    }
+    if( fcellsize <= 0 ) {
+        decimated = mesh;
+        return;
+    }
+
+    const dReal ficellsize = 1/fcellsize;
+    const Vector vorigin = ab.pos - ab.extents;
+    const uint64_t numcellsy = (uint64_t)(2*ab.extents.y*ficellsize) + 1, numcellsz = (uint64_t)(2*ab.extents.z*ficellsize) + 1;
+
+    // merge the vertices of every cell to their mean
+    std::map<uint64_t, int> mapCellVertices;
+    std::vector<int> vnewindices(mesh.vertices.size());
+    std::vector<int> vnumcellvertices;
+    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const Vector v = mesh.vertices[i] - vorigin;
+        const uint64_t key = ((uint64_t)(v.x*ficellsize)*numcellsy + (uint64_t)(v.y*ficellsize))*numcellsz + (uint64_t)(v.z*ficellsize);
+        std::map<uint64_t, int>::iterator it = mapCellVertices.find(key);
+        if( it == mapCellVertices.end() ) {
+            it = mapCellVertices.insert(std::make_pair(key, (int)decimated.vertices.size())).first;
+            decimated.vertices.push_back(Vector());
+            vnumcellvertices.push_back(0);
+        }
+        decimated.vertices[it->second] += mesh.vertices[i];
+        vnumcellvertices[it->second] += 1;
+        vnewindices[i] = it->second;
+    }
+    for(size_t i = 0; i < decimated.vertices.size(); ++i) {
+        decimated.vertices[i] *= 1.0/vnumcellvertices[i];
+    }
+
+    decimated.indices.reserve(mesh.indices.size());
+    for(size_t i = 0; i+2 < mesh.indices.size(); i += 3) {
+        const int i0 = vnewindices.at(mesh.indices[i]), i1 = vnewindices.at(mesh.indices[i+1]), i2 = vnewindices.at(mesh.indices[i+2]);
+        if( i0 == i1 || i1 == i2 || i0 == i2 ) {
+            continue; // collapsed
+        }
+        decimated.indices.push_back(i0);
+        decimated.indices.push_back(i1);
+        decimated.indices.push_back(i2);
+    }
+}
+
+uint64_t GeometryLODGenerator::_ComputeMeshKey(const TriMesh& mesh) const
+{
+    uint64_t key = OpenRAVE::utils::CombineFastHash(mesh.vertices.size(), mesh.indices.size());
+    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const dReal vertex[3] = { mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z };
+        key = OpenRAVE::utils::GetFastHash((const uint8_t*)vertex, sizeof(vertex), key);
+    }
+    if( mesh.indices.size() > 0 ) {
+        key = OpenRAVE::utils::GetFastHash((const uint8_t*)&mesh.indices[0], mesh.indices.size()*sizeof(mesh.indices[0]), key);
+    }
+    // the levels of detail also depend on the parameters
+    key = OpenRAVE::utils::CombineFastHash(key, _numspheres);
+    return OpenRAVE::utils::GetFastHash((const uint8_t*)&_fcellsize, sizeof(_fcellsize), key);
+}
+
+GeometryLODGenerator::MeshLODsConstPtr GeometryLODGenerator::_ComputeMeshLODs(const TriMesh& mesh) const
+{
+    boost::shared_ptr<MeshLODs> pmeshlods(new MeshLODs());
+    if( !ComputeConvexHull(mesh, pmeshlods->hull) ) {
+        // degenerate or qhull is not available, the bounding box also contains the mesh
+        _AppendBoxMesh(mesh.ComputeAABB(), pmeshlods->hull);
+    }
+    ComputeBoundingSpheres(mesh, _numspheres, pmeshlods->vspheres);
+    DecimateMesh(mesh, _fcellsize, pmeshlods->decimated);
+    return pmeshlods;
+}
+
+} // fclrave
@@ -0,0 +1,76 @@
+// -*- coding: utf-8 -*-
+#ifndef OPENRAVE_FCL_GEOMETRYLOD
+#define OPENRAVE_FCL_GEOMETRYLOD
+
+#include "plugindefs.h"
+
+namespace fclrave {
+
+using OpenRAVE::dReal;
+using OpenRAVE::TriMesh;
+
+/// \brief generates coarse levels of detail of the collision meshes of bodies and stores them as geometry groups.
+///
+/// For every link, three geometry groups are created:
+/// - prefix+"hull" : the convex hull of every mesh geometry. Contains the original geometry.
+/// - prefix+"spheres" : a small set of spheres for every mesh geometry. Their union contains the original geometry.
+/// - prefix+"decimated" : every mesh decimated by vertex clustering. Approximates the original geometry but does not contain it.
+/// Geometries that are not meshes are copied as they are to all groups since fcl already has cheap primitives for them.
+/// The first two groups are conservative and can be used with FCLSpace::SetTieredGeometryGroup.
+///
+/// The meshes are processed in parallel, and the results are cached by the mesh content, so identical meshes of different bodies and environments are only processed once.
+/// The cache is bounded, see SetMaxCacheSize.
+class GeometryLODGenerator
+{
+public:
+    /// \brief coarse representations of one collision mesh, in the coordinate system of the mesh
+    struct MeshLODs
+    {
+        TriMesh hull; ///< convex hull, contains the mesh
+        std::vector<Vector> vspheres; ///< (x,y,z) is the center and w is the radius, the union of the spheres contains the mesh
+        TriMesh decimated; ///< mesh decimated by vertex clustering
+    };
+    typedef boost::shared_ptr<MeshLODs const> MeshLODsConstPtr;
+
+    /// \param numspheres the maximum number of spheres for every mesh
+    /// \param fcellsize the size of the vertex clustering cells for decimation. If <= 0, uses 1/20 of the largest extent of every mesh.
+    /// \param numthreads the maximum number of meshes processed at once on the thread pool. If <= 0, uses all the workers of the thread pool.
+    GeometryLODGenerator(int numspheres=8, dReal fcellsize=0, int numthreads=0);
+
+    /// \brief generates the geometry groups of all the links of the body, overwriting groups with the same names
+    void GenerateGeometryGroups(KinBodyPtr pbody, const std::string& prefix);
+
+    /// \brief returns the levels of detail of a mesh, using the cache if a mesh with the same content was already processed with the same parameters
+    MeshLODsConstPtr GetMeshLODs(const TriMesh& mesh);
+
+    /// \brief sets the maximum number of meshes the process-wide cache keeps the levels of detail of, the least recently used ones are evicted first. 0 disables the cache.
+    static void SetMaxCacheSize(size_t maxsize);
+
+    /// \brief removes all the levels of detail from the process-wide cache
+    static void ClearCache();
+
+    /// \brief computes the convex hull of the vertices of the mesh with outward facing triangles
+    ///
+    /// \return false if the hull could not be computed, for example because the mesh is planar
+    static bool ComputeConvexHull(const TriMesh& mesh, TriMesh& hull);
+
+    /// \brief computes at most numspheres spheres whose union contains all the triangles of the mesh
+    ///
+    /// The triangles are recursively split at the median of their centers along the longest axis, and every leaf is bounded by one sphere.
+    static void ComputeBoundingSpheres(const TriMesh& mesh, int numspheres, std::vector<Vector>& vspheres);
+
+    /// \brief decimates the mesh by merging all the vertices inside the same grid cell and removing the collapsed triangles
+    static void DecimateMesh(const TriMesh& mesh, dReal fcellsize, TriMesh& decimated);
+
+private:
+    uint64_t _ComputeMeshKey(const TriMesh& mesh) const;
+    MeshLODsConstPtr _ComputeMeshLODs(const TriMesh& mesh) const;
+
+    int _numspheres;
+    dReal _fcellsize;
+    int _numthreads;
+};
+
+} // fclrave
+
+#endif
@@ -3,6 +3,9 @@
 #include "fclspace.h"
 #include <fcl/container.h>
 
+#include <mutex>
+#include <unordered_map>
+
 namespace fclrave {
 
 template <class T>
@@ -45,6 +48,9 @@ FCLSpace::FCLKinBodyInfo::LinkInfo::LinkInfo(KinBody::LinkPtr plink) : _plink(pl
 FCLSpace::FCLSpace(EnvironmentBasePtr penv, const std::string& userdatakey)
     : _penv(penv)
     , _userdatakey(userdatakey)
+    , _numspherespermesh(0)
+    , _fspheremargin(0)
+    , _bShareMeshes(false)
     , _currentpinfo(1, FCLKinBodyInfoPtr()) // initialize with one null pointer, this is a place holder for null pointer so that we can return by reference. env id 0 means invalid so it's consistent with the definition as well
     , _bIsSelfCollisionChecker(true)
 {
@@ -77,6 +83,49 @@ void FCLSpace::ReloadKinBodyLinks(KinBodyConstPtr pbody, FCLKinBodyInfoPtr pinfo
         return;
     }
     pinfo->nLastLinkReloadStamp = pbody->GetUpdateStamp();
+    // the new collision objects do not have transforms yet, so the next synchronization has to update all links
+    pinfo->nLastStamp = std::numeric_limits<int>::min();
+
+    // the fcl geometries are independent of each other and building the BVHs of meshes dominates, so create all of them up front
+    std::vector<const KinBody::GeometryInfo*> vgeominfos;
+    FOREACHC(itlink, pbody->GetLinks()) {
+        const KinBody::LinkPtr& plink = *itlink;
+        if(pinfo->_geometrygroup.size() > 0 && plink->GetGroupNumGeometries(pinfo->_geometrygroup) >= 0) {
+            FOREACHC(itgeominfo, plink->GetGeometriesFromGroup(pinfo->_geometrygroup)) {
+                if( !!*itgeominfo ) {
+                    vgeominfos.push_back(itgeominfo->get());
+                }
+            }
+        }
+        else {
+            FOREACHC(itgeom, plink->GetGeometries()) {
+                vgeominfos.push_back(&(*itgeom)->GetInfo());
+            }
+        }
+        if( _tieredgeometrygroup.size() > 0 && pinfo->_geometrygroup != _tieredgeometrygroup && plink->GetGroupNumGeometries(_tieredgeometrygroup) > 0 ) {
+            FOREACHC(itgeominfo, plink->GetGeometriesFromGroup(_tieredgeometrygroup)) {
+                if( !!*itgeominfo ) {
+                    vgeominfos.push_back(itgeominfo->get());
+                }
+            }
+        }
+    }
+    std::vector<CollisionGeometryPtr> vfclgeoms;
+    _CreateFCLGeomsFromGeometryInfos(vgeominfos, vfclgeoms);
+    std::unordered_map<const KinBody::GeometryInfo*, CollisionGeometryPtr> mapfclgeoms;
+    for(size_t iinfo = 0; iinfo < vgeominfos.size(); ++iinfo) {
+        mapfclgeoms.emplace(vgeominfos[iinfo], vfclgeoms[iinfo]);
+    }
+    // every created geometry is used once, an info that is encountered again gets its own geometry
+    const auto fnGetFCLGeom = [&](const KinBody::GeometryInfo& geominfo) -> CollisionGeometryPtr {
+        std::unordered_map<const KinBody::GeometryInfo*, CollisionGeometryPtr>::iterator it = mapfclgeoms.find(&geominfo);
+        if( it == mapfclgeoms.end() ) {
+            return _CreateFCLGeomFromGeometryInfo(geominfo);
+        }
+        CollisionGeometryPtr pfclgeom = it->second;
+        mapfclgeoms.erase(it);
+        return pfclgeom;
+    };
 
     pinfo->vlinks.clear();
     pinfo->vlinks.reserve(pbody->GetLinks().size());
@@ -96,7 +145,7 @@ void FCLSpace::ReloadKinBodyLinks(KinBodyConstPtr pbody, FCLKinBodyInfoPtr pinfo
                     throw OpenRAVE::OpenRAVEException(str(boost::format("Failed to access geometry info %d for link %s:%s with geometrygroup %s")%igeominfo%plink->GetParent()->GetName()%plink->GetName()%pinfo->_geometrygroup), OpenRAVE::ORE_InvalidState);
                 }
                 const KinBody::GeometryInfo& geominfo = *pgeominfo;
-                const CollisionGeometryPtr pfclgeom = _CreateFCLGeomFromGeometryInfo(geominfo);
+                const CollisionGeometryPtr pfclgeom = fnGetFCLGeom(geominfo);
 
                 if( !pfclgeom ) {
                     continue;
@@ -114,11 +163,15 @@ void FCLSpace::ReloadKinBodyLinks(KinBodyConstPtr pbody, FCLKinBodyInfoPtr pinfo
                 linkinfo->vgeoms.push_back(TransformCollisionPair(geominfo.GetTransform(), pfclcoll));
 
                 KinBody::Link::Geometry _tmpgeometry(boost::shared_ptr<KinBody::Link>(), geominfo);
+                const OpenRAVE::AABB ablocal = _tmpgeometry.ComputeAABB(Transform());
                 if( itgeominfo == vgeometryinfos.begin() ) {
-                    enclosingBV = ConvertAABBToFcl(_tmpgeometry.ComputeAABB(Transform()));
+                    enclosingBV = ConvertAABBToFcl(ablocal);
                 }
                 else {
-                    enclosingBV += ConvertAABBToFcl(_tmpgeometry.ComputeAABB(Transform()));
+                    enclosingBV += ConvertAABBToFcl(ablocal);
+                }
+                if( _numspherespermesh > 0 ) {
+                    linkinfo->spheretree.AddGeometry(geominfo, ablocal, _numspherespermesh);
                 }
             }
         }
@@ -127,14 +180,16 @@ void FCLSpace::ReloadKinBodyLinks(KinBodyConstPtr pbody, FCLKinBodyInfoPtr pinfo
             FOREACH(itgeom, vgeometries) {
                 const KinBody::GeometryPtr& pgeom = *itgeom;
                 const KinBody::GeometryInfo& geominfo = pgeom->GetInfo();
-                const CollisionGeometryPtr pfclgeom = _CreateFCLGeomFromGeometryInfo(geominfo);
+                const CollisionGeometryPtr pfclgeom = fnGetFCLGeom(geominfo);
 
                 if( !pfclgeom ) {
                     continue;
                 }
                 boost::shared_ptr<FCLKinBodyInfo::FCLGeometryInfo> pfclgeominfo(new FCLKinBodyInfo::FCLGeometryInfo(pgeom));
                 pfclgeominfo->bodylinkgeomname = pbody->GetName() + "/" + plink->GetName() + "/" + pgeom->GetName();
-                pfclgeom->setUserData(pfclgeominfo.get());
+                if( !_IsSharedGeometry(pfclgeom) ) {
+                    pfclgeom->setUserData(pfclgeominfo.get());
+                }
                 // save the pointers
                 linkinfo->vgeominfos.push_back(pfclgeominfo);
 
@@ -145,15 +200,40 @@ void FCLSpace::ReloadKinBodyLinks(KinBodyConstPtr pbody, FCLKinBodyInfoPtr pinfo
                 linkinfo->vgeoms.push_back(TransformCollisionPair(geominfo.GetTransform(), pfclcoll));
 
                 KinBody::Link::Geometry _tmpgeometry(boost::shared_ptr<KinBody::Link>(), geominfo);
+                const OpenRAVE::AABB ablocal = _tmpgeometry.ComputeAABB(Transform());
                 if( itgeom == vgeometries.begin() ) {
-                    enclosingBV = ConvertAABBToFcl(_tmpgeometry.ComputeAABB(Transform()));
+                    enclosingBV = ConvertAABBToFcl(ablocal);
                 }
                 else {
-                    enclosingBV += ConvertAABBToFcl(_tmpgeometry.ComputeAABB(Transform()));
+                    enclosingBV += ConvertAABBToFcl(ablocal);
+                }
+                if( _numspherespermesh > 0 ) {
+                    linkinfo->spheretree.AddGeometry(geominfo, ablocal, _numspherespermesh);
                 }
             }
         }
 
+        if( _numspherespermesh > 0 ) {
+            linkinfo->spheretree.Finalize(_fspheremargin);
+        }
+
+        // coarse geometries for the tiered checking, not needed if they are already the current geometries
+        if( _tieredgeometrygroup.size() > 0 && pinfo->_geometrygroup != _tieredgeometrygroup && linkinfo->vgeoms.size() > 0 && plink->GetGroupNumGeometries(_tieredgeometrygroup) > 0 ) {
+            FOREACHC(itgeominfo, plink->GetGeometriesFromGroup(_tieredgeometrygroup)) {
+                if( !*itgeominfo ) {
+                    continue;
+                }
+                const CollisionGeometryPtr pfclgeom = fnGetFCLGeom(**itgeominfo);
+                if( !pfclgeom ) {
+                    continue;
+                }
+                pfclgeom->setUserData(nullptr);
+                CollisionObjectPtr pfclcoll = boost::make_shared<fcl::CollisionObject>(pfclgeom);
+                pfclcoll->setUserData(linkinfo.get());
+                linkinfo->vcoarsegeoms.push_back(TransformCollisionPair((*itgeominfo)->GetTransform(), pfclcoll));
+            }
+        }
+
         if( linkinfo->vgeoms.size() == 0 ) {
             RAVELOG_DEBUG_FORMAT("env=%s, Initializing body '%s' (index=%d) link '%s' with 0 geometries (env %d) (userdatakey %s)", _penv->GetNameId()%pbody->GetName()%pbody->GetEnvironmentBodyIndex()%plink->GetName()%_penv->GetId()%_userdatakey);
         }
@@ -290,6 +370,116 @@ bool FCLSpace::SetBodyGeometryGroup(KinBodyConstPtr pbody, const std::string& gr
     return true;
 }
 
+void FCLSpace::SetTieredGeometryGroup(const std::string& groupname)
+{
+    if( groupname == _tieredgeometrygroup ) {
+        return;
+    }
+    _tieredgeometrygroup = groupname;
+
+    // the coarse geometries are created with the links, so reinitialize all the FCLKinBodyInfo
+    for (const KinBodyConstPtr& pbody : _vecInitializedBodies) {
+        if (!pbody) {
+            continue;
+        }
+        FCLKinBodyInfoPtr& pinfo = GetInfo(*pbody);
+        pinfo->nGeometryUpdateStamp++;
+        InitKinBody(pbody, pinfo);
+    }
+    _cachedpinfo.clear();
+}
+
+void FCLSpace::SetLinkSphereTrees(int numspheres, dReal fmargin)
+{
+    if( numspheres <= 0 ) {
+        numspheres = 0;
+        fmargin = 0;
+    }
+    if( numspheres == _numspherespermesh && fmargin == _fspheremargin ) {
+        return;
+    }
+    _numspherespermesh = numspheres;
+    _fspheremargin = fmargin;
+
+    // the sphere trees are built with the links, so reinitialize all the FCLKinBodyInfo
+    for (const KinBodyConstPtr& pbody : _vecInitializedBodies) {
+        if (!pbody) {
+            continue;
+        }
+        FCLKinBodyInfoPtr& pinfo = GetInfo(*pbody);
+        pinfo->nGeometryUpdateStamp++;
+        InitKinBody(pbody, pinfo);
+    }
+    _cachedpinfo.clear();
+}
+
+void FCLSpace::SetMeshSharing(bool bShareMeshes)
+{
+    if( bShareMeshes == _bShareMeshes ) {
+        return;
+    }
+    _bShareMeshes = bShareMeshes;
+
+    // the meshes are created with the links, so reinitialize all the FCLKinBodyInfo
+    for (const KinBodyConstPtr& pbody : _vecInitializedBodies) {
+        if (!pbody) {
+            continue;
+        }
+        FCLKinBodyInfoPtr& pinfo = GetInfo(*pbody);
+        pinfo->nGeometryUpdateStamp++;
+        InitKinBody(pbody, pinfo);
+    }
+    _cachedpinfo.clear();
+}
+
+/// \brief bytes of a BVH model, 0 if fclgeom is not one
+static size_t _GetBVHMemoryUsage(const fcl::CollisionGeometry& fclgeom)
+{
+    if( fclgeom.getObjectType() != fcl::OT_BVH ) {
+        return 0;
+    }
+    switch(fclgeom.getNodeType()) {
+    case fcl::BV_AABB: return static_cast<const fcl::BVHModel<fcl::AABB>&>(fclgeom).memUsage(0);
+    case fcl::BV_OBB: return static_cast<const fcl::BVHModel<fcl::OBB>&>(fclgeom).memUsage(0);
+    case fcl::BV_RSS: return static_cast<const fcl::BVHModel<fcl::RSS>&>(fclgeom).memUsage(0);
+    case fcl::BV_OBBRSS: return static_cast<const fcl::BVHModel<fcl::OBBRSS>&>(fclgeom).memUsage(0);
+    case fcl::BV_kIOS: return static_cast<const fcl::BVHModel<fcl::kIOS>&>(fclgeom).memUsage(0);
+    case fcl::BV_KDOP16: return static_cast<const fcl::BVHModel< fcl::KDOP<16> >&>(fclgeom).memUsage(0);
+    case fcl::BV_KDOP18: return static_cast<const fcl::BVHModel< fcl::KDOP<18> >&>(fclgeom).memUsage(0);
+    case fcl::BV_KDOP24: return static_cast<const fcl::BVHModel< fcl::KDOP<24> >&>(fclgeom).memUsage(0);
+    default:
+        return 0;
+    }
+}
+
+size_t FCLSpace::GetMeshMemoryUsage(size_t& nummeshes) const
+{
+    std::set<const fcl::CollisionGeometry*> setmeshes;
+    size_t numbytes = 0;
+    for (const KinBodyConstPtr& pbody : _vecInitializedBodies) {
+        if (!pbody) {
+            continue;
+        }
+        const FCLKinBodyInfoPtr& pinfo = GetInfo(*pbody);
+        if( !pinfo ) {
+            continue;
+        }
+        FOREACHC(itlink, pinfo->vlinks) {
+            for(const std::vector<TransformCollisionPair>* pvgeoms : { &(*itlink)->vgeoms, &(*itlink)->vcoarsegeoms }) {
+                FOREACHC(itgeom, *pvgeoms) {
+                    const fcl::CollisionGeometry* pfclgeom = itgeom->second->collisionGeometry().get();
+                    const size_t meshbytes = _GetBVHMemoryUsage(*pfclgeom);
+                    if( meshbytes > 0 && setmeshes.insert(pfclgeom).second ) {
+                        numbytes += meshbytes;
+                    }
+                }
+            }
+        }
+    }
+    nummeshes = setmeshes.size();
+    return numbytes;
+}
+
 const std::string& FCLSpace::GetBodyGeometryGroup(const KinBody &body) const {
     static const std::string empty;
     const FCLKinBodyInfoPtr& pinfo = GetInfo(body);
@@ -577,67 +767,166 @@ CollisionGeometryPtr FCLSpace::_CreateFCLGeomFromGeometryInfo(const KinBody::Geo
         }
 
         OPENRAVE_ASSERT_OP(mesh.indices.size() % 3, ==, 0);
-        size_t const num_points = mesh.vertices.size();
-        size_t const num_triangles = mesh.indices.size() / 3;
-
-        std::vector<fcl::Vec3f> fcl_points(num_points);
-        for (size_t ipoint = 0; ipoint < num_points; ++ipoint) {
-            Vector v = mesh.vertices[ipoint];
-            fcl_points[ipoint] = fcl::Vec3f(v.x, v.y, v.z);
+        if( _bShareMeshes ) {
+            return _GetSharedMeshGeometry(mesh);
         }
+        return _CreateMeshGeometry(mesh);
+    }
 
-        std::vector<fcl::Triangle> fcl_triangles(num_triangles);
-        for (size_t itri = 0; itri < num_triangles; ++itri) {
-            int const *const tri_indices = &mesh.indices[3 * itri];
-            fcl_triangles[itri] = fcl::Triangle(tri_indices[0], tri_indices[1], tri_indices[2]);
-        }
+    default:
+        RAVELOG_WARN(str(boost::format("FCL doesn't support geom type %d")%info._type));
+        return CollisionGeometryPtr();
+    }
+}
+
+CollisionGeometryPtr FCLSpace::_CreateMeshGeometry(const OpenRAVE::TriMesh& mesh)
+{
+    size_t const num_points = mesh.vertices.size();
+    size_t const num_triangles = mesh.indices.size() / 3;
+
+    std::vector<fcl::Vec3f> fcl_points(num_points);
+    for (size_t ipoint = 0; ipoint < num_points; ++ipoint) {
+        Vector v = mesh.vertices[ipoint];
+        fcl_points[ipoint] = fcl::Vec3f(v.x, v.y, v.z);
+    }
 
-        return _meshFactory(fcl_points, fcl_triangles);
+    std::vector<fcl::Triangle> fcl_triangles(num_triangles);
+    for (size_t itri = 0; itri < num_triangles; ++itri) {
+        int const *const tri_indices = &mesh.indices[3 * itri];
+        fcl_triangles[itri] = fcl::Triangle(tri_indices[0], tri_indices[1], tri_indices[2]);
     }
 
+    return _meshFactory(fcl_points, fcl_triangles);
+}
+
+/// \brief true if the BVH model was built from exactly the vertices and triangles of mesh
+template <class T>
+static bool _IsBVHModelOfMesh(const fcl::CollisionGeometry& fclgeom, const OpenRAVE::TriMesh& mesh)
+{
+    const fcl::BVHModel<T>& model = static_cast<const fcl::BVHModel<T>&>(fclgeom);
+    if( model.num_vertices != (int)mesh.vertices.size() || model.num_tris != (int)(mesh.indices.size()/3) ) {
+        return false;
+    }
+    for(int i = 0; i < model.num_vertices; ++i) {
+        const Vector& v = mesh.vertices[i];
+        const fcl::Vec3f& p = model.vertices[i];
+        if( p[0] != (fcl::FCL_REAL)v.x || p[1] != (fcl::FCL_REAL)v.y || p[2] != (fcl::FCL_REAL)v.z ) {
+            return false;
+        }
+    }
+    for(int i = 0; i < model.num_tris; ++i) {
+        const fcl::Triangle& tri = model.tri_indices[i];
+        if( (int)tri[0] != mesh.indices[3*i] || (int)tri[1] != mesh.indices[3*i+1] || (int)tri[2] != mesh.indices[3*i+2] ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \brief true if fclgeom is a BVH model built from mesh, used to guard the shared mesh cache against hash collisions
+static bool _IsMeshGeometryOf(const fcl::CollisionGeometry& fclgeom, const OpenRAVE::TriMesh& mesh)
+{
+    if( fclgeom.getObjectType() != fcl::OT_BVH ) {
+        return false;
+    }
+    switch(fclgeom.getNodeType()) {
+    case fcl::BV_AABB: return _IsBVHModelOfMesh<fcl::AABB>(fclgeom, mesh);
+    case fcl::BV_OBB: return _IsBVHModelOfMesh<fcl::OBB>(fclgeom, mesh);
+    case fcl::BV_RSS: return _IsBVHModelOfMesh<fcl::RSS>(fclgeom, mesh);
+    case fcl::BV_OBBRSS: return _IsBVHModelOfMesh<fcl::OBBRSS>(fclgeom, mesh);
+    case fcl::BV_kIOS: return _IsBVHModelOfMesh<fcl::kIOS>(fclgeom, mesh);
+    case fcl::BV_KDOP16: return _IsBVHModelOfMesh< fcl::KDOP<16> >(fclgeom, mesh);
+    case fcl::BV_KDOP18: return _IsBVHModelOfMesh< fcl::KDOP<18> >(fclgeom, mesh);
+    case fcl::BV_KDOP24: return _IsBVHModelOfMesh< fcl::KDOP<24> >(fclgeom, mesh);
     default:
-        RAVELOG_WARN(str(boost::format("FCL doesn't support geom type %d")%info._type));
+        return false;
+    }
+}
+
+/// process wide cache of the BVH models of spaces with mesh sharing enabled, keyed by BVH representation and mesh hash.
+/// Entries are weak so a model is freed once no space holds it anymore.
+static std::mutex s_mutexSharedMeshes;
+static std::map<std::pair<std::string, uint64_t>, std::weak_ptr<fcl::CollisionGeometry> > s_mapSharedMeshes;
+static size_t s_nSharedMeshesSweepSize = 64; ///< size of s_mapSharedMeshes at which the expired entries are removed next
+
+CollisionGeometryPtr FCLSpace::_GetSharedMeshGeometry(const OpenRAVE::TriMesh& mesh)
+{
+    if( mesh.vertices.empty() || mesh.indices.empty() ) {
+        // nothing to collide with, same as _CreateFCLGeomFromGeometryInfo
         return CollisionGeometryPtr();
     }
+    uint64_t key = OpenRAVE::utils::CombineFastHash(mesh.vertices.size(), mesh.indices.size());
+    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const dReal vertex[3] = { mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z };
+        key = OpenRAVE::utils::GetFastHash((const uint8_t*)vertex, sizeof(vertex), key);
+    }
+    key = OpenRAVE::utils::GetFastHash((const uint8_t*)&mesh.indices[0], mesh.indices.size()*sizeof(mesh.indices[0]), key);
+    const std::pair<std::string, uint64_t> cachekey(_bvhRepresentation, key);
+    {
+        std::lock_guard<std::mutex> lock(s_mutexSharedMeshes);
+        std::map<std::pair<std::string, uint64_t>, std::weak_ptr<fcl::CollisionGeometry> >::iterator it = s_mapSharedMeshes.find(cachekey);
+        if( it != s_mapSharedMeshes.end() ) {
+            CollisionGeometryPtr pfclgeom = it->second.lock();
+            if( !!pfclgeom ) {
+                if( _IsMeshGeometryOf(*pfclgeom, mesh) ) {
+                    return pfclgeom;
+                }
+                // hash collision, give this mesh its own model and keep the cached one for the meshes it was built from
+                RAVELOG_VERBOSE_FORMAT("mesh hash 0x%x collides with a different cached mesh, building an unshared BVH model", key);
+                return _CreateMeshGeometry(mesh);
+            }
+        }
+    }
+
+    // build outside of the lock, if another thread builds the same mesh meanwhile one of the two models is simply not shared
+    CollisionGeometryPtr pfclgeom = _CreateMeshGeometry(mesh);
+    std::lock_guard<std::mutex> lock(s_mutexSharedMeshes);
+    s_mapSharedMeshes[cachekey] = pfclgeom;
+    if( s_mapSharedMeshes.size() >= s_nSharedMeshesSweepSize ) {
+        for(std::map<std::pair<std::string, uint64_t>, std::weak_ptr<fcl::CollisionGeometry> >::iterator it = s_mapSharedMeshes.begin(); it != s_mapSharedMeshes.end(); ) {
+            if( it->second.expired() ) {
+                it = s_mapSharedMeshes.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        s_nSharedMeshesSweepSize = std::max((size_t)64, 2*s_mapSharedMeshes.size());
+    }
+    return pfclgeom;
+}
+
+void FCLSpace::_CreateFCLGeomsFromGeometryInfos(const std::vector<const KinBody::GeometryInfo*>& vinfos, std::vector<CollisionGeometryPtr>& vfclgeoms)
+{
+    vfclgeoms.resize(0);
+    vfclgeoms.resize(vinfos.size());
+
+    // below the threshold dispatching to the thread pool costs more than creating the geometries
+    static const size_t s_nMinGeometriesForThreads = 64;
+    RaveGetThreadPool()->ParallelFor(vinfos.size(), [&](size_t iinfo) {
+        vfclgeoms[iinfo] = _CreateFCLGeomFromGeometryInfo(*vinfos[iinfo]);
+    }, s_nMinGeometriesForThreads);
 }
 
 void FCLSpace::_Synchronize(FCLKinBodyInfo& info, const KinBody& body)
 {
     //KinBodyPtr pbody = info.GetBody();
     if( info.nLastStamp != body.GetUpdateStamp()) {
-        info.nLastStamp = body.GetUpdateStamp();
         if( body.GetLinks().size() != info.vlinks.size() ) {
             throw OpenRAVE::OpenRAVEException(str(boost::format("env=%s, the current number of links in body '%s' are %d, and are not the same as the number cached links %d")%_penv->GetNameId()%body.GetName()%body.GetLinks().size()%info.vlinks.size()), OpenRAVE::ORE_InvalidState);
         }
 
-        for(size_t i = 0; i < body.GetLinks().size(); ++i) {
-            FCLSpace::FCLKinBodyInfo::LinkInfo& linkInfo = *info.vlinks[i];
-            CollisionObjectPtr& pcoll = linkInfo.linkBV.second; // avoid copying shared pointer for performance
-            if( !pcoll ) {
-                continue;
+        // if only SetDOFValues was called since the last synchronization, only the links it moved have to be updated
+        const std::vector<int>* pvmovedlinks = body.GetLinksMovedSinceUpdateStamp(info.nLastStamp);
+        info.nLastStamp = body.GetUpdateStamp();
+        if( !!pvmovedlinks ) {
+            for(int linkindex : *pvmovedlinks) {
+                _SynchronizeLink(*info.vlinks[linkindex], body.GetLinks()[linkindex]->GetTransform());
             }
-            const Transform& linkTransform = body.GetLinks()[i]->GetTransform();
-            Transform pose = linkTransform;
-            pose.trans += pose.rotate(linkInfo.linkBV.first);
-            const fcl::Vec3f newPosition = ConvertVectorToFCL(pose.trans);
-            const fcl::Quaternion3f newOrientation = ConvertQuaternionToFCL(pose.rot);
-
-            pcoll->setTranslation(newPosition);
-            pcoll->setQuatRotation(newOrientation);
-            // Do not forget to recompute the AABB otherwise getAABB won't give an up to date AABB
-            pcoll->computeAABB();
-
-            //info.vlinks[i]->nLastStamp = info.nLastStamp;
-            for (const TransformCollisionPair& pgeom : linkInfo.vgeoms) {
-                fcl::CollisionObject& coll = *pgeom.second;
-                const Transform pose1 = linkTransform * pgeom.first;
-                const fcl::Vec3f newPosition1 = ConvertVectorToFCL(pose1.trans);
-                const fcl::Quaternion3f newOrientation1 = ConvertQuaternionToFCL(pose1.rot);
-
-                coll.setTranslation(newPosition1);
-                coll.setQuatRotation(newOrientation1);
-                // Do not forget to recompute the AABB otherwise getAABB won't give an up to date AABB
-                coll.computeAABB();
+        }
+        else {
+            for(size_t i = 0; i < body.GetLinks().size(); ++i) {
+                _SynchronizeLink(*info.vlinks[i], body.GetLinks()[i]->GetTransform());
             }
         }
 
@@ -648,6 +937,43 @@ void FCLSpace::_Synchronize(FCLKinBodyInfo& info, const KinBody& body)
     }
 }
 
+void FCLSpace::_SynchronizeLink(FCLKinBodyInfo::LinkInfo& linkInfo, const Transform& linkTransform)
+{
+    CollisionObjectPtr& pcoll = linkInfo.linkBV.second; // avoid copying shared pointer for performance
+    if( !pcoll ) {
+        return;
+    }
+    Transform pose = linkTransform;
+    pose.trans += pose.rotate(linkInfo.linkBV.first);
+    const fcl::Vec3f newPosition = ConvertVectorToFCL(pose.trans);
+    const fcl::Quaternion3f newOrientation = ConvertQuaternionToFCL(pose.rot);
+
+    pcoll->setTranslation(newPosition);
+    pcoll->setQuatRotation(newOrientation);
+    // Do not forget to recompute the AABB otherwise getAABB won't give an up to date AABB
+    pcoll->computeAABB();
+
+    for (const TransformCollisionPair& pgeom : linkInfo.vgeoms) {
+        fcl::CollisionObject& coll = *pgeom.second;
+        const Transform pose1 = linkTransform * pgeom.first;
+        const fcl::Vec3f newPosition1 = ConvertVectorToFCL(pose1.trans);
+        const fcl::Quaternion3f newOrientation1 = ConvertQuaternionToFCL(pose1.rot);
+
+        coll.setTranslation(newPosition1);
+        coll.setQuatRotation(newOrientation1);
+        // Do not forget to recompute the AABB otherwise getAABB won't give an up to date AABB
+        coll.computeAABB();
+    }
+    linkInfo.spheretree.SetTransform(linkTransform);
+    for (const TransformCollisionPair& pgeom : linkInfo.vcoarsegeoms) {
+        fcl::CollisionObject& coll = *pgeom.second;
+        const Transform pose1 = linkTransform * pgeom.first;
+        coll.setTranslation(ConvertVectorToFCL(pose1.trans));
+        coll.setQuatRotation(ConvertQuaternionToFCL(pose1.rot));
+        coll.computeAABB();
+    }
+}
+
 /// Scope guard to ensure that user data for a kinbody is cleared on scope exit
 /// May be reset to 'disarm' the guard if the data should be kept on scope exit after all.
 struct ScopedUserDataRemover
@@ -6,6 +6,8 @@
 #include <memory> // c++11
 #include <vector>
 
+#include "fclspheretree.h"
+
 namespace fclrave {
 
 typedef KinBody::LinkConstPtr LinkConstPtr;
@@ -120,6 +122,12 @@ public:
                     (*itgeompair).second.reset();
                 }
                 vgeoms.resize(0);
+                FOREACH(itgeompair, vcoarsegeoms) {
+                    (*itgeompair).second->setUserData(nullptr);
+                    (*itgeompair).second.reset();
+                }
+                vcoarsegeoms.resize(0);
+                spheretree.Reset();
 
                 // make sure to clear vgeominfos after vgeoms because the CollisionObject inside each vgeom element has a corresponding vgeominfo as a void pointer.
                 vgeominfos.resize(0);
@@ -135,6 +143,8 @@ public:
             //int nLastStamp; ///< Tracks if the collision geometries are up to date wrt the body update stamp. This is for narrow phase collision
             TranslationCollisionPair linkBV; ///< pair of the translation and collision object corresponding to a bounding OBB for the link
             std::vector<TransformCollisionPair> vgeoms; ///< vector of transformations and collision object; one per geometries
+            std::vector<TransformCollisionPair> vcoarsegeoms; ///< conservative coarse geometries from the tiered geometry group, tested before vgeoms. Empty if the link does not have the group. \see FCLSpace::SetTieredGeometryGroup
+            LinkSphereTree spheretree; ///< spheres containing vgeoms, tested before any fcl call. Not valid if the sphere trees are disabled. \see FCLSpace::SetLinkSphereTrees
             std::string bodylinkname; // for debugging purposes
             bool bFromKinBodyLink; ///< if true, then from kinbodylink. Otherwise from standalone object that does not have any KinBody associations
         };
@@ -202,6 +212,44 @@ public:
 
     const std::string& GetBodyGeometryGroup(const KinBody &body) const;
 
+    /// \brief sets the geometry group used as coarse geometries for the tiered collision checking, empty disables it
+    ///
+    /// The geometries of the group have to contain the geometries they stand for (like the hull or spheres groups of GeometryLODGenerator),
+    /// otherwise collisions can be missed. Links that do not have the group are checked with their geometries only.
+    void SetTieredGeometryGroup(const std::string& groupname);
+
+    inline const std::string& GetTieredGeometryGroup() const {
+        return _tieredgeometrygroup;
+    }
+
+    /// \brief enables the sphere trees of the links that screen the pairs before fcl is called
+    ///
+    /// \param numspheres the maximum number of spheres per mesh geometry, <= 0 disables the sphere trees
+    /// \param fmargin the distance all spheres are inflated by
+    void SetLinkSphereTrees(int numspheres, dReal fmargin);
+
+    inline int GetLinkSphereTreesNumSpheres() const {
+        return _numspherespermesh;
+    }
+
+    inline dReal GetLinkSphereTreesMargin() const {
+        return _fspheremargin;
+    }
+
+    /// \brief shares the BVH models of identical meshes between all spaces of the process that enable it, instead of every environment and clone building its own copy
+    ///
+    /// A shared BVH model cannot point back to a single geometry through its user data, so collision reports look the geometry up through the link instead.
+    void SetMeshSharing(bool bShareMeshes);
+
+    inline bool IsMeshSharing() const {
+        return _bShareMeshes;
+    }
+
+    /// \brief returns the bytes held by the BVH models of the initialized bodies, models shared between geometries are counted once
+    ///
+    /// \param nummeshes filled with the number of distinct BVH models
+    size_t GetMeshMemoryUsage(size_t& nummeshes) const;
+
     // Set the current bvhRepresentation and reinitializes all the KinbodyInfo if needed
     void SetBVHRepresentation(std::string const &type);
 
@@ -269,9 +317,30 @@ private:
     // what about the tests on non-zero size (eg. box extents) ?
     CollisionGeometryPtr _CreateFCLGeomFromGeometryInfo(const KinBody::GeometryInfo &info);
 
+    /// \brief builds the BVH model of the mesh with the current representation
+    CollisionGeometryPtr _CreateMeshGeometry(const OpenRAVE::TriMesh& mesh);
+
+    /// \brief returns the BVH model of the mesh from the process wide cache, building and caching it if no space holds it anymore.
+    ///
+    /// The cached model is only returned when its vertices and triangles match mesh, on a hash collision an unshared model is built. Returns null for an empty mesh.
+    CollisionGeometryPtr _GetSharedMeshGeometry(const OpenRAVE::TriMesh& mesh);
+
+    /// \brief true if pfclgeom can be held by several geometries, in which case its user data has to stay null
+    inline bool _IsSharedGeometry(const CollisionGeometryPtr& pfclgeom) const {
+        return _bShareMeshes && pfclgeom->getObjectType() == fcl::OT_BVH;
+    }
+
+    /// \brief creates the fcl geometries of all infos, on the thread pool when there are enough of them to pay for dispatching
+    ///
+    /// \param vfclgeoms filled with the geometry of every info, null when fcl does not support it
+    void _CreateFCLGeomsFromGeometryInfos(const std::vector<const KinBody::GeometryInfo*>& vinfos, std::vector<CollisionGeometryPtr>& vfclgeoms);
+
     /// \brief pass in info.GetBody() as a reference to avoid dereferencing the weak pointer in FCLKinBodyInfo
     void _Synchronize(FCLKinBodyInfo& info, const KinBody& body);
 
+    /// \brief updates the collision objects of one link from its transform
+    void _SynchronizeLink(FCLKinBodyInfo::LinkInfo& linkInfo, const Transform& linkTransform);
+
     /// \brief controls whether the kinbody info is removed during the destructor
     class FCLKinBodyInfoRemover
     {
@@ -321,6 +390,10 @@ private:
     EnvironmentBasePtr _penv;
     std::string _userdatakey;
     std::string _geometrygroup;
+    std::string _tieredgeometrygroup; ///< \see SetTieredGeometryGroup
+    int _numspherespermesh; ///< \see SetLinkSphereTrees
+    dReal _fspheremargin; ///< \see SetLinkSphereTrees
+    bool _bShareMeshes; ///< \see SetMeshSharing
     //SynchronizeCallbackFn _synccallback;
 
     std::string _bvhRepresentation;
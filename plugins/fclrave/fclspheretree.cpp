@@ -0,0 +1,164 @@
+#include "fclspheretree.h"
+#include "fclgeometrylod.h"
+
+#include <cmath>
+
+namespace fclrave {
+
+void LinkSphereTree::Reset()
+{
+    _vlocalspheres.resize(0);
+    _rootradius = -1;
+    _bUnbounded = false;
+    _vx.resize(0);
+    _vy.resize(0);
+    _vz.resize(0);
+    _vr.resize(0);
+}
+
+void LinkSphereTree::AddGeometry(const KinBody::GeometryInfo& info, const OpenRAVE::AABB& ablocal, int numspheres)
+{
+    switch(info._type) {
+    case OpenRAVE::GT_Sphere: {
+        Vector vsphere = info._t.trans;
+        vsphere.w = info._vGeomData.x;
+        _vlocalspheres.push_back(vsphere);
+        return;
+    }
+    case OpenRAVE::GT_ConicalFrustum:
+    case OpenRAVE::GT_Axial:
+    case OpenRAVE::GT_TriMesh: {
+        // fcl checks exactly these triangles, so spheres containing them are conservative
+        std::vector<Vector> vspheres;
+        GeometryLODGenerator::ComputeBoundingSpheres(info._meshcollision, numspheres, vspheres);
+        if( vspheres.size() > 0 ) {
+            FOREACHC(itsphere, vspheres) {
+                Vector vsphere = info._t * Vector(itsphere->x, itsphere->y, itsphere->z);
+                vsphere.w = itsphere->w;
+                _vlocalspheres.push_back(vsphere);
+            }
+            return;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    // the tessellation of the other primitives does not contain them, so bound the aabb instead
+    const dReal fradius = OpenRAVE::RaveSqrt(ablocal.extents.lengthsqr3());
+    if( !std::isfinite(fradius) || !std::isfinite(ablocal.pos.lengthsqr3()) ) {
+        _bUnbounded = true;
+        return;
+    }
+    Vector vsphere = ablocal.pos;
+    vsphere.w = fradius;
+    _vlocalspheres.push_back(vsphere);
+}
+
+void LinkSphereTree::Finalize(dReal fmargin)
+{
+    if( _bUnbounded || _vlocalspheres.size() == 0 ) {
+        _vlocalspheres.resize(0);
+        _rootradius = -1;
+        return;
+    }
+
+    Vector vmin = _vlocalspheres[0], vmax = _vlocalspheres[0];
+    FOREACH(itsphere, _vlocalspheres) {
+        itsphere->w += fmargin;
+        for(int j = 0; j < 3; ++j) {
+            vmin[j] = std::min(vmin[j], (*itsphere)[j] - itsphere->w);
+            vmax[j] = std::max(vmax[j], (*itsphere)[j] + itsphere->w);
+        }
+    }
+    _localroot = 0.5*(vmin + vmax);
+    _localroot.w = 0;
+    _rootradius = 0;
+    FOREACHC(itsphere, _vlocalspheres) {
+        const Vector vdelta = *itsphere - _localroot;
+        _rootradius = std::max(_rootradius, OpenRAVE::RaveSqrt(vdelta.lengthsqr3()) + itsphere->w);
+    }
+
+    _vx.resize(_vlocalspheres.size());
+    _vy.resize(_vlocalspheres.size());
+    _vz.resize(_vlocalspheres.size());
+    _vr.resize(_vlocalspheres.size());
+    for(size_t i = 0; i < _vlocalspheres.size(); ++i) {
+        _vr[i] = _vlocalspheres[i].w;
+    }
+    SetTransform(Transform());
+}
+
+void LinkSphereTree::SetTransform(const Transform& tlink)
+{
+    if( !IsValid() ) {
+        return;
+    }
+    _worldroot = tlink * _localroot;
+    for(size_t i = 0; i < _vlocalspheres.size(); ++i) {
+        const Vector v = tlink * _vlocalspheres[i];
+        _vx[i] = v.x;
+        _vy[i] = v.y;
+        _vz[i] = v.z;
+    }
+}
+
+bool LinkSphereTree::Overlaps(const LinkSphereTree& other) const
+{
+    if( !IsValid() || !other.IsValid() ) {
+        return true; // cannot screen
+    }
+    const Vector vrootdelta = _worldroot - other._worldroot;
+    const dReal frootradius = _rootradius + other._rootradius;
+    if( vrootdelta.lengthsqr3() > frootradius*frootradius ) {
+        return false;
+    }
+
+    const size_t numother = other._vr.size();
+    const dReal* px = &other._vx[0];
+    const dReal* py = &other._vy[0];
+    const dReal* pz = &other._vz[0];
+    const dReal* pr = &other._vr[0];
+    for(size_t i = 0; i < _vr.size(); ++i) {
+        const dReal x = _vx[i], y = _vy[i], z = _vz[i], r = _vr[i];
+        // no early exit inside the loop so that it can be vectorized
+        int noverlaps = 0;
+        for(size_t j = 0; j < numother; ++j) {
+            const dReal dx = px[j] - x, dy = py[j] - y, dz = pz[j] - z, sumr = pr[j] + r;
+            noverlaps += dx*dx + dy*dy + dz*dz <= sumr*sumr;
+        }
+        if( noverlaps > 0 ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LinkSphereTree::Overlaps(const fcl::AABB& ab) const
+{
+    if( !IsValid() ) {
+        return true;
+    }
+    const dReal minx = ab.min_[0], miny = ab.min_[1], minz = ab.min_[2];
+    const dReal maxx = ab.max_[0], maxy = ab.max_[1], maxz = ab.max_[2];
+    {
+        const dReal dx = std::max(minx - _worldroot.x, std::max(dReal(0), _worldroot.x - maxx));
+        const dReal dy = std::max(miny - _worldroot.y, std::max(dReal(0), _worldroot.y - maxy));
+        const dReal dz = std::max(minz - _worldroot.z, std::max(dReal(0), _worldroot.z - maxz));
+        if( dx*dx + dy*dy + dz*dz > _rootradius*_rootradius ) {
+            return false;
+        }
+    }
+
+    int noverlaps = 0;
+    for(size_t i = 0; i < _vr.size(); ++i) {
+        const dReal dx = std::max(minx - _vx[i], std::max(dReal(0), _vx[i] - maxx));
+        const dReal dy = std::max(miny - _vy[i], std::max(dReal(0), _vy[i] - maxy));
+        const dReal dz = std::max(minz - _vz[i], std::max(dReal(0), _vz[i] - maxz));
+        noverlaps += dx*dx + dy*dy + dz*dz <= _vr[i]*_vr[i];
+    }
+    return noverlaps > 0;
+}
+
+} // fclrave
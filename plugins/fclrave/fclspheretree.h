@@ -0,0 +1,66 @@
+// -*- coding: utf-8 -*-
+#ifndef OPENRAVE_FCL_SPHERETREE
+#define OPENRAVE_FCL_SPHERETREE
+
+#include "plugindefs.h"
+
+namespace fclrave {
+
+using OpenRAVE::dReal;
+
+/// \brief conservative sphere approximation of the geometries of a link, used to screen out pairs before calling fcl.
+///
+/// The tree has two levels: one root sphere containing all the leaf spheres, and the leaf spheres whose union contains all the geometries of the link.
+/// Mesh geometries get the spheres of GeometryLODGenerator::ComputeBoundingSpheres, sphere geometries are used as they are, and all other geometries are bounded by the sphere around their AABB.
+/// All spheres are inflated by a margin, so that two links whose trees do not overlap cannot be in collision.
+///
+/// The world coordinates of the spheres are stored as a structure of arrays so that the overlap loops can be vectorized by the compiler.
+class LinkSphereTree
+{
+public:
+    LinkSphereTree() : _rootradius(-1), _bUnbounded(false) {
+    }
+
+    void Reset();
+
+    /// \brief adds the spheres of one geometry
+    ///
+    /// \param info the geometry info, its _meshcollision is used when not empty
+    /// \param ablocal the aabb of the geometry in the link coordinate system, used for geometries without a mesh
+    /// \param numspheres the maximum number of spheres for a mesh
+    void AddGeometry(const KinBody::GeometryInfo& info, const OpenRAVE::AABB& ablocal, int numspheres);
+
+    /// \brief inflates all the spheres by fmargin and computes the root sphere. Has to be called after all the geometries are added.
+    void Finalize(dReal fmargin);
+
+    /// \brief updates the world coordinates of the spheres from the link transform
+    void SetTransform(const Transform& tlink);
+
+    /// \brief true if the tree has spheres. Links without spheres cannot be screened.
+    inline bool IsValid() const {
+        return _rootradius >= 0;
+    }
+
+    inline size_t GetNumSpheres() const {
+        return _vlocalspheres.size();
+    }
+
+    /// \brief returns true if any sphere of this tree overlaps any sphere of the other tree
+    bool Overlaps(const LinkSphereTree& other) const;
+
+    /// \brief returns true if any sphere of this tree overlaps the world aabb
+    bool Overlaps(const fcl::AABB& ab) const;
+
+private:
+    std::vector<Vector> _vlocalspheres; ///< leaf spheres in the link coordinate system, w is the radius
+    Vector _localroot; ///< center of the root sphere in the link coordinate system
+    dReal _rootradius; ///< radius of the root sphere, negative if the tree has no spheres
+    bool _bUnbounded; ///< true if one of the geometries could not be bounded, in which case the tree is not valid
+
+    Vector _worldroot; ///< center of the root sphere in world coordinates
+    std::vector<dReal> _vx, _vy, _vz, _vr; ///< leaf spheres in world coordinates
+};
+
+} // fclrave
+
+#endif
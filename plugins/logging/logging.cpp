@@ -18,6 +18,7 @@
 #include "logging.h"
 #include "plugindefs.h"
 
+OpenRAVE::ModuleBasePtr CreateStateJournal(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
 #ifdef ENABLE_VIDEORECORDING
 OpenRAVE::ModuleBasePtr CreateViewerRecorder(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
 void DestroyViewerRecordingStaticResources();
@@ -27,6 +28,7 @@ const std::string LoggingPlugin::_pluginname = "LoggingPlugin";
 
 LoggingPlugin::LoggingPlugin()
 {
+    _interfaces[OpenRAVE::PT_Module].push_back("StateJournal");
 #ifdef ENABLE_VIDEORECORDING
     _interfaces[OpenRAVE::PT_Module].push_back("ViewerRecorder");
 #endif
@@ -48,6 +50,9 @@ OpenRAVE::InterfaceBasePtr LoggingPlugin::CreateInterface(OpenRAVE::InterfaceTyp
 {
     switch(type) {
     case OpenRAVE::PT_Module:
+        if( interfacename == "statejournal" ) {
+            return CreateStateJournal(penv,sinput);
+        }
 #ifdef ENABLE_VIDEORECORDING
         if( interfacename == "viewerrecorder" ) {
             return CreateViewerRecorder(penv,sinput);
@@ -0,0 +1,742 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "plugindefs.h"
+
+#include <openrave/openravejson.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+/// \brief records the state of the environment into a binary journal and replays it.
+///
+/// The journal starts with the full EnvironmentBaseInfo of the scene serialized as JSON. After that, only the dynamic state
+/// of the bodies is stored: transforms, dof values, link enable states and grabbed bodies. Every keyframe period a state
+/// keyframe with all the bodies is written, in between only the bodies whose update stamp changed are written with the fields
+/// that actually changed. If bodies are added or removed, a new EnvironmentBaseInfo is written.
+///
+/// File layout::
+///
+///   header: "ORSJ" uint32 version
+///   record: uint8 type, uint64 timestamp (us), uint32 payload size, payload
+///
+/// All numbers are little endian as written by the host, all real values are stored as double.
+class StateJournal : public ModuleBase
+{
+    enum JournalRecordType
+    {
+        JRT_EnvironmentInfo = 0, ///< uint32 json size, json of EnvironmentBaseInfo, uint32 number of bodies, body names. The order of the names defines the body indices used by the other records.
+        JRT_KeyFrame = 1, ///< state of every body
+        JRT_Delta = 2, ///< state of the bodies that changed since the previous record
+    };
+
+    enum BodyStateField
+    {
+        BSF_Transform = 1,
+        BSF_DOFValues = 2,
+        BSF_LinkEnable = 4,
+        BSF_Grabbed = 8,
+        BSF_All = 15,
+    };
+
+    /// \brief the last recorded or replayed state of a body
+    struct BodyState
+    {
+        BodyState() : updatestamp(-1), environmentbodyindex(0) {
+        }
+        std::string name;
+        int updatestamp;
+        int environmentbodyindex;
+        Transform t;
+        std::vector<dReal> vdofvalues;
+        std::vector<uint8_t> vlinkenablestates;
+        std::vector<KinBody::GrabbedInfoPtr> vgrabbedinfos;
+    };
+
+    /// \brief location of a record inside the journal file
+    struct RecordIndex
+    {
+        RecordIndex() : type(0), timestamp(0), offset(0), size(0) {
+        }
+        uint8_t type;
+        uint64_t timestamp;
+        std::streamoff offset; ///< offset of the payload
+        uint32_t size;
+    };
+
+    /// \brief reads binary values from a record payload
+    class PayloadReader
+    {
+public:
+        PayloadReader(const std::vector<uint8_t>& vdata) : _vdata(vdata), _offset(0) {
+        }
+
+        template <typename T>
+        T Read()
+        {
+            T value;
+            _Check(sizeof(T));
+            memcpy(&value, &_vdata[_offset], sizeof(T));
+            _offset += sizeof(T);
+            return value;
+        }
+
+        std::string ReadString()
+        {
+            uint32_t size = Read<uint32_t>();
+            _Check(size);
+            std::string s(_vdata.begin()+_offset, _vdata.begin()+_offset+size);
+            _offset += size;
+            return s;
+        }
+
+        Transform ReadTransform()
+        {
+            Transform t;
+            for(int i = 0; i < 4; ++i) {
+                t.rot[i] = Read<double>();
+            }
+            for(int i = 0; i < 3; ++i) {
+                t.trans[i] = Read<double>();
+            }
+            return t;
+        }
+
+private:
+        void _Check(size_t size) const
+        {
+            if( _offset+size > _vdata.size() ) {
+                throw OPENRAVE_EXCEPTION_FORMAT("journal record is truncated, need %d bytes at offset %d of %d", size%_offset%_vdata.size(), ORE_InvalidArguments);
+            }
+        }
+
+        const std::vector<uint8_t>& _vdata;
+        size_t _offset;
+    };
+
+public:
+    StateJournal(EnvironmentBasePtr penv, std::istream& sinput) : ModuleBase(penv)
+    {
+        __description = ":Interface Author: Rosen Diankov\n\nRecords the environment state into a compact binary journal for post-mortem debugging and replays it. The full environment info is written once, after that only the transforms, dof values, enable states and grabbed bodies of the bodies whose update stamp changed are written. State keyframes are written periodically so that any timestamp can be restored quickly.";
+        RegisterCommand("Start",boost::bind(&StateJournal::_StartCommand,this,_1,_2),
+                        "Starts recording into a file, overwriting any previous file stored in this location. Format::\n\n  Start [rate] keyframeperiod [seconds] timing [simtime/realtime/manual]\\n filename [filename]\\n\n\nrate is the number of frames recorded per second by the recording thread. If timing is manual, no thread is started and frames are only recorded with the Capture command.");
+        RegisterCommand("Stop",boost::bind(&StateJournal::_StopCommand,this,_1,_2),
+                        "Stops recording and closes the file.");
+        RegisterCommand("Capture",boost::bind(&StateJournal::_CaptureCommand,this,_1,_2),
+                        "Records one frame now. Format::\n\n  Capture [timestamp]\n\nIf the timestamp (us) is not specified, the current time is used.");
+        RegisterCommand("GetStatistics",boost::bind(&StateJournal::_GetStatisticsCommand,this,_1,_2),
+                        "Returns the recording statistics: [frames] [keyframes] [bytes written] [total capture time in us]");
+        RegisterCommand("Open",boost::bind(&StateJournal::_OpenCommand,this,_1,_2),
+                        "Opens a journal for replay and indexes its records. Format::\n\n  Open [filename]");
+        RegisterCommand("GetTimeRange",boost::bind(&StateJournal::_GetTimeRangeCommand,this,_1,_2),
+                        "Returns the first and last timestamps (us) of the opened journal");
+        RegisterCommand("Seek",boost::bind(&StateJournal::_SeekCommand,this,_1,_2),
+                        "Restores the environment to the last recorded state at or before the timestamp (us). Format::\n\n  Seek [timestamp]");
+        _nTiming = 0;
+        _fRate = 100;
+        _nKeyFramePeriod = 1000000;
+        _nLastKeyFrameTime = 0;
+        _bRecording = false;
+        _bContinueThread = false;
+        _nNumFrames = _nNumKeyFrames = _nBytesWritten = _nCaptureTime = 0;
+        _nReplayEnvironmentInfo = -1;
+        _nReplayRecord = -1;
+    }
+
+    virtual ~StateJournal()
+    {
+        _Reset();
+    }
+
+    virtual void Destroy()
+    {
+        _Reset();
+        _CloseReplay();
+    }
+
+protected:
+    bool _StartCommand(ostream& sout, istream& sinput)
+    {
+        _Reset();
+        std::string filename;
+        dReal fKeyFramePeriod = 1;
+        sinput >> _fRate;
+        string cmd;
+        while(!sinput.eof()) {
+            sinput >> cmd;
+            if( !sinput ) {
+                break;
+            }
+            std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+            if( cmd == "keyframeperiod" ) {
+                sinput >> fKeyFramePeriod;
+            }
+            else if( cmd == "timing" ) {
+                string type;
+                sinput >> type;
+                if( type == "realtime" ) {
+                    _nTiming = 0;
+                }
+                else if( type == "simtime" ) {
+                    _nTiming = 1;
+                }
+                else if( type == "manual" ) {
+                    _nTiming = 2;
+                }
+                else {
+                    RAVELOG_WARN_FORMAT("unknown timing %s", type);
+                }
+            }
+            else if( cmd == "filename" ) {
+                if( !getline(sinput, filename) ) {
+                    return false;
+                }
+                boost::trim(filename);
+            }
+            else {
+                RAVELOG_WARN_FORMAT("unrecognized command: %s", cmd);
+                return false;
+            }
+            if( sinput.fail() || !sinput ) {
+                break;
+            }
+        }
+        if( filename.size() == 0 || _fRate <= 0 ) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _ofile.open(filename.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
+        if( !_ofile ) {
+            RAVELOG_WARN_FORMAT("failed to open %s for writing", filename);
+            return false;
+        }
+        _ofile.write("ORSJ", 4);
+        uint32_t version = 1;
+        _ofile.write((const char*)&version, sizeof(version));
+        _nNumFrames = _nNumKeyFrames = _nCaptureTime = 0;
+        _nBytesWritten = 4 + sizeof(version);
+        _nLastKeyFrameTime = 0;
+        _nKeyFramePeriod = (uint64_t)(1000000*fKeyFramePeriod);
+        _vbodystates.clear();
+        _bRecording = true;
+        RAVELOG_INFO_FORMAT("recording state journal %s at %f frames/sec", filename%_fRate);
+        if( _nTiming != 2 ) {
+            _bContinueThread = true;
+            _threadrecord = boost::make_shared<std::thread>(std::bind(&StateJournal::_RecordThread, this));
+        }
+        return true;
+    }
+
+    bool _StopCommand(ostream& sout, istream& sinput)
+    {
+        _Reset();
+        return true;
+    }
+
+    bool _CaptureCommand(ostream& sout, istream& sinput)
+    {
+        uint64_t timestamp = _GetTime();
+        sinput >> timestamp;
+        EnvironmentLock lockenv(GetEnv()->GetMutex());
+        std::lock_guard<std::mutex> lock(_mutex);
+        if( !_bRecording ) {
+            return false;
+        }
+        _CaptureFrame(timestamp);
+        return true;
+    }
+
+    bool _GetStatisticsCommand(ostream& sout, istream& sinput)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        sout << _nNumFrames << " " << _nNumKeyFrames << " " << _nBytesWritten << " " << _nCaptureTime;
+        return true;
+    }
+
+    uint64_t _GetTime()
+    {
+        return _nTiming == 1 ? GetEnv()->GetSimulationTime() : utils::GetMicroTime();
+    }
+
+    void _Reset()
+    {
+        if( !!_threadrecord ) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _bContinueThread = false;
+                _condstop.notify_all();
+            }
+            _threadrecord->join();
+            _threadrecord.reset();
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        if( _bRecording ) {
+            _ofile.close();
+            _bRecording = false;
+            RAVELOG_DEBUG_FORMAT("state journal stopped: %d frames, %d keyframes, %d bytes", _nNumFrames%_nNumKeyFrames%_nBytesWritten);
+        }
+    }
+
+    void _RecordThread()
+    {
+        const uint64_t periodus = (uint64_t)(1000000/_fRate);
+        uint64_t nexttime = utils::GetMicroTime();
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if( !_bContinueThread ) {
+                    break;
+                }
+                uint64_t curtime = utils::GetMicroTime();
+                if( curtime < nexttime ) {
+                    _condstop.wait_for(lock, std::chrono::microseconds(nexttime-curtime));
+                    continue;
+                }
+            }
+            nexttime += periodus;
+            // do not stall the environment, drop the frame if the lock cannot be acquired within a period
+            EnvironmentLock lockenv(GetEnv()->GetMutex(), OpenRAVE::defer_lock_t());
+            uint64_t basetime = utils::GetMicroTime();
+            while( !lockenv && utils::GetMicroTime()-basetime < periodus ) {
+                if( !lockenv.try_lock() ) {
+                    std::this_thread::yield();
+                }
+            }
+            if( !lockenv ) {
+                RAVELOG_VERBOSE("state journal could not lock the environment, dropping frame\n");
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            if( !_bRecording ) {
+                break;
+            }
+            try {
+                _CaptureFrame(_GetTime());
+            }
+            catch(const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("failed to record state journal frame: %s", ex.what());
+            }
+        }
+    }
+
+    /// \brief records one frame, environment and _mutex have to be locked
+    void _CaptureFrame(uint64_t timestamp)
+    {
+        uint64_t starttime = utils::GetMicroTime();
+        GetEnv()->GetBodies(_vbodies);
+        bool bBodiesChanged = _vbodies.size() != _vbodystates.size();
+        for(size_t ibody = 0; ibody < _vbodies.size() && !bBodiesChanged; ++ibody) {
+            bBodiesChanged = _vbodies[ibody]->GetEnvironmentBodyIndex() != _vbodystates[ibody].environmentbodyindex || _vbodies[ibody]->GetName() != _vbodystates[ibody].name;
+        }
+
+        bool bKeyFrame = bBodiesChanged || timestamp >= _nLastKeyFrameTime + _nKeyFramePeriod || timestamp < _nLastKeyFrameTime;
+        if( bBodiesChanged ) {
+            _vbodystates.resize(_vbodies.size());
+            for(size_t ibody = 0; ibody < _vbodies.size(); ++ibody) {
+                _vbodystates[ibody] = BodyState();
+                _vbodystates[ibody].name = _vbodies[ibody]->GetName();
+                _vbodystates[ibody].environmentbodyindex = _vbodies[ibody]->GetEnvironmentBodyIndex();
+            }
+            _WriteEnvironmentInfo(timestamp);
+        }
+
+        _vpayload.resize(0);
+        _WriteValue<uint32_t>(0); // number of bodies, filled at the end
+        uint32_t numbodies = 0;
+        for(size_t ibody = 0; ibody < _vbodies.size(); ++ibody) {
+            const KinBody& body = *_vbodies[ibody];
+            BodyState& state = _vbodystates[ibody];
+            if( !bKeyFrame && body.GetUpdateStamp() == state.updatestamp ) {
+                continue;
+            }
+            state.updatestamp = body.GetUpdateStamp();
+
+            uint8_t fields = bKeyFrame ? BSF_All : 0;
+            Transform t = body.GetTransform();
+            if( t != state.t ) {
+                state.t = t;
+                fields |= BSF_Transform;
+            }
+            body.GetDOFValues(_vdofvalues);
+            if( _vdofvalues != state.vdofvalues ) {
+                state.vdofvalues.swap(_vdofvalues);
+                fields |= BSF_DOFValues;
+            }
+            body.GetLinkEnableStates(_vlinkenablestates);
+            if( _vlinkenablestates != state.vlinkenablestates ) {
+                state.vlinkenablestates.swap(_vlinkenablestates);
+                fields |= BSF_LinkEnable;
+            }
+            if( body.GetNumGrabbed() > 0 || state.vgrabbedinfos.size() > 0 ) {
+                std::vector<KinBody::GrabbedInfoPtr> vgrabbedinfos;
+                body.GetGrabbedInfo(vgrabbedinfos);
+                bool bGrabbedChanged = vgrabbedinfos.size() != state.vgrabbedinfos.size();
+                for(size_t igrabbed = 0; igrabbed < vgrabbedinfos.size() && !bGrabbedChanged; ++igrabbed) {
+                    bGrabbedChanged = *vgrabbedinfos[igrabbed] != *state.vgrabbedinfos[igrabbed];
+                }
+                if( bGrabbedChanged ) {
+                    state.vgrabbedinfos.swap(vgrabbedinfos);
+                    fields |= BSF_Grabbed;
+                }
+            }
+            if( fields == 0 ) {
+                continue;
+            }
+
+            _WriteValue<uint32_t>(ibody);
+            _WriteValue<uint8_t>(fields);
+            if( fields & BSF_Transform ) {
+                _WriteTransform(state.t);
+            }
+            if( fields & BSF_DOFValues ) {
+                _WriteValue<uint32_t>(state.vdofvalues.size());
+                FOREACHC(itvalue, state.vdofvalues) {
+                    _WriteValue<double>(*itvalue);
+                }
+            }
+            if( fields & BSF_LinkEnable ) {
+                _WriteValue<uint32_t>(state.vlinkenablestates.size());
+                _vpayload.insert(_vpayload.end(), state.vlinkenablestates.begin(), state.vlinkenablestates.end());
+            }
+            if( fields & BSF_Grabbed ) {
+                _WriteValue<uint32_t>(state.vgrabbedinfos.size());
+                FOREACHC(itgrabbed, state.vgrabbedinfos) {
+                    _WriteString((*itgrabbed)->_grabbedname);
+                    _WriteString((*itgrabbed)->_robotlinkname);
+                    _WriteTransform((*itgrabbed)->_trelative);
+                    _WriteValue<uint32_t>((*itgrabbed)->_setIgnoreRobotLinkNames.size());
+                    FOREACHC(itname, (*itgrabbed)->_setIgnoreRobotLinkNames) {
+                        _WriteString(*itname);
+                    }
+                }
+            }
+            ++numbodies;
+        }
+
+        if( bKeyFrame || numbodies > 0 ) {
+            memcpy(&_vpayload[0], &numbodies, sizeof(numbodies));
+            _WriteRecord(bKeyFrame ? JRT_KeyFrame : JRT_Delta, timestamp);
+            if( bKeyFrame ) {
+                _nLastKeyFrameTime = timestamp;
+                ++_nNumKeyFrames;
+            }
+        }
+        _vbodies.clear(); // do not keep removed bodies alive
+        ++_nNumFrames;
+        _nCaptureTime += utils::GetMicroTime() - starttime;
+    }
+
+    void _WriteEnvironmentInfo(uint64_t timestamp)
+    {
+        EnvironmentBase::EnvironmentBaseInfo info;
+        GetEnv()->ExtractInfo(info);
+        rapidjson::Document rEnvInfo;
+        info.SerializeJSON(rEnvInfo, rEnvInfo.GetAllocator(), 1.0);
+        _vpayload.resize(0);
+        _WriteString(orjson::DumpJson(rEnvInfo));
+        _WriteValue<uint32_t>(_vbodystates.size());
+        FOREACHC(itstate, _vbodystates) {
+            _WriteString(itstate->name);
+        }
+        _WriteRecord(JRT_EnvironmentInfo, timestamp);
+    }
+
+    template <typename T>
+    void _WriteValue(T value)
+    {
+        size_t offset = _vpayload.size();
+        _vpayload.resize(offset+sizeof(T));
+        memcpy(&_vpayload[offset], &value, sizeof(T));
+    }
+
+    void _WriteString(const std::string& s)
+    {
+        _WriteValue<uint32_t>(s.size());
+        _vpayload.insert(_vpayload.end(), s.begin(), s.end());
+    }
+
+    void _WriteTransform(const Transform& t)
+    {
+        for(int i = 0; i < 4; ++i) {
+            _WriteValue<double>(t.rot[i]);
+        }
+        for(int i = 0; i < 3; ++i) {
+            _WriteValue<double>(t.trans[i]);
+        }
+    }
+
+    void _WriteRecord(uint8_t type, uint64_t timestamp)
+    {
+        uint32_t size = _vpayload.size();
+        _ofile.write((const char*)&type, sizeof(type));
+        _ofile.write((const char*)&timestamp, sizeof(timestamp));
+        _ofile.write((const char*)&size, sizeof(size));
+        _ofile.write((const char*)&_vpayload[0], size);
+        _nBytesWritten += sizeof(type) + sizeof(timestamp) + sizeof(size) + size;
+    }
+
+    bool _OpenCommand(ostream& sout, istream& sinput)
+    {
+        std::string filename;
+        if( !getline(sinput, filename) ) {
+            return false;
+        }
+        boost::trim(filename);
+        _CloseReplay();
+        _ifile.open(filename.c_str(), std::ios::in|std::ios::binary);
+        if( !_ifile ) {
+            RAVELOG_WARN_FORMAT("failed to open %s", filename);
+            return false;
+        }
+        char magic[4];
+        uint32_t version = 0;
+        _ifile.read(magic, 4);
+        _ifile.read((char*)&version, sizeof(version));
+        if( !_ifile || strncmp(magic, "ORSJ", 4) != 0 || version != 1 ) {
+            RAVELOG_WARN_FORMAT("%s is not a state journal", filename);
+            _CloseReplay();
+            return false;
+        }
+
+        // only read the record headers, the payloads are read when seeking
+        while(true) {
+            RecordIndex record;
+            _ifile.read((char*)&record.type, sizeof(record.type));
+            _ifile.read((char*)&record.timestamp, sizeof(record.timestamp));
+            _ifile.read((char*)&record.size, sizeof(record.size));
+            if( !_ifile ) {
+                break;
+            }
+            record.offset = _ifile.tellg();
+            _ifile.seekg(record.size, std::ios::cur);
+            if( !_ifile ) {
+                RAVELOG_WARN_FORMAT("%s has a truncated record at the end, ignoring it", filename);
+                break;
+            }
+            _vrecords.push_back(record);
+        }
+        _ifile.clear();
+        if( _vrecords.size() == 0 || _vrecords[0].type != JRT_EnvironmentInfo ) {
+            RAVELOG_WARN_FORMAT("%s does not start with the environment info", filename);
+            _CloseReplay();
+            return false;
+        }
+        return true;
+    }
+
+    bool _GetTimeRangeCommand(ostream& sout, istream& sinput)
+    {
+        if( _vrecords.size() == 0 ) {
+            return false;
+        }
+        sout << _vrecords.front().timestamp << " " << _vrecords.back().timestamp;
+        return true;
+    }
+
+    bool _SeekCommand(ostream& sout, istream& sinput)
+    {
+        uint64_t timestamp = 0;
+        sinput >> timestamp;
+        if( !sinput || _vrecords.size() == 0 ) {
+            return false;
+        }
+
+        // the last record at or before timestamp
+        int irecord = -1;
+        for(int i = (int)_vrecords.size()-1; i >= 0; --i) {
+            if( _vrecords[i].timestamp <= timestamp ) {
+                irecord = i;
+                break;
+            }
+        }
+        if( irecord < 0 ) {
+            RAVELOG_WARN_FORMAT("timestamp %d is before the start of the journal %d", timestamp%_vrecords[0].timestamp);
+            return false;
+        }
+        // environment info records are always followed by a keyframe at the same timestamp
+        while(irecord+1 < (int)_vrecords.size() && _vrecords[irecord+1].timestamp == _vrecords[irecord].timestamp ) {
+            ++irecord;
+        }
+        int ikeyframe = irecord;
+        while(ikeyframe > 0 && _vrecords[ikeyframe].type != JRT_KeyFrame) {
+            --ikeyframe;
+        }
+        int ienvinfo = ikeyframe;
+        while(ienvinfo > 0 && _vrecords[ienvinfo].type != JRT_EnvironmentInfo) {
+            --ienvinfo;
+        }
+
+        EnvironmentLock lockenv(GetEnv()->GetMutex());
+        int istart = ikeyframe;
+        if( ienvinfo != _nReplayEnvironmentInfo ) {
+            _ApplyEnvironmentInfo(_vrecords[ienvinfo]);
+            _nReplayEnvironmentInfo = ienvinfo;
+        }
+        else if( _nReplayRecord >= ikeyframe && _nReplayRecord <= irecord ) {
+            // playing forward, continue from the last applied record
+            istart = _nReplayRecord+1;
+        }
+        for(int i = istart; i <= irecord; ++i) {
+            if( _vrecords[i].type != JRT_EnvironmentInfo ) {
+                _ApplyState(_vrecords[i]);
+            }
+        }
+        _nReplayRecord = irecord;
+        sout << _vrecords[irecord].timestamp;
+        return true;
+    }
+
+    void _ReadPayload(const RecordIndex& record, std::vector<uint8_t>& vdata)
+    {
+        vdata.resize(record.size);
+        _ifile.seekg(record.offset);
+        if( record.size > 0 ) {
+            _ifile.read((char*)&vdata[0], record.size);
+        }
+        if( !_ifile ) {
+            _ifile.clear();
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to read journal record at %d", (uint64_t)record.offset, ORE_InvalidArguments);
+        }
+    }
+
+    void _ApplyEnvironmentInfo(const RecordIndex& record)
+    {
+        _ReadPayload(record, _vreplaypayload);
+        PayloadReader reader(_vreplaypayload);
+        rapidjson::Document rEnvInfo;
+        orjson::ParseJson(rEnvInfo, reader.ReadString());
+        EnvironmentBase::EnvironmentBaseInfo info;
+        info.DeserializeJSON(rEnvInfo, 1.0, 0);
+        std::vector<KinBodyPtr> vCreatedBodies, vModifiedBodies, vRemovedBodies;
+        GetEnv()->UpdateFromInfo(info, vCreatedBodies, vModifiedBodies, vRemovedBodies, UFIM_Exact);
+
+        uint32_t numbodies = reader.Read<uint32_t>();
+        _vreplaybodies.resize(numbodies);
+        for(uint32_t ibody = 0; ibody < numbodies; ++ibody) {
+            std::string name = reader.ReadString();
+            _vreplaybodies[ibody] = GetEnv()->GetKinBody(name);
+            if( !_vreplaybodies[ibody] ) {
+                RAVELOG_WARN_FORMAT("journal body %s was not restored", name);
+            }
+        }
+    }
+
+    void _ApplyState(const RecordIndex& record)
+    {
+        _ReadPayload(record, _vreplaypayload);
+        PayloadReader reader(_vreplaypayload);
+        uint32_t numbodies = reader.Read<uint32_t>();
+        std::vector<dReal> vdofvalues;
+        std::vector<uint8_t> vlinkenablestates;
+        for(uint32_t i = 0; i < numbodies; ++i) {
+            uint32_t ibody = reader.Read<uint32_t>();
+            uint8_t fields = reader.Read<uint8_t>();
+            KinBodyPtr pbody = ibody < _vreplaybodies.size() ? _vreplaybodies[ibody] : KinBodyPtr();
+
+            Transform t;
+            bool bSetTransform = false, bSetDOFValues = false;
+            if( fields & BSF_Transform ) {
+                t = reader.ReadTransform();
+                bSetTransform = true;
+            }
+            if( fields & BSF_DOFValues ) {
+                vdofvalues.resize(reader.Read<uint32_t>());
+                FOREACH(itvalue, vdofvalues) {
+                    *itvalue = reader.Read<double>();
+                }
+                bSetDOFValues = true;
+            }
+            if( !!pbody ) {
+                if( bSetDOFValues && (int)vdofvalues.size() == pbody->GetDOF() ) {
+                    pbody->SetDOFValues(vdofvalues, bSetTransform ? t : pbody->GetTransform(), KinBody::CLA_Nothing);
+                }
+                else if( bSetTransform ) {
+                    pbody->SetTransform(t);
+                }
+            }
+            if( fields & BSF_LinkEnable ) {
+                vlinkenablestates.resize(reader.Read<uint32_t>());
+                FOREACH(itstate, vlinkenablestates) {
+                    *itstate = reader.Read<uint8_t>();
+                }
+                if( !!pbody && vlinkenablestates.size() == pbody->GetLinks().size() ) {
+                    pbody->SetLinkEnableStates(vlinkenablestates);
+                }
+            }
+            if( fields & BSF_Grabbed ) {
+                std::vector<KinBody::GrabbedInfoConstPtr> vgrabbedinfos(reader.Read<uint32_t>());
+                FOREACH(itgrabbed, vgrabbedinfos) {
+                    KinBody::GrabbedInfoPtr pgrabbed(new KinBody::GrabbedInfo());
+                    pgrabbed->_grabbedname = reader.ReadString();
+                    pgrabbed->_robotlinkname = reader.ReadString();
+                    pgrabbed->_trelative = reader.ReadTransform();
+                    uint32_t numignore = reader.Read<uint32_t>();
+                    for(uint32_t iignore = 0; iignore < numignore; ++iignore) {
+                        pgrabbed->_setIgnoreRobotLinkNames.insert(reader.ReadString());
+                    }
+                    *itgrabbed = pgrabbed;
+                }
+                if( !!pbody ) {
+                    pbody->ResetGrabbed(vgrabbedinfos);
+                }
+            }
+        }
+    }
+
+    void _CloseReplay()
+    {
+        if( _ifile.is_open() ) {
+            _ifile.close();
+        }
+        _ifile.clear();
+        _vrecords.clear();
+        _vreplaybodies.clear();
+        _nReplayEnvironmentInfo = -1;
+        _nReplayRecord = -1;
+    }
+
+    // recording
+    std::mutex _mutex; ///< protects the recording file and the cached body states
+    std::condition_variable _condstop;
+    boost::shared_ptr<std::thread> _threadrecord;
+    bool _bRecording, _bContinueThread;
+    int _nTiming; ///< 0 for real time, 1 for simulation time, 2 for manual captures only
+    dReal _fRate; ///< frames per second of the recording thread
+    uint64_t _nKeyFramePeriod, _nLastKeyFrameTime; ///< us
+    std::ofstream _ofile;
+    std::vector<BodyState> _vbodystates; ///< last recorded state, indexed like the bodies of the last environment info record
+    uint64_t _nNumFrames, _nNumKeyFrames, _nBytesWritten, _nCaptureTime;
+
+    // replay
+    std::ifstream _ifile;
+    std::vector<RecordIndex> _vrecords;
+    std::vector<KinBodyPtr> _vreplaybodies; ///< the bodies of the applied environment info record
+    int _nReplayEnvironmentInfo, _nReplayRecord; ///< indices into _vrecords of the applied environment info and last applied record
+    std::vector<uint8_t> _vreplaypayload;
+
+    // cache
+    std::vector<KinBodyPtr> _vbodies;
+    std::vector<dReal> _vdofvalues;
+    std::vector<uint8_t> _vlinkenablestates;
+    std::vector<uint8_t> _vpayload;
+};
+
+ModuleBasePtr CreateStateJournal(EnvironmentBasePtr penv, std::istream& sinput) {
+    return ModuleBasePtr(new StateJournal(penv,sinput));
+}
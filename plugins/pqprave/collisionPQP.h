@@ -19,15 +19,28 @@
 
 #include "pqp/PQP.h"
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <limits>
 
 //wrapper class for PQP, distance and tolerance checking is _off_ by default, collision checking is _on_ by default
 class CollisionCheckerPQP : public CollisionCheckerBase
 {
 public:
+    /// \brief world axis aligned bounds used by the broadphase. Invalid (empty) when vmin.x > vmax.x
+    struct Bounds
+    {
+        Bounds() : vmin(1,1,1), vmax(-1,-1,-1) {
+        }
+        inline bool IsValid() const {
+            return vmin.x <= vmax.x;
+        }
+        Vector vmin, vmax;
+    };
+
     class KinBodyInfo : public OpenRAVE::UserData
     {
 public:
-        KinBodyInfo() : nLastStamp(0) {
+        KinBodyInfo() : nLastStamp(-1), nBroadPhaseVisit(0), nBroadPhaseVisitStamp(-1), bInBroadPhase(false) {
         }
         virtual ~KinBodyInfo() {
         }
@@ -36,7 +49,13 @@ public:
         }
         KinBodyWeakPtr _pbody;
         vector<boost::shared_ptr<PQP_Model> > vlinks;
-        int nLastStamp;
+        vector<AABB> vlocalaabbs; ///< bounds of each link collision mesh in the link frame, extents are negative if the link has no mesh
+        vector<Bounds> vlinkbounds; ///< world bounds of every link at nLastStamp
+        Bounds bodybounds; ///< union of vlinkbounds
+        int nLastStamp; ///< body update stamp that vlinkbounds were computed at
+        int nBroadPhaseVisit; ///< last broadphase update that saw this body in the environment
+        int nBroadPhaseVisitStamp; ///< nLastStamp when the body was last sorted in the broadphase
+        bool bInBroadPhase; ///< true if in _vbroadphasebodies
     };
     typedef boost::shared_ptr<KinBodyInfo> KinBodyInfoPtr;
     typedef boost::shared_ptr<KinBodyInfo const> KinBodyInfoConstPtr;
@@ -48,6 +67,7 @@ public:
         _rel_err = 200.0;     //temporary change
         _abs_err = 0.001;       //temporary change
         _tolerance = 0.0;
+        _nBroadPhaseVisit = 0;
 
         //enable or disable various features
         _benablecol = true;
@@ -79,6 +99,7 @@ public:
         FOREACHC(itbody, vbodies) {
             (*itbody)->RemoveUserData(_userdatakey);
         }
+        _vbroadphasebodies.clear();
     }
 
     virtual bool InitKinBody(KinBodyPtr pbody)
@@ -116,6 +137,19 @@ public:
                 pm->EndModel();
             }
             pinfo->vlinks.push_back(pm);
+
+            AABB ablocal;
+            ablocal.extents = Vector(-1,-1,-1);
+            if( trimesh.vertices.size() > 0 ) {
+                Vector vmin = trimesh.vertices[0], vmax = trimesh.vertices[0];
+                FOREACHC(itvertex, trimesh.vertices) {
+                    vmin.x = min(vmin.x, itvertex->x); vmin.y = min(vmin.y, itvertex->y); vmin.z = min(vmin.z, itvertex->z);
+                    vmax.x = max(vmax.x, itvertex->x); vmax.y = max(vmax.y, itvertex->y); vmax.z = max(vmax.z, itvertex->z);
+                }
+                ablocal.pos = 0.5*(vmin+vmax);
+                ablocal.extents = 0.5*(vmax-vmin);
+            }
+            pinfo->vlocalaabbs.push_back(ablocal);
         }
 
         return true;
@@ -211,9 +245,12 @@ public:
         if(!!report) {
             report->Reset(_options);
         }
-        _InitKinBody(plink1->GetParent());
-        _InitKinBody(plink2->GetParent());
+        KinBodyInfoPtr pinfo1 = _GetUpdatedInfo(plink1->GetParent());
+        KinBodyInfoPtr pinfo2 = _GetUpdatedInfo(plink2->GetParent());
         _pactiverobot.reset();
+        if( !_IsWithin(pinfo1->vlinkbounds.at(plink1->GetIndex()), pinfo2->vlinkbounds.at(plink2->GetIndex()), _GetBroadPhaseMargin(report)) ) {
+            return false;
+        }
         PQP_REAL R1[3][3], R2[3][3], T1[3], T2[3];
         GetPQPTransformFromTransform(plink1->GetTransform(),R1,T1);
         GetPQPTransformFromTransform(plink2->GetTransform(),R2,T2);
@@ -253,16 +290,24 @@ public:
 
         std::vector<KinBodyPtr> vecbodies;
         GetEnv()->GetBodies(vecbodies);
+        _UpdateBroadPhase(vecbodies);
+        KinBodyInfoPtr pinfo1 = _GetUpdatedInfo(plink->GetParent());
+        const Bounds& linkbounds = pinfo1->vlinkbounds.at(plink->GetIndex());
+        std::vector<KinBodyInfoPtr> vcandidates;
+        _QueryBroadPhase(linkbounds, _GetBroadPhaseMargin(report), vcandidates);
 
         PQP_REAL R1[3][3], R2[3][3], T1[3], T2[3];
 
         std::vector<Transform> vtrans1,vtrans2;
         plink->GetParent()->GetLinkTransformations(vtrans1);
-        FOREACH(itbody,vecbodies) {
+        FOREACH(itinfo,vcandidates) {
             if(!!report) {
                 report->numWithinTol = 0;
             }
-            KinBodyPtr pbody2 = *itbody;
+            KinBodyPtr pbody2 = (*itinfo)->GetBody();
+            if( !pbody2 ) {
+                continue;
+            }
 
             if(plink->GetParent()->IsAttached(*pbody2)) {
                 continue;
@@ -282,6 +327,9 @@ public:
                 if( find(vlinkexcluded.begin(),vlinkexcluded.end(),veclinks2[j]) != vlinkexcluded.end() ) {
                     continue;
                 }
+                if( !_IsWithin(linkbounds, (*itinfo)->vlinkbounds.at(j), _GetBroadPhaseMargin(report)) ) {
+                    continue;
+                }
                 GetPQPTransformFromTransform(vtrans2[j],R2,T2);
 
                 retval = DoPQP(plink,R1,T1,veclinks2[j],R2,T2,report);
@@ -395,6 +443,7 @@ public:
             report->Reset(_options);
         }
         _SetActiveBody(plink->GetParent());
+        KinBodyInfoPtr pinfo = _GetUpdatedInfo(pbody);
         int adjacentoptions = KinBody::AO_Enabled;
         if( (_options&OpenRAVE::CO_ActiveDOFs) && pbody->IsRobot() ) {
             adjacentoptions |= KinBody::AO_ActiveDOFs;
@@ -404,6 +453,9 @@ public:
         FOREACHC(itset, nonadjacent) {
             KinBody::LinkConstPtr plink1(pbody->GetLinks().at(*itset&0xffff)), plink2(pbody->GetLinks().at(*itset>>16));
             if( plink == plink1 || plink == plink2 ) {
+                if( !_IsWithin(pinfo->vlinkbounds.at(plink1->GetIndex()), pinfo->vlinkbounds.at(plink2->GetIndex()), _GetBroadPhaseMargin(report)) ) {
+                    continue;
+                }
                 GetPQPTransformFromTransform(plink1->GetTransform(),R1,T1);
                 GetPQPTransformFromTransform(plink2->GetTransform(),R2,T2);
                 if( DoPQP(plink1,R1,T1,plink2,R2,T2,report) ) {
@@ -437,19 +489,25 @@ private:
 
         std::vector<KinBodyPtr> vecbodies;
         GetEnv()->GetBodies(vecbodies);
+        _UpdateBroadPhase(vecbodies);
 
         PQP_REAL R1[3][3], R2[3][3], T1[3], T2[3];
 
         std::vector<Transform> vtrans1,vtrans2;
         pbody1->GetLinkTransformations(vtrans1);
-        _InitKinBody(pbody1);
+        KinBodyInfoPtr pinfo1 = _GetUpdatedInfo(pbody1);
+        std::vector<KinBodyInfoPtr> vcandidates;
+        _QueryBroadPhase(pinfo1->bodybounds, _GetBroadPhaseMargin(report), vcandidates);
 
         std::vector<KinBody::LinkPtr> veclinks1 = pbody1->GetLinks();
-        FOREACH(itbody,vecbodies) {
+        FOREACH(itinfo,vcandidates) {
             if(!!report) {
                 report->numWithinTol = 0;
             }
-            KinBodyPtr pbody2 = *itbody;
+            KinBodyPtr pbody2 = (*itinfo)->GetBody();
+            if( !pbody2 ) {
+                continue;
+            }
 
             if(pbody1->IsAttached(*pbody2)) {
                 continue;
@@ -471,6 +529,9 @@ private:
                     if(find(vlinkexcluded.begin(),vlinkexcluded.end(),veclinks2[j]) != vlinkexcluded.end()) {
                         continue;
                     }
+                    if( !_IsWithin(pinfo1->vlinkbounds.at(i), (*itinfo)->vlinkbounds.at(j), _GetBroadPhaseMargin(report)) ) {
+                        continue;
+                    }
                     GetPQPTransformFromTransform(vtrans2[j],R2,T2);
                     retval = DoPQP(veclinks1[i],R1,T1,veclinks2[j],R2,T2,report);
                     if(!report && _benablecol && !_benabledis && !_benabletol && retval) {
@@ -500,12 +561,18 @@ private:
     // does not check attached
     bool CheckCollisionP(KinBodyConstPtr pbody1, KinBodyConstPtr pbody2, CollisionReportPtr report)
     {
-        _InitKinBody(pbody1);
-        _InitKinBody(pbody2);
+        KinBodyInfoPtr pinfo1 = _GetUpdatedInfo(pbody1);
+        KinBodyInfoPtr pinfo2 = _GetUpdatedInfo(pbody2);
+        if( !_IsWithin(pinfo1->bodybounds, pinfo2->bodybounds, _GetBroadPhaseMargin(report)) ) {
+            return false;
+        }
         PQP_REAL R1[3][3], R2[3][3], T1[3], T2[3];
         FOREACHC(itlink1,pbody1->GetLinks()) {
             GetPQPTransformFromTransform((*itlink1)->GetTransform(),R1,T1);
             FOREACHC(itlink2,pbody2->GetLinks()) {
+                if( !_IsWithin(pinfo1->vlinkbounds.at((*itlink1)->GetIndex()), pinfo2->vlinkbounds.at((*itlink2)->GetIndex()), _GetBroadPhaseMargin(report)) ) {
+                    continue;
+                }
                 GetPQPTransformFromTransform((*itlink2)->GetTransform(),R2,T2);
                 bool retval = DoPQP(*itlink1,R1,T1,*itlink2,R2,T2,report);
                 if(!report && _benablecol && !_benabledis && !_benabletol && retval) {
@@ -524,12 +591,19 @@ private:
     // does not check attached
     bool CheckCollisionP(KinBody::LinkConstPtr plink, KinBodyConstPtr pbody, CollisionReportPtr report)
     {
-        _InitKinBody(plink->GetParent());
-        _InitKinBody(pbody);
+        KinBodyInfoPtr pinfo1 = _GetUpdatedInfo(plink->GetParent());
+        KinBodyInfoPtr pinfo2 = _GetUpdatedInfo(pbody);
+        const Bounds& linkbounds = pinfo1->vlinkbounds.at(plink->GetIndex());
+        if( !_IsWithin(linkbounds, pinfo2->bodybounds, _GetBroadPhaseMargin(report)) ) {
+            return false;
+        }
         bool success = false;
         PQP_REAL R1[3][3], R2[3][3], T1[3], T2[3];
         GetPQPTransformFromTransform(plink->GetTransform(),R1,T1);
         FOREACHC(itlink,pbody->GetLinks()) {
+            if( !_IsWithin(linkbounds, pinfo2->vlinkbounds.at((*itlink)->GetIndex()), _GetBroadPhaseMargin(report)) ) {
+                continue;
+            }
             GetPQPTransformFromTransform((*itlink)->GetTransform(),R2,T2);
             bool retval = DoPQP(plink,R1,T1,*itlink,R2,T2,report);
             success |= retval;
@@ -545,6 +619,152 @@ private:
         return success;
     }
 
+    /// \brief initializes the body if necessary and makes sure the world bounds of its links are up to date
+    KinBodyInfoPtr _GetUpdatedInfo(KinBodyConstPtr pbody)
+    {
+        _InitKinBody(pbody);
+        KinBodyInfoPtr pinfo = boost::dynamic_pointer_cast<KinBodyInfo>(pbody->GetUserData(_userdatakey));
+        _UpdateBounds(*pinfo, *pbody);
+        return pinfo;
+    }
+
+    /// \brief recomputes the world bounds of the links if the body changed since they were last computed
+    ///
+    /// \return true if the bounds were recomputed
+    bool _UpdateBounds(KinBodyInfo& info, const KinBody& body)
+    {
+        if( info.nLastStamp == body.GetUpdateStamp() && info.vlinkbounds.size() == info.vlocalaabbs.size() ) {
+            return false;
+        }
+        info.nLastStamp = body.GetUpdateStamp();
+        info.vlinkbounds.resize(info.vlocalaabbs.size());
+        info.bodybounds = Bounds();
+        const std::vector<KinBody::LinkPtr>& veclinks = body.GetLinks();
+        for(size_t ilink = 0; ilink < info.vlocalaabbs.size(); ++ilink) {
+            const AABB& ablocal = info.vlocalaabbs[ilink];
+            Bounds& bounds = info.vlinkbounds[ilink];
+            if( ablocal.extents.x < 0 ) {
+                bounds = Bounds();
+                continue;
+            }
+            TransformMatrix t(veclinks.at(ilink)->GetTransform());
+            Vector vcenter = t*ablocal.pos;
+            Vector vextents(RaveFabs(t.m[0])*ablocal.extents.x + RaveFabs(t.m[1])*ablocal.extents.y + RaveFabs(t.m[2])*ablocal.extents.z,
+                            RaveFabs(t.m[4])*ablocal.extents.x + RaveFabs(t.m[5])*ablocal.extents.y + RaveFabs(t.m[6])*ablocal.extents.z,
+                            RaveFabs(t.m[8])*ablocal.extents.x + RaveFabs(t.m[9])*ablocal.extents.y + RaveFabs(t.m[10])*ablocal.extents.z);
+            bounds.vmin = vcenter - vextents;
+            bounds.vmax = vcenter + vextents;
+            if( !info.bodybounds.IsValid() ) {
+                info.bodybounds = bounds;
+            }
+            else {
+                info.bodybounds.vmin.x = min(info.bodybounds.vmin.x, bounds.vmin.x); info.bodybounds.vmin.y = min(info.bodybounds.vmin.y, bounds.vmin.y); info.bodybounds.vmin.z = min(info.bodybounds.vmin.z, bounds.vmin.z);
+                info.bodybounds.vmax.x = max(info.bodybounds.vmax.x, bounds.vmax.x); info.bodybounds.vmax.y = max(info.bodybounds.vmax.y, bounds.vmax.y); info.bodybounds.vmax.z = max(info.bodybounds.vmax.z, bounds.vmax.z);
+            }
+        }
+        return true;
+    }
+
+    static bool _CompareBroadPhaseMin(const KinBodyInfoPtr& pinfo1, const KinBodyInfoPtr& pinfo2)
+    {
+        return pinfo1->bodybounds.vmin.x < pinfo2->bodybounds.vmin.x;
+    }
+
+    static bool _CompareBroadPhaseValueMin(dReal fvalue, const KinBodyInfoPtr& pinfo)
+    {
+        return fvalue < pinfo->bodybounds.vmin.x;
+    }
+
+    /// \brief brings the sweep and prune list of the environment bodies up to date.
+    ///
+    /// Only bodies whose update stamp changed get their bounds recomputed. When the set of bodies is the same as the previous call,
+    /// the list is nearly sorted so it is fixed with an insertion sort instead of being rebuilt.
+    void _UpdateBroadPhase(const std::vector<KinBodyPtr>& vecbodies)
+    {
+        ++_nBroadPhaseVisit;
+        bool bBodiesChanged = vecbodies.size() != _vbroadphasebodies.size();
+        bool bMoved = false;
+        FOREACHC(itbody, vecbodies) {
+            KinBodyInfoPtr pinfo = _GetUpdatedInfo(*itbody);
+            if( pinfo->nLastStamp != pinfo->nBroadPhaseVisitStamp ) {
+                pinfo->nBroadPhaseVisitStamp = pinfo->nLastStamp;
+                bMoved = true;
+            }
+            pinfo->nBroadPhaseVisit = _nBroadPhaseVisit;
+            if( !pinfo->bInBroadPhase ) {
+                bBodiesChanged = true;
+            }
+        }
+        if( !bBodiesChanged ) {
+            FOREACHC(itinfo, _vbroadphasebodies) {
+                if( (*itinfo)->nBroadPhaseVisit != _nBroadPhaseVisit ) {
+                    bBodiesChanged = true;
+                    break;
+                }
+            }
+        }
+
+        if( bBodiesChanged ) {
+            FOREACH(itinfo, _vbroadphasebodies) {
+                (*itinfo)->bInBroadPhase = false;
+            }
+            _vbroadphasebodies.resize(0);
+            FOREACHC(itbody, vecbodies) {
+                KinBodyInfoPtr pinfo = boost::dynamic_pointer_cast<KinBodyInfo>((*itbody)->GetUserData(_userdatakey));
+                pinfo->bInBroadPhase = true;
+                _vbroadphasebodies.push_back(pinfo);
+            }
+            std::sort(_vbroadphasebodies.begin(), _vbroadphasebodies.end(), _CompareBroadPhaseMin);
+        }
+        else if( bMoved ) {
+            for(size_t i = 1; i < _vbroadphasebodies.size(); ++i) {
+                for(size_t j = i; j > 0 && _CompareBroadPhaseMin(_vbroadphasebodies[j], _vbroadphasebodies[j-1]); --j) {
+                    std::swap(_vbroadphasebodies[j], _vbroadphasebodies[j-1]);
+                }
+            }
+        }
+    }
+
+    /// \brief collects the environment bodies whose bounds are within fmargin of bounds. _UpdateBroadPhase should be called before.
+    void _QueryBroadPhase(const Bounds& bounds, dReal fmargin, std::vector<KinBodyInfoPtr>& vcandidates) const
+    {
+        vcandidates.resize(0);
+        if( !bounds.IsValid() ) {
+            return;
+        }
+        // list is sorted by vmin.x, so every body after the first one starting past the query cannot overlap
+        const dReal fmaxx = bounds.vmax.x + fmargin;
+        std::vector<KinBodyInfoPtr>::const_iterator itend = std::upper_bound(_vbroadphasebodies.begin(), _vbroadphasebodies.end(), fmaxx, _CompareBroadPhaseValueMin);
+        for(std::vector<KinBodyInfoPtr>::const_iterator itinfo = _vbroadphasebodies.begin(); itinfo != itend; ++itinfo) {
+            if( _IsWithin(bounds, (*itinfo)->bodybounds, fmargin) ) {
+                vcandidates.push_back(*itinfo);
+            }
+        }
+    }
+
+    /// \brief returns the distance under which two bounds have to be checked by PQP for the current options
+    dReal _GetBroadPhaseMargin(CollisionReportPtr report) const
+    {
+        dReal fmargin = _benabletol ? _tolerance : 0;
+        if( _benabledis ) {
+            if( !report ) {
+                return std::numeric_limits<dReal>::infinity(); // DoPQP has to throw
+            }
+            fmargin = max(fmargin, report->minDistance);
+        }
+        return fmargin;
+    }
+
+    static bool _IsWithin(const Bounds& bounds1, const Bounds& bounds2, dReal fmargin)
+    {
+        if( !bounds1.IsValid() || !bounds2.IsValid() ) {
+            return false;
+        }
+        return bounds1.vmin.x <= bounds2.vmax.x + fmargin && bounds2.vmin.x <= bounds1.vmax.x + fmargin
+               && bounds1.vmin.y <= bounds2.vmax.y + fmargin && bounds2.vmin.y <= bounds1.vmax.y + fmargin
+               && bounds1.vmin.z <= bounds2.vmax.z + fmargin && bounds2.vmin.z <= bounds1.vmax.z + fmargin;
+    }
+
     Vector PQPRealToVector(const Vector& in, const PQP_REAL R[3][3], const PQP_REAL T[3])
     {
         return Vector(in.x*R[0][0]+in.y*R[0][1]+in.z*R[0][2]+T[0], in.x*R[1][0]+in.y*R[1][1]+in.z*R[1][2]+T[1], in.x*R[2][0]+in.y*R[2][1]+in.z*R[2][2]+T[2]);
@@ -695,6 +915,9 @@ private:
     vector<uint8_t> _vactivelinks;
     std::string _userdatakey;
 
+    std::vector<KinBodyInfoPtr> _vbroadphasebodies; ///< environment bodies sorted by the x of their minimum bound
+    int _nBroadPhaseVisit; ///< incremented on every _UpdateBroadPhase call
+
     void _SetActiveBody(KinBodyConstPtr pbody) {
         if( _options & CO_ActiveDOFs ) {
             _pactiverobot = OpenRAVE::RaveInterfaceConstCast<RobotBase>(pbody);
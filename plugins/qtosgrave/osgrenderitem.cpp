@@ -23,9 +23,139 @@
 #include <osg/PolygonOffset>
 #include <osg/LineStipple>
 #include <osg/Depth>
+#include <osg/observer_ptr>
 
 namespace qtosgrave {
 
+/// \brief shares the geodes of geometries with identical content between all the bodies of the viewers.
+///
+/// Bodies that use the same mesh, like totes and parts, reference a single geode, so the vertex arrays, normals and
+/// the GPU buffers created from them exist only once. The material is set on the per-geometry parent group, so every
+/// instance keeps its own color. Entries are released once the last body using them is reloaded or removed.
+class SharedGeodeCache
+{
+public:
+    /// \brief returns the live geode created for the same type and content, null if there is none
+    ///
+    /// \param vdata the float data the geode was created from, the dimensions of shapes or the vertices of meshes
+    /// \param vindices the triangle indices of meshes, empty for shapes
+    osg::ref_ptr<osg::Geode> Find(GeometryType type, uint64_t hash, const std::vector<float>& vdata, const std::vector<int32_t>& vindices)
+    {
+        osg::ref_ptr<osg::Geode> geode;
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::map<std::pair<GeometryType, uint64_t>, GeodeEntry>::iterator it = _mapGeodes.find(std::make_pair(type, hash));
+        if( it == _mapGeodes.end() ) {
+            return geode;
+        }
+        if( !it->second.geode.lock(geode) ) {
+            _mapGeodes.erase(it);
+            return geode;
+        }
+        if( it->second.vdata != vdata || it->second.vindices != vindices ) {
+            // hash collision with different content, the caller creates its own geode
+            RAVELOG_VERBOSE_FORMAT("geometry hash 0x%x of type %d collides with a different shared geode", hash%(int)type);
+            geode = NULL;
+        }
+        return geode;
+    }
+
+    /// \brief registers geode as the shared geode of the content, unless a different content with the same hash still has a live geode
+    void Add(GeometryType type, uint64_t hash, const std::vector<float>& vdata, const std::vector<int32_t>& vindices, osg::ref_ptr<osg::Geode> geode)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        GeodeEntry& entry = _mapGeodes[std::make_pair(type, hash)];
+        osg::ref_ptr<osg::Geode> existing;
+        if( entry.geode.lock(existing) ) {
+            return;
+        }
+        entry.vdata = vdata;
+        entry.vindices = vindices;
+        entry.geode = geode;
+    }
+
+private:
+    /// \brief the source data is kept to tell hash collisions apart from identical content
+    struct GeodeEntry
+    {
+        std::vector<float> vdata;
+        std::vector<int32_t> vindices;
+        osg::observer_ptr<osg::Geode> geode;
+    };
+
+    std::mutex _mutex;
+    std::map<std::pair<GeometryType, uint64_t>, GeodeEntry> _mapGeodes;
+};
+
+static SharedGeodeCache s_sharedGeodeCache;
+
+/// \brief hash of the float data and indices the geode of a geometry is created from
+static uint64_t _ComputeGeodeHash(const std::vector<float>& vdata, const std::vector<int32_t>& vindices)
+{
+    uint64_t hash = utils::CombineFastHash(vdata.size(), vindices.size());
+    if( vdata.size() > 0 ) {
+        hash = utils::GetFastHash((const uint8_t*)&vdata[0], vdata.size()*sizeof(vdata[0]), hash);
+    }
+    if( vindices.size() > 0 ) {
+        hash = utils::GetFastHash((const uint8_t*)&vindices[0], vindices.size()*sizeof(vindices[0]), hash);
+    }
+    return hash;
+}
+
+/// \brief returns the shared geode drawing shape, creating it if no other geometry uses the same shape
+static osg::ref_ptr<osg::Geode> _GetSharedShapeGeode(GeometryType type, const Vector& vdims, osg::Shape* shape)
+{
+    osg::ref_ptr<osg::Shape> pshape(shape); // released here if the shape is already shared
+    std::vector<float> vdata(3);
+    vdata[0] = vdims.x; vdata[1] = vdims.y; vdata[2] = vdims.z;
+    const std::vector<int32_t> vindices;
+    const uint64_t hash = _ComputeGeodeHash(vdata, vindices);
+    osg::ref_ptr<osg::Geode> geode = s_sharedGeodeCache.Find(type, hash, vdata, vindices);
+    if( !geode ) {
+        geode = new osg::Geode;
+        osg::ref_ptr<osg::ShapeDrawable> sd = new osg::ShapeDrawable(pshape.get());
+        geode->addDrawable(sd.get());
+        s_sharedGeodeCache.Add(type, hash, vdata, vindices, geode);
+    }
+    return geode;
+}
+
+/// \brief returns the shared geode drawing mesh, creating it if no other geometry of the same type uses the same mesh
+static osg::ref_ptr<osg::Geode> _GetSharedMeshGeode(GeometryType type, const TriMesh& mesh)
+{
+    // the content that is rendered, the vertices as floats and the indices
+    std::vector<float> vdata(3*mesh.vertices.size());
+    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
+        vdata[3*i] = mesh.vertices[i].x;
+        vdata[3*i+1] = mesh.vertices[i].y;
+        vdata[3*i+2] = mesh.vertices[i].z;
+    }
+    const uint64_t hash = _ComputeGeodeHash(vdata, mesh.indices);
+    osg::ref_ptr<osg::Geode> geode = s_sharedGeodeCache.Find(type, hash, vdata, mesh.indices);
+    if( !!geode ) {
+        return geode;
+    }
+
+    osg::ref_ptr<osg::Geometry> geom = new osg::Geometry;
+    osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array();
+    vertices->reserveArray(mesh.vertices.size());
+    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
+        vertices->push_back(osg::Vec3(vdata[3*i], vdata[3*i+1], vdata[3*i+2]));
+    }
+    geom->setVertexArray(vertices.get());
+
+    osg::DrawElementsUInt* geom_prim = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES, mesh.indices.size());
+    for(size_t i = 0; i < mesh.indices.size(); ++i) {
+        (*geom_prim)[i] = mesh.indices[i];
+    }
+    geom->addPrimitiveSet(geom_prim);
+
+    osgUtil::SmoothingVisitor::smooth(*geom); // compute vertex normals
+    geode = new osg::Geode;
+    geode->addDrawable(geom);
+    s_sharedGeodeCache.Add(type, hash, vdata, mesh.indices, geode);
+    return geode;
+}
+
 OSGGroupPtr CreateOSGXYZAxes(double len, double axisthickness)
 {
     osg::Vec4f colors[] = {
@@ -241,6 +371,8 @@ KinBodyItem::KinBodyItem(OSGGroupPtr osgSceneRoot, OSGGroupPtr osgFigureRoot, Ki
     _userdata = 0;
     _bReload = false;
     _bDrawStateChanged = false;
+    _updatestamp = 0;
+    _bUpdateStampValid = false;
 
     _environmentid = pbody->GetEnvironmentBodyIndex();
     _geometrycallback = pbody->RegisterChangeCallback(KinBody::Prop_LinkGeometry, boost::bind(&KinBodyItem::_HandleGeometryChangedCallback,this));
@@ -262,6 +394,7 @@ void KinBodyItem::Load()
 
     _veclinks.resize(0);
     _vecgeoms.resize(_pbody->GetLinks().size());
+    _bUpdateStampValid = false; // new link nodes, so have to set their transforms again
 
     Transform tbody = _pbody->GetTransform();
     Transform tbodyinv = tbody.inverse();
@@ -409,24 +542,16 @@ void KinBodyItem::Load()
                 //  Geometry is defined like a Sphere
                 case GT_Sphere: {
                     osg::Sphere* s = new osg::Sphere();
-                    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
                     s->setRadius(orgeom->GetSphereRadius());
-                    osg::ref_ptr<osg::ShapeDrawable> sd = new osg::ShapeDrawable(s);
-                    geode->addDrawable(sd.get());
-
+                    osg::ref_ptr<osg::Geode> geode = _GetSharedShapeGeode(GT_Sphere, Vector(orgeom->GetSphereRadius(),0,0), s);
                     pgeometrydata->addChild(geode.get());
                     break;
                 }
                 //  Geometry is defined like a Box
                 case GT_Box: {
-                    Vector v;
-                    osg::ref_ptr<osg::Box> box = new osg::Box();
+                    osg::Box* box = new osg::Box();
                     box->setHalfLengths(osg::Vec3f(orgeom->GetBoxExtents().x,orgeom->GetBoxExtents().y,orgeom->GetBoxExtents().z));
-
-                    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-                    osg::ref_ptr<osg::ShapeDrawable> sd = new osg::ShapeDrawable(box.get());
-                    geode->addDrawable(sd.get());
-
+                    osg::ref_ptr<osg::Geode> geode = _GetSharedShapeGeode(GT_Box, orgeom->GetBoxExtents(), box);
                     pgeometrydata->addChild(geode.get());
                     break;
                 }
@@ -436,9 +561,7 @@ void KinBodyItem::Load()
                     osg::Cylinder* cy = new osg::Cylinder();
                     cy->setRadius(orgeom->GetCylinderRadius());
                     cy->setHeight(orgeom->GetCylinderHeight());
-                    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-                    osg::ref_ptr<osg::ShapeDrawable> sd = new osg::ShapeDrawable(cy);
-                    geode->addDrawable(sd.get());
+                    osg::ref_ptr<osg::Geode> geode = _GetSharedShapeGeode(GT_Cylinder, Vector(orgeom->GetCylinderRadius(),orgeom->GetCylinderHeight(),0), cy);
                     pgeometrydata->addChild(geode.get());
                     break;
                 }
@@ -447,9 +570,7 @@ void KinBodyItem::Load()
                     osg::Capsule* cy = new osg::Capsule();
                     cy->setRadius(orgeom->GetCapsuleRadius());
                     cy->setHeight(orgeom->GetCapsuleHeight());
-                    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-                    osg::ref_ptr<osg::ShapeDrawable> sd = new osg::ShapeDrawable(cy);
-                    geode->addDrawable(sd.get());
+                    osg::ref_ptr<osg::Geode> geode = _GetSharedShapeGeode(GT_Capsule, Vector(orgeom->GetCapsuleRadius(),orgeom->GetCapsuleHeight(),0), cy);
                     pgeometrydata->addChild(geode.get());
                     break;
                 }
@@ -460,30 +581,8 @@ void KinBodyItem::Load()
                 case GT_Cage:
                 case GT_Container:
                 case GT_TriMesh: {
-                    // make triangleMesh
-                    osg::ref_ptr<osg::Geometry> geom = new osg::Geometry;
-
-                    //geom->setColorBinding(osg::Geometry::BIND_OVERALL); // need to call geom->setColorArray first
-
-                    const TriMesh& mesh = orgeom->GetCollisionMesh();
-                    osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array();
-                    vertices->reserveArray(mesh.vertices.size());
-                    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
-                        RaveVector<float> v = mesh.vertices[i];
-                        vertices->push_back(osg::Vec3(v.x, v.y, v.z));
-                    }
-                    geom->setVertexArray(vertices.get());
-
-
-                    osg::DrawElementsUInt* geom_prim = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES, mesh.indices.size());
-                    for(size_t i = 0; i < mesh.indices.size(); ++i) {
-                        (*geom_prim)[i] = mesh.indices[i];
-                    }
-                    geom->addPrimitiveSet(geom_prim);
-
-                    osgUtil::SmoothingVisitor::smooth(*geom); // compute vertex normals
-                    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-                    geode->addDrawable(geom);
+                    // make triangleMesh, identical meshes share the same geode
+                    osg::ref_ptr<osg::Geode> geode = _GetSharedMeshGeode(orgeom->GetType(), orgeom->GetCollisionMesh());
                     pgeometrydata->addChild(geode);
 
                     if(orgeom->GetType() == GT_TriMesh || orgeom->GetType() == GT_Axial || orgeom->GetType() == GT_ConicalFrustum){
@@ -913,6 +1012,16 @@ bool KinBodyItem::UpdateFromModel(const vector<dReal>& vjointvalues, const vecto
     return true;
 }
 
+bool KinBodyItem::UpdateFromBodyState(const KinBody::BodyState& bodystate)
+{
+    if( !UpdateFromModel(bodystate.jointvalues, bodystate.vectrans) ) {
+        return false;
+    }
+    _updatestamp = bodystate.updatestamp;
+    _bUpdateStampValid = true;
+    return true;
+}
+
 
 void KinBodyItem::SetCropContainerMarginsVisible(const std::string& linkName, const std::string& geometryName, const std::string& cropContainerMarginsType, bool visible)
 {
@@ -944,6 +1053,7 @@ void KinBodyItem::SetGrab(bool bGrab, bool bUpdate)
     }
 
     bGrabbed = bGrab;
+    _bUpdateStampValid = false; // robots show the end effectors only when grabbed
     if( bGrab ) {
         SetVisualizationMode("selected");
     }
@@ -145,6 +145,14 @@ public:
     /// \brief updates from openrave model
     virtual bool UpdateFromModel(const vector<dReal>& vjointvalues, const vector<Transform>& vtrans);
 
+    /// \brief updates from a published body state and remembers its update stamp
+    virtual bool UpdateFromBodyState(const KinBody::BodyState& bodystate);
+
+    /// \brief returns true if the osg nodes are out of date with respect to a published body state
+    inline bool IsUpdateFromBodyStateNeeded(const KinBody::BodyState& bodystate) const {
+        return !_bUpdateStampValid || _updatestamp != bodystate.updatestamp || _bReload || _bDrawStateChanged;
+    }
+
     virtual void SetGrab(bool bGrab, bool bUpdate=true);
 
     inline KinBodyPtr GetBody() const {
@@ -208,6 +216,8 @@ protected:
     std::vector<std::vector<GeomNodes> > _vecgeoms; ///< render items for each link's geometries, indexed same as geometries.
     bool bEnabled;
     bool bGrabbed, _bReload, _bDrawStateChanged;
+    int _updatestamp; ///< KinBody::GetUpdateStamp of the body state last applied to the osg nodes, only valid if _bUpdateStampValid is true
+    bool _bUpdateStampValid; ///< if false, the osg nodes have to be updated regardless of the update stamp, for example after they were re-created
     ViewGeometry _viewmode;
     int _userdata;
 
@@ -643,6 +643,7 @@ QOSGViewerWidget::QOSGViewerWidget(EnvironmentBasePtr penv, const std::string& u
 
     _vecTextScreenOffset = osg::Vec2(10.0, 0.0);
     _hudTextSize = 18.0;
+    _lastDrawTime = 0;
 
     if( !!_osgCameraHUD ) {
         // in order to get the axes to render without lighting:
@@ -914,7 +915,13 @@ void QOSGViewerWidget::HandleRayPick(const osgUtil::LineSegmentIntersector::Inte
         }
     }
     else {
-        OSGNodePtr node = intersection.nodePath.back();
+        // geodes of identical geometries are shared between bodies, so go up to the first node with a single parent
+        // in order to get a node that belongs to the picked body
+        osg::NodePath::const_reverse_iterator itnode = intersection.nodePath.rbegin();
+        while( itnode + 1 != intersection.nodePath.rend() && (*itnode)->getNumParents() > 1 ) {
+            ++itnode;
+        }
+        OSGNodePtr node = *itnode;
 
         // something hit
         if( buttonPressed ) {
@@ -1876,7 +1883,9 @@ void QOSGViewerWidget::initializeGL() {
 void QOSGViewerWidget::paintGL()
 {
     try {
+        uint64_t starttime = utils::GetMicroTime();
         _osgviewer->frame(); // osgViewer::CompositeViewer
+        _lastDrawTime = utils::GetMicroTime() - starttime;
     }
     catch(const std::exception& ex) {
         RAVELOG_WARN_FORMAT("got exception in paint event: %s", ex.what());
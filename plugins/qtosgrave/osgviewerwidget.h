@@ -172,6 +172,11 @@ public:
     osg::Camera *GetCamera();
     bool IsInOrthoMode();
 
+    /// \brief returns the time it took to render the last osg frame in microseconds. Only call from the GUI thread.
+    uint64_t GetLastDrawTime() const {
+        return _lastDrawTime;
+    }
+
     osg::ref_ptr<osgGA::CameraManipulator> GetCurrentCameraManipulator();
     void SetCurrentCameraManipulator(osgGA::CameraManipulator* manipulator);
     void SetCameraDistanceToFocus(double distance);
@@ -355,6 +360,7 @@ protected:
                    ///  values. Therefore, we manage zNear ourselves
     double _currentOrthoFrustumSize; ///< coordinate for the right vertical clipping plane 
     double _hudTextSize; ///< size of HUD text, scaled off of devicePixelRatio
+    uint64_t _lastDrawTime; ///< time it took to render the last osg frame in microseconds
 
     void GetSwitchedButtonValue(unsigned int &button);
 
@@ -185,6 +185,8 @@ QtOSGViewer::QtOSGViewer(EnvironmentBasePtr penv, std::istream& sinput, QCoreApp
     // crop container margins and crop container empty margins
     RegisterCommand("SetCropContainerMarginsVisible", boost::bind(&QtOSGViewer::_SetCropContainerMarginsVisibleCommand, this, _1, _2),
                     "Sets whether crop container margins are visualized or not");
+    RegisterCommand("GetFrameTimes", boost::bind(&QtOSGViewer::_GetFrameTimesCommand, this, _1, _2),
+                    "Returns the average times in ms of the viewer update since the last call: fetch diff update draw, followed by the number of frames, the average number of published bodies and the average number of updated bodies. Resets the timings.");
 
     // Establish size limits per priority
     _mapGUIFunctionListLimits[ViewerCommandPriority::VERY_HIGH] = 100000;
@@ -1356,6 +1358,19 @@ bool QtOSGViewer::_SetCropContainerMarginsVisibleCommand(ostream& sout, istream&
     return true;
 }
 
+bool QtOSGViewer::_GetFrameTimesCommand(ostream& sout, istream& sinput)
+{
+    FrameTimes frameTimes;
+    {
+        std::lock_guard<std::mutex> lock(_mutexFrameTimes);
+        frameTimes = _frameTimes;
+        _frameTimes = FrameTimes();
+    }
+    const double fmult = frameTimes.numframes > 0 ? 1.0/frameTimes.numframes : 0;
+    sout << frameTimes.fetch*fmult*1e-3 << " " << frameTimes.diff*fmult*1e-3 << " " << frameTimes.update*fmult*1e-3 << " " << frameTimes.draw*fmult*1e-3 << " " << frameTimes.numframes << " " << frameTimes.numbodies*fmult << " " << frameTimes.numchangedbodies*fmult;
+    return true;
+}
+
 void QtOSGViewer::_SetProjectionMode(const std::string& projectionMode)
 {
     if (projectionMode == "orthogonal")
@@ -2122,7 +2137,7 @@ void QtOSGViewer::UpdateFromModel()
     }
 
     std::lock_guard<std::mutex> lock(_mutexUpdateModels);
-    vector<KinBody::BodyState> vecbodies;
+    const uint64_t starttime = utils::GetMicroTime();
 
     EnvironmentLock lockenv(GetEnv()->GetMutex(), OpenRAVE::defer_lock_t());
 
@@ -2138,18 +2153,22 @@ void QtOSGViewer::UpdateFromModel()
     }
 
     try {
-        GetEnv()->GetPublishedBodies(vecbodies,100000); // 0.1s
+        // reuse the vector of the previous frame so that the body states do not have to be allocated again
+        GetEnv()->GetPublishedBodies(_vecPublishedBodies,100000); // 0.1s
     }
     catch(const std::exception& ex) {
         RAVELOG_WARN("timeout of GetPublishedBodies\n");
+        _ReleasePublishedBodies();
         return;
     }
+    const uint64_t fetchtime = utils::GetMicroTime();
     FOREACH(it, _mapbodies) {
         it->second->SetUserData(0);
     }
 
     bool newdata = false; // set to true if new object was created
-    FOREACH(itbody, vecbodies) {
+    _vecChangedItems.clear();
+    FOREACH(itbody, _vecPublishedBodies) {
         BOOST_ASSERT( !!itbody->pbody );
         KinBodyPtr pbody = itbody->pbody; // try to use only as an id, don't call any methods!
         KinBodyItemPtr pitem = boost::dynamic_pointer_cast<KinBodyItem>(pbody->GetUserData(_userdatakey));
@@ -2182,6 +2201,7 @@ void QtOSGViewer::UpdateFromModel()
                             }
                         }
                         if( !lockenv ) {
+                            _ReleasePublishedBodies();
                             return; // couldn't acquire the lock, try next time. This prevents deadlock situations
                         }
                     }
@@ -2227,8 +2247,32 @@ void QtOSGViewer::UpdateFromModel()
 
         pitem->SetUserData(1);
 
-        //  Update viewer with core transforms
-        pitem->UpdateFromModel(itbody->jointvalues, itbody->vectrans);
+        // only update the osg nodes of bodies that changed since the last frame, most bodies of big scenes are static
+        if( pitem->IsUpdateFromBodyStateNeeded(*itbody) ) {
+            _vecChangedItems.emplace_back(pitem, &*itbody);
+        }
+    }
+    const uint64_t difftime = utils::GetMicroTime();
+
+    //  Update viewer with core transforms
+    FOREACH(itchanged, _vecChangedItems) {
+        itchanged->first->UpdateFromBodyState(*itchanged->second);
+    }
+    const size_t numchangedbodies = _vecChangedItems.size();
+    _vecChangedItems.clear();
+    const uint64_t updatetime = utils::GetMicroTime();
+
+    _ReleasePublishedBodies();
+
+    {
+        std::lock_guard<std::mutex> lockframetimes(_mutexFrameTimes);
+        _frameTimes.fetch += fetchtime - starttime;
+        _frameTimes.diff += difftime - fetchtime;
+        _frameTimes.update += updatetime - difftime;
+        _frameTimes.draw += _posgWidget->GetLastDrawTime();
+        _frameTimes.numframes += 1;
+        _frameTimes.numbodies += _vecPublishedBodies.size();
+        _frameTimes.numchangedbodies += numchangedbodies;
     }
 
     FOREACH_NOINC(it, _mapbodies) {
@@ -2270,6 +2314,14 @@ void QtOSGViewer::UpdateFromModel()
     }
 }
 
+void QtOSGViewer::_ReleasePublishedBodies()
+{
+    // do not hold the bodies until the next frame, the states are only kept for their memory
+    FOREACH(itbody, _vecPublishedBodies) {
+        itbody->pbody.reset();
+    }
+}
+
 boost::shared_ptr<EnvironmentLock> QtOSGViewer::LockEnvironment(uint64_t timeout,bool bUpdateEnvironment)
 {
     // try to acquire the lock
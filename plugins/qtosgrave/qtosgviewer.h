@@ -162,6 +162,9 @@ public slots:
     /// \brief updates the screen with a new frame and runs viewer update logic. Also tries to update with the openrave environment
     void _UpdateViewerCallback();
 
+    /// \brief releases the bodies held by _vecPublishedBodies, keeping the memory of the states for the next frame. Called at every exit of UpdateFromModel so that removed bodies are not kept alive by the viewer.
+    void _ReleasePublishedBodies();
+
     /// \brief called when application quits
     void _ProcessApplicationQuit();
 
@@ -421,6 +424,7 @@ public:
     bool _PanCameraXDirectionCommand(ostream& sout, istream& sinput);
     bool _PanCameraYDirectionCommand(ostream& sout, istream& sinput);
     bool _SetCropContainerMarginsVisibleCommand(ostream& sout, istream& sinput);
+    bool _GetFrameTimesCommand(ostream& sout, istream& sinput);
 
     QCoreApplication* _pQtApp = nullptr; // the main application, do not delete
     //@{ Message Queue
@@ -438,6 +442,22 @@ public:
 
     std::string _userdatakey; ///< the key to use for KinBody::GetUserData and KinBody::SetUserData
     std::map<KinBodyPtr, KinBodyItemPtr> _mapbodies;    ///< mapping of all the bodies created
+    std::vector<KinBody::BodyState> _vecPublishedBodies; ///< published bodies fetched by UpdateFromModel, kept between frames in order to reuse the memory. protected by _mutexUpdateModels
+    std::vector< std::pair<KinBodyItemPtr, const KinBody::BodyState*> > _vecChangedItems; ///< items whose bodies changed in the current UpdateFromModel. protected by _mutexUpdateModels
+
+    /// \brief timings of the viewer update loop accumulated since the last GetFrameTimes command, in microseconds
+    struct FrameTimes
+    {
+        uint64_t fetch = 0; ///< getting the published bodies
+        uint64_t diff = 0; ///< finding the bodies that changed and creating the items of new bodies
+        uint64_t update = 0; ///< updating the osg nodes of the changed bodies
+        uint64_t draw = 0; ///< rendering the osg frame
+        uint64_t numframes = 0;
+        uint64_t numbodies = 0; ///< published bodies summed over all frames
+        uint64_t numchangedbodies = 0; ///< updated bodies summed over all frames
+    };
+    FrameTimes _frameTimes; ///< protected by _mutexFrameTimes
+    std::mutex _mutexFrameTimes;
     ItemPtr _pSelectedItem;     ///< the currently selected item
 
     //@{ camera
@@ -155,6 +155,51 @@ public:
     //        fcosfovy = cosf(ffovy); fsinfovy = sinf(ffovy);
     //    }
 
+    /// \brief state of a body when a visibility map was built, used to find the links that changed since
+    struct VisibilityMapBodyState
+    {
+        KinBodyWeakPtr pbody;
+        int updatestamp;
+        uint64_t geometrydigest;
+        std::vector<Transform> vlinktransforms;
+        std::vector<AABB> vlinkaabbs; ///< link aabbs in the world
+        std::vector<uint8_t> vlinkflags; ///< see _GetVisibilityMapLinkFlags
+    };
+
+    /// \brief visibility of one camera transform of _visibilitytransforms
+    struct VisibilityMapCell
+    {
+        VisibilityMapCell() : bCacheable(false), bOccluded(false) {
+        }
+        Transform tCameraInTarget;
+        Vector vrayplanes[6]; ///< planes bounding all the rays of the occlusion check in the target link coordinate system, positive is inside
+        bool bCacheable; ///< false if the target is not in front of the camera, then the rays cannot be bounded
+        bool bOccluded;
+        std::string errormsg; ///< error of the occlusion check if occluded
+    };
+
+    /// \brief visibility of all camera transforms for the target at the pose it had when the map was built, along with the state of the environment at that time.
+    ///
+    /// Links moving with the camera are placed at every camera transform when the cell is computed, so their occlusions are part of the cell.
+    struct VisibilityMap
+    {
+        VisibilityMap() : numtransforms(0), nLastUsed(0) {
+        }
+        KinBody::LinkWeakPtr ptargetlink; ///< target link the map was built for
+        std::string targetgeomname;
+        RobotBase::AttachedSensorWeakPtr psensor; ///< camera the map was built for
+        size_t numtransforms; ///< size of _visibilitytransforms when the map was built
+        uint64_t nLastUsed; ///< value of _nVisibilityMapUseCount when the map was last built or looked up, the least recently used map is dropped first
+        Transform tTargetInWorld;
+        std::vector<VisibilityMapCell> vcells; ///< one per camera transform of _visibilitytransforms
+        std::vector<VisibilityMapBodyState> vbodystates;
+        std::vector<int> vbodystateindices; ///< environment body index -> index into vbodystates, -1 if the body was not there
+        std::vector<uint8_t> vcarriedlinks; ///< 1 for every link of the robot that moves with the camera
+        std::vector<Transform> vcarriedlinkposes; ///< transforms of the carried links in the camera coordinate system
+        std::vector<AABB> vcarriedlinklocalaabbs; ///< aabbs of the carried links in their own coordinate system
+    };
+    typedef boost::shared_ptr<VisibilityMap> VisibilityMapPtr;
+
     class VisibilityConstraintFunction
     {
         class SampleRaysScope
@@ -291,7 +336,8 @@ public:
         /// samples the ik
         /// If camera is attached to robot, assume target is not movable and t is the camera position.
         /// If camera is not attached to robot, assume target is movable and t is the target position.
-        bool SampleWithCamera(const TransformMatrix& t, vector<dReal>& pNewSample, bool bOutputError, std::string& errormsg)
+        /// \param icell index of the camera transform in _visibilitytransforms if t comes from it, allows the occlusion to be looked up in the visibility map
+        bool SampleWithCamera(const TransformMatrix& t, vector<dReal>& pNewSample, bool bOutputError, std::string& errormsg, int icell=-1)
         {
             Transform tCameraInTarget, ttarget;
             if( _vf->_robot != _vf->_sensorrobot ) {
@@ -332,7 +378,7 @@ public:
             }
             _vf->_robot->SetActiveDOFValues(pNewSample);
 
-            return !IsOccluded(tCameraInTarget, bOutputError, errormsg);
+            return !IsOccluded(tCameraInTarget, bOutputError, errormsg, icell);
         }
 
         /// \brief checks if the target geometries of the target link are inside the camera visiblity convex hull (
@@ -356,8 +402,24 @@ public:
         /// check if any part of the environment or robot is in front of the camera blocking the object
         /// sample object's surface and shoot rays
         /// \param tCameraInTarget in target coordinate system
-        bool IsOccluded(const TransformMatrix& tCameraInTarget, bool bOutputError, std::string& errormsg)
+        /// \param icell index of tCameraInTarget in _visibilitytransforms if known. If the cell of the visibility map is still valid, its result is returned without shooting rays
+        bool IsOccluded(const TransformMatrix& tCameraInTarget, bool bOutputError, std::string& errormsg, int icell=-1)
         {
+            if( icell >= 0 && _vf->_bUseVisibilityMap && !!_vf->_pvisibilitymap ) {
+                const VisibilityMap& visibilitymap = *_vf->_pvisibilitymap;
+                if( icell < (int)visibilitymap.vcells.size() ) {
+                    const VisibilityMapCell& cell = visibilitymap.vcells[icell];
+                    if( cell.bCacheable && _IsSameVisibilityMapTransform(cell.tCameraInTarget, tCameraInTarget) && _IsSameVisibilityMapTransform(visibilitymap.tTargetInWorld, _vf->_targetlink->GetTransform()) && !_HasVisibilityMapCellChanged(visibilitymap, cell) ) {
+                        ++_vf->_nVisibilityMapHits;
+                        if( cell.bOccluded ) {
+                            errormsg = cell.errormsg;
+                        }
+                        return cell.bOccluded;
+                    }
+                }
+                ++_vf->_nVisibilityMapRetests;
+            }
+
             KinBody::KinBodyStateSaver saver1(_ptargetbox), saver2(_vf->_targetlink->GetParent(),KinBody::Save_LinkEnable);
             TransformMatrix tCameraInTargetinv = tCameraInTarget.inverse();
             Transform ttarget = _vf->_targetlink->GetTransform();
@@ -409,7 +471,148 @@ public:
             return false;
         }
 
+        /// \brief computes the occlusion of the camera at cell.tCameraInTarget and the planes bounding the rays that decide it
+        void ComputeVisibilityMapCell(VisibilityMapCell& cell)
+        {
+            // all rays go from the camera through points of the target box, so they are inside the pyramid of its projected corners
+            const Transform tTargetInCamera = cell.tCameraInTarget.inverse();
+            dReal fxmin = 0, fxmax = 0, fymin = 0, fymax = 0, fzmax = 0;
+            cell.bCacheable = true;
+            for(int icorner = 0; icorner < 8; ++icorner) {
+                Vector vcorner = _abTarget.pos;
+                vcorner.x += (icorner & 1) ? _abTarget.extents.x : -_abTarget.extents.x;
+                vcorner.y += (icorner & 2) ? _abTarget.extents.y : -_abTarget.extents.y;
+                vcorner.z += (icorner & 4) ? _abTarget.extents.z : -_abTarget.extents.z;
+                Vector v = tTargetInCamera*vcorner;
+                if( v.z <= 0 ) {
+                    cell.bCacheable = false;
+                    break;
+                }
+                dReal fx = v.x/v.z, fy = v.y/v.z;
+                if( icorner == 0 ) {
+                    fxmin = fxmax = fx;
+                    fymin = fymax = fy;
+                    fzmax = v.z;
+                }
+                else {
+                    fxmin = min(fxmin, fx); fxmax = max(fxmax, fx);
+                    fymin = min(fymin, fy); fymax = max(fymax, fy);
+                    fzmax = max(fzmax, v.z);
+                }
+            }
+
+            if( cell.bCacheable ) {
+                // _TestRay starts the rays 100*_fRayMinDist in front of the camera. If that is before the target box, the rays end at it, otherwise they can hit anything up to their end.
+                const dReal fRayStart = 100*_vf->_fRayMinDist;
+                const Vector& vcamera = cell.tCameraInTarget.trans;
+                Vector vclosest;
+                vclosest.x = min(max(vcamera.x, _abTarget.pos.x-_abTarget.extents.x), _abTarget.pos.x+_abTarget.extents.x);
+                vclosest.y = min(max(vcamera.y, _abTarget.pos.y-_abTarget.extents.y), _abTarget.pos.y+_abTarget.extents.y);
+                vclosest.z = min(max(vcamera.z, _abTarget.pos.z-_abTarget.extents.z), _abTarget.pos.z+_abTarget.extents.z);
+                const dReal fzfar = (vclosest-vcamera).lengthsqr3() > fRayStart*fRayStart ? fzmax : fRayStart+200;
+                const Vector vcameraplanes[6] = { Vector(1,0,-fxmin,0), Vector(-1,0,fxmax,0), Vector(0,1,-fymin,0), Vector(0,-1,fymax,0), Vector(0,0,1,0), Vector(0,0,-1,fzfar) };
+                for(int iplane = 0; iplane < 6; ++iplane) {
+                    cell.vrayplanes[iplane] = cell.tCameraInTarget.rotate(vcameraplanes[iplane]);
+                    cell.vrayplanes[iplane].w = vcameraplanes[iplane].w - vcamera.dot3(cell.vrayplanes[iplane]);
+                }
+            }
+
+            cell.errormsg.clear();
+            cell.bOccluded = IsOccluded(cell.tCameraInTarget, false, cell.errormsg);
+        }
+
 private:
+        /// \brief true if a link that moved, was added, removed or changed its geometry or enabled state since the visibility map was built can be on the rays of the cell
+        ///
+        /// Links carried by the camera are compared in the camera coordinate system since the cell placed them with the camera.
+        bool _HasVisibilityMapCellChanged(const VisibilityMap& visibilitymap, const VisibilityMapCell& cell)
+        {
+            const Transform tCamera = visibilitymap.tTargetInWorld*cell.tCameraInTarget;
+            const Transform tCameraInv = tCamera.inverse();
+            Vector vrayplanes[6];
+            for(int iplane = 0; iplane < 6; ++iplane) {
+                vrayplanes[iplane] = visibilitymap.tTargetInWorld.rotate(cell.vrayplanes[iplane]);
+                vrayplanes[iplane].w = cell.vrayplanes[iplane].w - visibilitymap.tTargetInWorld.trans.dot3(vrayplanes[iplane]);
+            }
+
+            _vvisitedbodystates.resize(visibilitymap.vbodystates.size());
+            std::fill(_vvisitedbodystates.begin(), _vvisitedbodystates.end(), 0);
+            _vf->GetEnv()->GetBodies(_vbodies);
+            FOREACHC(itbody, _vbodies) {
+                const KinBodyPtr& pbody = *itbody;
+                if( pbody == _ptargetbox ) {
+                    continue;
+                }
+                int istate = -1;
+                const int bodyindex = pbody->GetEnvironmentBodyIndex();
+                if( bodyindex >= 0 && bodyindex < (int)visibilitymap.vbodystateindices.size() ) {
+                    istate = visibilitymap.vbodystateindices[bodyindex];
+                    if( istate >= 0 && visibilitymap.vbodystates[istate].pbody.lock() != pbody ) {
+                        istate = -1;
+                    }
+                }
+                if( istate < 0 ) {
+                    // added after the map was built
+                    FOREACHC(itlink, pbody->GetLinks()) {
+                        if( (*itlink)->IsEnabled() && !_IsBoxOutsidePlanes((*itlink)->ComputeAABB(), Transform(), vrayplanes) ) {
+                            return true;
+                        }
+                    }
+                    continue;
+                }
+
+                _vvisitedbodystates[istate] = 1;
+                const VisibilityMapBodyState& state = visibilitymap.vbodystates[istate];
+                const bool bGeometryChanged = state.geometrydigest != pbody->GetKinematicsGeometryDigest() || state.vlinkflags.size() != pbody->GetLinks().size();
+                const bool bMoved = state.updatestamp != pbody->GetUpdateStamp();
+                const bool bCarrier = pbody == _vf->_robot;
+                const size_t numlinks = max(pbody->GetLinks().size(), state.vlinkflags.size());
+                for(size_t ilink = 0; ilink < numlinks; ++ilink) {
+                    const bool bHasLink = ilink < pbody->GetLinks().size(), bHadLink = ilink < state.vlinkflags.size();
+                    const KinBody::LinkPtr plink = bHasLink ? pbody->GetLinks()[ilink] : KinBody::LinkPtr();
+                    const uint8_t flags = bHasLink ? _GetVisibilityMapLinkFlags(*plink) : 0;
+                    const bool bCarried = bCarrier && bHadLink && ilink < visibilitymap.vcarriedlinks.size() && visibilitymap.vcarriedlinks[ilink];
+                    if( bHasLink && bHadLink && !bGeometryChanged && flags == state.vlinkflags[ilink] ) {
+                        if( bCarried ) {
+                            if( _IsSameVisibilityMapTransform(tCameraInv*plink->GetTransform(), visibilitymap.vcarriedlinkposes[ilink]) ) {
+                                continue;
+                            }
+                        }
+                        else if( !bMoved || _IsSameVisibilityMapTransform(plink->GetTransform(), state.vlinktransforms[ilink]) ) {
+                            continue;
+                        }
+                    }
+
+                    if( bHadLink && (state.vlinkflags[ilink] & 1) ) {
+                        if( bCarried ) {
+                            if( !_IsBoxOutsidePlanes(visibilitymap.vcarriedlinklocalaabbs[ilink], tCamera*visibilitymap.vcarriedlinkposes[ilink], vrayplanes) ) {
+                                return true;
+                            }
+                        }
+                        else if( !_IsBoxOutsidePlanes(state.vlinkaabbs[ilink], Transform(), vrayplanes) ) {
+                            return true;
+                        }
+                    }
+                    if( (flags & 1) && !_IsBoxOutsidePlanes(plink->ComputeAABB(), Transform(), vrayplanes) ) {
+                        return true;
+                    }
+                }
+            }
+
+            // removed after the map was built
+            for(size_t istate = 0; istate < visibilitymap.vbodystates.size(); ++istate) {
+                if( !_vvisitedbodystates[istate] ) {
+                    const VisibilityMapBodyState& state = visibilitymap.vbodystates[istate];
+                    for(size_t ilink = 0; ilink < state.vlinkflags.size(); ++ilink) {
+                        if( (state.vlinkflags[ilink] & 1) && !_IsBoxOutsidePlanes(state.vlinkaabbs[ilink], Transform(), vrayplanes) ) {
+                            return true;
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+
         /// \brief return true if not occluded by any other target (ray hits the intended target box)
         ///
         /// \brief v is in camera coordinate system
@@ -545,6 +748,8 @@ private:
         AABB _abTarget;         // local aabb in the targetlink coordinate system
         vector<Vector> _vconvexplanes3d; ///< the convex planes of the camera in the target link coordinate system
         PlannerBase::PlannerParameters::CheckPathVelocityConstraintFn _oldfn;
+        vector<KinBodyPtr> _vbodies; ///< cache
+        vector<uint8_t> _vvisitedbodystates; ///< cache
     };
 
     class GoalSampleFunction
@@ -581,7 +786,7 @@ public:
         bool SampleWithParameters(int isample, vector<dReal>& pNewSample, bool bOutputError, std::string& errormsg)
         {
             TransformMatrix tcamera = _ttarget*_visibilitytransforms.at(isample);
-            return _vconstraint.SampleWithCamera(tcamera,pNewSample, bOutputError, errormsg);
+            return _vconstraint.SampleWithCamera(tcamera,pNewSample, bOutputError, errormsg, isample);
         }
 
         VisibilityConstraintFunction _vconstraint;
@@ -614,6 +819,11 @@ Visibility computation checks occlusion with other objects using ray sampling in
         _fSampleRayDensity = 0.001;
         _fAllowableOcclusion = 0.1;
         _fRayMinDist = 0.02f;
+        _bUseVisibilityMap = true;
+        _nVisibilityMapHits = 0;
+        _nVisibilityMapRetests = 0;
+        _nVisibilityMapUseCount = 0;
+        _nMaxVisibilityMaps = 8;
 
         RegisterCommand("SetCameraAndTarget",boost::bind(&VisualFeedback::SetCameraAndTarget,this,_1,_2),
                         "Sets the camera index from the robot and its convex hull");
@@ -636,6 +846,14 @@ Visibility computation checks occlusion with other objects using ray sampling in
                         "Stochastic greedy grasp planner considering visibility");
         RegisterCommand("SetParameter",boost::bind(&VisualFeedback::SetParameter,this,_1,_2),
                         "Sets internal parameters of visibility computation");
+        RegisterCommand("BuildVisibilityMap",boost::bind(&VisualFeedback::BuildVisibilityMap,this,_1,_2),
+                        "Computes the occlusion of every camera transform for the current target pose in parallel so that goal sampling only has to shoot rays again for the camera transforms whose rays can hit bodies that changed since. Maps are cached by the hash of the target geometry, the camera and the camera transforms, and a cached map is only used if it was built for the same target link, camera and number of camera transforms. Returns the number of camera transforms and the number of occluded ones.\n\
+\n\
+:param numthreads: number of threads to build with, 0 (default) uses all threads of the thread pool\n\
+:param force: if 1, builds the map even if there is a cached one\n\
+:param maxcachedmaps: number of maps kept in the cache (default 8), the least recently used map is dropped first");
+        RegisterCommand("ClearVisibilityMaps",boost::bind(&VisualFeedback::ClearVisibilityMaps,this,_1,_2),
+                        "Removes the current and all cached visibility maps");
     }
 
     virtual ~VisualFeedback() {
@@ -651,6 +869,8 @@ Visibility computation checks occlusion with other objects using ray sampling in
         _pmanip.reset();
         _pcamerageom.reset();
         _visibilitytransforms.clear();
+        _pvisibilitymap.reset();
+        _mapVisibilityMaps.clear();
         _preport.reset();
         ModuleBase::Destroy();
     }
@@ -697,6 +917,7 @@ Visibility computation checks occlusion with other objects using ray sampling in
         _pcamerageom.reset();
         _targetlink.reset();
         _targetGeomName.clear();
+        _pvisibilitymap.reset();
         RobotBase::AttachedSensorPtr psensor;
         RobotBase::ManipulatorPtr pmanip;
         _sensorrobot = _robot;
@@ -1106,6 +1327,7 @@ Visibility computation checks occlusion with other objects using ray sampling in
     {
         string cmd;
         _visibilitytransforms.resize(0);
+        _pvisibilitymap.reset();
         dReal mindist = 0;
         while(!sinput.eof()) {
             sinput >> cmd;
@@ -1181,12 +1403,18 @@ Visibility computation checks occlusion with other objects using ray sampling in
 
             if( cmd == "raydensity" ) {
                 sinput >> _fSampleRayDensity;
+                _pvisibilitymap.reset();
             }
             else if( cmd == "raymindist") {
                 sinput >> _fRayMinDist;
+                _pvisibilitymap.reset();
             }
             else if( cmd == "allowableocclusion" ) {
                 sinput >> _fAllowableOcclusion;
+                _pvisibilitymap.reset();
+            }
+            else if( cmd == "usevisibilitymap" ) {
+                sinput >> _bUseVisibilityMap;
             }
             else {
                 RAVELOG_WARN(str(boost::format("unrecognized command: %s\n")%cmd));
@@ -1201,6 +1429,89 @@ Visibility computation checks occlusion with other objects using ray sampling in
         return true;
     }
 
+    bool BuildVisibilityMap(ostream& sout, istream& sinput)
+    {
+        string cmd;
+        int numthreads = 0;
+        bool bForce = false;
+        while(!sinput.eof()) {
+            sinput >> cmd;
+            if( !sinput ) {
+                break;
+            }
+            std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+
+            if( cmd == "numthreads" ) {
+                sinput >> numthreads;
+            }
+            else if( cmd == "force" ) {
+                sinput >> bForce;
+            }
+            else if( cmd == "maxcachedmaps" ) {
+                sinput >> _nMaxVisibilityMaps;
+            }
+            else {
+                RAVELOG_WARN(str(boost::format("unrecognized command: %s\n")%cmd));
+                break;
+            }
+
+            if( !sinput ) {
+                RAVELOG_ERROR(str(boost::format("failed processing command %s\n")%cmd));
+                return false;
+            }
+        }
+
+        if( !_targetlink || !_psensor || _visibilitytransforms.size() == 0 ) {
+            RAVELOG_WARN("camera, target and camera transforms need to be set before building a visibility map\n");
+            return false;
+        }
+        if( _sensorrobot != _robot ) {
+            // goal sampling moves the target with the robot, so the target never stays at the pose of the map
+            RAVELOG_WARN_FORMAT("visibility map needs the camera to be on robot %s", _robot->GetName());
+            return false;
+        }
+
+        const uint64_t key = _ComputeVisibilityMapKey();
+        std::map<uint64_t, VisibilityMapPtr>::iterator itmap = _mapVisibilityMaps.find(key);
+        if( !bForce && itmap != _mapVisibilityMaps.end() && _IsSameVisibilityMapIdentity(*itmap->second) && _IsSameVisibilityMapTransform(itmap->second->tTargetInWorld, _targetlink->GetTransform()) ) {
+            RAVELOG_DEBUG("using cached visibility map\n");
+            _pvisibilitymap = itmap->second;
+        }
+        else {
+            _pvisibilitymap = _BuildVisibilityMap(numthreads);
+            if( itmap == _mapVisibilityMaps.end() ) {
+                // drop the least recently used maps, every map holds one cell per camera transform
+                while( _mapVisibilityMaps.size() > 0 && (int)_mapVisibilityMaps.size() >= max(1, _nMaxVisibilityMaps) ) {
+                    std::map<uint64_t, VisibilityMapPtr>::iterator itoldest = _mapVisibilityMaps.begin();
+                    for(std::map<uint64_t, VisibilityMapPtr>::iterator itcached = _mapVisibilityMaps.begin(); itcached != _mapVisibilityMaps.end(); ++itcached) {
+                        if( itcached->second->nLastUsed < itoldest->second->nLastUsed ) {
+                            itoldest = itcached;
+                        }
+                    }
+                    _mapVisibilityMaps.erase(itoldest);
+                }
+            }
+            _mapVisibilityMaps[key] = _pvisibilitymap;
+        }
+        _pvisibilitymap->nLastUsed = ++_nVisibilityMapUseCount;
+
+        int numoccluded = 0;
+        FOREACHC(itcell, _pvisibilitymap->vcells) {
+            if( itcell->bOccluded ) {
+                ++numoccluded;
+            }
+        }
+        sout << _pvisibilitymap->vcells.size() << " " << numoccluded;
+        return true;
+    }
+
+    bool ClearVisibilityMaps(ostream& sout, istream& sinput)
+    {
+        _pvisibilitymap.reset();
+        _mapVisibilityMaps.clear();
+        return true;
+    }
+
     bool ComputeVisibleConfiguration(ostream& sout, istream& sinput)
     {
         string cmd;
@@ -1298,6 +1609,7 @@ Visibility computation checks occlusion with other objects using ray sampling in
         boost::shared_ptr<GoalSampleFunction> pgoalsampler(new GoalSampleFunction(shared_problem(),_visibilitytransforms));
 
         uint64_t starttime = utils::GetMicroTime();
+        const uint64_t nVisibilityMapHits = _nVisibilityMapHits, nVisibilityMapRetests = _nVisibilityMapRetests;
         vector<dReal> vsample;
         vector<dReal> vsamples(_robot->GetActiveDOF()*numsamples);
         int numsampled = 0;
@@ -1313,6 +1625,9 @@ Visibility computation checks occlusion with other objects using ray sampling in
         }
         float felapsed = (utils::GetMicroTime()-starttime)*1e-6f;
         RAVELOG_INFO("total time for %d samples is %fs, %f avg\n", numsamples,felapsed,felapsed/numsamples);
+        if( !!_pvisibilitymap && _bUseVisibilityMap ) {
+            RAVELOG_INFO_FORMAT("visibility map answered %d occlusion checks, %d had to shoot rays", (_nVisibilityMapHits-nVisibilityMapHits)%(_nVisibilityMapRetests-nVisibilityMapRetests));
+        }
         sout << numsampled << " ";
         for(int i = 0; i < numsampled*_robot->GetActiveDOF(); ++i) {
             sout << vsamples[i] << " ";
@@ -1555,6 +1870,206 @@ Visibility computation checks occlusion with other objects using ray sampling in
     }
 
 protected:
+    /// \brief hash of everything the cells of a visibility map depend on other than the state of the environment
+    uint64_t _ComputeVisibilityMapKey() const
+    {
+        uint64_t key = _targetlink->GetParent()->GetKinematicsGeometryDigest();
+        key = utils::CombineFastHash(key, _targetlink->GetIndex());
+        key = utils::CombineFastHash(key, utils::GetFastHash(_targetGeomName));
+        key = utils::CombineFastHash(key, _sensorrobot->GetKinematicsGeometryDigest());
+        key = utils::CombineFastHash(key, utils::GetFastHash(_psensor->GetName()));
+        key = utils::CombineFastHash(key, utils::GetFastHash(!!_pmanip ? _pmanip->GetName() : std::string()));
+        const dReal params[5] = { _fSampleRayDensity, _fAllowableOcclusion, _fRayMinDist, dReal(_bIgnoreSensorCollision), dReal(_bCameraOnManip) };
+        key = utils::GetFastHash((const uint8_t*)params, sizeof(params), key);
+        return utils::GetFastHash((const uint8_t*)&_visibilitytransforms[0], _visibilitytransforms.size()*sizeof(Transform), key);
+    }
+
+    /// \brief true if the map was built for the current target, camera and number of camera transforms, guards against collisions of _ComputeVisibilityMapKey
+    bool _IsSameVisibilityMapIdentity(const VisibilityMap& visibilitymap) const
+    {
+        return visibilitymap.ptargetlink.lock() == _targetlink && visibilitymap.targetgeomname == _targetGeomName && visibilitymap.psensor.lock() == _psensor && visibilitymap.numtransforms == _visibilitytransforms.size();
+    }
+
+    /// \brief computes the visibility map of _visibilitytransforms for the current state of the environment
+    ///
+    /// \param numthreads if not 1, the cells are split among that many clones of the environment, 0 uses all threads of the thread pool
+    VisibilityMapPtr _BuildVisibilityMap(int numthreads)
+    {
+        uint64_t starttime = utils::GetMicroTime();
+        VisibilityMapPtr pvisibilitymap(new VisibilityMap());
+        VisibilityMap& visibilitymap = *pvisibilitymap;
+        visibilitymap.ptargetlink = _targetlink;
+        visibilitymap.targetgeomname = _targetGeomName;
+        visibilitymap.psensor = _psensor;
+        visibilitymap.numtransforms = _visibilitytransforms.size();
+        visibilitymap.tTargetInWorld = _targetlink->GetTransform();
+
+        std::vector<KinBodyPtr> vbodies;
+        GetEnv()->GetBodies(vbodies);
+        visibilitymap.vbodystates.resize(vbodies.size());
+        for(size_t ibody = 0; ibody < vbodies.size(); ++ibody) {
+            const KinBodyPtr& pbody = vbodies[ibody];
+            VisibilityMapBodyState& state = visibilitymap.vbodystates[ibody];
+            state.pbody = pbody;
+            state.updatestamp = pbody->GetUpdateStamp();
+            state.geometrydigest = pbody->GetKinematicsGeometryDigest();
+            state.vlinktransforms.resize(pbody->GetLinks().size());
+            state.vlinkaabbs.resize(pbody->GetLinks().size());
+            state.vlinkflags.resize(pbody->GetLinks().size());
+            for(size_t ilink = 0; ilink < pbody->GetLinks().size(); ++ilink) {
+                const KinBody::Link& link = *pbody->GetLinks()[ilink];
+                state.vlinktransforms[ilink] = link.GetTransform();
+                state.vlinkaabbs[ilink] = link.ComputeAABB();
+                state.vlinkflags[ilink] = _GetVisibilityMapLinkFlags(link);
+            }
+            const int bodyindex = pbody->GetEnvironmentBodyIndex();
+            if( bodyindex >= (int)visibilitymap.vbodystateindices.size() ) {
+                visibilitymap.vbodystateindices.resize(bodyindex+1, -1);
+            }
+            visibilitymap.vbodystateindices.at(bodyindex) = ibody;
+        }
+
+        // links that move with the camera are placed at every camera transform of the cells
+        std::vector<KinBody::LinkPtr> vcarriedlinks;
+        _psensor->GetAttachingLink()->GetRigidlyAttachedLinks(vcarriedlinks);
+        if( _bCameraOnManip ) {
+            std::vector<KinBody::LinkPtr> vchildlinks;
+            _pmanip->GetChildLinks(vchildlinks);
+            FOREACH(itlink, vchildlinks) {
+                if( find(vcarriedlinks.begin(), vcarriedlinks.end(), *itlink) == vcarriedlinks.end() ) {
+                    vcarriedlinks.push_back(*itlink);
+                }
+            }
+        }
+        const Transform tSensorInv = _psensor->GetTransform().inverse();
+        visibilitymap.vcarriedlinks.resize(_robot->GetLinks().size(), 0);
+        visibilitymap.vcarriedlinkposes.resize(_robot->GetLinks().size());
+        visibilitymap.vcarriedlinklocalaabbs.resize(_robot->GetLinks().size());
+        FOREACHC(itlink, vcarriedlinks) {
+            const int linkindex = (*itlink)->GetIndex();
+            visibilitymap.vcarriedlinks.at(linkindex) = 1;
+            visibilitymap.vcarriedlinkposes[linkindex] = tSensorInv*(*itlink)->GetTransform();
+            visibilitymap.vcarriedlinklocalaabbs[linkindex] = (*itlink)->ComputeLocalAABB();
+        }
+
+        visibilitymap.vcells.resize(_visibilitytransforms.size());
+        for(size_t icell = 0; icell < visibilitymap.vcells.size(); ++icell) {
+            visibilitymap.vcells[icell].tCameraInTarget = _visibilitytransforms[icell];
+        }
+
+        int numworkers = numthreads > 0 ? numthreads : RaveGetThreadPool()->GetNumThreads();
+        numworkers = max(1, min(numworkers, (int)visibilitymap.vcells.size()));
+        if( numworkers == 1 ) {
+            RobotBase::RobotStateSaver saver(_robot, KinBody::Save_LinkTransformation);
+            VisibilityConstraintFunction constraintfn(shared_problem());
+            FOREACH(itcell, visibilitymap.vcells) {
+                _ComputeVisibilityMapCell(constraintfn, visibilitymap, *itcell);
+            }
+        }
+        else {
+            // every worker checks its cells on its own clone, the clones are only used for this map
+            std::vector<EnvironmentBasePtr> vclones;
+            std::vector< boost::shared_ptr<VisualFeedback> > vclonemodules;
+            try {
+                for(int iworker = 0; iworker < numworkers; ++iworker) {
+                    vclones.push_back(GetEnv()->CloneSelf(Clone_Bodies));
+                    vclonemodules.push_back(_CloneForEnvironment(vclones.back()));
+                }
+                std::atomic<size_t> nextcell(0);
+                RaveGetThreadPool()->ParallelFor(numworkers, [&](size_t iworker) {
+                    EnvironmentLock lockclone(vclones.at(iworker)->GetMutex());
+                    VisualFeedback& clonemodule = *vclonemodules.at(iworker);
+                    VisibilityConstraintFunction constraintfn(vclonemodules[iworker]);
+                    for(size_t icell = nextcell++; icell < visibilitymap.vcells.size(); icell = nextcell++) {
+                        clonemodule._ComputeVisibilityMapCell(constraintfn, visibilitymap, visibilitymap.vcells[icell]);
+                    }
+                });
+            }
+            catch(...) {
+                vclonemodules.clear();
+                FOREACH(itclone, vclones) {
+                    (*itclone)->Destroy();
+                }
+                throw;
+            }
+            vclonemodules.clear();
+            FOREACH(itclone, vclones) {
+                (*itclone)->Destroy();
+            }
+        }
+
+        RAVELOG_INFO_FORMAT("built visibility map of %d camera transforms with %d threads in %fs", visibilitymap.vcells.size()%numworkers%((utils::GetMicroTime()-starttime)*1e-6));
+        return pvisibilitymap;
+    }
+
+    /// \brief places the links carried by the camera at the camera transform of the cell and computes the cell
+    void _ComputeVisibilityMapCell(VisibilityConstraintFunction& constraintfn, const VisibilityMap& visibilitymap, VisibilityMapCell& cell)
+    {
+        const Transform tCamera = _targetlink->GetTransform()*cell.tCameraInTarget;
+        for(size_t ilink = 0; ilink < visibilitymap.vcarriedlinks.size(); ++ilink) {
+            if( visibilitymap.vcarriedlinks[ilink] ) {
+                _robot->GetLinks().at(ilink)->SetTransform(tCamera*visibilitymap.vcarriedlinkposes[ilink]);
+            }
+        }
+        constraintfn.ComputeVisibilityMapCell(cell);
+    }
+
+    /// \brief creates a module with the same camera and target set on the bodies of penv, penv has to be a clone of the environment of this module
+    boost::shared_ptr<VisualFeedback> _CloneForEnvironment(EnvironmentBasePtr penv) const
+    {
+        boost::shared_ptr<VisualFeedback> pclone(new VisualFeedback(penv));
+        pclone->_robot = penv->GetRobot(_robot->GetName());
+        pclone->_sensorrobot = penv->GetRobot(_sensorrobot->GetName());
+        KinBodyPtr ptarget = penv->GetKinBody(_targetlink->GetParent()->GetName());
+        OPENRAVE_ASSERT_FORMAT(!!pclone->_robot && !!pclone->_sensorrobot && !!ptarget, "robot %s or target %s is not in the cloned environment", _robot->GetName()%_targetlink->GetParent()->GetName(), ORE_InvalidState);
+        pclone->_targetlink = ptarget->GetLinks().at(_targetlink->GetIndex());
+        pclone->_targetGeomName = _targetGeomName;
+        pclone->_bIgnoreSensorCollision = _bIgnoreSensorCollision;
+        pclone->_fMaxVelMult = _fMaxVelMult;
+        pclone->_psensor = pclone->_sensorrobot->GetAttachedSensor(_psensor->GetName());
+        if( !!_pmanip ) {
+            pclone->_pmanip = pclone->_robot->GetManipulator(_pmanip->GetName());
+        }
+        pclone->_bCameraOnManip = _bCameraOnManip;
+        pclone->_pcamerageom = _pcamerageom;
+        pclone->_tToManip = _tToManip;
+        pclone->_fRayMinDist = _fRayMinDist;
+        pclone->_fAllowableOcclusion = _fAllowableOcclusion;
+        pclone->_fSampleRayDensity = _fSampleRayDensity;
+        pclone->_vconvexplanes = _vconvexplanes;
+        pclone->_vcenterconvex = _vcenterconvex;
+        return pclone;
+    }
+
+    /// \brief 1 if the link is enabled, 2 if it is visible (invisible links can be ignored by the ray checks)
+    static uint8_t _GetVisibilityMapLinkFlags(const KinBody::Link& link)
+    {
+        return (link.IsEnabled() ? 1 : 0)|(link.IsVisible() ? 2 : 0);
+    }
+
+    /// \brief true if the transforms are the same up to the precision of the ik solutions that place the camera
+    static bool _IsSameVisibilityMapTransform(const Transform& t0, const Transform& t1)
+    {
+        const dReal fthresh = 1e-8;
+        if( (t0.trans-t1.trans).lengthsqr3() > fthresh ) {
+            return false;
+        }
+        return (t0.rot-t1.rot).lengthsqr4() <= fthresh || (t0.rot+t1.rot).lengthsqr4() <= fthresh;
+    }
+
+    /// \brief true if the box ab transformed by t is completely on the negative side of one of the 6 planes
+    static bool _IsBoxOutsidePlanes(const AABB& ab, const Transform& t, const Vector* pplanes)
+    {
+        const Vector vpos = t*ab.pos, vx = t.rotate(Vector(ab.extents.x,0,0)), vy = t.rotate(Vector(0,ab.extents.y,0)), vz = t.rotate(Vector(0,0,ab.extents.z));
+        for(int iplane = 0; iplane < 6; ++iplane) {
+            const Vector& vplane = pplanes[iplane];
+            if( vplane.dot3(vpos) + vplane.w + RaveFabs(vplane.dot3(vx)) + RaveFabs(vplane.dot3(vy)) + RaveFabs(vplane.dot3(vz)) < 0 ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     RobotBasePtr _robot, _sensorrobot;
     bool _bIgnoreSensorCollision; ///< if true will ignore any collisions with vf->_sensorrobot
     KinBody::LinkPtr _targetlink; ///< the link where the verification pattern is attached
@@ -1568,6 +2083,13 @@ protected:
     vector<Transform> _visibilitytransforms; ///< the transform with respect to the targetlink and camera (or vice-versa)
     dReal _fRayMinDist, _fAllowableOcclusion, _fSampleRayDensity;
 
+    std::map<uint64_t, VisibilityMapPtr> _mapVisibilityMaps; ///< built visibility maps by _ComputeVisibilityMapKey, at most _nMaxVisibilityMaps of them
+    int _nMaxVisibilityMaps; ///< number of visibility maps kept in _mapVisibilityMaps
+    uint64_t _nVisibilityMapUseCount; ///< incremented every time a visibility map is built or looked up, see VisibilityMap::nLastUsed
+    VisibilityMapPtr _pvisibilitymap; ///< map of the current camera transforms, reset whenever they or the camera, target or ray parameters change
+    bool _bUseVisibilityMap; ///< if false, goal sampling ignores _pvisibilitymap
+    uint64_t _nVisibilityMapHits, _nVisibilityMapRetests; ///< occlusion checks answered by _pvisibilitymap and checks that had to shoot rays again
+
     CollisionReportPtr _preport;
 
     vector<Vector> _vconvexplanes;     ///< the planes defining the bounding visibility region (posive is inside). Inside camera coordinate system
@@ -0,0 +1,655 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "rrt.h"
+
+#include <cmath>
+
+namespace rplanners {
+
+/// \brief Informed RRT*. Keeps growing and rewiring one tree from the initial configurations after the first solution, sampling only the states that can shorten the best path.
+class InformedRrtStarPlanner : public RrtPlanner<SimpleNode>
+{
+    /// \brief vertex of the RRT* tree.
+    ///
+    /// The parents are kept here instead of in SimpleNode::rrtparent since rewiring changes them and the cover tree can hold several clones of a node. The _userdata of the nodes is the vertex index.
+    struct Vertex
+    {
+        Vertex() : pnode(NULL), parent(-1), cost(0) {
+        }
+        SimpleNode* pnode; ///< node holding the configuration, NULL if the configuration could not be inserted
+        int parent; ///< index of the parent vertex, -1 for the roots
+        dReal cost; ///< distance along the tree from the root
+        std::vector<int> children;
+    };
+
+public:
+    InformedRrtStarPlanner(EnvironmentBasePtr penv) : RrtPlanner<SimpleNode>(penv)
+    {
+        __description = ":Interface Author: Rosen Diankov\n\n\
+Informed RRT*, an anytime planner whose path converges to the shortest one for the distance metric of the parameters. See\n\n\
+- S. Karaman and E. Frazzoli. Sampling-based algorithms for optimal motion planning. International Journal of Robotics Research, 30(7):846-894, 2011.\n\
+- J.D. Gammell, S.S. Srinivasa and T.D. Barfoot. Informed RRT*: Optimal sampling-based path planning focused via direct sampling of an admissible ellipsoidal heuristic. In Proc. IEEE/RSJ Int'l Conf. on Intelligent Robots and Systems (IROS), 2014.\n\n\
+Takes RRTParameters. Planning continues after the first solution until _nMaxPlanningTime or _nMaxIterations is reached, a callback returns PA_ReturnWithAnySolution, or the path is a straight line. \
+Once there is a solution, states are sampled directly from the ellipsoid of the states that can shorten it, which assumes the distance metric is a weighted euclidean distance like the default one. \
+With RRTParameters::_bInformedSampling set to false, the whole space keeps being sampled like plain RRT*. \
+Every time the solution improves, the callbacks receive its cost and waypoints in PlannerProgress::_fSolutionCost and PlannerProgress::_vSolutionConfigs.";
+        RegisterCommand("GetSolutionCost",boost::bind(&InformedRrtStarPlanner::_GetSolutionCostCommand,this,_1,_2),
+                        "returns the cost of the path returned by the last plan, -1 if there is none");
+        _fGoalBiasProb = dReal(0.05);
+        _fExtendDistance = 0;
+        _fLogRewireGamma = 0;
+        _fLogSpaceVolume = 0;
+        _fLogUnitBallVolume = 0;
+        _fBestCost = -1;
+        _bEllipsoidSampling = false;
+    }
+    virtual ~InformedRrtStarPlanner() {
+    }
+
+    virtual PlannerStatus InitPlan(RobotBasePtr pbase, PlannerParametersConstPtr pparams) override
+    {
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        _parameters.reset(new RRTParameters());
+        _parameters->copy(pparams);
+        _fBestCost = -1;
+        PlannerStatus status = RrtPlanner<SimpleNode>::_InitPlan(pbase,_parameters);
+        if( !(status.GetStatusCode() & PS_HasSolution) ) {
+            _parameters.reset();
+            return status;
+        }
+
+        PlannerParameters::StateSaver savestate(_parameters);
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+        const int dof = _parameters->GetDOF();
+
+        // _InitPlan inserted the initial configurations with _userdata set to their index, so they are the first vertices
+        _vvertices.resize(0);
+        _vrootvertices.resize(0);
+        for(size_t index = 0; index < _vecInitialNodes.size(); ++index) {
+            _vvertices.push_back(Vertex());
+            _vvertices.back().pnode = (SimpleNode*)_vecInitialNodes[index];
+            _vrootvertices.push_back(!!_vecInitialNodes[index] ? (int)index : -1);
+        }
+
+        if( (_parameters->vgoalconfig.size() % dof) != 0 ) {
+            std::string msg = "env=" + GetEnv()->GetNameId() + ", InformedRrtStarPlanner::InitPlan - Error: goals are improperly specified";
+            RAVELOG_ERROR(msg);
+            _parameters.reset();
+            return PlannerStatus(msg, PS_Failed|PS_FailedDueToGoal);
+        }
+        _vgoals.resize(0);
+        _vgoalvertices.resize(0);
+        int nvalidgoals = 0;
+        std::vector<dReal> vgoal(dof);
+        for(size_t igoal = 0; igoal < _parameters->vgoalconfig.size(); igoal += dof) {
+            std::copy(_parameters->vgoalconfig.begin()+igoal,_parameters->vgoalconfig.begin()+igoal+dof,vgoal.begin());
+            int ret = _parameters->CheckPathAllConstraints(vgoal,vgoal,std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart);
+            if( ret == 0 ) {
+                _vgoals.push_back(vgoal);
+                ++nvalidgoals;
+            }
+            else {
+                RAVELOG_WARN_FORMAT("env=%s, goal %d fails constraints with 0x%x", GetEnv()->GetNameId()%(igoal/dof)%ret);
+                _vgoals.push_back(std::vector<dReal>()); // keep the indices of the goals
+            }
+            _vgoalvertices.push_back(-1);
+        }
+        if( nvalidgoals == 0 && !_parameters->_samplegoalfn ) {
+            std::string msg = "env=" + GetEnv()->GetNameId() + ", no goals specified";
+            RAVELOG_WARN(msg);
+            _parameters.reset();
+            return PlannerStatus(msg, PS_Failed|PS_FailedDueToGoal);
+        }
+
+        if( _parameters->_nMaxIterations <= 0 ) {
+            _parameters->_nMaxIterations = 10000;
+        }
+
+        dReal fMaxDistance = _parameters->_distmetricfn(_parameters->_vConfigLowerLimit, _parameters->_vConfigUpperLimit);
+        _fExtendDistance = max(_parameters->_fStepLength, dReal(0.2)*fMaxDistance);
+        _InitInformedSampling();
+
+        RAVELOG_DEBUG_FORMAT("env=%s, InformedRRT* initialized, initial=%d, goals=%d, extend distance=%f, informed sampling=%d, ellipsoid sampling=%d", GetEnv()->GetNameId()%_vecInitialNodes.size()%nvalidgoals%_fExtendDistance%_parameters->_bInformedSampling%_bEllipsoidSampling);
+        return PlannerStatus(PS_HasSolution);
+    }
+
+    virtual PlannerStatus PlanPath(TrajectoryBasePtr ptraj, int planningoptions) override
+    {
+        _goalindex = -1;
+        _startindex = -1;
+        if(!_parameters) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%s, InformedRrtStarPlanner::PlanPath - Error, planner not initialized")%GetEnv()->GetNameId()), PS_Failed);
+        }
+
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        uint64_t basetimeus = utils::GetMonotonicTime();
+        PlannerParameters::StateSaver savestate(_parameters);
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+
+        const int dof = _parameters->GetDOF();
+        std::vector<dReal> vsample(dof), vnew(dof), vconfig(dof);
+        PlannerProgress progress;
+        _fBestCost = -1;
+        int nbestgoal = -1;
+        int iter = 0;
+        for(iter = 0; iter < _parameters->_nMaxIterations; ++iter) {
+            progress._iteration = iter;
+            PlannerAction callbackaction = _CallCallbacks(progress);
+            if( callbackaction == PA_Interrupt ) {
+                return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%s, Planning was interrupted")%GetEnv()->GetNameId()), PS_Interrupted);
+            }
+            else if( callbackaction == PA_ReturnWithAnySolution ) {
+                if( nbestgoal >= 0 ) {
+                    break;
+                }
+            }
+
+            if( _parameters->_nMaxPlanningTime > 0 ) {
+                uint64_t elapsedtime = utils::GetMonotonicTime()-basetimeus;
+                if( elapsedtime >= 1000*_parameters->_nMaxPlanningTime ) {
+                    RAVELOG_DEBUG_FORMAT("env=%s, time exceeded (%d[us] > %d[us]) so breaking. iter=%d < %d", GetEnv()->GetNameId()%elapsedtime%(1000*_parameters->_nMaxPlanningTime)%iter%_parameters->_nMaxIterations);
+                    break;
+                }
+            }
+
+            if( !!_parameters->_samplegoalfn ) {
+                std::vector<dReal> vgoal;
+                if( _parameters->_samplegoalfn(vgoal) ) {
+                    RAVELOG_VERBOSE_FORMAT("env=%s, inserting new goal index %d", GetEnv()->GetNameId()%_vgoals.size());
+                    _vgoals.push_back(vgoal);
+                    _vgoalvertices.push_back(-1);
+                    _UpdateInformedFoci();
+                }
+            }
+            if( !!_parameters->_sampleinitialfn ) {
+                std::vector<dReal> vinitial;
+                if( _parameters->_sampleinitialfn(vinitial) ) {
+                    RAVELOG_VERBOSE_FORMAT("env=%s, inserting new initial %d", GetEnv()->GetNameId()%_vecInitialNodes.size());
+                    SimpleNode* pnode = (SimpleNode*)_treeForward.InsertNode(NULL, vinitial, _vvertices.size());
+                    _vecInitialNodes.push_back(pnode);
+                    _vrootvertices.push_back(-1);
+                    if( !!pnode ) {
+                        _vrootvertices.back() = _AddVertex(pnode, -1, 0);
+                        _UpdateInformedFoci();
+                    }
+                }
+            }
+
+            if( !_SampleState(vsample) ) {
+                continue;
+            }
+
+            std::pair<NodeBasePtr, dReal> nn = _treeForward.FindNearestNode(vsample);
+            if( !nn.first ) {
+                continue;
+            }
+            int inearest = ((SimpleNode*)nn.first)->_userdata;
+            if( !_Steer(inearest, vsample, nn.second, vnew) ) {
+                continue;
+            }
+            _GetVertexConfig(inearest, vconfig);
+            if( !_CheckEdge(vconfig, vnew, IT_OpenStart) ) {
+                continue;
+            }
+
+            // choose the parent with the lowest cost among the near vertices, only checking the edges of the ones that beat the nearest
+            dReal fRadius = _ComputeRewireRadius();
+            _GetNearVertices(vnew, fRadius);
+            int iparent = inearest;
+            dReal fparentcost = _vvertices[inearest].cost + _parameters->_distmetricfn(vconfig, vnew);
+            _vcandidates.resize(0);
+            FOREACHC(itnear, _vnearvertices) {
+                dReal fcost = _vvertices[itnear->first].cost + itnear->second;
+                if( itnear->first != inearest && fcost < fparentcost ) {
+                    _vcandidates.emplace_back(fcost, itnear->first);
+                }
+            }
+            std::sort(_vcandidates.begin(), _vcandidates.end());
+            FOREACHC(itcandidate, _vcandidates) {
+                _GetVertexConfig(itcandidate->second, vconfig);
+                if( _CheckEdge(vconfig, vnew, IT_Open) ) {
+                    iparent = itcandidate->second;
+                    fparentcost = itcandidate->first;
+                    break;
+                }
+            }
+
+            SimpleNode* pnewnode = (SimpleNode*)_treeForward.InsertNode(NULL, vnew, _vvertices.size());
+            if( !pnewnode ) {
+                // too close to an existing node
+                continue;
+            }
+            int inew = _AddVertex(pnewnode, iparent, fparentcost);
+
+            // rewire the near vertices through the new one
+            FOREACHC(itnear, _vnearvertices) {
+                if( itnear->first == iparent ) {
+                    continue;
+                }
+                dReal fcost = _vvertices[inew].cost + itnear->second;
+                if( fcost < _vvertices[itnear->first].cost - g_fEpsilonLinear ) {
+                    _GetVertexConfig(itnear->first, vconfig);
+                    if( _CheckEdge(vnew, vconfig, IT_Open) ) {
+                        _ChangeParent(itnear->first, inew, fcost);
+                    }
+                }
+            }
+
+            _ConnectGoals(inew, vnew);
+
+            // the costs of connected goals can also decrease from rewiring their ancestors
+            int ibestgoal = -1;
+            for(size_t igoal = 0; igoal < _vgoalvertices.size(); ++igoal) {
+                if( _vgoalvertices[igoal] >= 0 && (ibestgoal < 0 || _vvertices[_vgoalvertices[igoal]].cost < _vvertices[_vgoalvertices[ibestgoal]].cost) ) {
+                    ibestgoal = igoal;
+                }
+            }
+            if( ibestgoal >= 0 && (nbestgoal < 0 || _vvertices[_vgoalvertices[ibestgoal]].cost < _fBestCost - g_fEpsilonLinear) ) {
+                nbestgoal = ibestgoal;
+                _fBestCost = _vvertices[_vgoalvertices[ibestgoal]].cost;
+                _ExtractPath(_vgoalvertices[ibestgoal], progress._vSolutionConfigs);
+                progress._fSolutionCost = _fBestCost;
+                _UpdateInformedFoci();
+                RAVELOG_DEBUG_FORMAT("env=%s, iter=%d, solution cost=%f to goal %d after %u[us], vertices=%d", GetEnv()->GetNameId()%iter%_fBestCost%ibestgoal%(utils::GetMonotonicTime()-basetimeus)%_vvertices.size());
+                if( _vinformedfoci.size() == 0 ) {
+                    // the path is a straight line, it cannot improve
+                    break;
+                }
+            }
+        }
+
+        if( nbestgoal < 0 ) {
+            uint64_t elapsedtimeus = utils::GetMonotonicTime()-basetimeus;
+            std::string description = str(boost::format(_("env=%s, plan failed in %u[us], iter=%d, nMaxIterations=%d"))%GetEnv()->GetNameId()%(elapsedtimeus)%iter%_parameters->_nMaxIterations);
+            RAVELOG_WARN(description);
+            return OPENRAVE_PLANNER_STATUS(description, PS_Failed);
+        }
+
+        // the path of progress can be older than the current best when the last improvement was from rewiring, so extract it again
+        std::vector<dReal> vpath;
+        int iroot = _ExtractPath(_vgoalvertices[nbestgoal], vpath);
+        _goalindex = nbestgoal;
+        _startindex = std::find(_vrootvertices.begin(), _vrootvertices.end(), iroot) - _vrootvertices.begin();
+        if( ptraj->GetConfigurationSpecification().GetDOF() == 0 ) {
+            ptraj->Init(_parameters->_configurationspecification);
+        }
+        ptraj->Insert(ptraj->GetNumWaypoints(), vpath, _parameters->_configurationspecification);
+        uint64_t elapsedtimeus = utils::GetMonotonicTime()-basetimeus;
+        RAVELOG_DEBUG_FORMAT("env=%s, plan success, iters=%d, path=%d points, cost=%f, vertices=%d, computation time=%u[us]", GetEnv()->GetNameId()%iter%ptraj->GetNumWaypoints()%_vvertices[_vgoalvertices[nbestgoal]].cost%_vvertices.size()%elapsedtimeus);
+        return _ProcessPostPlanners(_robot,ptraj);
+    }
+
+    virtual PlannerParametersConstPtr GetParameters() const override {
+        return _parameters;
+    }
+
+protected:
+    /// \brief computes the scales turning the distance metric into a euclidean distance, and the constants for the rewiring radius
+    void _InitInformedSampling()
+    {
+        const int dof = _parameters->GetDOF();
+        _bEllipsoidSampling = true;
+        _vmetricscales.resize(dof);
+        _fLogSpaceVolume = 0;
+        std::vector<dReal> vmiddle(dof), voffset(dof);
+        for(int idof = 0; idof < dof; ++idof) {
+            vmiddle[idof] = 0.5*(_parameters->_vConfigLowerLimit[idof] + _parameters->_vConfigUpperLimit[idof]);
+        }
+        for(int idof = 0; idof < dof; ++idof) {
+            dReal frange = _parameters->_vConfigUpperLimit[idof] - _parameters->_vConfigLowerLimit[idof];
+            dReal fdelta = 0.01*frange;
+            _vmetricscales[idof] = 0;
+            if( fdelta > 0 ) {
+                voffset = vmiddle;
+                voffset[idof] += fdelta;
+                _vmetricscales[idof] = _parameters->_distmetricfn(vmiddle, voffset)/fdelta;
+            }
+            if( !(_vmetricscales[idof] > 0) || !std::isfinite(_vmetricscales[idof]) ) {
+                // the metric ignores this dof or it has no range, so there is no ellipsoid to sample from
+                _bEllipsoidSampling = false;
+                _vmetricscales[idof] = 1;
+                frange = max(frange, dReal(1));
+            }
+            _fLogSpaceVolume += RaveLog(_vmetricscales[idof]*frange);
+        }
+
+        // gamma = 2*(1+1/d)^(1/d)*(volume/unitballvolume)^(1/d), see Karaman and Frazzoli
+        dReal fdof = dof;
+        dReal fLogUnitBallVolume = 0.5*fdof*RaveLog(PI) - std::lgamma(0.5*fdof+1);
+        _fLogRewireGamma = RaveLog(dReal(2)) + (RaveLog(1+1/fdof) + _fLogSpaceVolume - fLogUnitBallVolume)/fdof;
+        _fLogUnitBallVolume = fLogUnitBallVolume;
+        _vinformedfoci.resize(0);
+    }
+
+    /// \brief the radius of the neighborhood that is rewired, shrinks with the number of vertices
+    dReal _ComputeRewireRadius() const
+    {
+        dReal fnumvertices = _vvertices.size()+1;
+        dReal fradius = RaveExp(_fLogRewireGamma + RaveLog(RaveLog(fnumvertices)/fnumvertices)/_parameters->GetDOF());
+        return min(fradius, _fExtendDistance);
+    }
+
+    /// \brief recomputes the pairs of roots and goals whose ellipsoids can contain states that shorten the best solution
+    void _UpdateInformedFoci()
+    {
+        _vinformedfoci.resize(0);
+        if( _fBestCost < 0 ) {
+            return;
+        }
+        const int dof = _parameters->GetDOF();
+        std::vector<dReal> vroot(dof);
+        FOREACHC(itroot, _vrootvertices) {
+            if( *itroot < 0 ) {
+                continue;
+            }
+            _GetVertexConfig(*itroot, vroot);
+            for(size_t igoal = 0; igoal < _vgoals.size(); ++igoal) {
+                if( _vgoals[igoal].size() == 0 ) {
+                    continue;
+                }
+                dReal fmincost = _parameters->_distmetricfn(vroot, _vgoals[igoal]);
+                if( fmincost < _fBestCost - g_fEpsilonLinear ) {
+                    _vinformedfoci.push_back(std::make_pair(*itroot, (int)igoal));
+                }
+            }
+        }
+    }
+
+    /// \brief samples the next state to grow the tree toward
+    bool _SampleState(std::vector<dReal>& vsample)
+    {
+        if( _fBestCost < 0 ) {
+            if( _uniformsampler->SampleSequenceOneReal() < _fGoalBiasProb ) {
+                // toward one of the goals that are not connected yet
+                uint32_t goalindex = _uniformsampler->SampleSequenceOneUInt32()%max(size_t(1), _vgoals.size());
+                if( goalindex < _vgoals.size() && _vgoals[goalindex].size() > 0 && _vgoalvertices[goalindex] < 0 ) {
+                    vsample = _vgoals[goalindex];
+                    return true;
+                }
+            }
+            return _parameters->_samplefn(vsample);
+        }
+
+        if( _vinformedfoci.size() == 0 ) {
+            return false;
+        }
+        if( !_parameters->_bInformedSampling ) {
+            // plain RRT*, keeps sampling the whole space
+            return _parameters->_samplefn(vsample);
+        }
+        for(int itry = 0; itry < 100; ++itry) {
+            const std::pair<int, int>& foci = _vinformedfoci.at(_uniformsampler->SampleSequenceOneUInt32()%_vinformedfoci.size());
+            if( _bEllipsoidSampling ) {
+                if( !_SampleEllipsoid(foci.first, _vgoals[foci.second], vsample) ) {
+                    continue;
+                }
+            }
+            else if( !_parameters->_samplefn(vsample) ) {
+                continue;
+            }
+            if( _ComputeHeuristicCost(vsample) < _fBestCost ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// \brief samples uniformly the states x for which dist(root,x)+dist(x,goal) <= _fBestCost.
+    ///
+    /// The ellipsoid is sampled in the space scaled by _vmetricscales where the metric is euclidean. When it is larger than the configuration space, uniform sampling is used instead.
+    bool _SampleEllipsoid(int iroot, const std::vector<dReal>& vgoal, std::vector<dReal>& vsample)
+    {
+        const int dof = _parameters->GetDOF();
+        _GetVertexConfig(iroot, _vfocus);
+        _vcenter.resize(dof);
+        _vaxis.resize(dof);
+        dReal fmincost2 = 0;
+        for(int idof = 0; idof < dof; ++idof) {
+            _vcenter[idof] = 0.5*_vmetricscales[idof]*(_vfocus[idof] + vgoal[idof]);
+            _vaxis[idof] = _vmetricscales[idof]*(vgoal[idof] - _vfocus[idof]);
+            fmincost2 += _vaxis[idof]*_vaxis[idof];
+        }
+        dReal fmincost = RaveSqrt(fmincost2);
+        dReal fmajorradius = 0.5*_fBestCost;
+        dReal fminorradius = 0.5*RaveSqrt(max(dReal(0), _fBestCost*_fBestCost - fmincost2));
+        dReal fLogEllipsoidVolume = _fLogUnitBallVolume + RaveLog(fmajorradius) + (dof-1)*RaveLog(max(fminorradius, g_fEpsilon));
+        if( fLogEllipsoidVolume >= _fLogSpaceVolume || fmincost <= g_fEpsilon ) {
+            return _parameters->_samplefn(vsample);
+        }
+
+        // uniform sample in the unit ball from a normalized gaussian scaled by u^(1/dof)
+        _vball.resize(dof);
+        dReal fnorm2 = 0;
+        for(int idof = 0; idof < dof; ++idof) {
+            dReal u0 = 1-_uniformsampler->SampleSequenceOneReal();
+            dReal u1 = _uniformsampler->SampleSequenceOneReal();
+            _vball[idof] = RaveSqrt(-2*RaveLog(u0))*RaveCos(2*PI*u1);
+            fnorm2 += _vball[idof]*_vball[idof];
+        }
+        if( fnorm2 <= g_fEpsilon ) {
+            return false;
+        }
+        dReal fscale = RavePow(_uniformsampler->SampleSequenceOneReal(), dReal(1)/dof)/RaveSqrt(fnorm2);
+        _vball[0] *= fscale*fmajorradius;
+        for(int idof = 1; idof < dof; ++idof) {
+            _vball[idof] *= fscale*fminorradius;
+        }
+
+        // reflect the first axis onto the axis from the root to the goal, v = e0 - axis, H = I - 2*v*v^T/(v^T*v)
+        for(int idof = 0; idof < dof; ++idof) {
+            _vaxis[idof] = -_vaxis[idof]/fmincost;
+        }
+        _vaxis[0] += 1;
+        dReal fv2 = 0, fvdot = 0;
+        for(int idof = 0; idof < dof; ++idof) {
+            fv2 += _vaxis[idof]*_vaxis[idof];
+            fvdot += _vaxis[idof]*_vball[idof];
+        }
+        dReal freflect = fv2 > g_fEpsilon ? 2*fvdot/fv2 : dReal(0);
+
+        vsample.resize(dof);
+        for(int idof = 0; idof < dof; ++idof) {
+            vsample[idof] = (_vcenter[idof] + _vball[idof] - freflect*_vaxis[idof])/_vmetricscales[idof];
+            if( vsample[idof] < _parameters->_vConfigLowerLimit[idof] || vsample[idof] > _parameters->_vConfigUpperLimit[idof] ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// \brief lower bound of the cost of a path through vstate, the minimum over the informed foci
+    dReal _ComputeHeuristicCost(const std::vector<dReal>& vstate)
+    {
+        dReal fbest = std::numeric_limits<dReal>::infinity();
+        FOREACHC(itfoci, _vinformedfoci) {
+            _GetVertexConfig(itfoci->first, _vfocus);
+            dReal fcost = _parameters->_distmetricfn(_vfocus, vstate) + _parameters->_distmetricfn(vstate, _vgoals[itfoci->second]);
+            if( fcost < fbest ) {
+                fbest = fcost;
+            }
+        }
+        return fbest;
+    }
+
+    /// \brief moves from vertex ifrom toward vtarget by at most _fExtendDistance
+    bool _Steer(int ifrom, const std::vector<dReal>& vtarget, dReal fdist, std::vector<dReal>& vnew)
+    {
+        _GetVertexConfig(ifrom, _vfrom);
+        vnew = _vfrom;
+        _vdelta = vtarget;
+        _parameters->_diffstatefn(_vdelta, _vfrom);
+        if( fdist > _fExtendDistance ) {
+            dReal fmult = _fExtendDistance/fdist;
+            FOREACH(it, _vdelta) {
+                *it *= fmult;
+            }
+        }
+        if( _parameters->SetStateValues(vnew) != 0 ) {
+            return false;
+        }
+        if( _parameters->_neighstatefn(vnew, _vdelta, NSO_FromPathSampling) == NSS_Failed ) {
+            return false;
+        }
+        return _parameters->_distmetricfn(_vfrom, vnew) > dReal(0.01)*_parameters->_fStepLength;
+    }
+
+    /// \return true if the straight edge from vstart to vend satisfies all the constraints
+    bool _CheckEdge(const std::vector<dReal>& vstart, const std::vector<dReal>& vend, IntervalType interval)
+    {
+        if( _parameters->CheckPathAllConstraints(vstart, vend, std::vector<dReal>(), std::vector<dReal>(), 0, interval, 0xffff|CFO_FromPathSampling, _filterreturn) != 0 ) {
+            return false;
+        }
+        // the costs assume straight edges, so edges that the constraints deviate are not used
+        return !_filterreturn->_bHasRampDeviatedFromInterpolation;
+    }
+
+    /// \brief fills _vnearvertices with the vertices within fRadius of vstate and their distances, once per vertex
+    void _GetNearVertices(const std::vector<dReal>& vstate, dReal fRadius)
+    {
+        _treeForward.GetNodesWithinDistance(vstate, fRadius, _vnearnodes);
+        _vnearvertices.resize(0);
+        FOREACHC(itnode, _vnearnodes) {
+            _vnearvertices.emplace_back((int)itnode->first->_userdata, itnode->second);
+        }
+        std::sort(_vnearvertices.begin(), _vnearvertices.end());
+        _vnearvertices.erase(std::unique(_vnearvertices.begin(), _vnearvertices.end(), [](const std::pair<int, dReal>& a, const std::pair<int, dReal>& b) {
+            return a.first == b.first;
+        }), _vnearvertices.end());
+    }
+
+    /// \brief connects the goals within _fExtendDistance of the new vertex that are not part of the tree yet
+    void _ConnectGoals(int inew, const std::vector<dReal>& vnew)
+    {
+        for(size_t igoal = 0; igoal < _vgoals.size(); ++igoal) {
+            if( _vgoalvertices[igoal] >= 0 || _vgoals[igoal].size() == 0 ) {
+                continue;
+            }
+            dReal fdist = _parameters->_distmetricfn(vnew, _vgoals[igoal]);
+            if( fdist > _fExtendDistance || !_CheckEdge(vnew, _vgoals[igoal], IT_Open) ) {
+                continue;
+            }
+            SimpleNode* pgoalnode = (SimpleNode*)_treeForward.InsertNode(NULL, _vgoals[igoal], _vvertices.size());
+            if( !!pgoalnode ) {
+                _vgoalvertices[igoal] = _AddVertex(pgoalnode, inew, _vvertices[inew].cost + fdist);
+            }
+            else {
+                // a vertex is already at the goal
+                std::pair<NodeBasePtr, dReal> nn = _treeForward.FindNearestNode(_vgoals[igoal]);
+                if( !!nn.first ) {
+                    _vgoalvertices[igoal] = ((SimpleNode*)nn.first)->_userdata;
+                }
+            }
+        }
+    }
+
+    int _AddVertex(SimpleNode* pnode, int iparent, dReal fcost)
+    {
+        int ivertex = _vvertices.size();
+        _vvertices.push_back(Vertex());
+        _vvertices.back().pnode = pnode;
+        _vvertices.back().parent = iparent;
+        _vvertices.back().cost = fcost;
+        if( iparent >= 0 ) {
+            _vvertices[iparent].children.push_back(ivertex);
+        }
+        return ivertex;
+    }
+
+    /// \brief sets the parent of ivertex and updates the costs of its subtree
+    void _ChangeParent(int ivertex, int inewparent, dReal fnewcost)
+    {
+        int ioldparent = _vvertices[ivertex].parent;
+        if( ioldparent >= 0 ) {
+            std::vector<int>& vsiblings = _vvertices[ioldparent].children;
+            vsiblings.erase(std::find(vsiblings.begin(), vsiblings.end(), ivertex));
+        }
+        _vvertices[ivertex].parent = inewparent;
+        _vvertices[inewparent].children.push_back(ivertex);
+
+        dReal fdelta = fnewcost - _vvertices[ivertex].cost;
+        _vpropagate.resize(0);
+        _vpropagate.push_back(ivertex);
+        while(_vpropagate.size() > 0) {
+            int icurrent = _vpropagate.back();
+            _vpropagate.pop_back();
+            _vvertices[icurrent].cost += fdelta;
+            _vpropagate.insert(_vpropagate.end(), _vvertices[icurrent].children.begin(), _vvertices[icurrent].children.end());
+        }
+    }
+
+    inline void _GetVertexConfig(int ivertex, std::vector<dReal>& vconfig) const
+    {
+        const SimpleNode* pnode = _vvertices[ivertex].pnode;
+        vconfig.resize(_parameters->GetDOF());
+        std::copy(pnode->q, pnode->q+_parameters->GetDOF(), vconfig.begin());
+    }
+
+    /// \brief fills vpath with the waypoints from the root to ivertex
+    /// \return the root vertex
+    int _ExtractPath(int ivertex, std::vector<dReal>& vpath)
+    {
+        const int dof = _parameters->GetDOF();
+        _cachedpath.resize(0);
+        int icurrent = ivertex;
+        while(1) {
+            const SimpleNode* pnode = _vvertices[icurrent].pnode;
+            _cachedpath.insert(_cachedpath.begin(), pnode->q, pnode->q+dof);
+            if( _vvertices[icurrent].parent < 0 ) {
+                break;
+            }
+            icurrent = _vvertices[icurrent].parent;
+        }
+        vpath.resize(_cachedpath.size());
+        std::copy(_cachedpath.begin(), _cachedpath.end(), vpath.begin());
+        return icurrent;
+    }
+
+    bool _GetSolutionCostCommand(std::ostream& sout, std::istream& sinput)
+    {
+        sout << _fBestCost;
+        return !!sout;
+    }
+
+    RRTParametersPtr _parameters;
+    dReal _fGoalBiasProb;
+    dReal _fExtendDistance; ///< the maximum distance of a new vertex from its nearest vertex
+    dReal _fLogRewireGamma; ///< log of the constant of the rewiring radius
+    dReal _fLogSpaceVolume; ///< log of the volume of the configuration space scaled by _vmetricscales
+    dReal _fLogUnitBallVolume; ///< log of the volume of the unit ball of dimension dof
+    dReal _fBestCost; ///< cost of the best solution, -1 if there is none
+    bool _bEllipsoidSampling; ///< if false, the metric could not be approximated by a weighted euclidean distance and the informed states are found by rejection sampling
+    std::vector<dReal> _vmetricscales; ///< per dof scale so that the metric is the euclidean distance of the scaled states
+
+    std::vector<Vertex> _vvertices;
+    std::vector<int> _vrootvertices; ///< vertex of every initial configuration, -1 if it is not part of the tree
+    std::vector< std::vector<dReal> > _vgoals; ///< goal configurations, empty for the ones that fail the constraints
+    std::vector<int> _vgoalvertices; ///< vertex of every goal, -1 if it is not connected yet
+    std::vector< std::pair<int, int> > _vinformedfoci; ///< root vertex and goal index of the ellipsoids to sample from
+
+    // cache
+    std::vector< std::pair<SimpleNode*, dReal> > _vnearnodes;
+    std::vector< std::pair<int, dReal> > _vnearvertices;
+    std::vector< std::pair<dReal, int> > _vcandidates;
+    std::vector<int> _vpropagate;
+    std::vector<dReal> _vfrom, _vdelta, _vfocus, _vcenter, _vaxis, _vball;
+};
+
+PlannerBasePtr CreateInformedRrtStarPlanner(EnvironmentBasePtr penv, std::istream& sinput)
+{
+    return PlannerBasePtr(new InformedRrtStarPlanner(penv));
+}
+
+} // end namespace rplanners
@@ -0,0 +1,384 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "rrt.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace rplanners {
+
+/// \brief Runs independent BiRRT planners on clones of the environment and returns the path of the lowest worker that connects.
+class ParallelBirrtPlanner : public PlannerBase
+{
+    /// \brief configurations sampled on the planning thread, every worker takes each of them once
+    class SharedSamples
+    {
+public:
+        void Add(const std::vector<dReal>& vsample)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _vsamples.push_back(vsample);
+        }
+
+        /// \brief gets the sample at nextindex and advances it, false if the worker has seen all samples
+        bool GetNext(size_t& nextindex, std::vector<dReal>& vsample)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if( nextindex >= _vsamples.size() ) {
+                return false;
+            }
+            vsample = _vsamples[nextindex++];
+            return true;
+        }
+
+        size_t GetNumSamples() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _vsamples.size();
+        }
+
+private:
+        mutable std::mutex _mutex;
+        std::vector< std::vector<dReal> > _vsamples;
+    };
+    typedef boost::shared_ptr<SharedSamples> SharedSamplesPtr;
+
+    struct Worker
+    {
+        Worker() : nextgoalindex(0), nextinitialindex(0) {
+        }
+        EnvironmentBasePtr penv; ///< clone of the planning environment, only the worker thread touches it while planning
+        PlannerBasePtr planner; ///< BiRRT in penv
+        RRTParametersPtr parameters;
+        TrajectoryBasePtr ptraj;
+        PlannerStatus status;
+        UserDataPtr callbackhandle;
+        size_t nextgoalindex, nextinitialindex; ///< index of the next shared sample to give the planner
+    };
+    typedef boost::shared_ptr<Worker> WorkerPtr;
+
+public:
+    ParallelBirrtPlanner(EnvironmentBasePtr penv) : PlannerBase(penv), _numthreads(0), _bStop(false), _nFirstSolved(-1), _nWinner(-1)
+    {
+        __description = ":Interface Author: Rosen Diankov\n\n\
+Runs one BiRRT per thread, each on its own clone of the environment with its own trees and its own counter-based random stream of the seed, and returns the path of the lowest worker index that connects. When a worker connects, the workers with a higher index are stopped while the ones with a lower index keep planning until they connect or fail, so for a fixed seed and number of workers the result is reproducible as long as the parameters have no goal or initial sampling functions and no time limit is hit: those samples are shared at a rate that depends on the timing of the calling thread. \
+Takes the same RRTParameters as BiRRT. Goals and initial configurations from _samplegoalfn and _sampleinitialfn are sampled on the calling thread and shared with all the workers.\n\n\
+The workers run on the process wide thread pool and only use the state functions of the configuration specification, custom constraint functions of the parameters are bound to the source environment and are not used. \
+The post-processing planner runs once on the returned path.";
+        RegisterCommand("SetNumThreads",boost::bind(&ParallelBirrtPlanner::_SetNumThreadsCommand,this,_1,_2),
+                        "sets the number of workers used by the next InitPlan, 0 uses the number of threads of the thread pool");
+        RegisterCommand("GetGoalIndex",boost::bind(&ParallelBirrtPlanner::_ForwardToWinnerCommand,this,_1,_2,"GetGoalIndex"),
+                        "returns the goal index of the plan. Indices past the goals of the parameters are sampled goals in the order the winning worker received them");
+        RegisterCommand("GetInitGoalIndices",boost::bind(&ParallelBirrtPlanner::_ForwardToWinnerCommand,this,_1,_2,"GetInitGoalIndices"),
+                        "returns the start and goal indices");
+    }
+    virtual ~ParallelBirrtPlanner() {
+        _DestroyWorkers();
+    }
+
+    virtual PlannerStatus InitPlan(RobotBasePtr pbase, PlannerParametersConstPtr pparams) override
+    {
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        _nWinner = -1;
+        _robot = pbase;
+        _parameters.reset(new RRTParameters());
+        _parameters->copy(pparams);
+        _parameters->Validate();
+
+        int numworkers = _numthreads > 0 ? _numthreads : RaveGetThreadPool()->GetNumThreads();
+        _goalsamples.reset(new SharedSamples());
+        _initialsamples.reset(new SharedSamples());
+
+        // keep the clones of the previous plan, synchronizing is cheaper than cloning
+        while( (int)_vworkers.size() > numworkers ) {
+            _vworkers.back()->planner.reset();
+            _vworkers.back()->penv->Destroy();
+            _vworkers.pop_back();
+        }
+        for(int iworker = 0; iworker < numworkers; ++iworker) {
+            if( iworker >= (int)_vworkers.size() ) {
+                _vworkers.push_back(WorkerPtr(new Worker()));
+                _vworkers.back()->penv = GetEnv()->CloneSelf(Clone_Bodies);
+            }
+            else {
+                _vworkers[iworker]->penv->Clone(GetEnv(), Clone_Bodies);
+            }
+            Worker& worker = *_vworkers[iworker];
+            worker.nextgoalindex = 0;
+            worker.nextinitialindex = 0;
+            worker.parameters = _CreateWorkerParameters(iworker, worker);
+            if( !worker.planner ) {
+                worker.planner = RaveCreatePlanner(worker.penv, "BiRRT");
+                if( !worker.planner ) {
+                    _parameters.reset();
+                    return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%s, failed to create BiRRT for the workers")%GetEnv()->GetNameId()), PS_Failed);
+                }
+                worker.callbackhandle = worker.planner->RegisterPlanCallback(boost::bind(&ParallelBirrtPlanner::_WorkerCallback,this,iworker,_1));
+            }
+
+            RobotBasePtr probot;
+            if( !!_robot ) {
+                probot = worker.penv->GetRobot(_robot->GetName());
+            }
+            // the stream of a worker only depends on its index, so the path of every worker is reproducible for a given seed
+            std::stringstream ssinput, ssoutput;
+            ssinput << "SetRandomStream " << iworker;
+            if( !worker.planner->SendCommand(ssoutput, ssinput) ) {
+                _parameters.reset();
+                return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%s, failed to set the random stream of worker %d")%GetEnv()->GetNameId()%iworker), PS_Failed);
+            }
+            // every worker checks the same initial and goal configurations in identical clones, so they fail or succeed together
+            PlannerStatus status = worker.planner->InitPlan(probot, worker.parameters);
+            if( !(status.GetStatusCode() & PS_HasSolution) ) {
+                _parameters.reset();
+                return status;
+            }
+        }
+        RAVELOG_DEBUG_FORMAT("env=%s, ParallelBiRRT initialized %d workers", GetEnv()->GetNameId()%numworkers);
+        return PlannerStatus(PS_HasSolution);
+    }
+
+    virtual PlannerStatus PlanPath(TrajectoryBasePtr ptraj, int planningoptions) override
+    {
+        _nWinner = -1;
+        if( !_parameters ) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%s, ParallelBirrtPlanner::PlanPath - Error, planner not initialized")%GetEnv()->GetNameId()), PS_Failed);
+        }
+
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        uint64_t basetimeus = utils::GetMonotonicTime();
+        PlannerParameters::StateSaver savestate(_parameters);
+
+        _bStop = false;
+        _nFirstSolved = -1;
+        ThreadPoolPtr pthreadpool = RaveGetThreadPool();
+        std::vector<ThreadPoolTaskPtr> vtasks(_vworkers.size());
+        for(size_t iworker = 0; iworker < _vworkers.size(); ++iworker) {
+            WorkerPtr pworker = _vworkers[iworker];
+            pworker->ptraj = RaveCreateTrajectory(pworker->penv, ptraj->GetXMLId());
+            pworker->status = PlannerStatus();
+            vtasks[iworker] = pthreadpool->Submit([this, pworker, iworker, planningoptions]() {
+                pworker->status = pworker->planner->PlanPath(pworker->ptraj, planningoptions);
+                if( pworker->status.GetStatusCode() & PS_HasSolution ) {
+                    // stops the workers with a higher index, see _WorkerCallback
+                    int nfirstsolved = _nFirstSolved;
+                    while( (nfirstsolved < 0 || (int)iworker < nfirstsolved) && !_nFirstSolved.compare_exchange_weak(nfirstsolved, (int)iworker) ) {
+                    }
+                }
+            });
+        }
+
+        // the sampling functions and callbacks are bound to this environment, so they run here while the workers plan
+        PlannerProgress progress;
+        bool bInterrupted = false;
+        while( true ) {
+            // the workers with a lower index than a solved one keep planning since one of them could still win
+            const int nfirstsolved = _nFirstSolved;
+            const size_t numwaitworkers = nfirstsolved >= 0 ? (size_t)nfirstsolved : vtasks.size();
+            bool bAllDone = true;
+            for(size_t iworker = 0; iworker < numwaitworkers; ++iworker) {
+                if( !vtasks[iworker]->IsDone() ) {
+                    bAllDone = false;
+                    break;
+                }
+            }
+            if( bAllDone ) {
+                break;
+            }
+
+            if( _CallCallbacks(progress) == PA_Interrupt ) {
+                bInterrupted = true;
+                break;
+            }
+            if( _parameters->_nMaxPlanningTime > 0 && utils::GetMonotonicTime()-basetimeus >= 1000*(uint64_t)_parameters->_nMaxPlanningTime ) {
+                RAVELOG_DEBUG_FORMAT("env=%s, time exceeded (%d[ms]) so breaking", GetEnv()->GetNameId()%_parameters->_nMaxPlanningTime);
+                break;
+            }
+
+            bool bSampled = false;
+            std::vector<dReal> vsample;
+            if( !!_parameters->_samplegoalfn && _parameters->_samplegoalfn(vsample) ) {
+                _goalsamples->Add(vsample);
+                bSampled = true;
+            }
+            if( !!_parameters->_sampleinitialfn && _parameters->_sampleinitialfn(vsample) ) {
+                _initialsamples->Add(vsample);
+                bSampled = true;
+            }
+            if( !bSampled ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            ++progress._iteration;
+        }
+
+        _bStop = true;
+        // wait for all workers even if one threw since they all reference this planner
+        std::exception_ptr exception;
+        FOREACH(ittask, vtasks) {
+            try {
+                (*ittask)->Wait();
+            }
+            catch(...) {
+                if( !exception ) {
+                    exception = std::current_exception();
+                }
+            }
+        }
+        if( !!exception ) {
+            std::rethrow_exception(exception);
+        }
+
+        // all workers below the first solved one ran to the end, so the lowest index that connected does not depend on the timing
+        for(size_t iworker = 0; iworker < _vworkers.size(); ++iworker) {
+            if( _vworkers[iworker]->status.GetStatusCode() & PS_HasSolution ) {
+                _nWinner = (int)iworker;
+                break;
+            }
+        }
+
+        uint64_t elapsedtimeus = utils::GetMonotonicTime()-basetimeus;
+        if( bInterrupted ) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%s, Planning was interrupted")%GetEnv()->GetNameId()), PS_Interrupted);
+        }
+        const int winner = _nWinner;
+        if( winner < 0 ) {
+            std::string description = str(boost::format(_("env=%s, plan failed in %u[us] with %d workers, nMaxIterations=%d"))%GetEnv()->GetNameId()%elapsedtimeus%_vworkers.size()%_parameters->_nMaxIterations);
+            RAVELOG_WARN(description);
+            PlannerStatus status = OPENRAVE_PLANNER_STATUS(description, PS_Failed);
+            FOREACHC(itworker, _vworkers) {
+                status.statusCode |= (*itworker)->status.statusCode & ~PS_HasSolution;
+            }
+            return status;
+        }
+
+        const Worker& worker = *_vworkers.at(winner);
+        std::vector<dReal> vdata;
+        worker.ptraj->GetWaypoints(0, worker.ptraj->GetNumWaypoints(), vdata, _parameters->_configurationspecification);
+        if( ptraj->GetConfigurationSpecification().GetDOF() == 0 ) {
+            ptraj->Init(_parameters->_configurationspecification);
+        }
+        ptraj->Insert(ptraj->GetNumWaypoints(), vdata, _parameters->_configurationspecification);
+        RAVELOG_DEBUG_FORMAT("env=%s, plan success by worker %d of %d, path=%d points, shared goals=%d, computation time=%u[us]", GetEnv()->GetNameId()%winner%_vworkers.size()%ptraj->GetNumWaypoints()%_goalsamples->GetNumSamples()%elapsedtimeus);
+        return _ProcessPostPlanners(_robot,ptraj);
+    }
+
+    virtual PlannerParametersConstPtr GetParameters() const override {
+        return _parameters;
+    }
+
+protected:
+    /// \brief copies the parameters for a worker and rebinds them to its clone
+    RRTParametersPtr _CreateWorkerParameters(int iworker, Worker& worker)
+    {
+        EnvironmentLock lockclone(worker.penv->GetMutex());
+        RRTParametersPtr params(new RRTParameters());
+        params->copy(_parameters);
+        params->_minimumgoalpaths = _parameters->_minimumgoalpaths;
+        params->_bLazyEdgeChecking = _parameters->_bLazyEdgeChecking;
+
+        // the functions of _parameters point to the bodies of the source environment, take the ones of the clone instead
+        RRTParameters cloneparams;
+        cloneparams.SetConfigurationSpecification(worker.penv, _parameters->_configurationspecification);
+        params->_distmetricfn = cloneparams._distmetricfn;
+        params->_checkpathvelocityconstraintsfn = cloneparams._checkpathvelocityconstraintsfn;
+        params->_checkpathvelocityaccelerationconstraintsfn = cloneparams._checkpathvelocityaccelerationconstraintsfn;
+        params->_samplefn = cloneparams._samplefn;
+        params->_sampleneighfn = cloneparams._sampleneighfn;
+        params->_setstatevaluesfn = cloneparams._setstatevaluesfn;
+        params->_getstatefn = cloneparams._getstatefn;
+        params->_diffstatefn = cloneparams._diffstatefn;
+        params->_neighstatefn = cloneparams._neighstatefn;
+        params->_listInternalSamplers = cloneparams._listInternalSamplers;
+        params->_costfn.clear();
+        params->_goalfn.clear();
+
+        params->_samplegoalfn.clear();
+        if( !!_parameters->_samplegoalfn ) {
+            SharedSamplesPtr goalsamples = _goalsamples;
+            size_t* pnextindex = &worker.nextgoalindex;
+            params->_samplegoalfn = [goalsamples, pnextindex](std::vector<dReal>& vgoal) {
+                return goalsamples->GetNext(*pnextindex, vgoal);
+            };
+        }
+        params->_sampleinitialfn.clear();
+        if( !!_parameters->_sampleinitialfn ) {
+            SharedSamplesPtr initialsamples = _initialsamples;
+            size_t* pnextindex = &worker.nextinitialindex;
+            params->_sampleinitialfn = [initialsamples, pnextindex](std::vector<dReal>& vinitial) {
+                return initialsamples->GetNext(*pnextindex, vinitial);
+            };
+        }
+
+        // every worker samples its own stream of the seed (see SetRandomStream in InitPlan), the path is post-processed once by this planner
+        params->_nRandomGeneratorSeed = _parameters->_nRandomGeneratorSeed;
+        params->_sPostProcessingPlanner.clear();
+        params->_sPostProcessingParameters.clear();
+        return params;
+    }
+
+    PlannerAction _WorkerCallback(size_t iworker, const PlannerProgress& progress)
+    {
+        const int nfirstsolved = _nFirstSolved;
+        return _bStop || (nfirstsolved >= 0 && (int)iworker > nfirstsolved) ? PA_Interrupt : PA_None;
+    }
+
+    bool _SetNumThreadsCommand(std::ostream& sout, std::istream& sinput)
+    {
+        sinput >> _numthreads;
+        return !!sinput;
+    }
+
+    bool _ForwardToWinnerCommand(std::ostream& sout, std::istream& sinput, const std::string& command)
+    {
+        const int winner = _nWinner;
+        if( winner < 0 || winner >= (int)_vworkers.size() ) {
+            sout << -1;
+            return !!sout;
+        }
+        std::stringstream ssinput;
+        ssinput << command;
+        return _vworkers[winner]->planner->SendCommand(sout, ssinput);
+    }
+
+    void _DestroyWorkers()
+    {
+        FOREACH(itworker, _vworkers) {
+            (*itworker)->callbackhandle.reset();
+            (*itworker)->planner.reset();
+            if( !!(*itworker)->penv ) {
+                (*itworker)->penv->Destroy();
+            }
+        }
+        _vworkers.clear();
+    }
+
+    RobotBasePtr _robot;
+    RRTParametersPtr _parameters;
+    std::vector<WorkerPtr> _vworkers;
+    SharedSamplesPtr _goalsamples, _initialsamples;
+    int _numthreads; ///< number of workers, 0 uses the size of the thread pool
+    std::atomic<bool> _bStop; ///< set once the workers should stop planning
+    std::atomic<int> _nFirstSolved; ///< lowest index of the workers that found a path, -1 if none. Workers with a higher index are stopped
+    std::atomic<int> _nWinner; ///< index of the worker whose path is returned, -1 if none
+};
+
+PlannerBasePtr CreateParallelBirrtPlanner(EnvironmentBasePtr penv, std::istream& sinput)
+{
+    return PlannerBasePtr(new ParallelBirrtPlanner(penv));
+}
+
+} // end namespace rplanners
@@ -37,6 +37,9 @@ OpenRAVE::PlannerBasePtr CreateCubicTrajectoryRetimer2(OpenRAVE::EnvironmentBase
 OpenRAVE::PlannerBasePtr CreateCubicSmoother(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
 OpenRAVE::PlannerBasePtr CreateQuinticSmoother(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
 OpenRAVE::PlannerBasePtr CreateQuinticTrajectoryRetimer(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
+OpenRAVE::PlannerBasePtr CreateTOPPRetimer(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
+OpenRAVE::PlannerBasePtr CreateParallelBirrtPlanner(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
+OpenRAVE::PlannerBasePtr CreateInformedRrtStarPlanner(OpenRAVE::EnvironmentBasePtr penv, std::istream& sinput);
 }
 
 const std::string RPlannersPlugin::_pluginname = "RPlannersPlugin";
@@ -45,6 +48,8 @@ RPlannersPlugin::RPlannersPlugin()
 {
     _interfaces[PT_Planner].push_back("RAStar");
     _interfaces[PT_Planner].push_back("BiRRT");
+    _interfaces[PT_Planner].push_back("ParallelBiRRT");
+    _interfaces[PT_Planner].push_back("InformedRRTStar");
     _interfaces[PT_Planner].push_back("BasicRRT");
     _interfaces[PT_Planner].push_back("ExplorationRRT");
     _interfaces[PT_Planner].push_back("GraspGradient");
@@ -62,6 +67,7 @@ RPlannersPlugin::RPlannersPlugin()
     _interfaces[PT_Planner].push_back("CubicSmoother");
     _interfaces[PT_Planner].push_back("QuinticSmoother");
     _interfaces[PT_Planner].push_back("QuinticTrajectoryRetimer");
+    _interfaces[PT_Planner].push_back("TOPPRetimer");
 }
 
 RPlannersPlugin::~RPlannersPlugin() {}
@@ -76,6 +82,12 @@ OpenRAVE::InterfaceBasePtr RPlannersPlugin::CreateInterface(OpenRAVE::InterfaceT
         else if( interfacename == "birrt") {
             return boost::make_shared<BirrtPlanner>(penv);
         }
+        else if( interfacename == "parallelbirrt" ) {
+            return rplanners::CreateParallelBirrtPlanner(penv,sinput);
+        }
+        else if( interfacename == "informedrrtstar" ) {
+            return rplanners::CreateInformedRrtStarPlanner(penv,sinput);
+        }
         else if( interfacename == "rbirrt") {
             RAVELOG_WARN("rBiRRT is deprecated, use BiRRT\n");
             return boost::make_shared<BirrtPlanner>(penv);
@@ -131,6 +143,9 @@ OpenRAVE::InterfaceBasePtr RPlannersPlugin::CreateInterface(OpenRAVE::InterfaceT
         else if( interfacename == "quintictrajectoryretimer" ) {
             return rplanners::CreateQuinticTrajectoryRetimer(penv, sinput);
         }
+        else if( interfacename == "toppretimer" ) {
+            return rplanners::CreateTOPPRetimer(penv, sinput);
+        }
         break;
     default:
         break;
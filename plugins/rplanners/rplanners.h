@@ -83,6 +83,7 @@ public:
         _level = 0;
         _hasselfchild = 0;
         _usenn = 1;
+        _validedge = 1;
         _userdata = 0;
     }
     SimpleNode(SimpleNode* parent, const dReal* pconfig, int dof) : rrtparent(parent) {
@@ -90,6 +91,7 @@ public:
         _level = 0;
         _hasselfchild = 0;
         _usenn = 1;
+        _validedge = 1;
         _userdata = 0;
     }
     ~SimpleNode() {
@@ -100,6 +102,7 @@ public:
     int16_t _level; ///< the level the node belongs to
     uint8_t _hasselfchild; ///< if 1, then _vchildren has contains a clone of this node in the level below it.
     uint8_t _usenn; ///< if 1, then use part of the nearest neighbor search, otherwise ignore
+    uint8_t _validedge; ///< if 1, then the edge from rrtparent to this node satisfies all constraints. 0 if only the node was checked.
     uint32_t _userdata; ///< user specified data tagging this node
 
 #ifdef _DEBUG
@@ -159,6 +162,9 @@ public:
         _maxlevel = 0;
         _minlevel = 0;
         _fMaxLevelBound = 0;
+        _bLazyEdgeChecking = false;
+        _numedgechecks = 0;
+        _numstatechecks = 0;
     }
 
     ~SpatialTree() {
@@ -194,6 +200,8 @@ public:
             _vsetLevelNodes.resize(enclevel+1);
         }
         _constraintreturn.reset(new ConstraintFilterReturn());
+        _numedgechecks = 0;
+        _numstatechecks = 0;
     }
 
     virtual void Reset()
@@ -234,6 +242,44 @@ public:
         return _FindNearestNode(vquerystate);
     }
 
+    /// \brief gets the nodes used in the nearest neighbor search that are within fRadius of vquerystate, with their distances.
+    ///
+    /// The cover tree can hold several clones of the same node at different levels, they are all returned.
+    void GetNodesWithinDistance(const std::vector<dReal>& vquerystate, dReal fRadius, std::vector< std::pair<NodePtr, dReal> >& vnearnodes) const
+    {
+        vnearnodes.resize(0);
+        if( _numnodes == 0 ) {
+            return;
+        }
+        OPENRAVE_ASSERT_OP((int)vquerystate.size(),==,_dof);
+
+        dReal fLevelBound = _fMaxLevelBound;
+        _vCurrentLevelNodes.resize(1);
+        _vCurrentLevelNodes[0].first = *_vsetLevelNodes.at(_EncodeLevel(_maxlevel)).begin();
+        _vCurrentLevelNodes[0].second = _ComputeDistance(_vCurrentLevelNodes[0].first->q, vquerystate);
+        if( _vCurrentLevelNodes[0].first->_usenn && _vCurrentLevelNodes[0].second <= fRadius ) {
+            vnearnodes.push_back(_vCurrentLevelNodes[0]);
+        }
+        while(_vCurrentLevelNodes.size() > 0 ) {
+            _vNextLevelNodes.resize(0);
+            // all the descendants of a child are within fLevelBound*_fBaseChildMult of it
+            dReal ftestbound = fRadius + fLevelBound*_fBaseChildMult;
+            FOREACH(itcurrentnode, _vCurrentLevelNodes) {
+                FOREACHC(itchild, itcurrentnode->first->_vchildren) {
+                    dReal curdist = _ComputeDistance((*itchild)->q, vquerystate);
+                    if( curdist <= fRadius && (*itchild)->_usenn ) {
+                        vnearnodes.emplace_back(*itchild, curdist);
+                    }
+                    if( curdist <= ftestbound ) {
+                        _vNextLevelNodes.emplace_back(*itchild, curdist);
+                    }
+                }
+            }
+            _vCurrentLevelNodes.swap(_vNextLevelNodes);
+            fLevelBound *= _fBaseInv;
+        }
+    }
+
     virtual NodeBasePtr InsertNode(NodeBasePtr parent, const vector<dReal>& config, uint32_t userdata)
     {
         return _InsertNode((NodePtr)parent, config, userdata);
@@ -361,12 +407,21 @@ public:
             }
 
             // necessary to pass in _constraintreturn since _neighstatefn can have constraints and it can change the interpolation. Use _constraintreturn->_bHasRampDeviatedFromInterpolation to figure out if something changed.
-            if( _fromgoal ) {
+            if( _bLazyEdgeChecking ) {
+                // only check the new state, the edge is checked by ValidateEdge once it is part of a path
+                ++_numstatechecks;
+                if( params->CheckPathAllConstraints(_vNewConfig, _vNewConfig, std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart, constraintFilterOptions|CFO_FromPathSampling, _constraintreturn) != 0 ) {
+                    return bHasAdded ? ET_Sucess : ET_Failed;
+                }
+            }
+            else if( _fromgoal ) {
+                ++_numedgechecks;
                 if( params->CheckPathAllConstraints(_vNewConfig, _vCurConfig, std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenEnd, constraintFilterOptions|CFO_FromPathSampling, _constraintreturn) != 0 ) {
                     return bHasAdded ? ET_Sucess : ET_Failed;
                 }
             }
             else {
+                ++_numedgechecks;
                 if( params->CheckPathAllConstraints(_vCurConfig, _vNewConfig, std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart, constraintFilterOptions|CFO_FromPathSampling, _constraintreturn) != 0 ) {
                     return bHasAdded ? ET_Sucess : ET_Failed;
                 }
@@ -394,7 +449,7 @@ public:
             // dReal currentDistance =  _ComputeDistance(&_vCurConfig[0], _vNewConfig);
 
             int iAdded = 0;
-            if( _constraintreturn->_bHasRampDeviatedFromInterpolation ) {
+            if( !_bLazyEdgeChecking && _constraintreturn->_bHasRampDeviatedFromInterpolation ) {
                 // Since the path checked by CheckPathAllConstraints can be different from a straight line segment connecting _vNewConfig and _vCurConfig, we add all checked configurations along the checked segment to the tree.
                 if( _fromgoal ) {
                     // Need to add nodes to the tree starting from the one closest to the nearest neighbor. Since _fromgoal is true, the closest one is the last config in _constraintreturn->_configurations
@@ -433,6 +488,7 @@ public:
             else {
                 NodePtr pnewnode = _InsertNode(pnode, _vNewConfig, 0); ///< set userdata to 0
                 if( !!pnewnode ) {
+                    pnewnode->_validedge = !_bLazyEdgeChecking;
                     pnode = pnewnode;
                     lastnode = pnode;
                     bHasAdded = true;
@@ -448,6 +504,54 @@ public:
         return bHasAdded ? ET_Sucess : ET_Failed;
     }
 
+    /// \brief if true, Extend only checks the constraints of the new states and their edges have to be checked with \ref ValidateEdge
+    void SetLazyEdgeChecking(bool bLazyEdgeChecking) {
+        _bLazyEdgeChecking = bLazyEdgeChecking;
+    }
+
+    /// \brief checks all the constraints on the edge from the parent of nodebase to nodebase if it has not been checked yet.
+    ///
+    /// The states at both ends were already checked when they were added, so only the states in between are checked.
+    /// \return true if the edge is valid
+    bool ValidateEdge(NodeBasePtr nodebase, int constraintFilterOptions=0xffff|CFO_FillCheckedConfiguration)
+    {
+        NodePtr node = (NodePtr)nodebase;
+        if( node->_validedge || !node->rrtparent ) {
+            return true;
+        }
+        boost::shared_ptr<PlannerBase> planner(_planner);
+        PlannerBase::PlannerParametersConstPtr params = planner->GetParameters();
+        _vEdgeConfig.resize(_dof);
+        _vEdgeParentConfig.resize(_dof);
+        std::copy(node->q, node->q+_dof, _vEdgeConfig.begin());
+        std::copy(node->rrtparent->q, node->rrtparent->q+_dof, _vEdgeParentConfig.begin());
+        ++_numedgechecks;
+        // check in the same direction Extend would have
+        int ret;
+        if( _fromgoal ) {
+            ret = params->CheckPathAllConstraints(_vEdgeConfig, _vEdgeParentConfig, std::vector<dReal>(), std::vector<dReal>(), 0, IT_Open, constraintFilterOptions|CFO_FromPathSampling, _constraintreturn);
+        }
+        else {
+            ret = params->CheckPathAllConstraints(_vEdgeParentConfig, _vEdgeConfig, std::vector<dReal>(), std::vector<dReal>(), 0, IT_Open, constraintFilterOptions|CFO_FromPathSampling, _constraintreturn);
+        }
+        // the tree only stores the straight edge, so an edge that the constraints had to deviate is not valid
+        if( ret != 0 || _constraintreturn->_bHasRampDeviatedFromInterpolation ) {
+            return false;
+        }
+        node->_validedge = 1;
+        return true;
+    }
+
+    /// \brief number of edges checked for constraints since Init, from Extend and ValidateEdge
+    inline int GetNumEdgeChecks() const {
+        return _numedgechecks;
+    }
+
+    /// \brief number of single states checked for constraints since Init, only done in lazy edge checking
+    inline int GetNumStateChecks() const {
+        return _numstatechecks;
+    }
+
     virtual int GetNumNodes() const {
         return _numnodes;
     }
@@ -1067,11 +1171,13 @@ private:
     int _minlevel; ///< the minimum allowed levels in the tree (inclusive)
     int _numnodes; ///< the number of nodes in the current tree starting at the root at _vsetLevelNodes.at(_EncodeLevel(_maxlevel))
     dReal _fMaxLevelBound; // pow(_base, _maxlevel)
+    bool _bLazyEdgeChecking; ///< see SetLazyEdgeChecking
+    int _numedgechecks, _numstatechecks; ///< constraint check counters since Init
 
     // cache
     vector<NodePtr> _vchildcache;
     set<NodePtr> _setchildcache;
-    vector<dReal> _vNewConfig, _vDeltaConfig, _vCurConfig;
+    vector<dReal> _vNewConfig, _vDeltaConfig, _vCurConfig, _vEdgeConfig, _vEdgeParentConfig;
     mutable vector<dReal> _vTempConfig;
     ConstraintFilterReturnPtr _constraintreturn;
 
@@ -26,7 +26,7 @@ class RrtPlanner : public PlannerBase
 {
 public:
 
-    RrtPlanner(EnvironmentBasePtr penv) : PlannerBase(penv), _treeForward(0)
+    RrtPlanner(EnvironmentBasePtr penv) : PlannerBase(penv), _nRandomStreamId(-1), _treeForward(0)
     {
         __description = "\
 :Interface Author:  Rosen Diankov\n\n\
@@ -36,6 +36,9 @@ Uses the Rapidly-Exploring Random Trees Algorithm.\n\
                         "returns the goal index of the plan");
         RegisterCommand("GetInitGoalIndices",boost::bind(&RrtPlanner<Node>::GetInitGoalIndicesCommand,this,_1,_2),
                         "returns the start and goal indices");
+        RegisterCommand("SetRandomStream",boost::bind(&RrtPlanner<Node>::SetRandomStreamCommand,this,_1,_2),
+                        "sets the stream id used by the next InitPlan, -1 (default) uses the mt19937 sampler. With a stream id >= 0 the planner samples from the counter-based 'philox' sampler, \
+planners with the same seed and different stream ids have independent and reproducible samples. The internal samplers of the parameters are switched to the stream as well.");
         _filterreturn.reset(new ConstraintFilterReturn());
     }
     virtual ~RrtPlanner() {
@@ -47,11 +50,25 @@ Uses the Rapidly-Exploring Random Trees Algorithm.\n\
         _goalindex = -1;
         _startindex = -1;
         EnvironmentLock lock(GetEnv()->GetMutex());
-        if( !_uniformsampler ) {
-            _uniformsampler = RaveCreateSpaceSampler(GetEnv(),"mt19937");
+        const bool bUseStream = _nRandomStreamId >= 0;
+        if( !_uniformsampler || _uniformsampler->SupportsCommand("SetStream") != bUseStream ) {
+            _uniformsampler = RaveCreateSpaceSampler(GetEnv(),bUseStream ? "philox" : "mt19937");
         }
         _robot = pbase;
 
+        if( bUseStream ) {
+            std::stringstream ssinput, ssoutput;
+            ssinput << "SetStream " << _nRandomStreamId;
+            _uniformsampler->SendCommand(ssoutput, ssinput);
+            FOREACH(it, params->_listInternalSamplers) {
+                if( (*it)->SupportsCommand("SetStream") ) {
+                    ssinput.clear(); ssinput.str(""); ssinput << "SetStream " << _nRandomStreamId;
+                    if( !(*it)->SendCommand(ssoutput, ssinput) ) {
+                        RAVELOG_WARN_FORMAT("env=%s, failed to set stream %d of internal sampler %s", GetEnv()->GetNameId()%_nRandomStreamId%(*it)->GetXMLId());
+                    }
+                }
+            }
+        }
         _uniformsampler->SetSeed(params->_nRandomGeneratorSeed);
         FOREACH(it, params->_listInternalSamplers) {
             (*it)->SetSeed(params->_nRandomGeneratorSeed);
@@ -251,11 +268,18 @@ Uses the Rapidly-Exploring Random Trees Algorithm.\n\
         return !!os;
     }
 
+    bool SetRandomStreamCommand(std::ostream& os, std::istream& is)
+    {
+        is >> _nRandomStreamId;
+        return !!is;
+    }
+
 protected:
     RobotBasePtr _robot;
     std::vector<dReal> _sampleConfig;
     int _goalindex, _startindex;
     SpaceSamplerBasePtr _uniformsampler;
+    int _nRandomStreamId; ///< stream of the samplers, -1 if not using streams
     ConstraintFilterReturnPtr _filterreturn;
     std::deque<dReal> _cachedpath;
 
@@ -287,7 +311,10 @@ Some python code to display data::\n\
   robot.SetActiveDOFValues(sourcetree[argmin(sourcedist)])\n\
 \n\
 ");
+        RegisterCommand("GetConstraintCheckStatistics", boost::bind(&BirrtPlanner::_GetConstraintCheckStatisticsCommand,this,_1,_2),
+                        "returns the number of edges and single states checked for constraints since the last InitPlan, and the number of edges rejected by lazy edge checking");
         _nValidGoals = 0;
+        _numrejectededges = 0;
     }
     virtual ~BirrtPlanner() {
     }
@@ -318,6 +345,9 @@ Some python code to display data::\n\
 
         // TODO perhaps distmetricfn should take into number of revolutions of circular joints
         _treeBackward.Init(shared_planner(), _parameters->GetDOF(), _parameters->_distmetricfn, _parameters->_fStepLength, _parameters->_distmetricfn(_parameters->_vConfigLowerLimit, _parameters->_vConfigUpperLimit));
+        _treeForward.SetLazyEdgeChecking(_parameters->_bLazyEdgeChecking);
+        _treeBackward.SetLazyEdgeChecking(_parameters->_bLazyEdgeChecking);
+        _numrejectededges = 0;
 
         //read in all goals
         if( (_parameters->vgoalconfig.size() % _parameters->GetDOF()) != 0 ) {
@@ -363,7 +393,7 @@ Some python code to display data::\n\
         if( _vgoalpaths.capacity() < _parameters->_minimumgoalpaths ) {
             _vgoalpaths.reserve(_parameters->_minimumgoalpaths);
         }
-        RAVELOG_DEBUG_FORMAT("env=%s, BiRRT Planner Initialized, initial=%d, goal=%d, step=%f", GetEnv()->GetNameId()%_vecInitialNodes.size()%_treeBackward.GetNumNodes()%_parameters->_fStepLength);
+        RAVELOG_DEBUG_FORMAT("env=%s, BiRRT Planner Initialized, initial=%d, goal=%d, step=%f, lazyedgechecking=%d", GetEnv()->GetNameId()%_vecInitialNodes.size()%_treeBackward.GetNumNodes()%_parameters->_fStepLength%_parameters->_bLazyEdgeChecking);
         return PlannerStatus(PS_HasSolution);
     }
 
@@ -494,6 +524,15 @@ Some python code to display data::\n\
                 planningstatus.AddCollisionReport(_treeBackward.GetConstraintReport()->_report);
             }
 
+            if( et == ET_Connected && _parameters->_bLazyEdgeChecking ) {
+                // check the edges of both branches so that one candidate path removes as many invalid edges as possible
+                bool bForwardValid = _ValidateLazyBranch(_treeForward, TreeA == &_treeForward ? iConnectedA : iConnectedB, constraintFilterOptions);
+                bool bBackwardValid = _ValidateLazyBranch(_treeBackward, TreeA == &_treeBackward ? iConnectedA : iConnectedB, constraintFilterOptions);
+                if( !bForwardValid || !bBackwardValid ) {
+                    et = ET_Failed;
+                }
+            }
+
             if( et == ET_Connected ) {
                 // connected, process goal
                 _vgoalpaths.push_back(GOALPATH());
@@ -534,7 +573,7 @@ Some python code to display data::\n\
 
         if( _vgoalpaths.size() == 0 ) {
             uint64_t elapsedtimeus = utils::GetMonotonicTime()-basetimeus;
-            std::string description = str(boost::format(_("env=%s, plan failed in %u[us], iter=%d, nMaxIterations=%d"))%GetEnv()->GetNameId()%(elapsedtimeus)%(iter/3)%_parameters->_nMaxIterations);
+            std::string description = str(boost::format(_("env=%s, plan failed in %u[us], iter=%d, nMaxIterations=%d, edgechecks=%d, statechecks=%d"))%GetEnv()->GetNameId()%(elapsedtimeus)%(iter/3)%_parameters->_nMaxIterations%_GetNumEdgeChecks()%_GetNumStateChecks());
             RAVELOG_WARN(description);
             return OPENRAVE_PLANNER_STATUS(description, PS_Failed);
         }
@@ -552,7 +591,7 @@ Some python code to display data::\n\
         }
         ptraj->Insert(ptraj->GetNumWaypoints(), itbest->qall, _parameters->_configurationspecification);
         uint64_t elapsedtimeus = utils::GetMonotonicTime()-basetimeus;
-        std::string description = str(boost::format(_("env=%s, plan success, iters=%d, path=%d points, computation time=%u[us]\n"))%GetEnv()->GetNameId()%progress._iteration%ptraj->GetNumWaypoints()%(elapsedtimeus));
+        std::string description = str(boost::format(_("env=%s, plan success, iters=%d, path=%d points, computation time=%u[us], edgechecks=%d, statechecks=%d, rejectededges=%d\n"))%GetEnv()->GetNameId()%progress._iteration%ptraj->GetNumWaypoints()%(elapsedtimeus)%_GetNumEdgeChecks()%_GetNumStateChecks()%_numrejectededges);
         RAVELOG_DEBUG(description);
         PlannerStatus status = _ProcessPostPlanners(_robot,ptraj);
         //TODO should use accessor to change description
@@ -668,6 +707,42 @@ Some python code to display data::\n\
         return _parameters;
     }
 
+    /// \brief checks the lazily added edges on the branch from pnodebase to the root of tree, starting from the root.
+    ///
+    /// At the first invalid edge, the node below it and all its descendants are removed from the nearest neighbor search.
+    /// \return true if all the edges of the branch are valid
+    bool _ValidateLazyBranch(SpatialTree<SimpleNode>& tree, NodeBase* pnodebase, int constraintFilterOptions)
+    {
+        _vlazybranch.resize(0);
+        for(SimpleNode* pnode = (SimpleNode*)pnodebase; !!pnode->rrtparent; pnode = pnode->rrtparent) {
+            if( !pnode->_validedge ) {
+                _vlazybranch.push_back(pnode);
+            }
+        }
+        for(std::vector<SimpleNode*>::reverse_iterator itnode = _vlazybranch.rbegin(); itnode != _vlazybranch.rend(); ++itnode) {
+            if( !tree.ValidateEdge(*itnode, constraintFilterOptions) ) {
+                tree.InvalidateNodesWithParent(*itnode);
+                ++_numrejectededges;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline int _GetNumEdgeChecks() const {
+        return _treeForward.GetNumEdgeChecks() + _treeBackward.GetNumEdgeChecks();
+    }
+
+    inline int _GetNumStateChecks() const {
+        return _treeForward.GetNumStateChecks() + _treeBackward.GetNumStateChecks();
+    }
+
+    bool _GetConstraintCheckStatisticsCommand(std::ostream& os, std::istream& is)
+    {
+        os << _GetNumEdgeChecks() << " " << _GetNumStateChecks() << " " << _numrejectededges;
+        return !!os;
+    }
+
     virtual bool _DumpTreeCommand(std::ostream& os, std::istream& is) {
         std::string filename = RaveGetHomeDirectory() + boost::str(boost::format("/birrtdump_%d.txt")%utils::GetMilliTime());
         getline(is, filename);
@@ -688,6 +763,8 @@ protected:
     std::vector< NodeBase* > _vecGoalNodes;
     size_t _nValidGoals; ///< num valid goals
     std::vector<GOALPATH> _vgoalpaths;
+    int _numrejectededges; ///< edges found invalid by lazy edge checking since InitPlan
+    std::vector<SimpleNode*> _vlazybranch; ///< cache for _ValidateLazyBranch
 };
 
 class BasicRrtPlanner : public RrtPlanner<SimpleNode>
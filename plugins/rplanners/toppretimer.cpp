@@ -0,0 +1,845 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "openraveplugindefs.h"
+
+#include <atomic>
+
+namespace rplanners {
+
+class TOPPParameters : public ConstraintTrajectoryTimingParameters
+{
+public:
+    TOPPParameters() : ConstraintTrajectoryTimingParameters(), numgridpoints(1000), torquelimitmode(DC_IgnoreTorque), numthreads(0), _bTOPPProcessing(false) {
+        _vXMLParameters.push_back("numgridpoints");
+        _vXMLParameters.push_back("torquelimitmode");
+        _vXMLParameters.push_back("numthreads");
+    }
+
+    int numgridpoints; ///< number of intervals the path is discretized into
+    int torquelimitmode; ///< one of DynamicsConstraintsType. DC_IgnoreTorque does not constrain the torques
+    int numthreads; ///< maximum number of threads of the thread pool evaluating the constraints on the grid. 0 uses all the workers
+
+protected:
+    bool _bTOPPProcessing;
+    virtual bool serialize(std::ostream& O, int options=0) const
+    {
+        if( !ConstraintTrajectoryTimingParameters::serialize(O, options&~1) ) {
+            return false;
+        }
+        O << "<numgridpoints>" << numgridpoints << "</numgridpoints>" << std::endl;
+        O << "<torquelimitmode>" << torquelimitmode << "</torquelimitmode>" << std::endl;
+        O << "<numthreads>" << numthreads << "</numthreads>" << std::endl;
+        if( !(options & 1) ) {
+            O << _sExtraParameters << std::endl;
+        }
+        return !!O;
+    }
+
+    ProcessElement startElement(const std::string& name, const AttributesList& atts)
+    {
+        if( _bTOPPProcessing ) {
+            return PE_Ignore;
+        }
+        switch( ConstraintTrajectoryTimingParameters::startElement(name,atts) ) {
+        case PE_Pass: break;
+        case PE_Support: return PE_Support;
+        case PE_Ignore: return PE_Ignore;
+        }
+        _bTOPPProcessing = name=="numgridpoints" || name=="torquelimitmode" || name=="numthreads";
+        return _bTOPPProcessing ? PE_Support : PE_Pass;
+    }
+
+    virtual bool endElement(const std::string& name)
+    {
+        if( _bTOPPProcessing ) {
+            if( name == "numgridpoints" ) {
+                _ss >> numgridpoints;
+            }
+            else if( name == "torquelimitmode" ) {
+                _ss >> torquelimitmode;
+            }
+            else if( name == "numthreads" ) {
+                _ss >> numthreads;
+            }
+            else {
+                RAVELOG_WARN(str(boost::format("unknown tag %s\n")%name));
+            }
+            _bTOPPProcessing = false;
+            return false;
+        }
+
+        // give a chance for the default parameters to get processed
+        return ConstraintTrajectoryTimingParameters::endElement(name);
+    }
+};
+
+typedef boost::shared_ptr<TOPPParameters> TOPPParametersPtr;
+
+/** \brief Time-optimal path parameterization by reachability analysis (TOPP-RA).
+
+    The path q(s) is discretized into a grid s_0 < ... < s_N. With x = sdot^2 and u = sddot constant on every interval,
+    qdot = q' sqrt(x) and qddot = q' u + q'' x, so every constraint at a grid point is linear in (u, x):
+
+    - dof velocity limits bound x directly
+    - dof acceleration limits are the rows -amax <= q' u + q'' x <= amax
+    - torques are M q' u + (M q'' + C(q,q')q') x + g + friction, the coefficients are computed from KinBody::InverseDynamicsModel
+    - the manipulator tool point p has pdot = p' sqrt(x) and pddot = p' u + p'' x, where p' and p'' are finite differences on the grid
+
+    The constraints of all the grid points are independent, so they are evaluated in parallel. A backward pass then computes
+    the controllable set of every grid point, and a forward pass greedily picks the largest reachable x that stays controllable.
+ */
+class TOPPRetimer : public PlannerBase
+{
+    /// \brief lower <= a*u + b*x <= upper at one grid point
+    struct ConstraintRow
+    {
+        ConstraintRow() : a(0), b(0), lower(-std::numeric_limits<dReal>::infinity()), upper(std::numeric_limits<dReal>::infinity()) {
+        }
+        dReal a, b, lower, upper;
+    };
+
+    /// \brief the torque of one dof is a*u + b*x + foffset + fviscous*sqrt(x), foffset holds gravity and coulomb friction
+    struct TorqueTerms
+    {
+        TorqueTerms() : foffset(0), fviscous(0) {
+        }
+        dReal foffset, fviscous;
+    };
+
+    /// \brief scratch memory of one thread evaluating grid points
+    struct GridThreadData
+    {
+        KinBody::InverseDynamicsModel::Workspace workspace;
+        std::vector<dReal> vfullvalues, vfullvelocities, vfullaccelerations;
+        std::vector<dReal> vgravitytorques, vinertiatorques, vcurvaturetorques, vvelocitytorques1, vvelocitytorques2, vvelocitytorques3;
+    };
+
+public:
+    TOPPRetimer(EnvironmentBasePtr penv, std::istream& sinput) : PlannerBase(penv), _ndof(0), _nrows(0)
+    {
+        __description = "Time-optimal path parameterization by reachability analysis. Keeps the geometric path of the trajectory and computes the fastest timing that respects the dof velocity and acceleration limits, the torque limits computed with inverse dynamics when torquelimitmode is set, and the speed and acceleration limits of the manipulator tool point when manipname is set. If the trajectory has timestamps, the path is the trajectory sampled at numgridpoints times. Otherwise the path is piecewise linear between the waypoints and stops at every waypoint.";
+    }
+
+    virtual PlannerStatus InitPlan(RobotBasePtr pbase, PlannerParametersConstPtr params) override
+    {
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        _parameters.reset(new TOPPParameters());
+        _parameters->copy(params);
+        return _InitPlan() ? PlannerStatus(PS_HasSolution) : PlannerStatus(PS_Failed);
+    }
+
+    virtual PlannerStatus InitPlan(RobotBasePtr pbase, std::istream& isParameters) override
+    {
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        _parameters.reset(new TOPPParameters());
+        isParameters >> *_parameters;
+        return _InitPlan() ? PlannerStatus(PS_HasSolution) : PlannerStatus(PS_Failed);
+    }
+
+    virtual PlannerParametersConstPtr GetParameters() const
+    {
+        return _parameters;
+    }
+
+    virtual PlannerStatus PlanPath(TrajectoryBasePtr ptraj, int planningoptions) override
+    {
+        BOOST_ASSERT(!!_parameters && !!ptraj);
+        if( ptraj->GetNumWaypoints() < 2 ) {
+            return OPENRAVE_PLANNER_STATUS(PS_Failed);
+        }
+
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        const int envid = GetEnv()->GetId();
+        const uint64_t starttime = utils::GetMicroTime();
+        const ConfigurationSpecification& posspec = _parameters->_configurationspecification;
+
+        std::vector<KinBodyPtr> vusedbodies;
+        posspec.ExtractUsedBodies(GetEnv(), vusedbodies);
+        if( vusedbodies.size() != 1 ) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, the configuration has to hold the joints of exactly one body, but it holds %d bodies")%envid%vusedbodies.size()), PS_Failed);
+        }
+        FOREACHC(itgroup, posspec._vgroups) {
+            if( itgroup->name.size() < 12 || itgroup->name.substr(0,12) != "joint_values" ) {
+                return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, group %s is not supported, only joint values can be retimed")%envid%itgroup->name), PS_Failed);
+            }
+        }
+        _pbody = vusedbodies[0];
+
+        std::vector<int> vuseddofindices, vusedconfigindices;
+        posspec.ExtractUsedIndices(_pbody, vuseddofindices, vusedconfigindices);
+        if( (int)vuseddofindices.size() != _ndof ) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, body %s has %d dofs in the configuration, expected %d")%envid%_pbody->GetName()%vuseddofindices.size()%_ndof), PS_Failed);
+        }
+        _vdofindices.resize(_ndof);
+        for(size_t i = 0; i < vuseddofindices.size(); ++i) {
+            _vdofindices.at(vusedconfigindices[i]) = vuseddofindices[i];
+        }
+
+        if( !_DiscretizePath(ptraj) ) {
+            // the path has no length, so there is nothing to time
+            std::vector<dReal> vdata;
+            ConfigurationSpecification newspec = posspec;
+            newspec.AddDeltaTimeGroup();
+            ptraj->GetWaypoints(0, 1, vdata, newspec);
+            ptraj->Init(newspec);
+            ptraj->Insert(0, vdata);
+            return OPENRAVE_PLANNER_STATUS(PS_HasSolution);
+        }
+        const int numintervals = (int)_vgrid.size() - 1;
+
+        // saves the velocities that are set when evaluating the torque limits
+        KinBody::KinBodyStateSaver saver(_pbody, KinBody::Save_LinkVelocities);
+        const bool btorque = _parameters->torquelimitmode == DC_NominalTorque || _parameters->torquelimitmode == DC_InstantaneousTorque;
+        _pmanip.reset();
+        if( _parameters->manipname.size() > 0 && (_parameters->maxmanipspeed > 0 || _parameters->maxmanipaccel > 0) ) {
+            RobotBasePtr probot = RaveInterfaceCast<RobotBase>(_pbody);
+            if( !!probot ) {
+                _pmanip = probot->GetManipulator(_parameters->manipname);
+            }
+            if( !_pmanip ) {
+                return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, body %s does not have manipulator %s")%envid%_pbody->GetName()%_parameters->manipname), PS_Failed);
+            }
+        }
+
+        _pmodel.reset();
+        if( btorque || !!_pmanip ) {
+            KinBody::InverseDynamicsModelPtr pmodel(new KinBody::InverseDynamicsModel());
+            try {
+                _pbody->ExtractInverseDynamicsModel(*pmodel);
+                _pmodel = pmodel;
+            }
+            catch(const openrave_exception& ex) {
+                if( btorque ) {
+                    return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, cannot constrain the torques of body %s: %s")%envid%_pbody->GetName()%ex.what()), PS_Failed);
+                }
+                RAVELOG_DEBUG_FORMAT("env=%d, computing the manipulator positions without an inverse dynamics model: %s", envid%ex.what());
+            }
+        }
+        _pbody->GetDOFValues(_vfullvalues);
+        _tbase = _pbody->GetLinks().at(0)->GetTransform();
+
+        bool bspeeddependenttorques = false;
+        _vtorquedofindices.resize(0);
+        std::vector< std::pair<dReal, dReal> > vtorquelimits;
+        if( btorque ) {
+            std::vector<dReal> vfullvelocities(_pbody->GetDOF(), 0);
+            _pbody->SetDOFVelocities(vfullvelocities, KinBody::CLA_Nothing);
+            FOREACHC(itjoint, _pbody->GetJoints()) {
+                for(int idof = 0; idof < (*itjoint)->GetDOF(); ++idof) {
+                    const std::pair<dReal, dReal> torquelimits = _GetTorqueLimits(**itjoint, idof);
+                    if( torquelimits.first < torquelimits.second ) {
+                        _vtorquedofindices.push_back((*itjoint)->GetDOFIndex()+idof);
+                        vtorquelimits.push_back(torquelimits);
+                    }
+                }
+            }
+
+            // the limits of motors with speed-torque curves drop when moving
+            std::vector<dReal> vmaxvelocities;
+            _pbody->GetDOFVelocityLimits(vmaxvelocities);
+            _pbody->SetDOFVelocities(vmaxvelocities, KinBody::CLA_Nothing);
+            for(size_t itorque = 0; itorque < _vtorquedofindices.size(); ++itorque) {
+                const KinBody::JointPtr& pjoint = _pbody->GetJointFromDOFIndex(_vtorquedofindices[itorque]);
+                const std::pair<dReal, dReal> torquelimits = _GetTorqueLimits(*pjoint, _vtorquedofindices[itorque]-pjoint->GetDOFIndex());
+                if( torquelimits != vtorquelimits[itorque] ) {
+                    bspeeddependenttorques = true;
+                }
+            }
+        }
+
+        _nrows = _ndof + (int)_vtorquedofindices.size() + (!!_pmanip && _parameters->maxmanipaccel > 0 ? 3 : 0);
+        _vrows.resize(0);
+        _vrows.resize((numintervals+1)*_nrows);
+        _vtorqueterms.resize((numintervals+1)*_vtorquedofindices.size());
+        _vxupperbase.resize(numintervals+1);
+        _vmanippoints.resize(!!_pmanip ? numintervals+1 : 0);
+        _vtorquelimits.resize((numintervals+1)*_vtorquedofindices.size());
+        for(int ipoint = 0; ipoint <= numintervals; ++ipoint) {
+            std::copy(vtorquelimits.begin(), vtorquelimits.end(), _vtorquelimits.begin() + ipoint*vtorquelimits.size());
+        }
+
+        _EvaluateGrid();
+        if( !!_pmanip ) {
+            _AddManipConstraints();
+        }
+
+        std::vector<dReal> vx;
+        for(int ipass = 0;; ++ipass) {
+            _UpdateTorqueRows();
+            _UpdateStateBounds();
+            int failedpoint = -1;
+            if( !_ComputeProfile(vx, failedpoint) ) {
+                return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, no feasible velocity at path parameter %.15e (grid point %d/%d)")%envid%_vgrid.at(failedpoint)%failedpoint%numintervals), PS_Failed);
+            }
+            if( ipass > 0 || !bspeeddependenttorques ) {
+                break;
+            }
+
+            // the second pass uses the limits at the speeds of the first pass. Since these limits are lower, the second profile is slower everywhere and the motors can deliver at least these limits.
+            std::vector<dReal> vfullvelocities(_pbody->GetDOF());
+            for(int ipoint = 0; ipoint <= numintervals; ++ipoint) {
+                std::fill(vfullvelocities.begin(), vfullvelocities.end(), 0);
+                const dReal fpathvelocity = RaveSqrt(vx[ipoint]);
+                for(int idof = 0; idof < _ndof; ++idof) {
+                    vfullvelocities[_vdofindices[idof]] = _vpathderivs[ipoint*_ndof+idof]*fpathvelocity;
+                }
+                _pbody->SetDOFVelocities(vfullvelocities, KinBody::CLA_Nothing);
+                for(size_t itorque = 0; itorque < _vtorquedofindices.size(); ++itorque) {
+                    const KinBody::JointPtr& pjoint = _pbody->GetJointFromDOFIndex(_vtorquedofindices[itorque]);
+                    const std::pair<dReal, dReal> torquelimits = _GetTorqueLimits(*pjoint, _vtorquedofindices[itorque]-pjoint->GetDOFIndex());
+                    std::pair<dReal, dReal>& pointlimits = _vtorquelimits[ipoint*_vtorquedofindices.size()+itorque];
+                    pointlimits.first = std::max(pointlimits.first, torquelimits.first);
+                    pointlimits.second = std::min(pointlimits.second, torquelimits.second);
+                }
+            }
+        }
+
+        // positions are cubic between the grid points so that the velocities at the grid points are exact
+        ConfigurationSpecification newspec = posspec;
+        newspec.AddDerivativeGroups(1, true);
+        FOREACH(itgroup, newspec._vgroups) {
+            if( itgroup->name.size() >= 12 && itgroup->name.substr(0,12) == "joint_values" ) {
+                itgroup->interpolation = "cubic";
+            }
+            else if( itgroup->name.size() >= 16 && itgroup->name.substr(0,16) == "joint_velocities" ) {
+                itgroup->interpolation = "quadratic";
+            }
+        }
+        const int newdof = newspec.GetDOF();
+        std::vector<dReal> vdata((numintervals+1)*newdof), vvelocities(_ndof);
+        dReal fduration = 0;
+        for(int ipoint = 0; ipoint <= numintervals; ++ipoint) {
+            dReal fdeltatime = 0;
+            if( ipoint > 0 ) {
+                const dReal fspeedsum = RaveSqrt(vx[ipoint-1]) + RaveSqrt(vx[ipoint]);
+                if( fspeedsum <= g_fEpsilonLinear ) {
+                    return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, the path cannot move between grid points %d and %d")%envid%(ipoint-1)%ipoint), PS_Failed);
+                }
+                fdeltatime = 2*(_vgrid[ipoint] - _vgrid[ipoint-1])/fspeedsum;
+            }
+            fduration += fdeltatime;
+            const dReal fpathvelocity = RaveSqrt(vx[ipoint]);
+            for(int idof = 0; idof < _ndof; ++idof) {
+                vvelocities[idof] = _vpathderivs[ipoint*_ndof+idof]*fpathvelocity;
+            }
+            std::vector<dReal>::iterator itdata = vdata.begin() + ipoint*newdof;
+            newspec.InsertJointValues(itdata, _vpathvalues.begin() + ipoint*_ndof, _pbody, _vdofindices, 0);
+            newspec.InsertJointValues(itdata, vvelocities.begin(), _pbody, _vdofindices, 1);
+            newspec.InsertDeltaTime(itdata, fdeltatime);
+        }
+        ptraj->Init(newspec);
+        ptraj->Insert(0, vdata);
+        RAVELOG_DEBUG_FORMAT("env=%d, TOPP retimed %d grid points with %d constraints each to duration %.15e in %fs", envid%(numintervals+1)%_nrows%fduration%(0.000001f*(float)(utils::GetMicroTime()-starttime)));
+        return OPENRAVE_PLANNER_STATUS(PS_HasSolution);
+    }
+
+protected:
+    bool _InitPlan()
+    {
+        _ndof = _parameters->GetDOF();
+        if( _ndof <= 0 ) {
+            RAVELOG_WARN_FORMAT("env=%d, no dofs to retime", GetEnv()->GetId());
+            return false;
+        }
+        if( (int)_parameters->_vConfigVelocityLimit.size() != _ndof || (int)_parameters->_vConfigAccelerationLimit.size() != _ndof ) {
+            RAVELOG_WARN_FORMAT("env=%d, velocity and acceleration limits need %d values", GetEnv()->GetId()%_ndof);
+            return false;
+        }
+        if( _parameters->numgridpoints < 2 ) {
+            RAVELOG_WARN_FORMAT("env=%d, numgridpoints is %d, setting it to 2", GetEnv()->GetId()%_parameters->numgridpoints);
+            _parameters->numgridpoints = 2;
+        }
+        return true;
+    }
+
+    std::pair<dReal, dReal> _GetTorqueLimits(const KinBody::Joint& joint, int iaxis) const
+    {
+        if( _parameters->torquelimitmode == DC_InstantaneousTorque ) {
+            return joint.GetInstantaneousTorqueLimits(iaxis);
+        }
+        return joint.GetNominalTorqueLimits(iaxis);
+    }
+
+    /// \brief fills the grid with the path values and their first two derivatives with respect to the path parameter
+    ///
+    /// \return false if the path has no length
+    bool _DiscretizePath(TrajectoryBasePtr ptraj)
+    {
+        const ConfigurationSpecification& posspec = _parameters->_configurationspecification;
+        _vgrid.resize(0);
+        _vpathvalues.resize(0);
+        _vstoppoints.resize(0);
+        std::vector<dReal> vvalues, vdelta;
+        const dReal fduration = ptraj->GetDuration();
+        if( _parameters->_hastimestamps && fduration > g_fEpsilonLinear ) {
+            // the path parameter is the original time
+            const int numintervals = _parameters->numgridpoints;
+            for(int ipoint = 0; ipoint <= numintervals; ++ipoint) {
+                const dReal s = ipoint < numintervals ? fduration*ipoint/numintervals : fduration;
+                ptraj->Sample(vvalues, s, posspec);
+                _vgrid.push_back(s);
+                _vpathvalues.insert(_vpathvalues.end(), vvalues.begin(), vvalues.end());
+                _vstoppoints.push_back(ipoint == 0 || ipoint == numintervals);
+            }
+            _vpathderivs.resize(_vpathvalues.size());
+            _ComputeGridDerivatives(_vpathvalues, _vpathderivs, _ndof, true, false);
+            _vpathsecondderivs.resize(_vpathderivs.size());
+            _ComputeGridDerivatives(_vpathderivs, _vpathsecondderivs, _ndof, false, true);
+        }
+        else {
+            // piecewise linear in the distance along the path, stopping at every waypoint
+            std::vector<dReal> vwaypoints, vlengths;
+            ptraj->GetWaypoints(0, ptraj->GetNumWaypoints(), vwaypoints, posspec);
+            const int numwaypoints = ptraj->GetNumWaypoints();
+            std::vector<dReal> vdeltas;
+            dReal ftotallength = 0;
+            for(int iwaypoint = 0; iwaypoint+1 < numwaypoints; ++iwaypoint) {
+                vdelta.assign(vwaypoints.begin() + (iwaypoint+1)*_ndof, vwaypoints.begin() + (iwaypoint+2)*_ndof);
+                vvalues.assign(vwaypoints.begin() + iwaypoint*_ndof, vwaypoints.begin() + (iwaypoint+1)*_ndof);
+                _parameters->_diffstatefn(vdelta, vvalues);
+                dReal flength = 0;
+                FOREACHC(itdelta, vdelta) {
+                    flength += *itdelta * *itdelta;
+                }
+                vlengths.push_back(RaveSqrt(flength));
+                vdeltas.insert(vdeltas.end(), vdelta.begin(), vdelta.end());
+                ftotallength += vlengths.back();
+            }
+            if( ftotallength <= g_fEpsilonLinear ) {
+                return false;
+            }
+
+            _vpathderivs.resize(0);
+            dReal s = 0;
+            for(int iwaypoint = 0; iwaypoint+1 < numwaypoints; ++iwaypoint) {
+                const dReal flength = vlengths[iwaypoint];
+                if( flength <= g_fEpsilonLinear ) {
+                    continue;
+                }
+                // at least two intervals so that the path can move between the stops
+                const int numintervals = std::max(2, (int)(_parameters->numgridpoints*flength/ftotallength + 0.5));
+                for(int iinterval = 0; iinterval < numintervals; ++iinterval) {
+                    const dReal t = dReal(iinterval)/dReal(numintervals);
+                    _vgrid.push_back(s + t*flength);
+                    for(int idof = 0; idof < _ndof; ++idof) {
+                        _vpathvalues.push_back(vwaypoints[iwaypoint*_ndof+idof] + t*vdeltas[iwaypoint*_ndof+idof]);
+                        _vpathderivs.push_back(vdeltas[iwaypoint*_ndof+idof]/flength);
+                    }
+                    _vstoppoints.push_back(iinterval == 0);
+                }
+                s += flength;
+            }
+            _vgrid.push_back(s);
+            _vpathvalues.insert(_vpathvalues.end(), vwaypoints.end() - _ndof, vwaypoints.end());
+            const std::vector<dReal> vlastderivs(_vpathderivs.end() - _ndof, _vpathderivs.end());
+            _vpathderivs.insert(_vpathderivs.end(), vlastderivs.begin(), vlastderivs.end());
+            _vstoppoints.push_back(1);
+            // straight segments
+            _vpathsecondderivs.resize(0);
+            _vpathsecondderivs.resize(_vpathderivs.size(), 0);
+        }
+        return true;
+    }
+
+    /// \brief central differences on the grid. At stop points the path can have a corner, so the difference is taken forward.
+    ///
+    /// \param busediff if true, uses _diffstatefn to difference the values
+    /// \param bjumpsatstops if true, the values at stop points belong to the next segment, so they are not used by the previous point
+    void _ComputeGridDerivatives(const std::vector<dReal>& vvalues, std::vector<dReal>& vderivs, int dof, bool busediff, bool bjumpsatstops)
+    {
+        const int numintervals = (int)_vgrid.size() - 1;
+        std::vector<dReal> vdelta(dof), vprev(dof);
+        for(int ipoint = 0; ipoint <= numintervals; ++ipoint) {
+            int iprev = ipoint > 0 ? ipoint-1 : 0;
+            int inext = ipoint < numintervals ? ipoint+1 : numintervals;
+            if( _vstoppoints[ipoint] && ipoint < numintervals ) {
+                iprev = ipoint;
+            }
+            if( bjumpsatstops && inext > ipoint && _vstoppoints[inext] && inext < numintervals ) {
+                inext = ipoint;
+            }
+            if( inext == iprev ) {
+                std::fill(vderivs.begin() + ipoint*dof, vderivs.begin() + (ipoint+1)*dof, dReal(0));
+                continue;
+            }
+            const dReal fdeltas = _vgrid[inext] - _vgrid[iprev];
+            vdelta.assign(vvalues.begin() + inext*dof, vvalues.begin() + (inext+1)*dof);
+            if( busediff ) {
+                vprev.assign(vvalues.begin() + iprev*dof, vvalues.begin() + (iprev+1)*dof);
+                _parameters->_diffstatefn(vdelta, vprev);
+            }
+            else {
+                for(int i = 0; i < dof; ++i) {
+                    vdelta[i] -= vvalues[iprev*dof+i];
+                }
+            }
+            for(int i = 0; i < dof; ++i) {
+                vderivs[ipoint*dof+i] = vdelta[i]/fdeltas;
+            }
+        }
+    }
+
+    /// \brief evaluates the constraints of all the grid points in parallel
+    void _EvaluateGrid()
+    {
+        const int numpoints = (int)_vgrid.size();
+        // the points are cheap without a model, so dispatching to the thread pool is not worth it
+        int numtasks = 1;
+        if( !!_pmodel ) {
+            // the workers and the calling thread
+            numtasks = _parameters->numthreads > 0 ? _parameters->numthreads : RaveGetThreadPool()->GetNumThreads() + 1;
+            numtasks = std::min(numtasks, numpoints);
+        }
+
+        // every task takes the next point with its own scratch data, so that at most numthreads points are evaluated at once
+        std::atomic<int> nextpoint(0);
+        RaveGetThreadPool()->ParallelFor(numtasks, [&](size_t) {
+            GridThreadData data;
+            for(int ipoint = nextpoint++; ipoint < numpoints; ipoint = nextpoint++) {
+                _EvaluateGridPoint(ipoint, data);
+            }
+        });
+
+        if( !!_pmanip && !_pmodel ) {
+            // no model, so compute the tool points with the body
+            KinBody::KinBodyStateSaver saver(_pbody, KinBody::Save_LinkTransformation);
+            std::vector<dReal> vvalues(_ndof);
+            for(int ipoint = 0; ipoint < numpoints; ++ipoint) {
+                vvalues.assign(_vpathvalues.begin() + ipoint*_ndof, _vpathvalues.begin() + (ipoint+1)*_ndof);
+                _pbody->SetDOFValues(vvalues, KinBody::CLA_Nothing, _vdofindices);
+                _vmanippoints[ipoint] = _pmanip->GetTransform().trans;
+            }
+        }
+    }
+
+    /// \brief fills the velocity bound, the dof acceleration rows, the torque rows and the tool point of one grid point. Only uses the model, so it can be called from any thread.
+    void _EvaluateGridPoint(int ipoint, GridThreadData& data)
+    {
+        const dReal* pderivs = &_vpathderivs[ipoint*_ndof];
+        const dReal* psecondderivs = &_vpathsecondderivs[ipoint*_ndof];
+        dReal& fxupper = _vxupperbase[ipoint];
+        fxupper = _vstoppoints[ipoint] ? 0 : s_fMaxSquaredPathVelocity;
+        ConstraintRow* prows = &_vrows[ipoint*_nrows];
+        for(int idof = 0; idof < _ndof; ++idof) {
+            const dReal fderiv = RaveFabs(pderivs[idof]);
+            if( fderiv > g_fEpsilonLinear ) {
+                const dReal fmaxpathvelocity = _parameters->_vConfigVelocityLimit[idof]/fderiv;
+                fxupper = std::min(fxupper, fmaxpathvelocity*fmaxpathvelocity);
+            }
+            prows[idof].a = pderivs[idof];
+            prows[idof].b = psecondderivs[idof];
+            prows[idof].lower = -_parameters->_vConfigAccelerationLimit[idof];
+            prows[idof].upper = _parameters->_vConfigAccelerationLimit[idof];
+        }
+
+        if( !_pmodel ) {
+            return;
+        }
+
+        const int nfulldof = _pmodel->GetDOF();
+        if( (int)data.vfullvalues.size() != nfulldof ) {
+            data.vfullvalues = _vfullvalues;
+            data.vfullvelocities.resize(nfulldof);
+            data.vfullaccelerations.resize(nfulldof);
+            data.vgravitytorques.resize(nfulldof);
+            data.vinertiatorques.resize(nfulldof);
+            data.vcurvaturetorques.resize(nfulldof);
+            data.vvelocitytorques1.resize(nfulldof);
+            data.vvelocitytorques2.resize(nfulldof);
+            data.vvelocitytorques3.resize(nfulldof);
+        }
+        for(int idof = 0; idof < _ndof; ++idof) {
+            data.vfullvalues[_vdofindices[idof]] = _vpathvalues[ipoint*_ndof+idof];
+        }
+        _pmodel->ComputeInverseDynamics(_tbase, &data.vfullvalues[0], NULL, NULL, &data.vgravitytorques[0], data.workspace);
+        if( !!_pmanip ) {
+            _vmanippoints[ipoint] = data.workspace.vlinktransforms.at(_pmanip->GetEndEffector()->GetIndex()) * _pmanip->GetLocalToolTransform().trans;
+        }
+        if( _vtorquedofindices.size() == 0 ) {
+            return;
+        }
+
+        // M q' from the accelerations q', and M q'' from the accelerations q''
+        std::fill(data.vfullaccelerations.begin(), data.vfullaccelerations.end(), 0);
+        for(int idof = 0; idof < _ndof; ++idof) {
+            data.vfullaccelerations[_vdofindices[idof]] = pderivs[idof];
+        }
+        _pmodel->ComputeInverseDynamics(_tbase, &data.vfullvalues[0], NULL, &data.vfullaccelerations[0], &data.vinertiatorques[0], data.workspace);
+        for(int idof = 0; idof < _ndof; ++idof) {
+            data.vfullaccelerations[_vdofindices[idof]] = psecondderivs[idof];
+        }
+        _pmodel->ComputeInverseDynamics(_tbase, &data.vfullvalues[0], NULL, &data.vfullaccelerations[0], &data.vcurvaturetorques[0], data.workspace);
+
+        // the torques at the velocities k*q' are g + k^2 C(q,q')q' + k V + coulomb, so three k separate the three terms
+        std::fill(data.vfullvelocities.begin(), data.vfullvelocities.end(), 0);
+        for(int k = 1; k <= 3; ++k) {
+            for(int idof = 0; idof < _ndof; ++idof) {
+                data.vfullvelocities[_vdofindices[idof]] = k*pderivs[idof];
+            }
+            dReal* ptorques = k == 1 ? &data.vvelocitytorques1[0] : (k == 2 ? &data.vvelocitytorques2[0] : &data.vvelocitytorques3[0]);
+            _pmodel->ComputeInverseDynamics(_tbase, &data.vfullvalues[0], &data.vfullvelocities[0], NULL, ptorques, data.workspace);
+        }
+
+        const size_t numtorques = _vtorquedofindices.size();
+        for(size_t itorque = 0; itorque < numtorques; ++itorque) {
+            const int dofindex = _vtorquedofindices[itorque];
+            const dReal fgravity = data.vgravitytorques[dofindex];
+            const dReal y1 = data.vvelocitytorques1[dofindex], y2 = data.vvelocitytorques2[dofindex], y3 = data.vvelocitytorques3[dofindex];
+            const dReal fcoriolis = 0.5*(y1 - 2*y2 + y3);
+            const dReal fviscous = y2 - y1 - 3*fcoriolis;
+            ConstraintRow& row = prows[_ndof+itorque];
+            row.a = data.vinertiatorques[dofindex] - fgravity;
+            row.b = data.vcurvaturetorques[dofindex] - fgravity + fcoriolis;
+            TorqueTerms& terms = _vtorqueterms[ipoint*numtorques+itorque];
+            terms.foffset = y1 - fcoriolis - fviscous;
+            terms.fviscous = RaveFabs(fviscous);
+        }
+    }
+
+    /// \brief adds the manipulator speed bound and acceleration rows from the finite differences of the tool points
+    void _AddManipConstraints()
+    {
+        const int numpoints = (int)_vgrid.size();
+        std::vector<dReal> vpoints(numpoints*3), vderivs(numpoints*3), vsecondderivs(numpoints*3);
+        for(int ipoint = 0; ipoint < numpoints; ++ipoint) {
+            for(int j = 0; j < 3; ++j) {
+                vpoints[ipoint*3+j] = _vmanippoints[ipoint][j];
+            }
+        }
+        _ComputeGridDerivatives(vpoints, vderivs, 3, false, false);
+        _ComputeGridDerivatives(vderivs, vsecondderivs, 3, false, true);
+
+        // a box inscribed in the sphere of maxmanipaccel
+        const dReal fmaxaxisaccel = _parameters->maxmanipaccel/RaveSqrt(dReal(3));
+        for(int ipoint = 0; ipoint < numpoints; ++ipoint) {
+            const dReal* pderiv = &vderivs[ipoint*3];
+            if( _parameters->maxmanipspeed > 0 ) {
+                const dReal fderivsqr = pderiv[0]*pderiv[0] + pderiv[1]*pderiv[1] + pderiv[2]*pderiv[2];
+                if( fderivsqr > g_fEpsilonLinear ) {
+                    _vxupperbase[ipoint] = std::min(_vxupperbase[ipoint], _parameters->maxmanipspeed*_parameters->maxmanipspeed/fderivsqr);
+                }
+            }
+            if( _parameters->maxmanipaccel > 0 ) {
+                ConstraintRow* prows = &_vrows[ipoint*_nrows + _nrows - 3];
+                for(int j = 0; j < 3; ++j) {
+                    prows[j].a = pderiv[j];
+                    prows[j].b = vsecondderivs[ipoint*3+j];
+                    prows[j].lower = -fmaxaxisaccel;
+                    prows[j].upper = fmaxaxisaccel;
+                }
+            }
+        }
+    }
+
+    /// \brief sets the bounds of the torque rows from the torque limits. Viscous friction is not linear in x, so its largest value is taken out of the limits.
+    void _UpdateTorqueRows()
+    {
+        const size_t numtorques = _vtorquedofindices.size();
+        for(size_t ipoint = 0; ipoint < _vgrid.size(); ++ipoint) {
+            const dReal fmaxpathvelocity = RaveSqrt(_vxupperbase[ipoint]);
+            for(size_t itorque = 0; itorque < numtorques; ++itorque) {
+                const TorqueTerms& terms = _vtorqueterms[ipoint*numtorques+itorque];
+                const std::pair<dReal, dReal>& torquelimits = _vtorquelimits[ipoint*numtorques+itorque];
+                ConstraintRow& row = _vrows[ipoint*_nrows + _ndof + itorque];
+                row.lower = torquelimits.first - terms.foffset + terms.fviscous*fmaxpathvelocity;
+                row.upper = torquelimits.second - terms.foffset - terms.fviscous*fmaxpathvelocity;
+            }
+        }
+    }
+
+    /// \brief rows that do not depend on u only bound x, so they are moved into the state bounds
+    void _UpdateStateBounds()
+    {
+        const size_t numpoints = _vgrid.size();
+        _vxlower.resize(numpoints);
+        _vxupper.resize(numpoints);
+        for(size_t ipoint = 0; ipoint < numpoints; ++ipoint) {
+            dReal fxlower = 0, fxupper = _vxupperbase[ipoint];
+            const ConstraintRow* prows = &_vrows[ipoint*_nrows];
+            for(int irow = 0; irow < _nrows; ++irow) {
+                const ConstraintRow& row = prows[irow];
+                if( RaveFabs(row.a) > g_fEpsilonLinear ) {
+                    continue;
+                }
+                if( row.b > g_fEpsilonLinear ) {
+                    fxlower = std::max(fxlower, row.lower/row.b);
+                    fxupper = std::min(fxupper, row.upper/row.b);
+                }
+                else if( row.b < -g_fEpsilonLinear ) {
+                    fxlower = std::max(fxlower, row.upper/row.b);
+                    fxupper = std::min(fxupper, row.lower/row.b);
+                }
+                else if( row.lower > s_fFeasibilityTolerance || row.upper < -s_fFeasibilityTolerance ) {
+                    fxupper = -1;
+                }
+            }
+            _vxlower[ipoint] = fxlower;
+            _vxupper[ipoint] = fxupper;
+        }
+    }
+
+    /// \brief bounds of u at grid point ipoint and state x such that all the rows hold and the next state is in [fnextlower, fnextupper]
+    void _GetAccelerationBounds(int ipoint, dReal x, dReal fnextlower, dReal fnextupper, dReal& flower, dReal& fupper) const
+    {
+        const dReal f2delta = 2*(_vgrid[ipoint+1] - _vgrid[ipoint]);
+        flower = (fnextlower - x)/f2delta;
+        fupper = (fnextupper - x)/f2delta;
+        const ConstraintRow* prows = &_vrows[ipoint*_nrows];
+        for(int irow = 0; irow < _nrows; ++irow) {
+            const ConstraintRow& row = prows[irow];
+            if( row.a > g_fEpsilonLinear ) {
+                flower = std::max(flower, (row.lower - row.b*x)/row.a);
+                fupper = std::min(fupper, (row.upper - row.b*x)/row.a);
+            }
+            else if( row.a < -g_fEpsilonLinear ) {
+                flower = std::max(flower, (row.upper - row.b*x)/row.a);
+                fupper = std::min(fupper, (row.lower - row.b*x)/row.a);
+            }
+        }
+    }
+
+    inline dReal _GetAccelerationMargin(int ipoint, dReal x, dReal fnextlower, dReal fnextupper) const
+    {
+        dReal flower, fupper;
+        _GetAccelerationBounds(ipoint, x, fnextlower, fnextupper, flower, fupper);
+        return fupper - flower;
+    }
+
+    /** \brief computes the interval of states at ipoint from which the next controllable set [fnextlower, fnextupper] can be reached
+
+        The rows are linear in (u, x), so the margin between the largest and the smallest feasible u is concave in x and the set is an interval.
+        The maximum of the margin is found by golden section search, the ends of the interval by bisection towards it.
+     */
+    bool _ComputeControllableSet(int ipoint, dReal fnextlower, dReal fnextupper, dReal& flower, dReal& fupper) const
+    {
+        const dReal fxlower = _vxlower[ipoint], fxupper = _vxupper[ipoint];
+        if( fxlower > fxupper + s_fFeasibilityTolerance ) {
+            return false;
+        }
+        const dReal fgolden = 0.38196601125010515;
+        dReal x0 = fxlower, x1 = std::max(fxlower, fxupper);
+        for(int iter = 0; iter < 200 && x1 - x0 > s_fFeasibilityTolerance; ++iter) {
+            const dReal m0 = x0 + fgolden*(x1 - x0), m1 = x1 - fgolden*(x1 - x0);
+            if( _GetAccelerationMargin(ipoint, m0, fnextlower, fnextupper) < _GetAccelerationMargin(ipoint, m1, fnextlower, fnextupper) ) {
+                x0 = m0;
+            }
+            else {
+                x1 = m1;
+            }
+        }
+        const dReal xbest = 0.5*(x0 + x1);
+        if( _GetAccelerationMargin(ipoint, xbest, fnextlower, fnextupper) < -s_fFeasibilityTolerance ) {
+            return false;
+        }
+
+        flower = xbest;
+        fupper = xbest;
+        for(int iside = 0; iside < 2; ++iside) {
+            const dReal xend = iside == 0 ? fxlower : std::max(fxlower, fxupper);
+            dReal xgood = xbest, xbad = xend;
+            if( _GetAccelerationMargin(ipoint, xend, fnextlower, fnextupper) >= -s_fFeasibilityTolerance ) {
+                xgood = xend;
+            }
+            else {
+                for(int iter = 0; iter < 100 && RaveFabs(xbad - xgood) > s_fFeasibilityTolerance; ++iter) {
+                    const dReal xmid = 0.5*(xgood + xbad);
+                    if( _GetAccelerationMargin(ipoint, xmid, fnextlower, fnextupper) >= -s_fFeasibilityTolerance ) {
+                        xgood = xmid;
+                    }
+                    else {
+                        xbad = xmid;
+                    }
+                }
+            }
+            if( iside == 0 ) {
+                flower = xgood;
+            }
+            else {
+                fupper = xgood;
+            }
+        }
+        return true;
+    }
+
+    /// \brief computes the squared path velocity of every grid point
+    ///
+    /// \param[out] failedpoint if the path cannot be timed, the grid point without controllable states
+    bool _ComputeProfile(std::vector<dReal>& vx, int& failedpoint)
+    {
+        const int numintervals = (int)_vgrid.size() - 1;
+        std::vector<dReal>& vcontrollable = _vcontrollablesets;
+        vcontrollable.resize(2*(numintervals+1));
+        vcontrollable[2*numintervals] = 0;
+        vcontrollable[2*numintervals+1] = 0;
+        for(int ipoint = numintervals-1; ipoint >= 0; --ipoint) {
+            if( !_ComputeControllableSet(ipoint, vcontrollable[2*ipoint+2], vcontrollable[2*ipoint+3], vcontrollable[2*ipoint], vcontrollable[2*ipoint+1]) ) {
+                failedpoint = ipoint;
+                return false;
+            }
+        }
+        if( vcontrollable[0] > s_fFeasibilityTolerance ) {
+            failedpoint = 0;
+            return false;
+        }
+
+        vx.resize(numintervals+1);
+        vx[0] = 0;
+        for(int ipoint = 0; ipoint < numintervals; ++ipoint) {
+            const dReal fnextlower = vcontrollable[2*ipoint+2], fnextupper = vcontrollable[2*ipoint+3];
+            dReal flower, fupper;
+            _GetAccelerationBounds(ipoint, vx[ipoint], fnextlower, fnextupper, flower, fupper);
+            const dReal fnext = vx[ipoint] + 2*(_vgrid[ipoint+1] - _vgrid[ipoint])*fupper;
+            vx[ipoint+1] = std::max(dReal(0), std::min(fnextupper, std::max(fnextlower, fnext)));
+        }
+        vx[numintervals] = 0;
+        return true;
+    }
+
+    static const dReal s_fMaxSquaredPathVelocity; ///< bounds x where no constraint does
+    static const dReal s_fFeasibilityTolerance;
+
+    TOPPParametersPtr _parameters;
+    int _ndof; ///< dof of the configuration
+    int _nrows; ///< number of rows at every grid point: the dof accelerations, the torques, and the manipulator accelerations
+    KinBodyPtr _pbody;
+    RobotBase::ManipulatorPtr _pmanip;
+    KinBody::InverseDynamicsModelPtr _pmodel;
+    std::vector<int> _vdofindices; ///< for every configuration index the dof index of _pbody
+    std::vector<int> _vtorquedofindices; ///< dofs of _pbody with torque limits
+    std::vector<dReal> _vfullvalues; ///< dof values of _pbody, the dofs not in the configuration keep them
+    Transform _tbase;
+
+    std::vector<dReal> _vgrid; ///< path parameter of every grid point
+    std::vector<dReal> _vpathvalues, _vpathderivs, _vpathsecondderivs; ///< q, q' and q'' at every grid point
+    std::vector<uint8_t> _vstoppoints; ///< 1 if the path has to stop at the grid point
+    std::vector<Vector> _vmanippoints; ///< tool point at every grid point
+    std::vector<ConstraintRow> _vrows; ///< _nrows for every grid point
+    std::vector<TorqueTerms> _vtorqueterms; ///< _vtorquedofindices.size() for every grid point
+    std::vector< std::pair<dReal, dReal> > _vtorquelimits; ///< _vtorquedofindices.size() for every grid point
+    std::vector<dReal> _vxupperbase; ///< upper bound of x from the velocity limits
+    std::vector<dReal> _vxlower, _vxupper; ///< bounds of x from all the constraints
+    std::vector<dReal> _vcontrollablesets; ///< 2 values for every grid point
+};
+
+const dReal TOPPRetimer::s_fMaxSquaredPathVelocity = 1e8;
+const dReal TOPPRetimer::s_fFeasibilityTolerance = 1e-9;
+
+PlannerBasePtr CreateTOPPRetimer(EnvironmentBasePtr penv, std::istream& sinput)
+{
+    return PlannerBasePtr(new TOPPRetimer(penv, sinput));
+}
+
+} // end namespace rplanners
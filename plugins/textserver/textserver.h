@@ -17,9 +17,13 @@
 #ifndef OPENRAVE_TEXTSERVER
 #define OPENRAVE_TEXTSERVER
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <set>
 #include <openrave/planningutils.h>
+#include <openrave/utils.h>
 #include <cstdlib>
 #include <boost/bind/bind.hpp>
 
@@ -46,7 +50,20 @@ typedef int socklen_t;
 #define CLOSESOCKET close
 #endif
 
-/// manages all connections. At the moment, server can handle only one connectino at a time
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#define TEXTSERVER_HAS_EPOLL
+#endif
+
+/// manages all connections.
+///
+/// By default every connection gets its own read thread. With the epoll option (linux only), a single thread multiplexes all the
+/// connections and runs the requests on a thread pool. The requests of a connection can be pipelined, they are executed one at a time
+/// and answered in the order they were received. The read-only commands can optionally run on a per-connection clone of
+/// the environment so that clients do not contend for the environment lock.
 class SimpleTextServer : public ModuleBase
 {
     // socket just accepts connections
@@ -239,6 +256,34 @@ public:
             return true;
         }
 
+        /// \brief appends the next size bytes received to s
+        bool ReadData(string& s, size_t size)
+        {
+            size_t offset = s.size();
+            s.resize(offset+size);
+            int failed = 0;
+            while(offset < s.size()) {
+                long nBytesReceived = recv(client_sockfd, &s[offset], s.size()-offset, 0);
+                if( nBytesReceived > 0 ) {
+                    offset += nBytesReceived;
+                }
+                else if( nBytesReceived == 0 ) {
+                    return false;
+                }
+                else {
+                    if( failed < 10 ) {
+                        failed++;
+                        usleep(1000);
+                        continue;
+                    }
+                    perror("failed to read data");
+                    Close();
+                    return false;
+                }
+            }
+            return true;
+        }
+
 private:
         int client_sockfd;
         int client_len;
@@ -270,11 +315,25 @@ private:
     };
 
 public:
-    SimpleTextServer(EnvironmentBasePtr penv) : ModuleBase(penv) {
+    /// \param bOpenLog if true, logs the network commands to textserver.log in the openrave home directory
+    SimpleTextServer(EnvironmentBasePtr penv, bool bOpenLog=true) : ModuleBase(penv) {
         _nIdIndex = 1;
         _nNextFigureId = 1;
         _bWorking = false;
         bDestroying = false;
+        bInitThread = false;
+        bCloseThread = false;
+        server_sockfd = 0;
+        _bUseEpoll = false;
+        _bCloneEnvironments = false;
+        _nNumWorkers = 0;
+        _nMaxConnectionPending = 64;
+        _nMaxPendingRequests = 1024;
+#ifdef TEXTSERVER_HAS_EPOLL
+        _nEpollPending = 0;
+        _epollfd = -1;
+        _eventfd = -1;
+#endif
         __description=":Interface Author: Rosen Diankov\n\nSimple text-based server using sockets.";
         mapNetworkFns["body_checkcollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvCheckCollision, this, _1, _2, _3), OpenRaveWorkerFn(), true);
         mapNetworkFns["body_getjoints"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetJointValues, this,_1, _2, _3), OpenRaveWorkerFn(), true);
@@ -302,6 +361,7 @@ public:
         mapNetworkFns["loadscene"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvLoadScene,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["plot"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvPlot,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["problem_sendcmd"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orProblemSendCommand,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["problem_sendmsgpackcmd"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orProblemSendMsgPackCommand,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["robot_checkselfcollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotCheckSelfCollision,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["robot_controllersend"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotControllerSend,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["robot_controllerset"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotControllerSet,this,_1,_2,_3), OpenRaveWorkerFn(), true);
@@ -322,16 +382,30 @@ public:
         mapNetworkFns["test"] = RAVENETWORKFN(OpenRaveNetworkFn(), OpenRaveWorkerFn(), false);
         mapNetworkFns["wait"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvWait,this,_1,_2,_3), OpenRaveWorkerFn(), true);
 
-        string logfilename = RaveGetHomeDirectory() + string("/textserver.log");
-        flog.open(logfilename.c_str());
-        if( !!flog )
-            RAVELOG_DEBUG("logging network to %s.txt\n",logfilename.c_str());
+        // commands that do not modify the environment, they can run on a clone of it. module commands are not among them since they can move or grab bodies
+        const char* cloneablecommands[] = {"body_checkcollision", "body_getjoints", "body_getaabb", "body_getaabbs", "body_getlinks", "body_getdof", "env_getbodies", "env_getrobots", "env_getbody", "env_raycollision", "env_triangulate", "robot_checkselfcollision", "robot_getactivedof", "robot_getdofvalues", "robot_getlimits", "robot_getmanipulators"};
+        _setCloneableCommands.insert(cloneablecommands, cloneablecommands+sizeof(cloneablecommands)/sizeof(cloneablecommands[0]));
+
+        if( bOpenLog ) {
+            string logfilename = RaveGetHomeDirectory() + string("/textserver.log");
+            flog.open(logfilename.c_str());
+            if( !!flog )
+                RAVELOG_DEBUG("logging network to %s.txt\n",logfilename.c_str());
+        }
     }
 
     virtual ~SimpleTextServer() {
         Destroy();
     }
 
+    /// \brief starts the server
+    ///
+    /// \param cmd port [epoll] [numworkers n] [maxpending n] [maxqueued n] [clone 0|1]
+    /// - epoll - multiplex all connections on one thread and run the requests on a thread pool (linux only)
+    /// - numworkers - number of threads of the pool of the epoll server, if 0 uses the process thread pool
+    /// - maxpending - maximum number of pipelined requests queued per connection before the server stops reading from it
+    /// - maxqueued - maximum number of requests queued over all connections before the server stops reading from them
+    /// - clone - if 1, the read-only commands of a connection run on a clone of the environment owned by the connection
     virtual int main(const std::string& cmd)
     {
         _nPort = 4765;
@@ -340,6 +414,46 @@ public:
 
         Destroy();
 
+        _bUseEpoll = false;
+        _bCloneEnvironments = false;
+        _nNumWorkers = 0;
+        _nMaxConnectionPending = 64;
+        _nMaxPendingRequests = 1024;
+        string option;
+        while( !!ss ) {
+            ss >> option;
+            if( !ss ) {
+                break;
+            }
+            std::transform(option.begin(), option.end(), option.begin(), ::tolower);
+            if( option == "epoll" ) {
+                _bUseEpoll = true;
+            }
+            else if( option == "numworkers" ) {
+                ss >> _nNumWorkers;
+            }
+            else if( option == "maxpending" ) {
+                ss >> _nMaxConnectionPending;
+            }
+            else if( option == "maxqueued" ) {
+                ss >> _nMaxPendingRequests;
+            }
+            else if( option == "clone" ) {
+                ss >> _bCloneEnvironments;
+            }
+            else {
+                RAVELOG_WARN_FORMAT("unknown textserver option '%s'", option);
+            }
+        }
+        _nMaxConnectionPending = max(1, _nMaxConnectionPending);
+        _nMaxPendingRequests = max(_nMaxConnectionPending, _nMaxPendingRequests);
+#ifndef TEXTSERVER_HAS_EPOLL
+        if( _bUseEpoll ) {
+            RAVELOG_WARN("epoll is not supported on this platform, using one thread per connection\n");
+            _bUseEpoll = false;
+        }
+#endif
+
 #ifdef _WIN32
         WORD wVersionRequested;
         WSADATA wsaData;
@@ -406,7 +520,19 @@ public:
 #endif
 
         RAVELOG_DEBUG("text server listening on port %d\n",_nPort);
-        _servthread = boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_listen_threadcb, this));
+#ifdef TEXTSERVER_HAS_EPOLL
+        if( _bUseEpoll ) {
+            if( !_InitEpoll() ) {
+                return -1;
+            }
+            RAVELOG_DEBUG_FORMAT("text server using epoll with %d threads, maxpending=%d, maxqueued=%d, clone=%d", _pthreadpool->GetNumThreads()%_nMaxConnectionPending%_nMaxPendingRequests%_bCloneEnvironments);
+            _servthread = boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_epoll_threadcb, this));
+        }
+        else
+#endif
+        {
+            _servthread = boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_listen_threadcb, this));
+        }
         _workerthread = boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_worker_threadcb, this));
         bInitThread = true;
         return 0;
@@ -439,6 +565,9 @@ public:
                 (*it)->join();
             }
             _listReadThreads.clear();
+#ifdef TEXTSERVER_HAS_EPOLL
+            _DestroyEpoll();
+#endif
             _condHasWork.notify_all();
             if( !!_workerthread ) {
                 _workerthread->join();
@@ -561,91 +690,576 @@ private:
     void _read_threadcb(SocketPtr psocket)
     {
         RAVELOG_VERBOSE("started new server connection\n");
-        string cmd, line;
-        stringstream sout;
+        string line, sresult;
         while(!bCloseThread) {
             if( psocket->ReadLine(line) && line.length() ) {
+                size_t payloadsize = _GetRequestPayloadSize(line);
+                if( payloadsize > 0 ) {
+                    line.push_back('\n');
+                    if( !psocket->ReadData(line, payloadsize) ) {
+                        RAVELOG_ERROR("failed to read the %d bytes following the request\n", (int)payloadsize);
+                        continue;
+                    }
+                }
+                if( _ProcessRequest(line, sresult) ) {
+                    psocket->SendData(sresult.c_str(), sresult.size());
+                }
+            }
+            else if( !psocket->IsInit() ) {
+                break;
+            }
+            usleep(1000);
+        }
+
+        RAVELOG_VERBOSE("Closing socket connection\n");
+    }
+
+    /// \brief executes one request line received from a client
+    ///
+    /// The socket function of the command runs on the calling thread, its worker function is scheduled on the worker thread.
+    /// \param sresult filled with the data to send back to the client
+    /// \return true if sresult has to be sent to the client
+    bool _ProcessRequest(const string& line, string& sresult)
+    {
+        sresult.resize(0);
+        if( !!flog &&( GetEnv()->GetDebugLevel()>0) ) {
+            std::lock_guard<std::mutex> lock(_mutexLog);
+            static int index=0;
+            flog << index++ << ": " << line.substr(0, line.find('\n')) << endl;
+        }
+
+        string cmd;
+        boost::shared_ptr<istream> is(new stringstream(line));
+        *is >> cmd;
+        if( !*is ) {
+            RAVELOG_ERROR("Failed to get command\n");
+            sresult = "e";
+            return true;
+        }
+        std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+        stringstream::pos_type inputpos = is->tellg();
+
+        map<string, RAVENETWORKFN>::iterator itfn = mapNetworkFns.find(cmd);
+        if( itfn == mapNetworkFns.end() ) {
+            RAVELOG_ERROR("Failed to recognize command: %s\n", cmd.c_str());
+            sresult = "e";
+            return true;
+        }
+
+        bool bCallWorker = true, bSendResult = false;
+        boost::shared_ptr<void> pdata;
+        stringstream sout;
+        if( !!itfn->second.fnSocketThread ) {
+            bool bSuccess = false;
+            try {
+                bSuccess = itfn->second.fnSocketThread(*is, sout, pdata);
+            }
+            catch(const std::exception& ex) {
+                RAVELOG_FATAL("server caught exception: %s\n",ex.what());
+            }
+            catch(...) {
+                RAVELOG_FATAL("unknown exception!!\n");
+            }
 
-                if( !!flog &&( GetEnv()->GetDebugLevel()>0) ) {
-                    static int index=0;
-                    flog << index++ << ": " << line << endl;
+            if( bSuccess ) {
+                if( itfn->second.bReturnResult ) {
+                    sresult = sout.str();
+                    bSendResult = true;
+                }
+                if( !itfn->second.fnWorker ) {
+                    bCallWorker = false;
+                }
+            }
+            else {
+                bCallWorker = false;
+                if( !!flog  ) {
+                    std::lock_guard<std::mutex> lock(_mutexLog);
+                    flog << " error" << endl;
+                }
+                if( itfn->second.bReturnResult ) {
+                    sresult = "error\n";
+                    bSendResult = true;
                 }
+            }
+        }
+        else {
+            if( itfn->second.bReturnResult ) {
+                bSendResult = true;     // return dummy
+            }
+            bCallWorker = !!itfn->second.fnWorker;
+        }
 
-                boost::shared_ptr<istream> is(new stringstream(line));
-                *is >> cmd;
-                if( !*is ) {
-                    RAVELOG_ERROR("Failed to get command\n");
-                    psocket->SendData("error\n",1);
-                    continue;
+        if( bCallWorker ) {
+            BOOST_ASSERT(!!itfn->second.fnWorker);
+            is->clear();
+            is->seekg(inputpos);
+            ScheduleWorker(boost::bind(itfn->second.fnWorker,is,pdata));
+        }
+        return bSendResult;
+    }
+
+    /// \brief returns the lower case command name of a request line
+    static string _GetCommandName(const string& line)
+    {
+        string cmd;
+        stringstream ss(line);
+        ss >> cmd;
+        std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+        return cmd;
+    }
+
+    /// \brief returns the number of binary bytes following a request line
+    ///
+    /// Only problem_sendmsgpackcmd has such a payload, its size is the last argument of the line.
+    static size_t _GetRequestPayloadSize(const string& line)
+    {
+        if( _GetCommandName(line) != "problem_sendmsgpackcmd" ) {
+            return 0;
+        }
+        string cmd, cmdname;
+        int problemid = 0;
+        size_t payloadsize = 0;
+        stringstream ss(line);
+        ss >> cmd >> problemid >> cmdname >> payloadsize;
+        return !ss ? 0 : payloadsize;
+    }
+
+    /// \brief maximum size of a request including its payload
+    static size_t _GetMaxRequestSize() {
+        return 64<<20;
+    }
+
+#ifdef TEXTSERVER_HAS_EPOLL
+    /// \brief state of a client connection of the epoll server
+    ///
+    /// Except for the clone, only touched by the epoll thread. The clone is only touched by the task running the current request of the connection.
+    struct EpollConnection
+    {
+        EpollConnection() : sockfd(-1), bExecuting(false), bReadPaused(false), bPeerShutdown(false), bClosed(false), clonestamp(0) {
+        }
+        int sockfd;
+        string sinput; ///< received data that does not form a full line yet
+        string soutput; ///< framed responses that the socket could not take yet
+        std::deque<string> queuerequests; ///< pipelined request lines waiting to be executed
+        ThreadPoolTaskPtr ptask; ///< task executing the current request
+        bool bExecuting; ///< true while a request runs on the pool. requests of a connection run one at a time so that the responses keep the order of the requests
+        bool bReadPaused; ///< true if EPOLLIN is disabled because the queues are full
+        bool bPeerShutdown; ///< the peer will not send more requests, the connection is closed once the queued ones are answered
+        bool bClosed; ///< the peer closed the connection or it failed, the connection is freed once bExecuting is false
+
+        EnvironmentBasePtr pcloneenv; ///< clone of the environment for the cloneable commands
+        boost::shared_ptr<SimpleTextServer> pcloneserver; ///< server attached to pcloneenv running the cloneable commands
+        uint64_t clonestamp; ///< value of _ComputeEnvironmentStamp when pcloneenv was last synchronized
+    };
+    typedef boost::shared_ptr<EpollConnection> EpollConnectionPtr;
+
+    /// \brief response of a request computed on the pool
+    struct EpollResult
+    {
+        EpollConnectionPtr pconn;
+        string sresult;
+        bool bSendResult;
+    };
+
+    /// \brief maximum size of data waiting to be sent on a connection before the server stops reading its requests
+    static size_t _GetMaxOutputSize() {
+        return 1<<20;
+    }
+
+    bool _InitEpoll()
+    {
+        _pthreadpool = _nNumWorkers > 0 ? boost::make_shared<ThreadPool>(_nNumWorkers) : RaveGetThreadPool();
+        _epollfd = epoll_create1(EPOLL_CLOEXEC);
+        if( _epollfd < 0 ) {
+            RAVELOG_ERROR("failed to create epoll instance: %s\n", strerror(errno));
+            return false;
+        }
+        _eventfd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+        if( _eventfd < 0 ) {
+            RAVELOG_ERROR("failed to create eventfd: %s\n", strerror(errno));
+            _DestroyEpoll();
+            return false;
+        }
+        // the data of the server socket and the eventfd is their file descriptor, the data of the connections is their EpollConnection
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = server_sockfd;
+        if( epoll_ctl(_epollfd, EPOLL_CTL_ADD, server_sockfd, &event) < 0 ) {
+            RAVELOG_ERROR("failed to add server socket to epoll: %s\n", strerror(errno));
+            _DestroyEpoll();
+            return false;
+        }
+        event.data.fd = _eventfd;
+        if( epoll_ctl(_epollfd, EPOLL_CTL_ADD, _eventfd, &event) < 0 ) {
+            RAVELOG_ERROR("failed to add eventfd to epoll: %s\n", strerror(errno));
+            _DestroyEpoll();
+            return false;
+        }
+        _nEpollPending = 0;
+        return true;
+    }
+
+    /// \brief called once the epoll thread has exited, cancels the requests and closes the connections
+    void _DestroyEpoll()
+    {
+        FOREACH(itconn, _mapEpollConnections) {
+            if( !!itconn->second->ptask ) {
+                itconn->second->ptask->Cancel();
+                try {
+                    itconn->second->ptask->Wait();
                 }
-                std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
-                stringstream::pos_type inputpos = is->tellg();
-
-                map<string, RAVENETWORKFN>::iterator itfn = mapNetworkFns.find(cmd);
-                if( itfn != mapNetworkFns.end() ) {
-                    bool bCallWorker = true;
-                    boost::shared_ptr<void> pdata;
-
-                    // need to set w.args before pcmdend is modified
-                    sout.str(""); sout.clear();
-                    if( !!itfn->second.fnSocketThread ) {
-                        bool bSuccess = false;
-                        try {
-                            bSuccess = itfn->second.fnSocketThread(*is, sout, pdata);
-                        }
-                        catch(const std::exception& ex) {
-                            RAVELOG_FATAL("server caught exception: %s\n",ex.what());
-                        }
-                        catch(...) {
-                            RAVELOG_FATAL("unknown exception!!\n");
-                        }
-
-                        if( bSuccess ) {
-                            if( itfn->second.bReturnResult ) {
-                                psocket->SendData(sout.str().c_str(), sout.str().size());
-                            }
-                            if( !itfn->second.fnWorker ) {
-                                bCallWorker = false;
-                            }
-                        }
-                        else {
-                            bCallWorker = false;
-                            if( !!flog  ) {
-                                flog << " error" << endl;
-                            }
-                            if( itfn->second.bReturnResult ) {
-                                psocket->SendData("error\n", 6);
-                            }
-                        }
+                catch(...) {
+                }
+            }
+            _CloseEpollConnection(itconn->second);
+        }
+        _mapEpollConnections.clear();
+        {
+            std::lock_guard<std::mutex> lock(_mutexEpollResults);
+            _listEpollResults.clear();
+        }
+        if( _eventfd >= 0 ) {
+            close(_eventfd);
+            _eventfd = -1;
+        }
+        if( _epollfd >= 0 ) {
+            close(_epollfd);
+            _epollfd = -1;
+        }
+        _nEpollPending = 0;
+        _pthreadpool.reset();
+    }
+
+    /// \brief closes the socket of an idle connection and releases its clone
+    void _CloseEpollConnection(EpollConnectionPtr pconn)
+    {
+        CLOSESOCKET(pconn->sockfd);
+        pconn->sockfd = -1;
+        pconn->ptask.reset(); // the task holds a reference to the connection
+        pconn->pcloneserver.reset();
+        if( !!pconn->pcloneenv ) {
+            pconn->pcloneenv->Destroy();
+            pconn->pcloneenv.reset();
+        }
+    }
+
+    void _epoll_threadcb()
+    {
+        std::vector<struct epoll_event> vevents(64);
+        while(!bCloseThread) {
+            int numevents = epoll_wait(_epollfd, &vevents[0], vevents.size(), 100);
+            if( numevents < 0 ) {
+                if( errno != EINTR ) {
+                    RAVELOG_ERROR("epoll_wait failed: %s\n", strerror(errno));
+                    usleep(1000);
+                }
+                continue;
+            }
+            for(int ievent = 0; ievent < numevents; ++ievent) {
+                if( vevents[ievent].data.fd == server_sockfd ) {
+                    _EpollAccept();
+                }
+                else if( vevents[ievent].data.fd == _eventfd ) {
+                    _EpollProcessResults();
+                }
+                else {
+                    map<int, EpollConnectionPtr>::iterator itconn = _mapEpollConnections.find(vevents[ievent].data.fd);
+                    if( itconn == _mapEpollConnections.end() ) {
+                        continue;
                     }
-                    else {
-                        if( itfn->second.bReturnResult ) {
-                            psocket->SendData(sout.str().c_str(), sout.str().size());     // return dummy
-                        }
-                        bCallWorker = !!itfn->second.fnWorker;
+                    EpollConnectionPtr pconn = itconn->second;
+                    if( vevents[ievent].events & (EPOLLHUP|EPOLLERR) ) {
+                        pconn->bClosed = true;
                     }
-
-                    if( bCallWorker ) {
-                        BOOST_ASSERT(!!itfn->second.fnWorker);
-                        is->clear();
-                        is->seekg(inputpos);
-                        ScheduleWorker(boost::bind(itfn->second.fnWorker,is,pdata));
+                    if( vevents[ievent].events & EPOLLOUT ) {
+                        _EpollFlush(pconn);
+                    }
+                    if( vevents[ievent].events & (EPOLLIN|EPOLLRDHUP) ) {
+                        _EpollRead(pconn);
                     }
+                    _EpollUpdateConnection(pconn);
                 }
-                else {
-                    RAVELOG_ERROR("Failed to recognize command: %s\n", cmd.c_str());
-                    psocket->SendData("error\n",1);
+            }
+        }
+        RAVELOG_DEBUG("**Server epoll thread exiting\n");
+    }
+
+    void _EpollAccept()
+    {
+        while(1) {
+            struct sockaddr_in client_address;
+            socklen_t client_len = sizeof(client_address);
+            int sockfd = accept4(server_sockfd, (struct sockaddr *)&client_address, &client_len, SOCK_NONBLOCK|SOCK_CLOEXEC);
+            if( sockfd < 0 ) {
+                if( errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR ) {
+                    RAVELOG_WARN("failed to accept connection: %s\n", strerror(errno));
                 }
+                return;
             }
-            else if( !psocket->IsInit() ) {
+
+            EpollConnectionPtr pconn(new EpollConnection());
+            pconn->sockfd = sockfd;
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN|EPOLLRDHUP;
+            event.data.fd = sockfd;
+            if( epoll_ctl(_epollfd, EPOLL_CTL_ADD, sockfd, &event) < 0 ) {
+                RAVELOG_WARN("failed to add connection to epoll: %s\n", strerror(errno));
+                CLOSESOCKET(sockfd);
+                continue;
+            }
+            _mapEpollConnections[sockfd] = pconn;
+            RAVELOG_VERBOSE("started new server connection\n");
+        }
+    }
+
+    /// \brief reads the available data of the connection and queues its complete lines, stops when the queues are full
+    void _EpollRead(EpollConnectionPtr pconn)
+    {
+        char buffer[4096];
+        while(!pconn->bClosed && !pconn->bPeerShutdown && !_IsEpollReadFull(pconn)) {
+            ssize_t nBytesReceived = recv(pconn->sockfd, buffer, sizeof(buffer), 0);
+            if( nBytesReceived > 0 ) {
+                pconn->sinput.append(buffer, nBytesReceived);
+                _EpollParseInput(pconn);
+                if( pconn->sinput.size() > _GetMaxRequestSize() ) {
+                    RAVELOG_ERROR("request is larger than %d bytes, closing connection\n", (int)_GetMaxRequestSize());
+                    pconn->bClosed = true;
+                }
+            }
+            else if( nBytesReceived == 0 ) {
+                pconn->bPeerShutdown = true;
+            }
+            else if( errno == EINTR ) {
+                continue;
+            }
+            else {
+                if( errno != EAGAIN && errno != EWOULDBLOCK ) {
+                    RAVELOG_WARN("failed to read from connection: %s\n", strerror(errno));
+                    pconn->bClosed = true;
+                }
                 break;
             }
-            usleep(1000);
         }
+    }
 
-        RAVELOG_VERBOSE("Closing socket connection\n");
+    /// \brief moves the complete requests of the input buffer to the request queue while it has room
+    void _EpollParseInput(EpollConnectionPtr pconn)
+    {
+        size_t startpos = 0;
+        while(!_IsEpollReadFull(pconn)) {
+            size_t endpos = pconn->sinput.find_first_of("\n\r", startpos);
+            if( endpos == string::npos ) {
+                break;
+            }
+            size_t nextpos = endpos+1;
+            string line = pconn->sinput.substr(startpos, endpos-startpos);
+            size_t payloadsize = _GetRequestPayloadSize(line);
+            if( payloadsize > 0 ) {
+                if( pconn->sinput.size() < nextpos+payloadsize ) {
+                    break; // wait for the rest of the payload
+                }
+                line.push_back('\n');
+                line.append(pconn->sinput, nextpos, payloadsize);
+                nextpos += payloadsize;
+            }
+            if( line.size() > 0 ) {
+                pconn->queuerequests.push_back(line);
+                ++_nEpollPending;
+            }
+            startpos = nextpos;
+        }
+        pconn->sinput.erase(0, startpos);
+    }
+
+    /// \brief true if the server should not accept more requests from the connection
+    bool _IsEpollReadFull(EpollConnectionPtr pconn) const
+    {
+        return (int)pconn->queuerequests.size() >= _nMaxConnectionPending || _nEpollPending >= _nMaxPendingRequests || pconn->soutput.size() >= _GetMaxOutputSize();
+    }
+
+    /// \brief sends as much of the output buffer as the socket takes
+    void _EpollFlush(EpollConnectionPtr pconn)
+    {
+        size_t offset = 0;
+        while(offset < pconn->soutput.size()) {
+            ssize_t nBytesSent = send(pconn->sockfd, pconn->soutput.c_str()+offset, pconn->soutput.size()-offset, MSG_NOSIGNAL);
+            if( nBytesSent > 0 ) {
+                offset += nBytesSent;
+            }
+            else if( nBytesSent < 0 && errno == EINTR ) {
+                continue;
+            }
+            else {
+                if( nBytesSent < 0 && errno != EAGAIN && errno != EWOULDBLOCK ) {
+                    RAVELOG_WARN("failed to send to connection: %s\n", strerror(errno));
+                    pconn->bClosed = true;
+                }
+                break;
+            }
+        }
+        pconn->soutput.erase(0, offset);
+    }
+
+    /// \brief starts the next request of the connection, updates its epoll events and frees it once it is closed and idle
+    void _EpollUpdateConnection(EpollConnectionPtr pconn)
+    {
+        if( pconn->bPeerShutdown && !pconn->bExecuting && pconn->queuerequests.size() == 0 && pconn->soutput.size() == 0 ) {
+            pconn->bClosed = true;
+        }
+        if( pconn->bClosed ) {
+            // drop the requests that were not started yet
+            _nEpollPending -= pconn->queuerequests.size();
+            pconn->queuerequests.clear();
+            if( !pconn->bExecuting ) {
+                RAVELOG_VERBOSE("Closing socket connection\n");
+                epoll_ctl(_epollfd, EPOLL_CTL_DEL, pconn->sockfd, NULL);
+                _mapEpollConnections.erase(pconn->sockfd);
+                _CloseEpollConnection(pconn);
+            }
+            return;
+        }
+
+        // there can be lines left in the input buffer from the time the queues were full
+        _EpollParseInput(pconn);
+        if( !pconn->bExecuting && pconn->queuerequests.size() > 0 ) {
+            string line = pconn->queuerequests.front();
+            pconn->queuerequests.pop_front();
+            --_nEpollPending;
+            pconn->bExecuting = true;
+            pconn->ptask = _pthreadpool->Submit(boost::bind(&SimpleTextServer::_EpollExecute, this, pconn, line));
+            _EpollParseInput(pconn);
+        }
+
+        bool bReadPaused = _IsEpollReadFull(pconn);
+        bool bRead = !bReadPaused && !pconn->bPeerShutdown;
+        bool bWrite = pconn->soutput.size() > 0;
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = (bRead ? EPOLLIN|EPOLLRDHUP : 0) | (bWrite ? EPOLLOUT : 0);
+        event.data.fd = pconn->sockfd;
+        if( epoll_ctl(_epollfd, EPOLL_CTL_MOD, pconn->sockfd, &event) < 0 ) {
+            RAVELOG_WARN("failed to modify epoll events of connection: %s\n", strerror(errno));
+        }
+        pconn->bReadPaused = bReadPaused;
+    }
+
+    /// \brief runs on the pool, executes a request of a connection and hands the response to the epoll thread
+    void _EpollExecute(EpollConnectionPtr pconn, const string& line)
+    {
+        EpollResult result;
+        result.pconn = pconn;
+        result.bSendResult = false;
+        bool bCloneable = _bCloneEnvironments && _setCloneableCommands.find(_GetCommandName(line)) != _setCloneableCommands.end();
+        try {
+            if( bCloneable ) {
+                result.bSendResult = _GetConnectionCloneServer(pconn)->_ProcessRequest(line, result.sresult);
+            }
+            else {
+                result.bSendResult = _ProcessRequest(line, result.sresult);
+            }
+        }
+        catch(const std::exception& ex) {
+            RAVELOG_FATAL("server caught exception: %s\n",ex.what());
+            result.sresult = "error\n";
+            result.bSendResult = true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutexEpollResults);
+            _listEpollResults.push_back(result);
+        }
+        uint64_t value = 1;
+        if( write(_eventfd, &value, sizeof(value)) < 0 ) {
+            RAVELOG_WARN("failed to notify epoll thread: %s\n", strerror(errno));
+        }
+    }
+
+    /// \brief called on the epoll thread when requests finished executing
+    void _EpollProcessResults()
+    {
+        uint64_t value = 0;
+        while( read(_eventfd, &value, sizeof(value)) > 0 ) {
+        }
+
+        list<EpollResult> listresults;
+        {
+            std::lock_guard<std::mutex> lock(_mutexEpollResults);
+            listresults.swap(_listEpollResults);
+        }
+        FOREACH(itresult, listresults) {
+            EpollConnectionPtr pconn = itresult->pconn;
+            pconn->bExecuting = false;
+            pconn->ptask.reset();
+            if( itresult->bSendResult && !pconn->bClosed ) {
+                // same framing as Socket::SendData
+                int size = (int)itresult->sresult.size();
+                pconn->soutput.append((const char*)&size, 4);
+                pconn->soutput.append(itresult->sresult);
+                _EpollFlush(pconn);
+            }
+            _EpollUpdateConnection(pconn);
+        }
+
+        if( listresults.size() > 0 && _nEpollPending < _nMaxPendingRequests ) {
+            // connections paused by the limit over all connections can read again
+            std::vector<EpollConnectionPtr> vpaused;
+            FOREACH(itconn, _mapEpollConnections) {
+                if( itconn->second->bReadPaused ) {
+                    vpaused.push_back(itconn->second);
+                }
+            }
+            FOREACH(itconn, vpaused) {
+                _EpollUpdateConnection(*itconn);
+            }
+        }
     }
 
+    /// \brief returns the server running the cloneable commands of the connection, creates or synchronizes its clone of the environment
+    boost::shared_ptr<SimpleTextServer> _GetConnectionCloneServer(EpollConnectionPtr pconn)
+    {
+        // commands queued on the worker thread by this or other connections have to be applied before the stamp is taken
+        _SyncWithWorkerThread();
+
+        // the environment can also change from outside of the server, e.g. python, the simulation or controllers, so compare the state of the bodies
+        uint64_t stamp = 0;
+        {
+            EnvironmentLock lock(GetEnv()->GetMutex());
+            stamp = _ComputeEnvironmentStamp();
+        }
+        if( !!pconn->pcloneenv && pconn->clonestamp == stamp ) {
+            return pconn->pcloneserver;
+        }
+
+        if( !pconn->pcloneenv ) {
+            // CloneSelf locks the source itself
+            pconn->pcloneenv = GetEnv()->CloneSelf(Clone_Bodies);
+            pconn->pcloneserver = boost::make_shared<SimpleTextServer>(pconn->pcloneenv, false);
+        }
+        else {
+            EnvironmentLock lock(GetEnv()->GetMutex());
+            pconn->pcloneenv->Clone(GetEnv(), Clone_Bodies);
+        }
+
+        // the stamp was computed before cloning, a change in between only causes one more synchronization
+        pconn->clonestamp = stamp;
+        return pconn->pcloneserver;
+    }
+
+    /// \brief hash of the bodies of the environment and their update stamps, changes whenever a body is added, removed or modified. Environment has to be locked.
+    uint64_t _ComputeEnvironmentStamp() const
+    {
+        std::vector<KinBodyPtr> vbodies;
+        GetEnv()->GetBodies(vbodies);
+        uint64_t stamp = utils::CombineFastHash(0, vbodies.size());
+        FOREACHC(itbody, vbodies) {
+            stamp = utils::CombineFastHash(stamp, (uint64_t)(*itbody)->GetEnvironmentBodyIndex());
+            stamp = utils::CombineFastHash(stamp, (uint64_t)(uint32_t)(*itbody)->GetUpdateStamp());
+        }
+        return stamp;
+    }
+#endif
+
     int _nPort;     ///< port used for listening to incoming connections
 
     boost::shared_ptr<std::thread> _servthread, _workerthread;
@@ -674,6 +1288,23 @@ private:
 
     bool _bWorking;     ///< worker thread processing current work items
 
+    std::mutex _mutexLog; ///< protects flog
+
+    bool _bUseEpoll; ///< if true, the connections are served by _epoll_threadcb instead of one thread per connection
+    bool _bCloneEnvironments; ///< if true, the epoll server runs the cloneable commands on per-connection clones of the environment
+    int _nNumWorkers; ///< threads of the pool of the epoll server, 0 for the process pool
+    int _nMaxConnectionPending; ///< maximum number of queued requests per connection
+    int _nMaxPendingRequests; ///< maximum number of queued requests over all connections
+    set<string> _setCloneableCommands; ///< commands that do not modify the environment
+#ifdef TEXTSERVER_HAS_EPOLL
+    ThreadPoolPtr _pthreadpool; ///< runs the requests of the epoll server
+    int _epollfd, _eventfd; ///< _eventfd wakes up the epoll thread when requests finish
+    int _nEpollPending; ///< requests queued over all connections, only touched by the epoll thread
+    map<int, EpollConnectionPtr> _mapEpollConnections; ///< indexed by socket, only touched by the epoll thread
+    std::mutex _mutexEpollResults; ///< protects _listEpollResults
+    list<EpollResult> _listEpollResults; ///< responses of the finished requests waiting to be sent
+#endif
+
 protected:
     // all the server functions
     KinBodyPtr orMacroGetBody(istream& is)
@@ -2302,6 +2933,34 @@ protected:
         return true;
     }
 
+    /// sends a JSON command to a problem in msgpack form: problem_sendmsgpackcmd problemid cmdname numbytes
+    /// the request line is followed by numbytes of msgpack encoded input, the response is the msgpack encoded output
+    bool orProblemSendMsgPackCommand(istream& is, ostream& os, boost::shared_ptr<void>& pdata)
+    {
+        int problemid=0;
+        string cmdname;
+        size_t payloadsize = 0;
+        is >> problemid >> cmdname >> payloadsize;
+        if( !is || is.get() != '\n' ) {
+            return false;
+        }
+        string payload(payloadsize, '\0');
+        if( payloadsize > 0 && !is.read(&payload[0], payloadsize) ) {
+            return false;
+        }
+        _SyncWithWorkerThread();
+
+        map<int, ModuleBasePtr >::iterator it = _mapModules.find(problemid);
+        if( it == _mapModules.end() ) {
+            RAVELOG_WARN("failed to find problem %d\n", problemid);
+            return false;
+        }
+        std::vector<char> output;
+        it->second->SendMsgPackCommand(cmdname, payload.data(), payload.size(), output);
+        os.write(output.data(), output.size());
+        return true;
+    }
+
     /// sends a comment to the problem
     bool orEnvLoadPlugin(istream& is, ostream& os, boost::shared_ptr<void>& pdata)
     {
@@ -65,6 +65,7 @@ public:
     py::list collisionInfos; // list of PyCollisionPairInfo
     int options = 0;
     OpenRAVE::dReal minDistance = 1e20;
+    bool bMinDistanceIsLowerBound = false;
     int numWithinTol = 0;
     uint32_t nKeepPrevious = 0;
 };
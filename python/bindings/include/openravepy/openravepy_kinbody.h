@@ -297,6 +297,7 @@ public:
     py::object ComputeHessianTranslation(int index, py::object oposition, py::object oindices=py::none_());
     py::object ComputeHessianAxisAngle(int index, py::object oindices=py::none_());
     py::object ComputeInverseDynamics(py::object odofaccelerations, py::object oexternalforcetorque=py::none_(), bool returncomponents=false);
+    py::object ComputeInverseDynamicsWithModel(py::object odofvalues, py::object odofvelocities=py::none_(), py::object odofaccelerations=py::none_(), py::object oexternalforcetorque=py::none_());
     py::object GetDOFDynamicAccelerationJerkLimits(py::object oDOFPositions, py::object oDOFVelocities) const;
     void SetSelfCollisionChecker(PyCollisionCheckerBasePtr pycollisionchecker);
     PyInterfaceBasePtr GetSelfCollisionChecker();
@@ -336,6 +337,8 @@ public:
     void SetAdjacentLinks(int linkindex0, int linkindex1);
     void SetAdjacentLinksCombinations(py::object olinkIndices);
     py::object GetAdjacentLinks() const;
+    void SetDisabledCollisionLinkPairs(py::object olinkIndices);
+    py::object GetDisabledCollisionLinkPairs() const;
     py::object GetManageData() const;
     int GetUpdateStamp() const;
     std::string serialize(int options) const;
@@ -30,6 +30,8 @@ public:
     PyPlannerProgress(const PlannerBase::PlannerProgress& progress);
     std::string __str__();
     int _iteration = 0;
+    dReal _fSolutionCost = -1;
+    object _vSolutionConfigs = py::none_();
 };
 
 
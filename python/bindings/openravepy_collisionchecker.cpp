@@ -124,6 +124,7 @@ void PyCollisionReport::Init(const CollisionReport& report)
 
     options = report.options;
     minDistance = report.minDistance;
+    bMinDistanceIsLowerBound = report.bMinDistanceIsLowerBound;
     numWithinTol = report.numWithinTol;
     nKeepPrevious = report.nKeepPrevious;
 }
@@ -133,6 +134,7 @@ void PyCollisionReport::Reset(int coloptions)
     collisionInfos = py::list();
     options = 0;
     minDistance = 1e20;
+    bMinDistanceIsLowerBound = false;
     numWithinTol = 0;
     nKeepPrevious = 0;
 }
@@ -980,6 +982,7 @@ void init_openravepy_collisionchecker()
     .def_readonly("collisionInfos",&PyCollisionReport::collisionInfos)
     .def_readonly("options",&PyCollisionReport::options)
     .def_readonly("minDistance",&PyCollisionReport::minDistance)
+    .def_readonly("bMinDistanceIsLowerBound",&PyCollisionReport::bMinDistanceIsLowerBound)
     .def_readonly("numWithinTol",&PyCollisionReport::numWithinTol)
     .def_readonly("nKeepPrevious", &PyCollisionReport::nKeepPrevious)
     .def("__str__",&PyCollisionReport::__str__)
@@ -1032,6 +1032,59 @@ object PyInterfaceBase::SendJSONCommand(const string& cmd, object input, bool re
     return toPyObject(out);
 }
 
+object PyInterfaceBase::SendMsgPackCommand(const string& cmd, object input, bool releasegil, bool lockenv)
+{
+    // input keeps the bytes alive during the call, so the command reads them without a copy
+    const char* pinput = NULL;
+    size_t inputsize = 0;
+    if( !IS_PYTHONOBJECT_NONE(input) ) {
+#if PY_MAJOR_VERSION >= 3
+        if( !PyBytes_Check(input.ptr()) ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("SendMsgPackCommand input has to be bytes"),ORE_InvalidArguments);
+        }
+        pinput = PyBytes_AS_STRING(input.ptr());
+        inputsize = PyBytes_GET_SIZE(input.ptr());
+#else
+        if( !PyString_Check(input.ptr()) ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("SendMsgPackCommand input has to be a string"),ORE_InvalidArguments);
+        }
+        pinput = PyString_AS_STRING(input.ptr());
+        inputsize = PyString_GET_SIZE(input.ptr());
+#endif
+    }
+
+    std::vector<char> output;
+    {
+        openravepy::PythonThreadSaverPtr statesaver;
+        openravepy::PyEnvironmentLockSaverPtr envsaver;
+        if( releasegil ) {
+            statesaver.reset(new openravepy::PythonThreadSaver());
+            if( lockenv ) {
+                // GIL is already released, so use a regular environment lock
+                envsaver.reset(new openravepy::PyEnvironmentLockSaver(_pyenv, true));
+            }
+        }
+        else {
+            if( lockenv ) {
+                // try to safely lock the environment first
+                envsaver.reset(new openravepy::PyEnvironmentLockSaver(_pyenv, false));
+            }
+        }
+
+        _pbase->SendMsgPackCommand(cmd, pinput, inputsize, output);
+    }
+
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+#if PY_MAJOR_VERSION >= 3
+    return py::cast<py::object>(PyBytes_FromStringAndSize(output.data(), output.size()));
+#else
+    return py::cast<py::object>(PyString_FromStringAndSize(output.data(), output.size()));
+#endif
+#else
+    return py::to_object(py::handle<>(PyString_FromStringAndSize(output.data(), output.size())));
+#endif
+}
+
 object PyReadablesContainer::GetReadableInterfaces()
 {
     py::dict ointerfaces;
@@ -3280,6 +3333,7 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(drawboxarray_overloads, drawboxarray, 2,
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(drawtrimesh_overloads, drawtrimesh, 1, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SendCommand_overloads, SendCommand, 1, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SendJSONCommand_overloads, SendJSONCommand, 2, 4)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SendMsgPackCommand_overloads, SendMsgPackCommand, 2, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Add_overloads, Add, 1, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Save_overloads, Save, 1, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(WriteToMemory_overloads, WriteToMemory, 1, 3)
@@ -3534,6 +3588,17 @@ Because race conditions can pop up when trying to lock the openrave environment
              )
 #else
         .def("SendJSONCommand",&PyInterfaceBase::SendJSONCommand, SendJSONCommand_overloads(PY_ARGS("cmd","input","releasegil","lockenv") DOXY_FN(InterfaceBase,SendJSONCommand)))
+#endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        .def("SendMsgPackCommand",&PyInterfaceBase::SendMsgPackCommand,
+             "cmd"_a,
+             "input"_a,
+             "releasegil"_a = false,
+             "lockenv"_a = false,
+             DOXY_FN(InterfaceBase,SendMsgPackCommand)
+             )
+#else
+        .def("SendMsgPackCommand",&PyInterfaceBase::SendMsgPackCommand, SendMsgPackCommand_overloads(PY_ARGS("cmd","input","releasegil","lockenv") DOXY_FN(InterfaceBase,SendMsgPackCommand)))
 #endif
         .def("__repr__", &PyInterfaceBase::__repr__)
         .def("__str__", &PyInterfaceBase::__str__)
@@ -3958,6 +3958,31 @@ object PyKinBody::ComputeHessianAxisAngle(int index, object oindices)
     return toPyArray(vhessian,dims);
 }
 
+/// \brief converts a dictionary of link indices and 6-element arrays of forces/torques
+static void _ExtractForceTorqueMap(object oexternalforcetorque, KinBody::ForceTorqueMap& mapExternalForceTorque)
+{
+    if( IS_PYTHONOBJECT_NONE(oexternalforcetorque) ) {
+        return;
+    }
+    py::dict odict = (py::dict)oexternalforcetorque;
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+    for (const std::pair<py::handle, py::handle>& item : odict) {
+        int linkindex = py::extract<int>(item.first);
+        object oforcetorque = extract<py::object>(item.second);
+        OPENRAVE_ASSERT_OP(len(oforcetorque),==,6);
+        mapExternalForceTorque[linkindex] = make_pair(Vector(py::extract<dReal>(oforcetorque[py::to_object(0)]),py::extract<dReal>(oforcetorque[py::to_object(1)]),py::extract<dReal>(oforcetorque[py::to_object(2)])),Vector(py::extract<dReal>(oforcetorque[py::to_object(3)]),py::extract<dReal>(oforcetorque[py::to_object(4)]),py::extract<dReal>(oforcetorque[py::to_object(5)])));
+    }
+#else
+    py::list iterkeys = (py::list)odict.iterkeys();
+    for (int i = 0; i < py::len(iterkeys); i++) {
+        int linkindex = py::extract<int>(iterkeys[i]);
+        object oforcetorque = odict[iterkeys[i]];
+        OPENRAVE_ASSERT_OP(len(oforcetorque),==,6);
+        mapExternalForceTorque[linkindex] = make_pair(Vector(py::extract<dReal>(oforcetorque[0]),py::extract<dReal>(oforcetorque[1]),py::extract<dReal>(oforcetorque[2])),Vector(py::extract<dReal>(oforcetorque[3]),py::extract<dReal>(oforcetorque[4]),py::extract<dReal>(oforcetorque[5])));
+    }
+#endif
+}
+
 object PyKinBody::ComputeInverseDynamics(object odofaccelerations, object oexternalforcetorque, bool returncomponents)
 {
     std::vector<dReal> vDOFAccelerations;
@@ -3965,26 +3990,7 @@ object PyKinBody::ComputeInverseDynamics(object odofaccelerations, object oexter
         vDOFAccelerations = ExtractArray<dReal>(odofaccelerations);
     }
     KinBody::ForceTorqueMap mapExternalForceTorque;
-    if( !IS_PYTHONOBJECT_NONE(oexternalforcetorque) ) {
-        py::dict odict = (py::dict)oexternalforcetorque;
-        std::vector<dReal> v;
-#ifdef USE_PYBIND11_PYTHON_BINDINGS
-        for (const std::pair<py::handle, py::handle>& item : odict) {
-            int linkindex = py::extract<int>(item.first);
-            object oforcetorque = extract<py::object>(item.second);
-            OPENRAVE_ASSERT_OP(len(oforcetorque),==,6);
-            mapExternalForceTorque[linkindex] = make_pair(Vector(py::extract<dReal>(oforcetorque[py::to_object(0)]),py::extract<dReal>(oforcetorque[py::to_object(1)]),py::extract<dReal>(oforcetorque[py::to_object(2)])),Vector(py::extract<dReal>(oforcetorque[py::to_object(3)]),py::extract<dReal>(oforcetorque[py::to_object(4)]),py::extract<dReal>(oforcetorque[py::to_object(5)])));
-        }
-#else
-        py::list iterkeys = (py::list)odict.iterkeys();
-        for (int i = 0; i < py::len(iterkeys); i++) {
-            int linkindex = py::extract<int>(iterkeys[i]);
-            object oforcetorque = odict[iterkeys[i]];
-            OPENRAVE_ASSERT_OP(len(oforcetorque),==,6);
-            mapExternalForceTorque[linkindex] = make_pair(Vector(py::extract<dReal>(oforcetorque[0]),py::extract<dReal>(oforcetorque[1]),py::extract<dReal>(oforcetorque[2])),Vector(py::extract<dReal>(oforcetorque[3]),py::extract<dReal>(oforcetorque[4]),py::extract<dReal>(oforcetorque[5])));
-        }
-#endif
-    }
+    _ExtractForceTorqueMap(oexternalforcetorque, mapExternalForceTorque);
     if( returncomponents ) {
         boost::array< std::vector<dReal>, 3> vDOFTorqueComponents;
         _pbody->ComputeInverseDynamics(vDOFTorqueComponents,vDOFAccelerations,mapExternalForceTorque);
@@ -3997,6 +4003,29 @@ object PyKinBody::ComputeInverseDynamics(object odofaccelerations, object oexter
     }
 }
 
+object PyKinBody::ComputeInverseDynamicsWithModel(object odofvalues, object odofvelocities, object odofaccelerations, object oexternalforcetorque)
+{
+    KinBody::InverseDynamicsModel model;
+    _pbody->ExtractInverseDynamicsModel(model);
+    const std::vector<dReal> vDOFValues = ExtractArray<dReal>(odofvalues);
+    OPENRAVE_ASSERT_OP((int)vDOFValues.size(),==,model.GetDOF());
+    std::vector<dReal> vDOFVelocities, vDOFAccelerations;
+    if( !IS_PYTHONOBJECT_NONE(odofvelocities) ) {
+        vDOFVelocities = ExtractArray<dReal>(odofvelocities);
+        OPENRAVE_ASSERT_OP((int)vDOFVelocities.size(),==,model.GetDOF());
+    }
+    if( !IS_PYTHONOBJECT_NONE(odofaccelerations) ) {
+        vDOFAccelerations = ExtractArray<dReal>(odofaccelerations);
+        OPENRAVE_ASSERT_OP((int)vDOFAccelerations.size(),==,model.GetDOF());
+    }
+    KinBody::ForceTorqueMap mapExternalForceTorque;
+    _ExtractForceTorqueMap(oexternalforcetorque, mapExternalForceTorque);
+    std::vector<dReal> vDOFTorques(model.GetDOF());
+    KinBody::InverseDynamicsModel::Workspace workspace;
+    model.ComputeInverseDynamics(_pbody->GetTransform(), vDOFValues.data(), vDOFVelocities.size() > 0 ? vDOFVelocities.data() : NULL, vDOFAccelerations.size() > 0 ? vDOFAccelerations.data() : NULL, vDOFTorques.data(), workspace, mapExternalForceTorque);
+    return toPyArray(vDOFTorques);
+}
+
 object PyKinBody::GetDOFDynamicAccelerationJerkLimits(py::object oDOFPositions, py::object oDOFVelocities) const
 {
     if( IS_PYTHONOBJECT_NONE(oDOFPositions) || IS_PYTHONOBJECT_NONE(oDOFVelocities) ) {
@@ -4306,6 +4335,27 @@ object PyKinBody::GetAdjacentLinks() const
     return adjacent;
 }
 
+void PyKinBody::SetDisabledCollisionLinkPairs(object olinkIndices)
+{
+    std::vector<std::pair<int, int> > linkIndices(len(olinkIndices));
+    for(size_t i = 0; i < linkIndices.size(); ++i) {
+        linkIndices[i].first = py::extract<int>(olinkIndices[py::to_object(i)][py::to_object(0)]);
+        linkIndices[i].second = py::extract<int>(olinkIndices[py::to_object(i)][py::to_object(1)]);
+    }
+    _pbody->SetDisabledCollisionLinkPairs(linkIndices);
+}
+
+object PyKinBody::GetDisabledCollisionLinkPairs() const
+{
+    std::vector<std::pair<int, int> > linkIndices;
+    _pbody->GetDisabledCollisionLinkPairs(linkIndices);
+    py::list opairs;
+    FOREACHC(itpair, linkIndices) {
+        opairs.append(py::make_tuple(itpair->first, itpair->second));
+    }
+    return opairs;
+}
+
 object PyKinBody::GetManageData() const
 {
     KinBody::ManageDataPtr pdata = _pbody->GetManageData();
@@ -4895,6 +4945,7 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeJacobianAxisAngle_overloads, Compu
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeHessianTranslation_overloads, ComputeHessianTranslation, 2, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeHessianAxisAngle_overloads, ComputeHessianAxisAngle, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeInverseDynamics_overloads, ComputeInverseDynamics, 1, 3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeInverseDynamicsWithModel_overloads, ComputeInverseDynamicsWithModel, 1, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Restore_overloads, Restore, 0,1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ExtractInfo_overloads, ExtractInfo, 0,1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(CreateKinBodyStateSaver_overloads, CreateKinBodyStateSaver, 0,1)
@@ -5691,6 +5742,7 @@ void init_openravepy_kinbody()
         std::string sInitFromBoxesDoc = std::string(DOXY_FN(KinBody,InitFromBoxes "const std::vector< AABB; bool")) + std::string("\nboxes is a Nx6 array, first 3 columsn are position, last 3 are extents");
         std::string sGetChainDoc = std::string(DOXY_FN(KinBody,GetChain)) + std::string("If returnjoints is false will return a list of links, otherwise will return a list of links (default is true)");
         std::string sComputeInverseDynamicsDoc = std::string(":param returncomponents: If True will return three N-element arrays that represents the torque contributions to M, C, and G.\n\n:param externalforcetorque: A dictionary of link indices and a 6-element array of forces/torques in that order.\n\n") + std::string(DOXY_FN(KinBody, ComputeInverseDynamics));
+        std::string sComputeInverseDynamicsWithModelDoc = std::string("Extracts the inverse dynamics model of the body and computes the torques of the given state with it, the body state is not changed. The base link is assumed to be static.\n\n:param externalforcetorque: A dictionary of link indices and a 6-element array of forces/torques in that order.\n\n") + std::string(DOXY_FN(KinBody, ExtractInverseDynamicsModel));
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
         scope_ kinbody = class_<PyKinBody, OPENRAVE_SHARED_PTR<PyKinBody>, PyInterfaceBase>(m, "KinBody", py::dynamic_attr(), DOXY_CLASS(KinBody))
 #else
@@ -6047,6 +6099,17 @@ void init_openravepy_kinbody()
                               )
 #else
                          .def("ComputeInverseDynamics",&PyKinBody::ComputeInverseDynamics, ComputeInverseDynamics_overloads(PY_ARGS("dofaccelerations","externalforcetorque","returncomponents") sComputeInverseDynamicsDoc.c_str()))
+#endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+                         .def("ComputeInverseDynamicsWithModel", &PyKinBody::ComputeInverseDynamicsWithModel,
+                              "dofvalues"_a,
+                              "dofvelocities"_a = py::none_(),
+                              "dofaccelerations"_a = py::none_(),
+                              "externalforcetorque"_a = py::none_(),
+                              sComputeInverseDynamicsWithModelDoc.c_str()
+                              )
+#else
+                         .def("ComputeInverseDynamicsWithModel",&PyKinBody::ComputeInverseDynamicsWithModel, ComputeInverseDynamicsWithModel_overloads(PY_ARGS("dofvalues","dofvelocities","dofaccelerations","externalforcetorque") sComputeInverseDynamicsWithModelDoc.c_str()))
 #endif
                          .def("GetDOFDynamicAccelerationJerkLimits",&PyKinBody::GetDOFDynamicAccelerationJerkLimits, PY_ARGS("dofPositions","dofVelocities") DOXY_FN(KinBody,ComputeDynamicLimits))
                          .def("SetSelfCollisionChecker",&PyKinBody::SetSelfCollisionChecker,PY_ARGS("collisionchecker") DOXY_FN(KinBody,SetSelfCollisionChecker))
@@ -6106,6 +6169,8 @@ void init_openravepy_kinbody()
                          .def("SetAdjacentLinks",&PyKinBody::SetAdjacentLinks, PY_ARGS("linkindex0", "linkindex1") DOXY_FN(KinBody,SetAdjacentLinks))
                          .def("SetAdjacentLinksCombinations",&PyKinBody::SetAdjacentLinksCombinations, PY_ARGS("linkIndices") DOXY_FN(KinBody,SetAdjacentLinksCombinations))
                          .def("GetAdjacentLinks",&PyKinBody::GetAdjacentLinks, DOXY_FN(KinBody,GetAdjacentLinks))
+                         .def("SetDisabledCollisionLinkPairs",&PyKinBody::SetDisabledCollisionLinkPairs, PY_ARGS("linkIndices") DOXY_FN(KinBody,SetDisabledCollisionLinkPairs))
+                         .def("GetDisabledCollisionLinkPairs",&PyKinBody::GetDisabledCollisionLinkPairs, DOXY_FN(KinBody,GetDisabledCollisionLinkPairs))
                          .def("GetManageData",&PyKinBody::GetManageData, DOXY_FN(KinBody,GetManageData))
                          .def("GetUpdateStamp",&PyKinBody::GetUpdateStamp, DOXY_FN(KinBody,GetUpdateStamp))
                          .def("serialize",&PyKinBody::serialize,PY_ARGS("options") DOXY_FN(KinBody,serialize))
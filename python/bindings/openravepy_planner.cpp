@@ -54,9 +54,13 @@ PyPlannerProgress::PyPlannerProgress() {
 }
 PyPlannerProgress::PyPlannerProgress(const PlannerBase::PlannerProgress& progress) {
     _iteration = progress._iteration;
+    _fSolutionCost = progress._fSolutionCost;
+    if( progress._vSolutionConfigs.size() > 0 ) {
+        _vSolutionConfigs = toPyArray(progress._vSolutionConfigs);
+    }
 }
 std::string PyPlannerProgress::__str__() {
-    return boost::str(boost::format("<PlannerProgress: iter=%d>")%_iteration);
+    return boost::str(boost::format("<PlannerProgress: iter=%d, solutioncost=%f>")%_iteration%_fSolutionCost);
 }
 
 PyPlannerStatus::PyPlannerStatus() {
@@ -478,6 +482,8 @@ void init_openravepy_planner()
     class_<PyPlannerProgress, OPENRAVE_SHARED_PTR<PyPlannerProgress> >("PlannerProgress", DOXY_CLASS(PlannerBase::PlannerProgress))
 #endif
     .def_readwrite("_iteration",&PyPlannerProgress::_iteration)
+    .def_readwrite("_fSolutionCost",&PyPlannerProgress::_fSolutionCost)
+    .def_readwrite("_vSolutionConfigs",&PyPlannerProgress::_vSolutionConfigs)
     ;
 
     {
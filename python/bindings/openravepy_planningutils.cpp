@@ -70,6 +70,13 @@ bool pyJitterTransform(PyKinBodyPtr pybody, dReal fJitter, int nMaxIterations=10
     return OpenRAVE::planningutils::JitterTransform(openravepy::GetKinBody(pybody), fJitter, nMaxIterations);
 }
 
+int pySetDisabledCollisionLinkPairsFromSampling(PyKinBodyPtr pybody, int numsamples=10000, int numthreads=0, bool usedatabase=true)
+{
+    KinBodyPtr pbody = openravepy::GetKinBody(pybody);
+    openravepy::PythonThreadSaver threadsaver;
+    return OpenRAVE::planningutils::SetDisabledCollisionLinkPairsFromSampling(pbody, numsamples, numthreads, usedatabase);
+}
+
 void pyConvertTrajectorySpecification(PyTrajectoryBasePtr pytraj, PyConfigurationSpecificationPtr pyspec)
 {
     OpenRAVE::planningutils::ConvertTrajectorySpecification(openravepy::GetTrajectory(pytraj),openravepy::GetConfigurationSpecification(pyspec));
@@ -516,6 +523,7 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SampleAll_overloads, SampleAll, 0, 3)
 
 BOOST_PYTHON_FUNCTION_OVERLOADS(JitterCurrentConfiguration_overloads, planningutils::pyJitterCurrentConfiguration, 1, 4);
 BOOST_PYTHON_FUNCTION_OVERLOADS(JitterTransform_overloads, planningutils::pyJitterTransform, 2, 3);
+BOOST_PYTHON_FUNCTION_OVERLOADS(SetDisabledCollisionLinkPairsFromSampling_overloads, planningutils::pySetDisabledCollisionLinkPairsFromSampling, 1, 4);
 BOOST_PYTHON_FUNCTION_OVERLOADS(SmoothActiveDOFTrajectory_overloads, planningutils::pySmoothActiveDOFTrajectory, 2, 6)
 BOOST_PYTHON_FUNCTION_OVERLOADS(SmoothAffineTrajectory_overloads, planningutils::pySmoothAffineTrajectory, 3, 5)
 BOOST_PYTHON_FUNCTION_OVERLOADS(SmoothTrajectory_overloads, planningutils::pySmoothTrajectory, 1, 5)
@@ -561,6 +569,18 @@ void InitPlanningUtils()
                                .def("JitterTransform",planningutils::pyJitterTransform,JitterTransform_overloads(PY_ARGS("body","jitter","maxiterations") DOXY_FN1(JitterTransform)))
                                .staticmethod("JitterTransform")
 #endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+                               .def_static("SetDisabledCollisionLinkPairsFromSampling", planningutils::pySetDisabledCollisionLinkPairsFromSampling,
+                                           "body"_a,
+                                           "numsamples"_a = 10000,
+                                           "numthreads"_a = 0,
+                                           "usedatabase"_a = true,
+                                           DOXY_FN1(SetDisabledCollisionLinkPairsFromSampling)
+                                           )
+#else
+                               .def("SetDisabledCollisionLinkPairsFromSampling",planningutils::pySetDisabledCollisionLinkPairsFromSampling,SetDisabledCollisionLinkPairsFromSampling_overloads(PY_ARGS("body","numsamples","numthreads","usedatabase") DOXY_FN1(SetDisabledCollisionLinkPairsFromSampling)))
+                               .staticmethod("SetDisabledCollisionLinkPairsFromSampling")
+#endif
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
                                .def_static("JitterCurrentConfiguration", planningutils::pyJitterCurrentConfiguration,
                                            "plannerparameters"_a,
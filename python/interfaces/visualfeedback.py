@@ -204,7 +204,7 @@ class VisualFeedback:
         if res is None:
             raise PlanningError()
         return res
-    def SetParameter(self,raydensity=None,raymindist=None,allowableocclusion=None):
+    def SetParameter(self,raydensity=None,raymindist=None,allowableocclusion=None,usevisibilitymap=None):
         """See :ref:`module-visualfeedback-setparameter`
         """
         cmd = 'SetParameter '
@@ -214,4 +214,24 @@ class VisualFeedback:
             cmd += 'raymindist %.15e '%raymindist
         if allowableocclusion is not None:
             cmd += 'allowableocclusion %.15e '%allowableocclusion
+        if usevisibilitymap is not None:
+            cmd += 'usevisibilitymap %d '%usevisibilitymap
         return self.prob.SendCommand(cmd)
+    def BuildVisibilityMap(self,numthreads=None,force=None):
+        """See :ref:`module-visualfeedback-buildvisibilitymap`
+
+        :return: the number of camera transforms and the number of occluded ones
+        """
+        cmd = 'BuildVisibilityMap '
+        if numthreads is not None:
+            cmd += 'numthreads %d '%numthreads
+        if force is not None:
+            cmd += 'force %d '%force
+        res = self.prob.SendCommand(cmd)
+        if res is None:
+            raise PlanningError()
+        return [int(s) for s in res.split()]
+    def ClearVisibilityMaps(self):
+        """See :ref:`module-visualfeedback-clearvisibilitymaps`
+        """
+        return self.prob.SendCommand('ClearVisibilityMaps')
@@ -2508,7 +2508,7 @@ public:
 
             KinBody::Link::GeometryPtr pgeom(new KinBody::Link::Geometry(plink,*itgeominfo));
             pgeom->_info._id = str(boost::format("geom%d")%plink->_vGeometries.size());
-            pgeom->_info.InitCollisionMesh();
+            pgeom->InitCollisionMesh();
             plink->_vGeometries.push_back(pgeom);
             //  Append the collision mesh
             TriMesh trimesh = pgeom->GetCollisionMesh();
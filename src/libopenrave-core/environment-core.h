@@ -622,6 +622,64 @@ public:
     virtual bool Load(const std::string& filename, const AttributesList& atts) override
     {
         EnvironmentLock lockenv(GetMutex());
+        if( _IsSceneFile(filename) ) {
+            return _LoadSceneFile(filename, atts);
+        }
+        return _LoadFile(filename, atts);
+    }
+
+    /// \brief loads a compiled scene, recompiling it from its source first if any of the files it was built from changed. Environment has to be locked.
+    bool _LoadSceneFile(const std::string& filename, const AttributesList& atts)
+    {
+        std::string sourceFilename;
+        if( RaveIsSceneFileCurrent(filename, sourceFilename) ) {
+            _ClearRapidJsonBuffer();
+            if( RaveParseSceneFile(shared_from_this(), filename, UFIM_Exact, atts, *_prLoadEnvAlloc) ) {
+                return true;
+            }
+            RAVELOG_WARN_FORMAT("env=%s, load failed on scene file '%s'", GetNameId()%filename);
+            return false;
+        }
+        if( sourceFilename.empty() ) {
+            // the header or dependency table could not be read, so fall back to the source the caller passed
+            sourceFilename = _GetSceneSourceFilename(atts);
+        }
+        if( sourceFilename.empty() ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, scene file '%s' is out of date or unreadable and has no source to recompile it from, pass the 'source' attribute"), GetNameId()%filename, ORE_InvalidArguments);
+        }
+
+        RAVELOG_INFO_FORMAT("env=%s, scene file '%s' is out of date, recompiling it from '%s'", GetNameId()%filename%sourceFilename);
+        std::set<KinBodyPtr> setPreviousBodies;
+        {
+            SharedLock lock(_mutexInterfaces);
+            setPreviousBodies.insert(_vecbodies.begin(), _vecbodies.end());
+        }
+        if( !_LoadFile(sourceFilename, atts) ) {
+            return false;
+        }
+        std::list<KinBodyPtr> listbodies;
+        {
+            SharedLock lock(_mutexInterfaces);
+            for (KinBodyPtr& pbody : _vecbodies) {
+                if( !!pbody && setPreviousBodies.count(pbody) == 0 ) {
+                    listbodies.push_back(pbody);
+                }
+            }
+        }
+        try {
+            _ClearRapidJsonBuffer();
+            RaveWriteSceneFile(listbodies, RaveFindLocalFile(filename), sourceFilename, atts, *_prLoadEnvAlloc);
+        }
+        catch(const openrave_exception& ex) {
+            // the scene itself was loaded, so only the next load pays for the failed write
+            RAVELOG_WARN_FORMAT("env=%s, failed to recompile scene file '%s': %s", GetNameId()%filename%ex.message());
+        }
+        return true;
+    }
+
+    /// \brief dispatches on the file type of filename. Environment has to be locked.
+    bool _LoadFile(const std::string& filename, const AttributesList& atts)
+    {
         OpenRAVEXMLParser::GetXMLErrorCount() = 0;
         std::string path;
         if (_IsURI(filename, path)) {
@@ -729,6 +787,16 @@ public:
                 _ClearRapidJsonBuffer();
                 RaveWriteMsgPackFile(shared_from_this(),filename,atts,*_prLoadEnvAlloc);
             }
+            else if( _IsSceneFile(filename) ) {
+                _ClearRapidJsonBuffer();
+                std::list<KinBodyPtr> listallbodies;
+                for (KinBodyPtr& pbody : _vecbodies) {
+                    if( !!pbody ) {
+                        listallbodies.push_back(pbody);
+                    }
+                }
+                RaveWriteSceneFile(listallbodies,filename,_GetSceneSourceFilename(atts),atts,*_prLoadEnvAlloc);
+            }
             else if (StringEndsWith(filename, ".json.gpg")) {
                 _ClearRapidJsonBuffer();
                 RaveWriteEncryptedJSONFile(shared_from_this(), filename, atts, *_prLoadEnvAlloc);
@@ -795,6 +863,10 @@ public:
             _ClearRapidJsonBuffer();
             RaveWriteMsgPackFile(listbodies,filename,atts,*_prLoadEnvAlloc);
         }
+        else if( _IsSceneFile(filename) ) {
+            _ClearRapidJsonBuffer();
+            RaveWriteSceneFile(listbodies,filename,_GetSceneSourceFilename(atts),atts,*_prLoadEnvAlloc);
+        }
         else if( StringEndsWith(filename, ".json.gpg") ) {
             _ClearRapidJsonBuffer();
             RaveWriteEncryptedJSONFile(listbodies,filename,atts,*_prLoadEnvAlloc);
@@ -3719,7 +3791,7 @@ protected:
                             if( !!probotInThisEnv &&
                                 probotInThisEnv->IsRobot() &&
                                 probotInThisEnv->GetName() == robotInOtherEnv.GetName() &&
-                                probotInThisEnv->GetKinematicsGeometryHash() == robotInOtherEnv.GetKinematicsGeometryHash() ) {
+                                probotInThisEnv->GetKinematicsGeometryDigest() == robotInOtherEnv.GetKinematicsGeometryDigest() ) {
                                 pnewrobot = RaveInterfaceCast<RobotBase>(probotInThisEnv);
                                 break;
                             }
@@ -3768,7 +3840,7 @@ protected:
                             if( !pNewBodyCandidate ) {
                                 RAVELOG_WARN_FORMAT("env=%s, a body (name=%s, envBodyIndex=%d) in vecbodies is not initialized", GetNameId()%name%envBodyIdx);
                             }
-                            else if (pNewBodyCandidate->GetKinematicsGeometryHash() == body.GetKinematicsGeometryHash() ) {
+                            else if (pNewBodyCandidate->GetKinematicsGeometryDigest() == body.GetKinematicsGeometryDigest() ) {
                                 pnewbody = pNewBodyCandidate;
                             }
                         }
@@ -4420,6 +4492,23 @@ protected:
         return StringEndsWith(filename, ".msgpack");
     }
 
+    /// \brief compiled openrave binary scene, see RaveWriteSceneFile
+    static bool _IsSceneFile(const std::string& filename)
+    {
+        return StringEndsWith(filename, ".orscene");
+    }
+
+    /// \brief the 'source' attribute names the file a compiled scene is rebuilt from once it goes stale
+    static std::string _GetSceneSourceFilename(const AttributesList& atts)
+    {
+        FOREACHC(itatt,atts) {
+            if( itatt->first == "source" ) {
+                return itatt->second;
+            }
+        }
+        return std::string();
+    }
+
     static bool _IsMsgPackData(const std::string& data)
     {
         return data.size() > 0 && !std::isprint(data[0]);
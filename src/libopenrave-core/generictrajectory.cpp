@@ -19,6 +19,7 @@
 #include <boost/lambda/lambda.hpp>
 #include <boost/lexical_cast.hpp>
 #include <openrave/xmlreaders.h>
+#include <openrave/openravemsgpack.h>
 
 using namespace boost::placeholders;
 
@@ -187,6 +188,8 @@ public:
         _maporder["joint_torques"] = 11;
         _bInit = false;
         _bSamplingVerified = false;
+        RegisterJSONCommand("InsertWaypoints", boost::bind(&GenericTrajectory::_InsertWaypointsCommand, this, _1, _2, _3),
+                            "Inserts waypoints. Input is {\"data\": values of the waypoints, an array or a typed array, \"index\": waypoint index, defaults to the end, \"overwrite\": bool}, output is {\"numWaypoints\": int}.");
     }
 
     bool SortGroups(const ConfigurationSpecification::Group& g1, const ConfigurationSpecification::Group& g2)
@@ -271,6 +274,32 @@ public:
         }
     }
 
+    /// \brief JSON command version of Insert, when data is a typed array of float64 it is inserted directly from the input buffer
+    void _InsertWaypointsCommand(const rapidjson::Value& input, rapidjson::Value& output, rapidjson::Document::AllocatorType& allocator)
+    {
+        if( !input.IsObject() || !input.HasMember("data") ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("InsertWaypoints needs an object with data"), ORE_InvalidArguments);
+        }
+        int index = GetNumWaypoints();
+        bool bOverwrite = false;
+        orjson::LoadJsonValueByKey(input, "index", index);
+        orjson::LoadJsonValueByKey(input, "overwrite", bOverwrite);
+        OPENRAVE_ASSERT_OP(index, >=, 0);
+
+        MsgPack::TypedArrayView view;
+        if( MsgPack::GetTypedArrayView(input["data"], view) && view.GetTypeCode() == 'd' && sizeof(dReal) == sizeof(double) && ((uintptr_t)view.GetData() % alignof(dReal)) == 0 ) {
+            Insert(index, (const dReal*)view.GetData(), view.size(), bOverwrite);
+        }
+        else {
+            std::vector<double> vdata;
+            MsgPack::LoadNumberArray(input["data"], vdata);
+            std::vector<dReal> vtrajdata(vdata.begin(), vdata.end());
+            Insert(index, vtrajdata, bOverwrite);
+        }
+        output.SetObject();
+        orjson::SetJsonValueByKey(output, "numWaypoints", (int)GetNumWaypoints(), allocator);
+    }
+
     void Insert(size_t index, const std::vector<dReal>& data, bool bOverwrite) override
     {
         Insert (index, data.data(), data.size(), bOverwrite);
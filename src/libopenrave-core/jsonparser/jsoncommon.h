@@ -99,6 +99,17 @@ void RaveWriteEncryptedMsgPackMemory(const std::list<KinBodyPtr>& listbodies, st
 void RaveWriteEncryptedMsgPackStream(EnvironmentBasePtr penv, std::ostream& os, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc);
 void RaveWriteEncryptedMsgPackStream(const std::list<KinBodyPtr>& listbodies, std::ostream& os, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc);
 
+/// \brief returns true if every file the compiled scene was built from still has the same contents
+///
+/// \param sourceFilename filled with the file the scene was compiled from, empty if the scene cannot be recompiled
+bool RaveIsSceneFileCurrent(const std::string& filename, std::string& sourceFilename);
+/// \brief loads a compiled scene (.orscene) by memory mapping it and constructing the bodies directly from their infos
+bool RaveParseSceneFile(EnvironmentBasePtr penv, const std::string& filename, UpdateFromInfoMode updateMode, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc);
+/// \brief compiles the bodies into a scene file that records the hashes of every file they were loaded from
+///
+/// \param sourceFilename the file the bodies were loaded from, used to recompile the scene when it becomes stale
+void RaveWriteSceneFile(const std::list<KinBodyPtr>& listbodies, const std::string& filename, const std::string& sourceFilename, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc);
+
 bool GpgDecrypt(std::istream& inputStream, std::ostream& outputData);
 bool GpgEncrypt(std::istream& inputStream, std::ostream& outputData, const std::unordered_set<string>& keyIds);
 
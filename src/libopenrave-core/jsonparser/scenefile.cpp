@@ -0,0 +1,303 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "jsoncommon.h"
+#include "stringutils.h"
+
+#include <openrave/openravejson.h>
+#include <openrave/openravemsgpack.h>
+#include <openrave/utils.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace OpenRAVE {
+
+/*  Layout of a compiled scene file (.orscene), integers are in host byte order since the files are meant as local caches:
+
+    char[8]  magic "ORSCENE\0"
+    uint32   format version
+    uint32   size of the dependency table in bytes
+    uint64   size of the scene in bytes
+    char[]   dependency table, json {"source": file to recompile from, "dependencies": [{"filename", "md5"}, ...]}
+    char[]   scene, msgpack of the environment json where every body is fully expanded, meshes included
+
+    The dependency table is kept separate from the scene so that staleness can be checked without touching the scene.
+ */
+static const char s_sceneFileMagic[8] = {'O','R','S','C','E','N','E','\0'};
+static const uint32_t s_sceneFileVersion = 1; ///< bump whenever the layout or the serialized infos change incompatibly
+static const size_t s_sceneFileHeaderSize = sizeof(s_sceneFileMagic) + 2*sizeof(uint32_t) + sizeof(uint64_t);
+
+/// \brief md5 of the contents of a file, empty if the file cannot be read
+static std::string _GetFileHash(const std::string& filename)
+{
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if( !ifs ) {
+        return std::string();
+    }
+    std::string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    return utils::GetMD5HashString(data);
+}
+
+/// \brief resolves the uri a body was loaded from into a local filename, empty if it is not backed by a file
+static std::string _ResolveSourceFilename(const std::string& uri)
+{
+    if( uri.empty() ) {
+        return std::string();
+    }
+    std::string scheme, path, fragment;
+    ParseURI(uri.c_str(), scheme, path, fragment);
+    if( path.empty() ) {
+        return std::string();
+    }
+    if( scheme.empty() || scheme == "file" ) {
+        return RaveFindLocalFile(path);
+    }
+    // openrave scheme aliases are relative to the data directories
+    return RaveFindLocalFile(path[0] == '/' ? path.substr(1) : path);
+}
+
+/// \brief reads the fields of the fixed size header, returns false if pdata does not start with the scene file magic
+static bool _ParseSceneFileHeader(const char* pdata, uint32_t& version, uint32_t& dependenciesSize, uint64_t& sceneSize)
+{
+    if( std::memcmp(pdata, s_sceneFileMagic, sizeof(s_sceneFileMagic)) != 0 ) {
+        return false;
+    }
+    std::memcpy(&version, pdata + sizeof(s_sceneFileMagic), sizeof(version));
+    std::memcpy(&dependenciesSize, pdata + sizeof(s_sceneFileMagic) + sizeof(uint32_t), sizeof(dependenciesSize));
+    std::memcpy(&sceneSize, pdata + sizeof(s_sceneFileMagic) + 2*sizeof(uint32_t), sizeof(sceneSize));
+    return true;
+}
+
+/// \brief validates the fixed size header and returns the sizes of the two sections
+static void _ReadSceneFileHeader(const char* pdata, size_t size, const std::string& filename, uint32_t& dependenciesSize, uint64_t& sceneSize)
+{
+    uint32_t version = 0;
+    if( size < s_sceneFileHeaderSize || !_ParseSceneFileHeader(pdata, version, dependenciesSize, sceneSize) ) {
+        throw OPENRAVE_EXCEPTION_FORMAT("file '%s' is not an openrave scene file", filename, ORE_InvalidArguments);
+    }
+    if( version != s_sceneFileVersion ) {
+        throw OPENRAVE_EXCEPTION_FORMAT("scene file '%s' has version %d, expected %d, it needs to be recompiled", filename%version%s_sceneFileVersion, ORE_InvalidArguments);
+    }
+    if( (uint64_t)size < (uint64_t)s_sceneFileHeaderSize + dependenciesSize + sceneSize ) {
+        throw OPENRAVE_EXCEPTION_FORMAT("scene file '%s' is truncated, %d bytes but header requires %d", filename%size%((uint64_t)s_sceneFileHeaderSize + dependenciesSize + sceneSize), ORE_InvalidArguments);
+    }
+}
+
+/// \brief adds the mesh files a geometry was loaded from
+static void _AddGeometryDependencies(const KinBody::GeometryInfo& info, std::set<std::string>& setDependencies)
+{
+    const std::string* pfilenames[] = {&info._filenamecollision, &info._filenamerender};
+    for(size_t ifilename = 0; ifilename < 2; ++ifilename) {
+        // skip viewer hints such as __norenderif__
+        if( pfilenames[ifilename]->size() == 0 || pfilenames[ifilename]->compare(0, 2, "__") == 0 ) {
+            continue;
+        }
+        std::string meshFilename = _ResolveSourceFilename(*pfilenames[ifilename]);
+        if( meshFilename.size() > 0 ) {
+            setDependencies.insert(meshFilename);
+        }
+    }
+}
+
+bool RaveIsSceneFileCurrent(const std::string& filename, std::string& sourceFilename)
+{
+    sourceFilename.clear();
+    std::string fullFilename = RaveFindLocalFile(filename);
+    if( fullFilename.size() == 0 ) {
+        return false;
+    }
+
+    // only the header and dependency table are read, the scene can be arbitrarily large
+    std::ifstream ifs(fullFilename.c_str(), std::ios::binary|std::ios::ate);
+    const uint64_t fileSize = ifs ? (uint64_t)ifs.tellg() : 0;
+    ifs.seekg(0);
+    std::vector<char> vheader(s_sceneFileHeaderSize);
+    if( fileSize < s_sceneFileHeaderSize || !ifs.read(vheader.data(), vheader.size()) ) {
+        RAVELOG_WARN_FORMAT("scene file '%s' is too short to be a scene file", fullFilename);
+        return false;
+    }
+    uint32_t version = 0, dependenciesSize = 0;
+    uint64_t sceneSize = 0;
+    if( !_ParseSceneFileHeader(vheader.data(), version, dependenciesSize, sceneSize) ) {
+        RAVELOG_WARN_FORMAT("file '%s' is not an openrave scene file", fullFilename);
+        return false;
+    }
+    if( (uint64_t)s_sceneFileHeaderSize + dependenciesSize > fileSize ) {
+        RAVELOG_WARN_FORMAT("scene file '%s' has a truncated dependency table", fullFilename);
+        return false;
+    }
+
+    // the dependency table is read even for other versions so that the recorded source can be used to recompile the scene
+    std::string dependenciesData(dependenciesSize, '\0');
+    if( !ifs.read(&dependenciesData[0], dependenciesSize) ) {
+        return false;
+    }
+    rapidjson::Document rDependencies;
+    try {
+        orjson::ParseJson(rDependencies, dependenciesData);
+    }
+    catch(const std::exception& ex) {
+        RAVELOG_WARN_FORMAT("scene file '%s' has a corrupted dependency table: %s", fullFilename%ex.what());
+        return false;
+    }
+    orjson::LoadJsonValueByKey(rDependencies, "source", sourceFilename);
+    if( version != s_sceneFileVersion ) {
+        RAVELOG_DEBUG_FORMAT("scene file '%s' has version %d, expected %d", fullFilename%version%s_sceneFileVersion);
+        return false;
+    }
+    if( (uint64_t)s_sceneFileHeaderSize + dependenciesSize + sceneSize > fileSize ) {
+        RAVELOG_WARN_FORMAT("scene file '%s' is truncated", fullFilename);
+        return false;
+    }
+
+    rapidjson::Value::ConstMemberIterator itDependencies = rDependencies.FindMember("dependencies");
+    if( itDependencies == rDependencies.MemberEnd() || !itDependencies->value.IsArray() ) {
+        return false;
+    }
+    for(rapidjson::Value::ConstValueIterator itDependency = itDependencies->value.Begin(); itDependency != itDependencies->value.End(); ++itDependency) {
+        std::string dependencyFilename, hash;
+        orjson::LoadJsonValueByKey(*itDependency, "filename", dependencyFilename);
+        orjson::LoadJsonValueByKey(*itDependency, "md5", hash);
+        std::string currentHash = _GetFileHash(dependencyFilename);
+        if( currentHash != hash ) {
+            RAVELOG_DEBUG_FORMAT("scene file '%s' is stale since '%s' changed", fullFilename%dependencyFilename);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RaveParseSceneFile(EnvironmentBasePtr penv, const std::string& filename, UpdateFromInfoMode updateMode, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
+{
+    std::string fullFilename = RaveFindLocalFile(filename);
+    if( fullFilename.size() == 0 ) {
+        return false;
+    }
+
+    // map the file instead of reading it so the scene is decoded straight from the page cache
+    boost::interprocess::file_mapping mapping(fullFilename.c_str(), boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+    const char* pdata = static_cast<const char*>(region.get_address());
+    uint32_t dependenciesSize = 0;
+    uint64_t sceneSize = 0;
+    _ReadSceneFileHeader(pdata, region.get_size(), fullFilename, dependenciesSize, sceneSize);
+
+    rapidjson::Document rEnvInfo(&alloc);
+    MsgPack::ParseMsgPack(rEnvInfo, pdata + s_sceneFileHeaderSize + dependenciesSize, sceneSize);
+
+    // bodies are self-contained, so there is no uri to resolve references against
+    std::vector<KinBodyPtr> vCreatedBodies, vModifiedBodies, vRemovedBodies;
+    return RaveParseJSON(penv, std::string(), rEnvInfo, updateMode, vCreatedBodies, vModifiedBodies, vRemovedBodies, atts, alloc);
+}
+
+void RaveWriteSceneFile(const std::list<KinBodyPtr>& listbodies, const std::string& filename, const std::string& sourceFilename, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
+{
+    rapidjson::Document rEnvInfo(&alloc);
+    RaveWriteJSON(listbodies, rEnvInfo, rEnvInfo.GetAllocator(), atts);
+
+    // the infos already hold everything the reference would provide, so drop the references to skip resolving them on load
+    rapidjson::Value::MemberIterator itBodies = rEnvInfo.FindMember("bodies");
+    if( itBodies != rEnvInfo.MemberEnd() && itBodies->value.IsArray() ) {
+        for(rapidjson::Value::ValueIterator itBody = itBodies->value.Begin(); itBody != itBodies->value.End(); ++itBody) {
+            itBody->RemoveMember("referenceUri");
+        }
+    }
+
+    std::vector<char> vscene;
+    MsgPack::DumpMsgPack(rEnvInfo, vscene);
+
+    // every file the bodies and their meshes were loaded from, so that editing an included robot or mesh also invalidates the scene
+    std::set<std::string> setDependencies;
+    std::string fullSourceFilename;
+    if( sourceFilename.size() > 0 ) {
+        fullSourceFilename = RaveFindLocalFile(sourceFilename);
+        if( fullSourceFilename.size() > 0 ) {
+            setDependencies.insert(fullSourceFilename);
+        }
+        else {
+            RAVELOG_WARN_FORMAT("could not find scene source '%s', scene file '%s' cannot be recompiled", sourceFilename%filename);
+        }
+    }
+    FOREACHC(itbody, listbodies) {
+        std::string bodyFilename = _ResolveSourceFilename((*itbody)->GetURI());
+        if( bodyFilename.size() > 0 ) {
+            setDependencies.insert(bodyFilename);
+        }
+        FOREACHC(itlink, (*itbody)->GetLinks()) {
+            FOREACHC(itgeom, (*itlink)->GetGeometries()) {
+                _AddGeometryDependencies((*itgeom)->GetInfo(), setDependencies);
+            }
+            FOREACHC(itgroup, (*itlink)->GetInfo()._mapExtraGeometries) {
+                FOREACHC(itgeominfo, itgroup->second) {
+                    _AddGeometryDependencies(**itgeominfo, setDependencies);
+                }
+            }
+        }
+    }
+
+    rapidjson::Document rDependencies;
+    rDependencies.SetObject();
+    orjson::SetJsonValueByKey(rDependencies, "source", fullSourceFilename, rDependencies.GetAllocator());
+    rapidjson::Value rDependencyArray(rapidjson::kArrayType);
+    FOREACHC(itfilename, setDependencies) {
+        std::string hash = _GetFileHash(*itfilename);
+        if( hash.empty() ) {
+            continue;
+        }
+        rapidjson::Value rDependency(rapidjson::kObjectType);
+        orjson::SetJsonValueByKey(rDependency, "filename", *itfilename, rDependencies.GetAllocator());
+        orjson::SetJsonValueByKey(rDependency, "md5", hash, rDependencies.GetAllocator());
+        rDependencyArray.PushBack(rDependency, rDependencies.GetAllocator());
+    }
+    rDependencies.AddMember("dependencies", rDependencyArray, rDependencies.GetAllocator());
+    std::string dependenciesData = orjson::DumpJson(rDependencies);
+
+    uint32_t dependenciesSize = dependenciesData.size();
+    uint64_t sceneSize = vscene.size();
+    // write next to the target and rename over it, other processes may have the old scene mapped and must never see a partial file
+    std::string tempFilename = str(boost::format("%s.%d.tmp")%filename%utils::GetMicroTime());
+    {
+        std::ofstream ofs(tempFilename.c_str(), std::ios::binary);
+        if( !ofs ) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to open scene file '%s' for writing", tempFilename, ORE_InvalidArguments);
+        }
+        ofs.write(s_sceneFileMagic, sizeof(s_sceneFileMagic));
+        ofs.write(reinterpret_cast<const char*>(&s_sceneFileVersion), sizeof(s_sceneFileVersion));
+        ofs.write(reinterpret_cast<const char*>(&dependenciesSize), sizeof(dependenciesSize));
+        ofs.write(reinterpret_cast<const char*>(&sceneSize), sizeof(sceneSize));
+        ofs.write(dependenciesData.data(), dependenciesData.size());
+        ofs.write(vscene.data(), vscene.size());
+        ofs.close();
+        if( !ofs ) {
+            std::remove(tempFilename.c_str());
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to write scene file '%s'", tempFilename, ORE_Failed);
+        }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(tempFilename, filename, ec);
+    if( !!ec ) {
+        std::remove(tempFilename.c_str());
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to replace scene file '%s': %s", filename%ec.message(), ORE_Failed);
+    }
+}
+
+}
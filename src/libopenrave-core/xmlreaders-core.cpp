@@ -964,6 +964,7 @@ public:
                     Transform tnew = _plink->GetTransform();
                     FOREACH(itgeom, _plink->_vGeometries) {
                         (*itgeom)->_info.SetTransform(tnew * (*itgeom)->_info.GetTransform());
+                        (*itgeom)->_InvalidateSerializationDigest();
                     }
                     _plink->_collision.ApplyTransform(tnew);
                     _plink->SetTransform(tOrigTrans);
@@ -1087,7 +1088,7 @@ public:
 
                         // call before attaching the geom
                         KinBody::Link::GeometryPtr geom(new KinBody::Link::Geometry(_plink,*info));
-                        geom->_info.InitCollisionMesh();
+                        geom->InitCollisionMesh();
                         FOREACH(it,info->_meshcollision.vertices) {
                             *it = tmres * *it;
                         }
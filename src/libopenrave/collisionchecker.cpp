@@ -441,6 +441,7 @@ void CollisionReport::Reset(int coloptions)
     options = coloptions;
     if( !(nKeepPrevious & 1) ) {
         minDistance = 1e20f;
+        bMinDistanceIsLowerBound = false;
         numWithinTol = 0;
         nNumValidCollisions = 0;
     }
@@ -452,6 +453,7 @@ void CollisionReport::Swap(CollisionReport& rhs)
     std::swap(nNumValidCollisions, rhs.nNumValidCollisions);
     std::swap(options, rhs.options);
     std::swap(minDistance, rhs.minDistance);
+    std::swap(bMinDistanceIsLowerBound, rhs.bMinDistanceIsLowerBound);
     std::swap(numWithinTol, rhs.numWithinTol);
     std::swap(nKeepPrevious, rhs.nKeepPrevious);
 }
@@ -468,6 +470,7 @@ CollisionReport& CollisionReport::operator=(const CollisionReport& rhs)
     }
     options = rhs.options;
     minDistance = rhs.minDistance;
+    bMinDistanceIsLowerBound = rhs.bMinDistanceIsLowerBound;
     numWithinTol = rhs.numWithinTol;
     nKeepPrevious = rhs.nKeepPrevious;
     return *this;
@@ -487,7 +490,7 @@ std::string CollisionReport::__str__() const
     }
     s << "]";
     if( minDistance < 1e10 ) {
-        s << ", mindist="<<minDistance;
+        s << ", mindist="<<(bMinDistanceIsLowerBound ? ">=" : "")<<minDistance;
     }
     return s.str();
 }
@@ -512,6 +515,9 @@ void CollisionReport::SaveToJson(rapidjson::Value& rCollisionReport, rapidjson::
     }
     if( minDistance < 1e10 ) {
         orjson::SetJsonValueByKey(rCollisionReport, "minDistance", minDistance, alloc);
+        if( bMinDistanceIsLowerBound ) {
+            orjson::SetJsonValueByKey(rCollisionReport, "minDistanceIsLowerBound", bMinDistanceIsLowerBound, alloc);
+        }
     }
     if( numWithinTol ) {
         orjson::SetJsonValueByKey(rCollisionReport, "numWithinTol", numWithinTol, alloc);
@@ -541,6 +547,7 @@ void CollisionReport::LoadFromJson(const rapidjson::Value& rCollisionReport)
 
     orjson::LoadJsonValueByKey(rCollisionReport, "options", options);
     orjson::LoadJsonValueByKey(rCollisionReport, "minDistance", minDistance);
+    orjson::LoadJsonValueByKey(rCollisionReport, "minDistanceIsLowerBound", bMinDistanceIsLowerBound);
     orjson::LoadJsonValueByKey(rCollisionReport, "numWithinTol", numWithinTol);
 }
 
@@ -15,6 +15,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "libopenrave.h"
+#include <openrave/openravemsgpack.h>
 
 #include <boost/bind/bind.hpp>
 
@@ -251,6 +252,18 @@ void InterfaceBase::SendJSONCommand(const std::string& cmdname, const rapidjson:
     interfacecmd->fn(input, output, allocator);
 }
 
+void InterfaceBase::SendMsgPackCommand(const std::string& cmdname, const void* pinput, size_t inputsize, std::vector<char>& output)
+{
+    rapidjson::Document rInput, rOutput;
+    if( inputsize > 0 ) {
+        // pinput outlives rInput, so the typed arrays do not have to be copied
+        MsgPack::ParseMsgPack(rInput, pinput, inputsize, true);
+    }
+    SendJSONCommand(cmdname, rInput, rOutput);
+    output.clear();
+    MsgPack::DumpMsgPack(rOutput, output);
+}
+
 void InterfaceBase::_GetJSONCommandHelp(const rapidjson::Value& input, rapidjson::Value& output, rapidjson::Document::AllocatorType& allocator) const {
     output.SetObject();
 
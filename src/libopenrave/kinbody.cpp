@@ -441,6 +441,7 @@ KinBody::KinBody(InterfaceType type, EnvironmentBasePtr penv) : InterfaceBase(ty
     _environmentBodyIndex = 0;
     _nNonAdjacentLinkCache = 0x80000000;
     _nUpdateStampId = 0;
+    _nFKUpdateStamp = _nIncrementalFKPrevStamp = _nIncrementalFKStamp = std::numeric_limits<int>::min();
     _bAreAllJoints1DOFAndNonCircular = false;
     _lastModifiedAtUS = 0;
     _revisionId = 0;
@@ -489,6 +490,7 @@ void KinBody::Destroy()
     _vClosedLoops.clear();
     _vClosedLoopIndices.clear();
     _vForcedAdjacentLinks.clear();
+    _vDisabledCollisionLinks.clear();
     _nHierarchyComputed = 0;
     _nParametersChanged = 0;
     _pManageData.reset();
@@ -497,6 +499,7 @@ void KinBody::Destroy()
     _selfcollisionchecker.reset();
 
     __hashKinematicsGeometryDynamics.resize(0);
+    __nKinematicsGeometryDynamicsDigest = 0;
     ClearReadableInterfaces();
 }
 
@@ -518,7 +521,7 @@ bool KinBody::InitFromBoxes(const std::vector<AABB>& vaabbs, bool visible, const
         info._vDiffuseColor=Vector(1,0.5f,0.5f,1);
         info._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
         Link::GeometryPtr geom(new Link::Geometry(plink,info));
-        geom->_info.InitCollisionMesh();
+        geom->InitCollisionMesh();
         numvertices += geom->GetCollisionMesh().vertices.size();
         numindices += geom->GetCollisionMesh().indices.size();
         plink->_vGeometries.push_back(geom);
@@ -563,7 +566,7 @@ bool KinBody::InitFromBoxes(const std::vector<OBB>& vobbs, bool visible, const s
         info._vDiffuseColor=Vector(1,0.5f,0.5f,1);
         info._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
         Link::GeometryPtr geom(new Link::Geometry(plink,info));
-        geom->_info.InitCollisionMesh();
+        geom->InitCollisionMesh();
         numvertices += geom->GetCollisionMesh().vertices.size();
         numindices += geom->GetCollisionMesh().indices.size();
         plink->_vGeometries.push_back(geom);
@@ -603,7 +606,7 @@ bool KinBody::InitFromSpheres(const std::vector<Vector>& vspheres, bool visible,
         info._vDiffuseColor=Vector(1,0.5f,0.5f,1);
         info._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
         Link::GeometryPtr geom(new Link::Geometry(plink,info));
-        geom->_info.InitCollisionMesh();
+        geom->InitCollisionMesh();
         plink->_vGeometries.push_back(geom);
         trimesh = geom->GetCollisionMesh();
         trimesh.ApplyTransform(geom->GetTransform());
@@ -657,7 +660,7 @@ bool KinBody::InitFromGeometries(const std::vector<KinBody::GeometryInfo>& geome
     unsigned totalVertices = 0, totalIndices = 0;
     FOREACHC(geomIt, geometries) {
         Link::GeometryPtr geom {new KinBody::Link::Geometry(plink, *geomIt)};
-        geom->_info.InitCollisionMesh();
+        geom->InitCollisionMesh();
         const TriMesh& mesh = geom->GetCollisionMesh();
         totalVertices += mesh.vertices.size();
         totalIndices += mesh.indices.size();
@@ -731,10 +734,17 @@ bool KinBody::Init(const std::vector<KinBody::LinkInfoConstPtr>& linkinfos, cons
     OPENRAVE_ASSERT_FORMAT(GetEnvironmentBodyIndex()==0, "%s: cannot Init a body while it is added to the environment", GetName(), ORE_Failed);
     Destroy();
     _veclinks.reserve(linkinfos.size());
+    std::vector<LinkPtr> vlinks;
+    vlinks.reserve(linkinfos.size());
     FOREACHC(itlinkinfo, linkinfos) {
         LinkPtr plink(new Link(shared_kinbody()));
         plink->_info = **itlinkinfo;
-        _InitAndAddLink(plink);
+        vlinks.push_back(plink);
+    }
+    // tessellate the geometries of all links at once so that the work can be spread over threads
+    _InitLinkGeometries(vlinks);
+    FOREACH(itlink, vlinks) {
+        _InitAndAddLink(*itlink, true);
     }
     _vecjoints.reserve(jointinfos.size());
     FOREACHC(itjointinfo, jointinfos) {
@@ -756,10 +766,16 @@ void KinBody::InitFromLinkInfos(const std::vector<LinkInfo>& linkinfos, const st
     OPENRAVE_ASSERT_OP(linkinfos.size(),>,0);
     Destroy();
     _veclinks.reserve(linkinfos.size());
+    std::vector<LinkPtr> vlinks;
+    vlinks.reserve(linkinfos.size());
     FOREACHC(itlinkinfo, linkinfos) {
         LinkPtr plink(new Link(shared_kinbody()));
         plink->_info = *itlinkinfo;
-        _InitAndAddLink(plink);
+        vlinks.push_back(plink);
+    }
+    _InitLinkGeometries(vlinks);
+    FOREACH(itlink, vlinks) {
+        _InitAndAddLink(*itlink, true);
     }
     if( linkinfos.size() > 1 ) {
         // create static joints
@@ -2128,6 +2144,12 @@ void KinBody::SetDOFValues(const dReal* pJointValues, int dof, uint32_t checklim
     OPENRAVE_ASSERT_OP_FORMAT((int)dof,>=,expecteddof, "env=%s, not enough values %d<%d", GetEnv()->GetNameId()%dof%GetDOF(),ORE_InvalidArguments);
 
     GetDOFValues(_vTempJoints);
+    // if nothing changed the link transforms since the last forward kinematics, only the links affected by the changed dofs have to be recomputed
+    const bool bIncremental = _nFKUpdateStamp == _nUpdateStampId && _vClosedLoops.empty() && !_pCurrentKinematicsFunctions;
+    const int nPrevUpdateStamp = _nUpdateStampId;
+    if( bIncremental ) {
+        _vPrevDOFValuesCache = _vTempJoints;
+    }
     if( dofindices.size() > 0 ) {
         // user only set a certain number of indices, so have to fill the temporary array with the full set of values first
         // and then overwrite with the user set values
@@ -2277,7 +2299,30 @@ void KinBody::SetDOFValues(const dReal* pJointValues, int dof, uint32_t checklim
 
     std::vector<uint8_t>& vlinkscomputed = _vLinksVisitedCache;
     vlinkscomputed.resize(_veclinks.size());
-    std::fill(vlinkscomputed.begin(), vlinkscomputed.end(), 0);
+    if( bIncremental ) {
+        // mark the links that are not affected by any changed dof as computed so that they keep their transforms
+        std::fill(vlinkscomputed.begin(), vlinkscomputed.end(), 1);
+        const size_t numlinks = _veclinks.size();
+        for(int idof = 0; idof < (int)_vPrevDOFValuesCache.size(); ++idof) {
+            if( _vPrevDOFValuesCache[idof] != pJointValues[idof] ) {
+                const int8_t* paffectedlinks = &_vJointsAffectingLinks.at(_vDOFIndices.at(idof)*numlinks);
+                for(size_t ilink = 1; ilink < numlinks; ++ilink) {
+                    if( paffectedlinks[ilink] ) {
+                        vlinkscomputed[ilink] = 0;
+                    }
+                }
+            }
+        }
+        _vIncrementalFKMovedLinks.resize(0);
+        for(size_t ilink = 1; ilink < numlinks; ++ilink) {
+            if( !vlinkscomputed[ilink] ) {
+                _vIncrementalFKMovedLinks.push_back(ilink);
+            }
+        }
+    }
+    else {
+        std::fill(vlinkscomputed.begin(), vlinkscomputed.end(), 0);
+    }
     vlinkscomputed[0] = 1;
     boost::array<dReal,3> dummyvalues; // dummy values for a joint
     std::vector<dReal>& vtempvalues = _vTempMimicValues;
@@ -2290,6 +2335,9 @@ void KinBody::SetDOFValues(const dReal* pJointValues, int dof, uint32_t checklim
         const LinkPtr& childlink = joint._attachedbodies[1];
 
         if( joint.IsStatic() ) {
+            if( bIncremental && vlinkscomputed[childlink->GetIndex()] ) {
+                continue;
+            }
             // if joint.IsStatic(), then joint._info._tRightNoOffset and tjoint are assigned identities
             const Transform t = (!!parentlink ? parentlink->GetTransform() : _veclinks.at(0)->GetTransform()) * joint.GetInternalHierarchyLeftTransform();
             childlink->SetTransform(t);
@@ -2482,6 +2530,14 @@ void KinBody::SetDOFValues(const dReal* pJointValues, int dof, uint32_t checklim
 
     _UpdateGrabbedBodies();
     _PostprocessChangedParameters(Prop_LinkTransforms);
+    if( bIncremental ) {
+        _nIncrementalFKPrevStamp = nPrevUpdateStamp;
+        _nIncrementalFKStamp = _nUpdateStampId;
+    }
+    else {
+        _nIncrementalFKStamp = std::numeric_limits<int>::min();
+    }
+    _nFKUpdateStamp = _nUpdateStampId;
 }
 
 bool KinBody::IsDOFRevolute(int dofindex) const
@@ -5569,6 +5625,10 @@ private:
         for(size_t ind0 = 0; ind0 < _veclinks.size(); ++ind0) {
             for(size_t ind1 = ind0+1; ind1 < _veclinks.size(); ++ind1) {
                 const bool bAdjacent = AreAdjacentLinks(ind0, ind1);
+                const size_t index = _GetIndex1d(ind0, ind1);
+                if( index < _vDisabledCollisionLinks.size() && _vDisabledCollisionLinks[index] ) {
+                    continue;
+                }
                 if(!bAdjacent && !collisionchecker->CheckCollision(LinkConstPtr(_veclinks[ind0]), LinkConstPtr(_veclinks[ind1])) ) {
                     _vNonAdjacentLinks[0].push_back(ind0|(ind1<<16));
                 }
@@ -5656,6 +5716,35 @@ void KinBody::_SetAdjacentLinksInternal(int linkindex0, int linkindex1)
     _vForcedAdjacentLinks.at(index) = 1;
 }
 
+void KinBody::SetDisabledCollisionLinkPairs(const std::vector<std::pair<int, int> >& linkIndices)
+{
+    const int numLinks = GetLinks().size();
+    _vDisabledCollisionLinks.clear();
+    _ResizeVectorFor2DTable(_vDisabledCollisionLinks, numLinks);
+    for (const std::pair<int, int>& link01 : linkIndices) {
+        OPENRAVE_ASSERT_OP(link01.first, !=, link01.second);
+        if( link01.first < 0 || link01.first >= numLinks || link01.second < 0 || link01.second >= numLinks ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s has %d links, cannot disable link pair (%d, %d)"), GetEnv()->GetNameId()%GetName()%numLinks%link01.first%link01.second, ORE_InvalidArguments);
+        }
+        _vDisabledCollisionLinks.at(_GetIndex1d(link01.first, link01.second)) = 1;
+    }
+    _ResetInternalCollisionCache();
+}
+
+void KinBody::GetDisabledCollisionLinkPairs(std::vector<std::pair<int, int> >& linkIndices) const
+{
+    linkIndices.resize(0);
+    const int numLinks = GetLinks().size();
+    for(int ind1 = 1; ind1 < numLinks; ++ind1) {
+        for(int ind0 = 0; ind0 < ind1; ++ind0) {
+            const size_t index = _GetIndex1d(ind0, ind1);
+            if( index < _vDisabledCollisionLinks.size() && _vDisabledCollisionLinks[index] ) {
+                linkIndices.emplace_back(ind0, ind1);
+            }
+        }
+    }
+}
+
 void KinBody::Clone(InterfaceBaseConstPtr preference, int cloningoptions)
 {
     InterfaceBase::Clone(preference,cloningoptions);
@@ -5668,6 +5757,8 @@ void KinBody::Clone(InterfaceBaseConstPtr preference, int cloningoptions)
     _nHierarchyComputed = r->_nHierarchyComputed;
     _bMakeJoinedLinksAdjacent = r->_bMakeJoinedLinksAdjacent;
     __hashKinematicsGeometryDynamics = r->__hashKinematicsGeometryDynamics;
+    __nKinematicsGeometryDynamicsDigest = r->__nKinematicsGeometryDynamicsDigest;
+    __nKinematicsGeometryDynamicsHashDigest = r->__nKinematicsGeometryDynamicsHashDigest;
     _vTempJoints = r->_vTempJoints;
 
     _vLinkTransformPointers.clear(); _vLinkTransformPointers.reserve(r->_veclinks.size());
@@ -5753,6 +5844,7 @@ void KinBody::Clone(InterfaceBaseConstPtr preference, int cloningoptions)
     _vAdjacentLinks = r->_vAdjacentLinks;
     _vInitialLinkTransformations = r->_vInitialLinkTransformations;
     _vForcedAdjacentLinks = r->_vForcedAdjacentLinks;
+    _vDisabledCollisionLinks = r->_vDisabledCollisionLinks;
     _vAllPairsShortestPaths = r->_vAllPairsShortestPaths;
     _vClosedLoopIndices = r->_vClosedLoopIndices;
     _vClosedLoops.resize(0); _vClosedLoops.reserve(r->_vClosedLoops.size());
@@ -5901,7 +5993,7 @@ void KinBody::_PostprocessChangedParameters(uint32_t parameters)
     }
     // do not change hash if geometry changed!
     if( !!(parameters & (Prop_LinkDynamics|Prop_LinkGeometry|Prop_JointMimic)) ) {
-        __hashKinematicsGeometryDynamics.resize(0);
+        __nKinematicsGeometryDynamicsDigest = 0;
     }
 
     if( (parameters&Prop_LinkEnable) == Prop_LinkEnable ) {
@@ -5963,16 +6055,45 @@ void KinBody::SetZeroConfiguration()
 const std::string& KinBody::GetKinematicsGeometryHash() const
 {
     CHECK_INTERNAL_COMPUTATION;
-    if( __hashKinematicsGeometryDynamics.size() == 0 ) {
+    // the md5 is only recomputed when the structure really changed since it needs the full serialization of all meshes
+    const uint64_t digest = GetKinematicsGeometryDigest();
+    if( __hashKinematicsGeometryDynamics.size() == 0 || __nKinematicsGeometryDynamicsHashDigest != digest ) {
         ostringstream ss;
         ss << std::fixed << std::setprecision(SERIALIZATION_PRECISION);
         // should add dynamics since that affects a lot how part is treated.
         serialize(ss,SO_Kinematics|SO_Geometry|SO_Dynamics);
         __hashKinematicsGeometryDynamics = utils::GetMD5HashString(ss.str());
+        __nKinematicsGeometryDynamicsHashDigest = digest;
     }
     return __hashKinematicsGeometryDynamics;
 }
 
+uint64_t KinBody::GetKinematicsGeometryDigest() const
+{
+    CHECK_INTERNAL_COMPUTATION;
+    if( __nKinematicsGeometryDynamicsDigest == 0 ) {
+        const int options = SO_Kinematics|SO_Geometry|SO_Dynamics;
+        uint64_t digest = _veclinks.size();
+        FOREACHC(itlink,_veclinks) {
+            digest = utils::CombineFastHash(digest, (*itlink)->ComputeSerializationDigest(options));
+        }
+        // joints are small, so serialize them directly
+        ostringstream ss;
+        ss << std::fixed << std::setprecision(SERIALIZATION_PRECISION);
+        ss << _vecjoints.size() << " ";
+        FOREACHC(it,_vecjoints) {
+            (*it)->serialize(ss,options);
+        }
+        ss << _vPassiveJoints.size() << " ";
+        FOREACHC(it,_vPassiveJoints) {
+            (*it)->serialize(ss,options);
+        }
+        digest = utils::CombineFastHash(digest, utils::GetFastHash(ss.str()));
+        __nKinematicsGeometryDynamicsDigest = digest != 0 ? digest : 1; // 0 is reserved for invalid
+    }
+    return __nKinematicsGeometryDynamicsDigest;
+}
+
 void KinBody::SetConfigurationValues(std::vector<dReal>::const_iterator itvalues, uint32_t checklimits)
 {
     vector<dReal> vdofvalues(GetDOF());
@@ -6058,7 +6179,30 @@ void KinBody::_SetForcedAdjacentLinks(int linkindex0, int linkindex1)
     _vForcedAdjacentLinks.at(index) = 1;
 }
 
-void KinBody::_InitAndAddLink(LinkPtr plink)
+void KinBody::_InitLinkGeometries(const std::vector<LinkPtr>& vlinks)
+{
+    std::vector<Link::Geometry*> vtessellategeoms;
+    FOREACHC(itlink, vlinks) {
+        const LinkPtr& plink = *itlink;
+        plink->_vGeometries.clear();
+        plink->_vGeometries.reserve(plink->_info._vgeometryinfos.size());
+        FOREACHC(itgeominfo,plink->_info._vgeometryinfos) {
+            Link::GeometryPtr geom(new Link::Geometry(plink,**itgeominfo));
+            if( geom->_info._meshcollision.vertices.size() == 0 ) { // try to avoid recomputing
+                vtessellategeoms.push_back(geom.get());
+            }
+            plink->_vGeometries.push_back(geom);
+        }
+    }
+
+    // below the threshold dispatching to the thread pool costs more than the tessellation
+    static const size_t s_nMinGeometriesForThreads = 64;
+    RaveGetThreadPool()->ParallelFor(vtessellategeoms.size(), [&vtessellategeoms](size_t igeom) {
+        vtessellategeoms[igeom]->InitCollisionMesh();
+    }, s_nMinGeometriesForThreads);
+}
+
+void KinBody::_InitAndAddLink(LinkPtr plink, bool bGeometriesInitialized)
 {
     CHECK_NO_INTERNAL_COMPUTATION;
     LinkInfo& info = plink->_info;
@@ -6071,16 +6215,13 @@ void KinBody::_InitAndAddLink(LinkPtr plink)
     }
 
     plink->_index = static_cast<int>(_veclinks.size());
-    plink->_vGeometries.clear();
+    if( !bGeometriesInitialized ) {
+        _InitLinkGeometries(std::vector<LinkPtr>(1, plink));
+    }
     plink->_collision.vertices.clear();
     plink->_collision.indices.clear();
-    FOREACHC(itgeominfo,info._vgeometryinfos) {
-        Link::GeometryPtr geom(new Link::Geometry(plink,**itgeominfo));
-        if( geom->_info._meshcollision.vertices.size() == 0 ) { // try to avoid recomputing
-            geom->_info.InitCollisionMesh();
-        }
-        plink->_vGeometries.push_back(geom);
-        plink->_collision.Append(geom->GetCollisionMesh(),geom->GetTransform());
+    FOREACHC(itgeom, plink->_vGeometries) {
+        plink->_collision.Append((*itgeom)->GetCollisionMesh(),(*itgeom)->GetTransform());
     }
 
     FOREACH(it, info._mReadableInterfaces) {
@@ -6089,7 +6230,7 @@ void KinBody::_InitAndAddLink(LinkPtr plink)
 
     _veclinks.push_back(plink);
     _vLinkTransformPointers.clear();
-    __hashKinematicsGeometryDynamics.resize(0);
+    __nKinematicsGeometryDynamicsDigest = 0;
 }
 
 void KinBody::_InitAndAddJoint(JointPtr pjoint)
@@ -6142,7 +6283,7 @@ void KinBody::_InitAndAddJoint(JointPtr pjoint)
     else {
         _vPassiveJoints.push_back(pjoint);
     }
-    __hashKinematicsGeometryDynamics.resize(0);
+    __nKinematicsGeometryDynamicsDigest = 0;
 }
 
 void KinBody::ExtractInfo(KinBodyInfo& info, ExtractInfoOptions options)
@@ -0,0 +1,259 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "libopenrave.h"
+
+namespace OpenRAVE {
+
+void KinBody::ExtractInverseDynamicsModel(InverseDynamicsModel& model) const
+{
+    CHECK_INTERNAL_COMPUTATION;
+    if( _vClosedLoops.size() > 0 ) {
+        throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s has closed loops, which inverse dynamics models do not support"), GetEnv()->GetNameId()%GetName(), ORE_NotImplemented);
+    }
+
+    model._nDOF = GetDOF();
+    model._vgravity = GetEnv()->GetPhysicsEngine()->GetGravity();
+    model._vjoints.resize(0);
+    model._vlinkbasetransforms.resize(_veclinks.size());
+    model._vlinkinertials.resize(13*_veclinks.size());
+    if( _veclinks.size() == 0 ) {
+        return;
+    }
+
+    const Transform tbaseinv = _veclinks[0]->GetTransform().inverse();
+    for(size_t ilink = 0; ilink < _veclinks.size(); ++ilink) {
+        const Link& link = *_veclinks[ilink];
+        model._vlinkbasetransforms[ilink] = tbaseinv * link.GetTransform();
+        dReal* pinertial = &model._vlinkinertials[13*ilink];
+        const Vector vlocalcom = link.GetLocalCOM();
+        const TransformMatrix tinertia = link.GetLocalInertia();
+        pinertial[0] = link.GetMass();
+        pinertial[1] = vlocalcom.x;
+        pinertial[2] = vlocalcom.y;
+        pinertial[3] = vlocalcom.z;
+        for(int i = 0; i < 3; ++i) {
+            for(int j = 0; j < 3; ++j) {
+                pinertial[4+3*i+j] = tinertia.m[4*i+j];
+            }
+        }
+    }
+
+    model._vjoints.reserve(_vTopologicallySortedJointsAll.size());
+    FOREACHC(itjoint, _vTopologicallySortedJointsAll) {
+        const Joint& joint = **itjoint;
+        InverseDynamicsModel::JointData jointdata;
+        jointdata.parentindex = !!joint.GetHierarchyParentLink() ? joint.GetHierarchyParentLink()->GetIndex() : -1;
+        jointdata.childindex = joint.GetHierarchyChildLink()->GetIndex();
+        jointdata.dofindex = joint.GetDOFIndex();
+        jointdata.tleft = joint.GetInternalHierarchyLeftTransform();
+        jointdata.tright = joint.GetInternalHierarchyRightTransform();
+        jointdata.bstatic = joint.IsStatic();
+        jointdata.brevolute = true;
+        jointdata.faxissign = 1;
+        jointdata.fcoulombfriction = 0;
+        jointdata.fviscousfriction = 0;
+        jointdata.frotorinertia = 0;
+        if( joint.IsMimic() ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s joint %s is mimic, which inverse dynamics models do not support"), GetEnv()->GetNameId()%GetName()%joint.GetName(), ORE_NotImplemented);
+        }
+        if( !jointdata.bstatic && jointdata.dofindex < 0 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s joint %s is passive, which inverse dynamics models do not support"), GetEnv()->GetNameId()%GetName()%joint.GetName(), ORE_NotImplemented);
+        }
+        if( jointdata.dofindex >= 0 ) {
+            if( joint.GetType() == JointRevolute ) {
+                jointdata.brevolute = true;
+            }
+            else if( joint.GetType() == JointPrismatic ) {
+                jointdata.brevolute = false;
+            }
+            else {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s joint %s has type 0x%x, which inverse dynamics models do not support"), GetEnv()->GetNameId()%GetName()%joint.GetName()%joint.GetType(), ORE_NotImplemented);
+            }
+            jointdata.vaxis = joint.GetInternalHierarchyAxis(0);
+            const Transform& tparent = jointdata.parentindex >= 0 ? _veclinks[jointdata.parentindex]->GetTransform() : _veclinks[0]->GetTransform();
+            if( (tparent * jointdata.tleft).rotate(jointdata.vaxis).dot3(joint.GetAxis(0)) < 0 ) {
+                jointdata.faxissign = -1;
+            }
+            if( !!joint._info._infoElectricMotor ) {
+                const ElectricMotorActuatorInfo& actuatorinfo = *joint._info._infoElectricMotor;
+                jointdata.fcoulombfriction = actuatorinfo.coloumb_friction;
+                jointdata.fviscousfriction = actuatorinfo.viscous_friction;
+                if( actuatorinfo.rotor_inertia > 0 ) {
+                    jointdata.frotorinertia = actuatorinfo.rotor_inertia * actuatorinfo.gear_ratio * actuatorinfo.gear_ratio;
+                }
+            }
+        }
+        model._vjoints.push_back(jointdata);
+    }
+}
+
+void KinBody::InverseDynamicsModel::ComputeInverseDynamics(const Transform& tbase, const dReal* pdofvalues, const dReal* pdofvelocities, const dReal* pdofaccelerations, dReal* pdoftorques, Workspace& workspace, const ForceTorqueMap& externalforcetorque) const
+{
+    for(int idof = 0; idof < _nDOF; ++idof) {
+        pdoftorques[idof] = 0;
+    }
+    const size_t numlinks = _vlinkbasetransforms.size();
+    if( numlinks == 0 ) {
+        return;
+    }
+    if( workspace.vlinktransforms.size() < numlinks ) {
+        workspace.vlinktransforms.resize(numlinks);
+        workspace.vlinearvelocities.resize(numlinks);
+        workspace.vangularvelocities.resize(numlinks);
+        workspace.vlinearaccelerations.resize(numlinks);
+        workspace.vangularaccelerations.resize(numlinks);
+        workspace.vcoms.resize(numlinks);
+        workspace.vforces.resize(numlinks);
+        workspace.vtorques.resize(numlinks);
+    }
+    if( workspace.vjointaxes.size() < _vjoints.size() ) {
+        workspace.vjointaxes.resize(_vjoints.size());
+        workspace.vjointanchors.resize(_vjoints.size());
+    }
+
+    // links that no joint moves keep their pose relative to the base. gravity is applied as an acceleration of the base, which propagates to all links
+    for(size_t ilink = 0; ilink < numlinks; ++ilink) {
+        workspace.vlinktransforms[ilink] = tbase * _vlinkbasetransforms[ilink];
+        workspace.vlinearvelocities[ilink] = Vector();
+        workspace.vangularvelocities[ilink] = Vector();
+        workspace.vlinearaccelerations[ilink] = -_vgravity;
+        workspace.vangularaccelerations[ilink] = Vector();
+    }
+
+    // forward recursion for the transforms, velocities, and accelerations of the link origins
+    for(size_t ijoint = 0; ijoint < _vjoints.size(); ++ijoint) {
+        const JointData& joint = _vjoints[ijoint];
+        const int parentindex = joint.parentindex >= 0 ? joint.parentindex : 0;
+        const int childindex = joint.childindex;
+        const Transform tleft = workspace.vlinktransforms[parentindex] * joint.tleft;
+        const Vector vaxis = tleft.rotate(joint.vaxis);
+        workspace.vjointaxes[ijoint] = vaxis*joint.faxissign;
+        workspace.vjointanchors[ijoint] = tleft.trans;
+
+        // motion of the child relative to the parent
+        Vector vrelvel, vrelangvel, vrelaccel, vrelangaccel;
+        Transform& tchild = workspace.vlinktransforms[childindex];
+        if( joint.bstatic ) {
+            tchild = tleft;
+        }
+        else {
+            const dReal fvalue = pdofvalues[joint.dofindex];
+            const dReal fvelocity = !!pdofvelocities ? pdofvelocities[joint.dofindex] : 0;
+            const dReal facceleration = !!pdofaccelerations ? pdofaccelerations[joint.dofindex] : 0;
+            Transform tjoint;
+            if( joint.brevolute ) {
+                tjoint.rot = quatFromAxisAngle(joint.vaxis, fvalue);
+                tchild = tleft * tjoint * joint.tright;
+                const Vector vdelta = tchild.trans - tleft.trans;
+                vrelangvel = vaxis*fvelocity;
+                vrelangaccel = vaxis*facceleration;
+                vrelvel = vrelangvel.cross(vdelta);
+                vrelaccel = vrelangaccel.cross(vdelta) + vrelangvel.cross(vrelvel);
+            }
+            else {
+                tjoint.trans = joint.vaxis*fvalue;
+                tchild = tleft * tjoint * joint.tright;
+                vrelvel = vaxis*fvelocity;
+                vrelaccel = vaxis*facceleration;
+            }
+        }
+
+        const Vector vdelta = tchild.trans - workspace.vlinktransforms[parentindex].trans;
+        const Vector vparentangvel = workspace.vangularvelocities[parentindex];
+        const Vector vparentangaccel = workspace.vangularaccelerations[parentindex];
+        workspace.vlinearvelocities[childindex] = workspace.vlinearvelocities[parentindex] + vparentangvel.cross(vdelta) + vrelvel;
+        workspace.vangularvelocities[childindex] = vparentangvel + vrelangvel;
+        workspace.vlinearaccelerations[childindex] = workspace.vlinearaccelerations[parentindex] + vparentangaccel.cross(vdelta) + vparentangvel.cross(vparentangvel.cross(vdelta)) + vparentangvel.cross(vrelvel)*2 + vrelaccel;
+        workspace.vangularaccelerations[childindex] = vparentangaccel + vparentangvel.cross(vrelangvel) + vrelangaccel;
+    }
+
+    // force and torque about the center of mass needed to move every link
+    for(size_t ilink = 0; ilink < numlinks; ++ilink) {
+        const dReal* pinertial = &_vlinkinertials[13*ilink];
+        const Transform& tlink = workspace.vlinktransforms[ilink];
+        const Vector& vangularvelocity = workspace.vangularvelocities[ilink];
+        const Vector vcom = tlink * Vector(pinertial[1], pinertial[2], pinertial[3]);
+        const Vector vcomfromlink = vcom - tlink.trans;
+        workspace.vcoms[ilink] = vcom;
+        workspace.vforces[ilink] = (workspace.vlinearaccelerations[ilink] + workspace.vangularaccelerations[ilink].cross(vcomfromlink) + vangularvelocity.cross(vangularvelocity.cross(vcomfromlink)))*pinertial[0];
+
+        // apply the inertia in the link coordinate system
+        const Vector qinv = quatInverse(tlink.rot);
+        const Vector w = quatRotate(qinv, vangularvelocity);
+        const Vector dw = quatRotate(qinv, workspace.vangularaccelerations[ilink]);
+        const dReal* I = pinertial + 4;
+        const Vector Iw(I[0]*w.x + I[1]*w.y + I[2]*w.z, I[3]*w.x + I[4]*w.y + I[5]*w.z, I[6]*w.x + I[7]*w.y + I[8]*w.z);
+        const Vector Idw(I[0]*dw.x + I[1]*dw.y + I[2]*dw.z, I[3]*dw.x + I[4]*dw.y + I[5]*dw.z, I[6]*dw.x + I[7]*dw.y + I[8]*dw.z);
+        workspace.vtorques[ilink] = quatRotate(tlink.rot, Idw + w.cross(Iw));
+    }
+    FOREACHC(itforcetorque, externalforcetorque) {
+        if( itforcetorque->first < 0 || itforcetorque->first >= (int)numlinks ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("external force/torque on link %d, but the model has %d links"), itforcetorque->first%numlinks, ORE_InvalidArguments);
+        }
+        workspace.vforces[itforcetorque->first] += itforcetorque->second.first;
+        workspace.vtorques[itforcetorque->first] += itforcetorque->second.second;
+    }
+
+    // backward recursion accumulating the children into the parents and projecting onto the joint axes
+    for(int ijoint = (int)_vjoints.size()-1; ijoint >= 0; --ijoint) {
+        const JointData& joint = _vjoints[ijoint];
+        const int childindex = joint.childindex;
+        const Vector& vcomforce = workspace.vforces[childindex];
+        const Vector& vjointtorque = workspace.vtorques[childindex];
+        if( joint.parentindex >= 0 ) {
+            workspace.vforces[joint.parentindex] += vcomforce;
+            workspace.vtorques[joint.parentindex] += vjointtorque + (workspace.vcoms[childindex] - workspace.vcoms[joint.parentindex]).cross(vcomforce);
+        }
+        if( joint.dofindex < 0 ) {
+            continue;
+        }
+
+        const Vector& vaxis = workspace.vjointaxes[ijoint];
+        dReal ftorque;
+        if( joint.brevolute ) {
+            ftorque = vaxis.dot3(vjointtorque + (workspace.vcoms[childindex] - workspace.vjointanchors[ijoint]).cross(vcomforce));
+        }
+        else {
+            // same convention as KinBody::ComputeInverseDynamics
+            ftorque = vaxis.dot3(vcomforce)/(2*PI);
+        }
+        if( !!pdofvelocities ) {
+            const dReal fvelocity = pdofvelocities[joint.dofindex];
+            if( fvelocity > g_fEpsilonLinear ) {
+                ftorque += joint.fcoulombfriction;
+            }
+            else if( fvelocity < -g_fEpsilonLinear ) {
+                ftorque -= joint.fcoulombfriction;
+            }
+            ftorque += fvelocity*joint.fviscousfriction;
+        }
+        if( !!pdofaccelerations ) {
+            ftorque += pdofaccelerations[joint.dofindex]*joint.frotorinertia;
+        }
+        pdoftorques[joint.dofindex] += ftorque;
+    }
+}
+
+void KinBody::InverseDynamicsModel::ComputeInverseDynamicsBatch(const Transform& tbase, size_t numsamples, const dReal* pdofvalues, const dReal* pdofvelocities, const dReal* pdofaccelerations, dReal* pdoftorques, Workspace& workspace) const
+{
+    for(size_t isample = 0; isample < numsamples; ++isample) {
+        const size_t offset = isample*_nDOF;
+        ComputeInverseDynamics(tbase, pdofvalues + offset, !!pdofvelocities ? pdofvelocities + offset : NULL, !!pdofaccelerations ? pdofaccelerations + offset : NULL, pdoftorques + offset, workspace);
+    }
+}
+
+} // end namespace OpenRAVE
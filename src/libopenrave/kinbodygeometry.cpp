@@ -1875,6 +1875,7 @@ KinBody::Geometry::Geometry(KinBody::LinkPtr parent, const KinBody::GeometryInfo
 
 bool KinBody::Geometry::InitCollisionMesh(float fTessellation)
 {
+    _InvalidateSerializationDigest();
     return _info.InitCollisionMesh(fTessellation);
 }
 
@@ -1915,11 +1916,26 @@ void KinBody::Geometry::serialize(std::ostream& o, int options) const
     }
 }
 
+uint64_t KinBody::Geometry::GetSerializationDigest() const
+{
+    if( _nSerializationDigest == 0 ) {
+        ostringstream ss;
+        ss << std::fixed << std::setprecision(SERIALIZATION_PRECISION);
+        serialize(ss, 0);
+        _nSerializationDigest = utils::GetFastHash(ss.str());
+        if( _nSerializationDigest == 0 ) {
+            _nSerializationDigest = 1; // 0 is reserved for invalid
+        }
+    }
+    return _nSerializationDigest;
+}
+
 void KinBody::Geometry::SetCollisionMesh(const TriMesh& mesh)
 {
     OPENRAVE_ASSERT_FORMAT0(_info._bModifiable, "geometry cannot be modified", ORE_Failed);
     LinkPtr parent(_parent);
     _info._meshcollision = mesh;
+    _InvalidateSerializationDigest();
     // _info._modifiedFields; change??
     parent->_Update();
 }
@@ -16,6 +16,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "libopenrave.h"
 #include <algorithm>
+#include <cctype>
 #include <boost/algorithm/string.hpp> // boost::trim
 #include <boost/lexical_cast.hpp>
 
@@ -2247,6 +2248,9 @@ void KinBody::Joint::SetMimicEquations(int iaxis, const std::string& poseq, cons
     if( ret >= 0 ) {
         throw OPENRAVE_EXCEPTION_FORMAT(_("failed to set equation '%s' on %s:%s, at %d. Error is %s\n"), poseq % parent->GetName() % GetName() % ret % pmimic->_posfn->ErrorMsg(), ORE_InvalidArguments);
     }
+    if( !pmimic->_poscompiled.Compile(eq, resultVars) ) {
+        RAVELOG_VERBOSE_FORMAT("mimic equation '%s' of %s:%s is not polynomial, evaluating with fparser", poseq % parent->GetName() % GetName());
+    }
 
     // process the depended joint variables
     for(const std::string& var : resultVars) {
@@ -2289,6 +2293,7 @@ void KinBody::Joint::SetMimicEquations(int iaxis, const std::string& poseq, cons
         }
 
         std::vector<OpenRAVEFunctionParserRealPtr> vfns(nVars);
+        std::vector<Mimic::CompiledEquation> vcompiled(nVars);
         /*
             extract from `eq` the partial derivative formulas ∂z/∂xi for joint z:=z(x1,x2,...xn) defined in `poseq`.
             `eq` takes form
@@ -2340,6 +2345,7 @@ void KinBody::Joint::SetMimicEquations(int iaxis, const std::string& poseq, cons
                 throw OPENRAVE_EXCEPTION_FORMAT(_("failed to set equation '%s' on %s:%s, at %d. Error is %s"), sequation%parent->GetName()%GetName()%ret%fn->ErrorMsg(),ORE_InvalidArguments);
             }
             vfns.at(itnameindex-resultVars.begin()) = fn;
+            vcompiled.at(itnameindex-resultVars.begin()).Compile(sequation, resultVars);
         }
         // check if anything is missing
         for(size_t j = 0; j < nVars; ++j) {
@@ -2348,14 +2354,17 @@ void KinBody::Joint::SetMimicEquations(int iaxis, const std::string& poseq, cons
                 RAVELOG_WARN(str(boost::format("SetMimicEquations: missing variable %s from partial derivatives of joint %s!")%mapinvnames[resultVars[j]]%_info._name));
                 vfns[j] = CreateJointFunctionParser();
                 vfns[j]->Parse("0","");
+                vcompiled[j].Compile("0", resultVars);
             }
         }
 
         if( itype == 1 ) {
             pmimic->_velfns.swap(vfns);
+            pmimic->_velcompiled.swap(vcompiled);
         }
         else {
             pmimic->_accelfns.swap(vfns);
+            pmimic->_accelcompiled.swap(vcompiled);
         }
     }
     _vmimic.at(iaxis) = pmimic;
@@ -2434,8 +2443,14 @@ void KinBody::Joint::_ComputePartialVelocities(std::vector<std::pair<int, dReal>
         const int jointIndex = dofformat.jointindex; ///< index of this depended joint
         dReal fvel = 0;
         if(ivar < nvelfns) {
-            const OpenRAVEFunctionParserRealPtr velfn = pmimic->_velfns.at(ivar); ///< function that evaluates the partial derivative ∂z/∂x
-            fvel = velfn->Eval(vDependedJointValues.empty() ? NULL : &vDependedJointValues[0]); ///< value of ∂z/∂x
+            const dReal* pDependedJointValues = vDependedJointValues.empty() ? NULL : &vDependedJointValues[0];
+            if( pmimic->_velcompiled.at(ivar).IsValid() ) {
+                fvel = pmimic->_velcompiled[ivar].Eval(pDependedJointValues); ///< value of ∂z/∂x
+            }
+            else {
+                const OpenRAVEFunctionParserRealPtr velfn = pmimic->_velfns.at(ivar); ///< function that evaluates the partial derivative ∂z/∂x
+                fvel = velfn->Eval(pDependedJointValues); ///< value of ∂z/∂x
+            }
         }
         else {
             RAVELOG_WARN_FORMAT("This mimic joint %s depends on joint %s, but the user did not provide the mimic velocity formula. Now treat the first-order partial derivative as 0", this->GetName() % dependedjoint->GetName());
@@ -2491,25 +2506,28 @@ void KinBody::Joint::_ComputePartialVelocities(std::vector<std::pair<int, dReal>
 
 int KinBody::Joint::_Eval(int axis, uint32_t timederiv, const std::vector<dReal>& vdependentvalues, std::vector<dReal>& voutput) const
 {
+    const Mimic& mimic = *_vmimic.at(axis);
+    const dReal* pdependentvalues = vdependentvalues.empty() ? NULL : &vdependentvalues[0];
     if( timederiv == 0 ) {
-        _vmimic.at(axis)->_posfn->EvalMulti(voutput, vdependentvalues.empty() ? NULL : &vdependentvalues[0]);
-        return _vmimic.at(axis)->_posfn->EvalError();
-    }
-    else if( timederiv == 1 ) {
-        voutput.resize(_vmimic.at(axis)->_velfns.size());
+        if( mimic._poscompiled.IsValid() ) {
+            voutput.resize(1);
+            voutput[0] = mimic._poscompiled.Eval(pdependentvalues);
+            return 0;
+        }
+        mimic._posfn->EvalMulti(voutput, pdependentvalues);
+        return mimic._posfn->EvalError();
+    }
+    else if( timederiv == 1 || timederiv == 2 ) {
+        const std::vector<OpenRAVEFunctionParserRealPtr>& vfns = timederiv == 1 ? mimic._velfns : mimic._accelfns;
+        const std::vector<Mimic::CompiledEquation>& vcompiled = timederiv == 1 ? mimic._velcompiled : mimic._accelcompiled;
+        voutput.resize(vfns.size());
         for(size_t i = 0; i < voutput.size(); ++i) {
-            voutput[i] = _vmimic.at(axis)->_velfns.at(i)->Eval(vdependentvalues.empty() ? NULL : &vdependentvalues[0]);
-            int err = _vmimic.at(axis)->_velfns.at(i)->EvalError();
-            if( err ) {
-                return err;
+            if( i < vcompiled.size() && vcompiled[i].IsValid() ) {
+                voutput[i] = vcompiled[i].Eval(pdependentvalues);
+                continue;
             }
-        }
-    }
-    else if( timederiv == 2 ) {
-        voutput.resize(_vmimic.at(axis)->_accelfns.size());
-        for(size_t i = 0; i < voutput.size(); ++i) {
-            voutput[i] = _vmimic.at(axis)->_accelfns.at(i)->Eval(vdependentvalues.empty() ? NULL : &vdependentvalues[0]);
-            int err = _vmimic.at(axis)->_accelfns.at(i)->EvalError();
+            voutput[i] = vfns.at(i)->Eval(pdependentvalues);
+            int err = vfns.at(i)->EvalError();
             if( err ) {
                 return err;
             }
@@ -2543,6 +2561,283 @@ KinBody::JointConstPtr KinBody::Joint::MIMIC::DOFFormat::GetJoint(const KinBody
     return jointindex < numjoints ? parent.GetJoints().at(jointindex) : parent.GetPassiveJoints().at(jointindex-numjoints);
 }
 
+/// \brief recursive descent parser that reduces an fparser expression to a polynomial of its variables.
+///
+/// A polynomial is stored as a map from the exponents of each variable to the coefficient of the term.
+/// Parsing fails as soon as a construct outside of polynomial arithmetic is encountered (functions, comparisons, division by variables, etc).
+class MimicPolynomialParser
+{
+public:
+    typedef std::map<std::vector<uint8_t>, dReal> Polynomial;
+
+    MimicPolynomialParser(const std::string& equation, const std::vector<std::string>& vvariables) : _equation(equation), _vvariables(vvariables), _pos(0) {
+    }
+
+    bool Parse(Polynomial& poly) {
+        if( !_ParseExpression(poly) ) {
+            return false;
+        }
+        _SkipSpaces();
+        return _pos == _equation.size();
+    }
+
+    /// \brief returns true if the term does not depend on any variable
+    static bool IsConstantTerm(const std::vector<uint8_t>& vexponents) {
+        for(size_t ivar = 0; ivar < vexponents.size(); ++ivar) {
+            if( vexponents[ivar] != 0 ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static const int s_maxdegree = 8; ///< maximum exponent of a variable, higher degrees are left to fparser
+
+    void _SkipSpaces() {
+        while( _pos < _equation.size() && std::isspace(static_cast<unsigned char>(_equation[_pos])) ) {
+            ++_pos;
+        }
+    }
+
+    bool _Consume(char c) {
+        _SkipSpaces();
+        if( _pos < _equation.size() && _equation[_pos] == c ) {
+            ++_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void _AddTerm(Polynomial& poly, const std::vector<uint8_t>& vexponents, dReal coeff) const {
+        Polynomial::iterator it = poly.find(vexponents);
+        if( it == poly.end() ) {
+            poly[vexponents] = coeff;
+        }
+        else {
+            it->second += coeff;
+        }
+    }
+
+    bool _Multiply(Polynomial& result, const Polynomial& a, const Polynomial& b) const {
+        result.clear();
+        std::vector<uint8_t> vexponents(_vvariables.size());
+        FOREACHC(ita, a) {
+            FOREACHC(itb, b) {
+                for(size_t ivar = 0; ivar < vexponents.size(); ++ivar) {
+                    int exponent = (int)ita->first[ivar] + (int)itb->first[ivar];
+                    if( exponent > s_maxdegree ) {
+                        return false;
+                    }
+                    vexponents[ivar] = exponent;
+                }
+                _AddTerm(result, vexponents, ita->second*itb->second);
+            }
+        }
+        return true;
+    }
+
+    /// \brief if poly is a constant, returns true and sets value
+    bool _GetConstant(const Polynomial& poly, dReal& value) const {
+        value = 0;
+        FOREACHC(it, poly) {
+            if( IsConstantTerm(it->first) ) {
+                value += it->second;
+            }
+            else if( it->second != 0 ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // expression := term (('+'|'-') term)*
+    bool _ParseExpression(Polynomial& poly) {
+        if( !_ParseTerm(poly) ) {
+            return false;
+        }
+        while(true) {
+            dReal fsign;
+            if( _Consume('+') ) {
+                fsign = 1;
+            }
+            else if( _Consume('-') ) {
+                fsign = -1;
+            }
+            else {
+                return true;
+            }
+            Polynomial other;
+            if( !_ParseTerm(other) ) {
+                return false;
+            }
+            FOREACHC(it, other) {
+                _AddTerm(poly, it->first, fsign*it->second);
+            }
+        }
+    }
+
+    // term := unary (('*'|'/') unary)*
+    bool _ParseTerm(Polynomial& poly) {
+        if( !_ParseUnary(poly) ) {
+            return false;
+        }
+        while(true) {
+            bool bdivide;
+            if( _Consume('*') ) {
+                bdivide = false;
+            }
+            else if( _Consume('/') ) {
+                bdivide = true;
+            }
+            else {
+                return true;
+            }
+            Polynomial other;
+            if( !_ParseUnary(other) ) {
+                return false;
+            }
+            if( bdivide ) {
+                dReal fdenom = 0;
+                if( !_GetConstant(other, fdenom) || fdenom == 0 ) {
+                    return false;
+                }
+                FOREACH(it, poly) {
+                    it->second /= fdenom;
+                }
+            }
+            else {
+                Polynomial result;
+                if( !_Multiply(result, poly, other) ) {
+                    return false;
+                }
+                poly.swap(result);
+            }
+        }
+    }
+
+    // unary := '-' unary | power
+    bool _ParseUnary(Polynomial& poly) {
+        if( _Consume('-') ) {
+            if( !_ParseUnary(poly) ) {
+                return false;
+            }
+            FOREACH(it, poly) {
+                it->second = -it->second;
+            }
+            return true;
+        }
+        return _ParsePower(poly);
+    }
+
+    // power := primary ('^' unary)?, right associative like fparser
+    bool _ParsePower(Polynomial& poly) {
+        if( !_ParsePrimary(poly) ) {
+            return false;
+        }
+        if( !_Consume('^') ) {
+            return true;
+        }
+        Polynomial exponentpoly;
+        dReal fexponent = 0;
+        if( !_ParseUnary(exponentpoly) || !_GetConstant(exponentpoly, fexponent) ) {
+            return false;
+        }
+        if( fexponent < 0 || fexponent > s_maxdegree || fexponent != std::floor(fexponent) ) {
+            return false;
+        }
+        Polynomial result;
+        result[std::vector<uint8_t>(_vvariables.size(), 0)] = 1;
+        for(int iexp = 0; iexp < (int)fexponent; ++iexp) {
+            Polynomial temp;
+            if( !_Multiply(temp, result, poly) ) {
+                return false;
+            }
+            result.swap(temp);
+        }
+        poly.swap(result);
+        return true;
+    }
+
+    // primary := number | variable | '(' expression ')'
+    bool _ParsePrimary(Polynomial& poly) {
+        poly.clear();
+        if( _Consume('(') ) {
+            return _ParseExpression(poly) && _Consume(')');
+        }
+        _SkipSpaces();
+        if( _pos >= _equation.size() ) {
+            return false;
+        }
+        const char c = _equation[_pos];
+        if( std::isdigit(static_cast<unsigned char>(c)) || c == '.' ) {
+            const char* pstart = _equation.c_str() + _pos;
+            char* pend = NULL;
+            const double fvalue = std::strtod(pstart, &pend);
+            if( pend == pstart ) {
+                return false;
+            }
+            _pos += pend - pstart;
+            poly[std::vector<uint8_t>(_vvariables.size(), 0)] = fvalue;
+            return true;
+        }
+        if( std::isalpha(static_cast<unsigned char>(c)) || c == '_' ) {
+            const size_t startpos = _pos;
+            while( _pos < _equation.size() && (std::isalnum(static_cast<unsigned char>(_equation[_pos])) || _equation[_pos] == '_') ) {
+                ++_pos;
+            }
+            std::vector<std::string>::const_iterator itvar = std::find(_vvariables.begin(), _vvariables.end(), _equation.substr(startpos, _pos-startpos));
+            if( itvar == _vvariables.end() ) {
+                return false; // function or unknown constant
+            }
+            std::vector<uint8_t> vexponents(_vvariables.size(), 0);
+            vexponents.at(itvar - _vvariables.begin()) = 1;
+            poly[vexponents] = 1;
+            return true;
+        }
+        return false;
+    }
+
+    const std::string& _equation;
+    const std::vector<std::string>& _vvariables;
+    size_t _pos;
+};
+
+bool KinBody::Mimic::CompiledEquation::Compile(const std::string& equation, const std::vector<std::string>& vvariables)
+{
+    Reset();
+    MimicPolynomialParser::Polynomial poly;
+    MimicPolynomialParser parser(equation, vvariables);
+    if( !parser.Parse(poly) ) {
+        return false;
+    }
+
+    const int nvariables = vvariables.size();
+    _vcoeffs.reserve(poly.size());
+    _vexponents.reserve(poly.size()*nvariables);
+    FOREACHC(it, poly) {
+        if( it->second == 0 ) {
+            continue;
+        }
+        if( MimicPolynomialParser::IsConstantTerm(it->first) ) {
+            _fconstant += it->second;
+            continue;
+        }
+        _vcoeffs.push_back(it->second);
+        _vexponents.insert(_vexponents.end(), it->first.begin(), it->first.end());
+    }
+    _nvariables = nvariables;
+    return true;
+}
+
+void KinBody::Mimic::CompiledEquation::Reset()
+{
+    _fconstant = 0;
+    _vcoeffs.clear();
+    _vexponents.clear();
+    _nvariables = -1;
+}
+
 void KinBody::Joint::SetFloatParameters(const std::string& key, const std::vector<dReal>& parameters)
 {
     if( parameters.size() > 0 ) {
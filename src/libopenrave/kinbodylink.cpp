@@ -686,6 +686,28 @@ void KinBody::Link::serialize(std::ostream& o, int options) const
     }
 }
 
+uint64_t KinBody::Link::ComputeSerializationDigest(int options) const
+{
+    ostringstream ss;
+    ss << std::fixed << std::setprecision(SERIALIZATION_PRECISION);
+    ss << _index << " ";
+    if( options & SO_Geometry ) {
+        ss << _vGeometries.size() << " ";
+    }
+    if( options & SO_Dynamics ) {
+        SerializeRound(ss,_info._tMassFrame);
+        SerializeRound(ss,_info._mass);
+        SerializeRound3(ss,_info._vinertiamoments);
+    }
+    uint64_t digest = utils::GetFastHash(ss.str());
+    if( options & SO_Geometry ) {
+        FOREACHC(it,_vGeometries) {
+            digest = utils::CombineFastHash(digest, (*it)->GetSerializationDigest());
+        }
+    }
+    return digest;
+}
+
 void KinBody::Link::SetStatic(bool bStatic)
 {
     if( _info._bStatic != bStatic ) {
@@ -360,6 +360,7 @@ class RaveGlobal : private boost::noncopyable, public boost::enable_shared_from_
         _nDebugLevel = Level_Info;
         _nGlobalEnvironmentId = 0;
         _nDataAccessOptions = 0;
+        _nThreadPoolNumThreads = 0;
 #ifdef USE_CRLIBM
         _bcrlibmInit = false;
 #endif
@@ -500,6 +501,14 @@ public:
         }
 
         // don't use any log statements since global instance might be null
+        // stop the thread pool first, its workers hold clones of the environments and might still be running tasks on them
+        ThreadPoolPtr pthreadpool;
+        {
+            std::lock_guard<std::mutex> lock(_mutexinternal);
+            pthreadpool.swap(_pthreadpool);
+        }
+        pthreadpool.reset();
+
         // environments have to be destroyed carefully since their destructors can be called, which will attempt to unregister the environment
         std::map<int, EnvironmentBase*> mapenvironments;
         {
@@ -800,6 +809,40 @@ protected:
         return _pdefaultsampler;
     }
 
+    ThreadPoolPtr GetThreadPool()
+    {
+        std::lock_guard<std::mutex> lock(_mutexinternal);
+        if( !_pthreadpool ) {
+            int numthreads = _nThreadPoolNumThreads;
+            if( numthreads <= 0 ) {
+                const char* pnumthreads = getenv("OPENRAVE_NUM_THREADS"); // getenv not thread-safe?
+                if( pnumthreads != NULL ) {
+                    numthreads = atoi(pnumthreads);
+                }
+            }
+            _pthreadpool.reset(new ThreadPool(numthreads));
+        }
+        return _pthreadpool;
+    }
+
+    void SetThreadPoolNumThreads(int numthreads)
+    {
+        if( ThreadPool::IsWorkerThread() ) {
+            // releasing the pool could join the calling thread itself
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("cannot change the number of threads of the thread pool from one of its workers"), ORE_InvalidState);
+        }
+        ThreadPoolPtr pthreadpool;
+        {
+            std::lock_guard<std::mutex> lock(_mutexinternal);
+            _nThreadPoolNumThreads = numthreads;
+            if( !!_pthreadpool && _pthreadpool->GetNumThreads() == numthreads ) {
+                return;
+            }
+            // the next call to GetThreadPool creates the pool with the new size
+            pthreadpool.swap(_pthreadpool);
+        }
+    }
+
     std::string FindLocalFile(const std::string& _filename, const std::string& curdir)
     {
 #ifndef HAVE_BOOST_FILESYSTEM
@@ -1106,6 +1149,8 @@ private:
     std::vector<std::string> _vdbdirectories;
     int _nGlobalEnvironmentId;
     SpaceSamplerBasePtr _pdefaultsampler;
+    ThreadPoolPtr _pthreadpool; ///< created on first use
+    int _nThreadPoolNumThreads; ///< number of threads of _pthreadpool, if <= 0 uses OPENRAVE_NUM_THREADS or the number of hardware threads
 #ifdef USE_CRLIBM
     long long _crlibm_fpu_state;
     bool _bcrlibmInit; ///< true if crlibm is initialized
@@ -1243,6 +1288,16 @@ void RaveGetEnvironments(std::list<EnvironmentBasePtr>& listenvironments)
     RaveGlobal::instance()->GetEnvironments(listenvironments);
 }
 
+ThreadPoolPtr RaveGetThreadPool()
+{
+    return RaveGlobal::instance()->GetThreadPool();
+}
+
+void RaveSetThreadPoolNumThreads(int numthreads)
+{
+    RaveGlobal::instance()->SetThreadPoolNumThreads(numthreads);
+}
+
 void RaveGetPluginInfo(std::list< std::pair<std::string, PLUGININFO> >& plugins)
 {
     RaveGlobal::instance()->GetDatabase()->GetPluginInfo(plugins);
@@ -18,10 +18,83 @@
 
 #include <openrave/openravemsgpack.h>
 
+size_t OpenRAVE::MsgPack::GetTypedArrayElementSize(char typecode)
+{
+    switch(typecode) {
+    case 'd': return sizeof(double);
+    case 'f': return sizeof(float);
+    case 'q': return sizeof(int64_t);
+    case 'i': return sizeof(int32_t);
+    default: return 0;
+    }
+}
+
+bool OpenRAVE::MsgPack::GetTypedArrayView(const rapidjson::Value& value, TypedArrayView& view)
+{
+    // objects with other members are regular objects that happen to use the same keys, converting them would drop the other members
+    if( !value.IsObject() || value.MemberCount() != 2 ) {
+        return false;
+    }
+    rapidjson::Value::ConstMemberIterator ittype = value.FindMember("__typedarray__");
+    if( ittype == value.MemberEnd() || !ittype->value.IsString() || ittype->value.GetStringLength() != 1 ) {
+        return false;
+    }
+    rapidjson::Value::ConstMemberIterator itdata = value.FindMember("data");
+    if( itdata == value.MemberEnd() || !itdata->value.IsString() ) {
+        return false;
+    }
+    char typecode = ittype->value.GetString()[0];
+    size_t elementsize = GetTypedArrayElementSize(typecode);
+    if( elementsize == 0 || itdata->value.GetStringLength() % elementsize != 0 ) {
+        return false;
+    }
+    view = TypedArrayView(itdata->value.GetString(), itdata->value.GetStringLength()/elementsize, typecode);
+    return true;
+}
+
+void OpenRAVE::MsgPack::LoadNumberArray(const rapidjson::Value& value, std::vector<double>& values)
+{
+    TypedArrayView view;
+    if( GetTypedArrayView(value, view) ) {
+        view.CopyTo(values);
+        return;
+    }
+    if( !value.IsArray() ) {
+        throw OPENRAVE_EXCEPTION_FORMAT0(_("value is not an array of numbers"), ORE_InvalidArguments);
+    }
+    values.resize(value.Size());
+    for(rapidjson::SizeType i = 0; i < value.Size(); ++i) {
+        if( !value[i].IsNumber() ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("element %d of the array is not a number"), i, ORE_InvalidArguments);
+        }
+        values[i] = value[i].GetDouble();
+    }
+}
+
+void OpenRAVE::MsgPack::SetTypedArray(rapidjson::Value& value, const std::vector<double>& values, rapidjson::Document::AllocatorType& allocator)
+{
+    value.SetObject();
+    value.AddMember("__typedarray__", rapidjson::Value("d", 1, allocator), allocator);
+    value.AddMember("data", rapidjson::Value(values.size() > 0 ? (const char*)&values[0] : "", values.size()*sizeof(double), allocator), allocator);
+}
+
 #if OPENRAVE_MSGPACK
 #include <msgpack.hpp>
 #include <rapidjson/document.h>
 
+namespace {
+
+/// true while ParseMsgPack converts a buffer whose typed arrays are referenced instead of copied
+thread_local bool s_bReferenceTypedArrays = false;
+
+/// makes msgpack keep pointers to the buffer for the extensions instead of copying them to its zone
+bool _ReferenceExtensions(msgpack::type::object_type type, std::size_t length, void* userdata)
+{
+    return type == msgpack::type::EXT;
+}
+
+} // end namespace
+
 namespace msgpack {
 
 MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
@@ -99,6 +172,25 @@ struct convert< rapidjson::GenericDocument<Encoding, Allocator, StackAllocator>
                     formatted[++size] = '\0';
 
                     v.SetString(formatted, size, v.GetAllocator());
+                } else if (o.via.ext.type() == OpenRAVE::MsgPack::MSGPACK_EXT_TYPEDARRAY) {
+                    const char* pdata = o.via.ext.data();
+                    const size_t elementsize = o.via.ext.size > 0 ? OpenRAVE::MsgPack::GetTypedArrayElementSize(pdata[0]) : 0;
+                    if (elementsize == 0 || (o.via.ext.size-1) % elementsize != 0) {
+                        RAVELOG_WARN("Invalid msgpack typed array.");
+                        v.SetNull();
+                        break;
+                    }
+                    v.SetObject();
+                    v.AddMember("__typedarray__", rapidjson::GenericValue<Encoding, Allocator>(pdata, 1, v.GetAllocator()), v.GetAllocator());
+                    rapidjson::GenericValue<Encoding, Allocator> data;
+                    if (s_bReferenceTypedArrays) {
+                        // zero copy, the value points to the buffer being parsed
+                        data.SetString(rapidjson::StringRef(pdata+1, o.via.ext.size-1));
+                    }
+                    else {
+                        data.SetString(pdata+1, o.via.ext.size-1, v.GetAllocator());
+                    }
+                    v.AddMember("data", data, v.GetAllocator());
                 } else {
                     RAVELOG_WARN("Unrecognized msgpack extension type.");
                 }
@@ -136,6 +228,15 @@ struct pack< rapidjson::GenericValue<Encoding, Allocator> > {
                 return o.pack_true();
             case rapidjson::kObjectType:
             {
+                OpenRAVE::MsgPack::TypedArrayView view;
+                if (OpenRAVE::MsgPack::GetTypedArrayView(v, view)) {
+                    const char typecode = view.GetTypeCode();
+                    const size_t numbytes = view.size()*OpenRAVE::MsgPack::GetTypedArrayElementSize(typecode);
+                    o.pack_ext(numbytes+1, OpenRAVE::MsgPack::MSGPACK_EXT_TYPEDARRAY);
+                    o.pack_ext_body(&typecode, 1);
+                    o.pack_ext_body(view.GetData(), numbytes);
+                    return o;
+                }
                 o.pack_map(v.MemberCount());
                 typename rapidjson::GenericValue<Encoding, Allocator>::ConstMemberIterator i = v.MemberBegin(), END = v.MemberEnd();
                 for (; i != END; ++i)
@@ -345,6 +446,25 @@ void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const void* data, s
     unpacked.get().convert(d);
 }
 
+void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const void* data, size_t size, bool bReferenceTypedArrays)
+{
+    if( !bReferenceTypedArrays ) {
+        ParseMsgPack(d, data, size);
+        return;
+    }
+    msgpack::unpacked unpacked;
+    msgpack::unpack(unpacked, (const char*) data, size, _ReferenceExtensions);
+    s_bReferenceTypedArrays = true;
+    try {
+        unpacked.get().convert(d);
+    }
+    catch(...) {
+        s_bReferenceTypedArrays = false;
+        throw;
+    }
+    s_bReferenceTypedArrays = false;
+}
+
 void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, std::istream& is)
 {
     std::string str;
@@ -381,4 +501,9 @@ void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, std::istream& is)
     throw OPENRAVE_EXCEPTION_FORMAT0("MsgPack support is not enabled", ORE_NotImplemented);
 }
 
+void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const void* data, size_t size, bool bReferenceTypedArrays)
+{
+    throw OPENRAVE_EXCEPTION_FORMAT0("MsgPack support is not enabled", ORE_NotImplemented);
+}
+
 #endif
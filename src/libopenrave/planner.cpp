@@ -1127,7 +1127,7 @@ void PlannerParameters::Validate() const
     }
 }
 
-PlannerBase::PlannerProgress::PlannerProgress() : _iteration(0)
+PlannerBase::PlannerProgress::PlannerProgress() : _iteration(0), _fSolutionCost(-1)
 {
 }
 
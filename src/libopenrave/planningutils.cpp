@@ -25,6 +25,8 @@
 
 #include <boost/bind/bind.hpp>
 
+#include <random>
+
 using namespace boost::placeholders;
 
 namespace OpenRAVE {
@@ -2274,6 +2276,178 @@ void GetDHParameters(std::vector<DHParameter>& vparameters, KinBodyConstPtr pbod
     }
 }
 
+/// \brief counts the collisions of the link pairs over numsamples random configurations of the body in its own environment clone
+static void _CountLinkPairCollisions(EnvironmentBasePtr penvclone, const std::string& bodyname, const std::vector<int>& vlinkpairs, int numsamples, uint32_t seed, std::vector<int>& vcollisioncounts)
+{
+    EnvironmentLock lockenv(penvclone->GetMutex());
+    KinBodyPtr pbody = penvclone->GetKinBody(bodyname);
+    if( !pbody ) {
+        throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, cloned environment does not have body %s"), penvclone->GetNameId()%bodyname, ORE_InvalidState);
+    }
+    CollisionCheckerBasePtr pchecker = !!pbody->GetSelfCollisionChecker() ? pbody->GetSelfCollisionChecker() : penvclone->GetCollisionChecker();
+    CollisionOptionsStateSaver colsaver(pchecker, CO_IgnoreCallbacks);
+    pbody->Enable(true);
+
+    std::vector<dReal> vlower, vupper, vvalues(pbody->GetDOF());
+    pbody->GetDOFLimits(vlower, vupper);
+    // the geometry of a revolute axis repeats every 2*PI, so only circular axes and axes with a wider range are sampled over one period. all other axes keep their real limits
+    FOREACHC(itjoint, pbody->GetJoints()) {
+        for(int iaxis = 0; iaxis < (*itjoint)->GetDOF(); ++iaxis) {
+            const int idof = (*itjoint)->GetDOFIndex()+iaxis;
+            if( (*itjoint)->IsCircular(iaxis) ) {
+                vlower[idof] = -PI;
+                vupper[idof] = PI;
+            }
+            else if( (*itjoint)->IsRevolute(iaxis) && vupper[idof] - vlower[idof] > 2*PI ) {
+                vlower[idof] = max(vlower[idof], min(dReal(-PI), vupper[idof] - 2*PI));
+                vupper[idof] = vlower[idof] + 2*PI;
+            }
+        }
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<dReal> sampler(0, 1);
+    const std::vector<KinBody::LinkPtr>& vlinks = pbody->GetLinks();
+    vcollisioncounts.resize(0);
+    vcollisioncounts.resize(vlinkpairs.size(), 0);
+    for(int isample = 0; isample < numsamples; ++isample) {
+        for(size_t idof = 0; idof < vvalues.size(); ++idof) {
+            vvalues[idof] = vlower[idof] + sampler(rng)*(vupper[idof] - vlower[idof]);
+        }
+        pbody->SetDOFValues(vvalues, KinBody::CLA_Nothing);
+        for(size_t ipair = 0; ipair < vlinkpairs.size(); ++ipair) {
+            if( pchecker->CheckCollision(KinBody::LinkConstPtr(vlinks.at(vlinkpairs[ipair]&0xffff)), KinBody::LinkConstPtr(vlinks.at(vlinkpairs[ipair]>>16))) ) {
+                vcollisioncounts[ipair]++;
+            }
+        }
+    }
+}
+
+void ComputeLinkPairCollisionClasses(KinBodyConstPtr pbody, std::vector< std::pair<int, LinkPairCollisionClass> >& vpairclasses, int numsamples, int numthreads)
+{
+    if( numsamples <= 0 ) {
+        throw OPENRAVE_EXCEPTION_FORMAT(_("numsamples %d has to be positive"), numsamples, ORE_InvalidArguments);
+    }
+    if( numthreads <= 0 ) {
+        numthreads = max(1, RaveGetThreadPool()->GetNumThreads());
+    }
+    numthreads = min(numthreads, numsamples);
+
+    EnvironmentBasePtr penv = pbody->GetEnv();
+    std::vector<int> vlinkpairs;
+    std::vector<EnvironmentBasePtr> vclones;
+    std::string bodyname;
+    {
+        EnvironmentLock lockenv(penv->GetMutex());
+        bodyname = pbody->GetName();
+        const int numlinks = pbody->GetLinks().size();
+        for(int ind0 = 0; ind0 < numlinks; ++ind0) {
+            for(int ind1 = ind0+1; ind1 < numlinks; ++ind1) {
+                if( !pbody->AreAdjacentLinks(ind0, ind1) ) {
+                    vlinkpairs.push_back(ind0|(ind1<<16));
+                }
+            }
+        }
+        for(int ithread = 0; ithread < numthreads; ++ithread) {
+            vclones.push_back(penv->CloneSelf(Clone_Bodies));
+        }
+    }
+
+    // the samples are split into numthreads fixed shares with their own seeds, so the result does not depend on how the thread pool schedules them
+    std::vector< std::vector<int> > vvcollisioncounts(numthreads);
+    try {
+        RaveGetThreadPool()->ParallelFor(numthreads, [&](size_t ishare) {
+            const int numsharesamples = numsamples/numthreads + ((int)ishare < numsamples%numthreads ? 1 : 0);
+            _CountLinkPairCollisions(vclones[ishare], bodyname, vlinkpairs, numsharesamples, 0x5eed + (uint32_t)ishare, vvcollisioncounts[ishare]);
+        });
+    }
+    catch(...) {
+        FOREACH(itclone, vclones) {
+            (*itclone)->Destroy();
+        }
+        throw;
+    }
+    FOREACH(itclone, vclones) {
+        (*itclone)->Destroy();
+    }
+
+    vpairclasses.resize(vlinkpairs.size());
+    int numnever = 0, numalways = 0;
+    for(size_t ipair = 0; ipair < vlinkpairs.size(); ++ipair) {
+        int numcollisions = 0;
+        FOREACHC(itcounts, vvcollisioncounts) {
+            numcollisions += itcounts->at(ipair);
+        }
+        LinkPairCollisionClass pairclass = LPCC_Sometimes;
+        if( numcollisions == 0 ) {
+            pairclass = LPCC_Never;
+            numnever++;
+        }
+        else if( numcollisions == numsamples ) {
+            pairclass = LPCC_Always;
+            numalways++;
+        }
+        vpairclasses[ipair] = std::make_pair(vlinkpairs[ipair], pairclass);
+    }
+    RAVELOG_DEBUG_FORMAT("env=%s, body %s: %d non-adjacent link pairs over %d samples, %d never collide, %d always collide", penv->GetNameId()%bodyname%vlinkpairs.size()%numsamples%numnever%numalways);
+}
+
+int SetDisabledCollisionLinkPairsFromSampling(KinBodyPtr pbody, int numsamples, int numthreads, bool busedatabase)
+{
+    std::string filename;
+    {
+        EnvironmentLock lockenv(pbody->GetEnv()->GetMutex());
+        filename = str(boost::format("linkpaircollisions.%s.%s.txt")%(pbody->IsRobot() ? "robot" : "kinbody")%pbody->GetKinematicsGeometryHash());
+    }
+
+    std::vector< std::pair<int, LinkPairCollisionClass> > vpairclasses;
+    bool bloaded = false;
+    if( busedatabase ) {
+        std::string fullfilename = RaveFindDatabaseFile(filename, true);
+        if( fullfilename.size() > 0 ) {
+            std::ifstream f(fullfilename.c_str());
+            std::string tag;
+            int numstoredsamples = 0;
+            f >> tag >> numstoredsamples;
+            if( !!f && tag == "numsamples" && numstoredsamples >= numsamples ) {
+                int index0, index1, pairclass;
+                while( f >> index0 >> index1 >> pairclass ) {
+                    vpairclasses.push_back(std::make_pair(index0|(index1<<16), (LinkPairCollisionClass)pairclass));
+                }
+                bloaded = true;
+                RAVELOG_DEBUG_FORMAT("env=%s, loaded %d link pair classes of body %s from %s", pbody->GetEnv()->GetNameId()%vpairclasses.size()%pbody->GetName()%fullfilename);
+            }
+        }
+    }
+
+    if( !bloaded ) {
+        ComputeLinkPairCollisionClasses(pbody, vpairclasses, numsamples, numthreads);
+        if( busedatabase ) {
+            std::string fullfilename = RaveFindDatabaseFile(filename, false);
+            std::ofstream f(fullfilename.c_str());
+            if( !!f ) {
+                f << "numsamples " << numsamples << std::endl;
+                FOREACHC(itpair, vpairclasses) {
+                    f << (itpair->first&0xffff) << " " << (itpair->first>>16) << " " << (int)itpair->second << std::endl;
+                }
+            }
+            else {
+                RAVELOG_WARN_FORMAT("env=%s, failed to write link pair classes of body %s to %s", pbody->GetEnv()->GetNameId()%pbody->GetName()%fullfilename);
+            }
+        }
+    }
+
+    std::vector<std::pair<int, int> > vdisabledpairs;
+    FOREACHC(itpair, vpairclasses) {
+        if( itpair->second != LPCC_Sometimes ) {
+            vdisabledpairs.push_back(std::make_pair(itpair->first&0xffff, itpair->first>>16));
+        }
+    }
+    EnvironmentLock lockenv(pbody->GetEnv()->GetMutex());
+    pbody->SetDisabledCollisionLinkPairs(vdisabledpairs);
+    return vdisabledpairs.size();
+}
+
 DynamicsCollisionConstraint::DynamicsCollisionConstraint(PlannerBase::PlannerParametersConstPtr parameters, const std::list<KinBodyPtr>& listCheckBodies, int filtermask) : _listCheckBodies(listCheckBodies), _filtermask(filtermask), _torquelimitmode(DC_NominalTorque), _perturbation(0.1)
 {
     BOOST_ASSERT(listCheckBodies.size()>0);
@@ -2288,6 +2462,7 @@ DynamicsCollisionConstraint::DynamicsCollisionConstraint(PlannerBase::PlannerPar
 void DynamicsCollisionConstraint::SetPlannerParameters(PlannerBase::PlannerParametersConstPtr parameters)
 {
     _parameters = parameters;
+    _mapinversedynamicsmodels.clear(); // the bodies might have changed since the last planning query
     if( !!parameters ) {
         _specvel = parameters->_configurationspecification.ConvertToVelocitySpecification();
         _setvelstatefn = _specvel.GetSetFn(_listCheckBodies.front()->GetEnv());
@@ -2489,7 +2664,25 @@ int DynamicsCollisionConstraint::_CheckState(const std::vector<dReal>& vdofveloc
                     _specvel.ExtractJointValues(_dofaccelerations.begin(), vdofaccels.begin(), pbody, _vdofindices, 1);
 
                     // compute inverse dynamics and check
-                    pbody->ComputeInverseDynamics(_doftorques, _dofaccelerations);
+                    std::map<KinBodyPtr, KinBody::InverseDynamicsModelPtr>::iterator itmodel = _mapinversedynamicsmodels.find(pbody);
+                    if( itmodel == _mapinversedynamicsmodels.end() ) {
+                        KinBody::InverseDynamicsModelPtr pmodel(new KinBody::InverseDynamicsModel());
+                        try {
+                            pbody->ExtractInverseDynamicsModel(*pmodel);
+                        }
+                        catch(const openrave_exception& ex) {
+                            RAVELOG_DEBUG_FORMAT("env=%s, cannot use inverse dynamics model for body %s, falling back to ComputeInverseDynamics: %s", pbody->GetEnv()->GetNameId()%pbody->GetName()%ex.what());
+                            pmodel.reset();
+                        }
+                        itmodel = _mapinversedynamicsmodels.insert(std::make_pair(pbody, pmodel)).first;
+                    }
+                    if( !!itmodel->second ) {
+                        // the model does not use the body state, so pass the values that were set
+                        itmodel->second->ComputeInverseDynamics(pbody->GetLinks().at(0)->GetTransform(), &_vfulldofvalues[0], &_vfulldofvelocities[0], &_dofaccelerations[0], &_doftorques[0], _inversedynamicsworkspace);
+                    }
+                    else {
+                        pbody->ComputeInverseDynamics(_doftorques, _dofaccelerations);
+                    }
                     FOREACH(it, _vtorquevalues) {
                         int index = it->first;
                         const std::pair<dReal, dReal>& torquelimits = it->second;
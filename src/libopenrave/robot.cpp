@@ -2506,6 +2506,8 @@ void RobotBase::Clone(InterfaceBaseConstPtr preference, int cloningoptions)
     KinBody::Clone(preference,cloningoptions);
     RobotBaseConstPtr r = RaveInterfaceConstCast<RobotBase>(preference);
     __hashrobotstructure = r->__hashrobotstructure;
+    __hashrobotstructurelast = r->__hashrobotstructurelast;
+    __nRobotStructureDigest = r->__nRobotStructureDigest;
     _vecManipulators.clear();
     _pManipActive.reset();
     FOREACHC(itmanip, r->_vecManipulators) {
@@ -2595,10 +2597,26 @@ const std::string& RobotBase::GetRobotStructureHash() const
 {
     CHECK_INTERNAL_COMPUTATION;
     if( __hashrobotstructure.size() == 0 ) {
+        // manipulators and sensors are cheap to serialize, the body digest avoids serializing all the meshes again if only they changed
         ostringstream ss;
         ss << std::fixed << std::setprecision(SERIALIZATION_PRECISION);
-        serialize(ss,SO_Kinematics|SO_Geometry|SO_RobotManipulators|SO_RobotSensors);
-        __hashrobotstructure = utils::GetMD5HashString(ss.str());
+        FOREACHC(itmanip,_vecManipulators) {
+            (*itmanip)->serialize(ss,SO_Kinematics|SO_Geometry|SO_RobotManipulators|SO_RobotSensors);
+        }
+        FOREACHC(itsensor,_vecAttachedSensors) {
+            (*itsensor)->serialize(ss,SO_Kinematics|SO_Geometry|SO_RobotManipulators|SO_RobotSensors);
+        }
+        const uint64_t digest = utils::CombineFastHash(GetKinematicsGeometryDigest(), utils::GetFastHash(ss.str()));
+        if( __hashrobotstructurelast.size() > 0 && __nRobotStructureDigest == digest ) {
+            __hashrobotstructure = __hashrobotstructurelast;
+        }
+        else {
+            ss.str("");
+            serialize(ss,SO_Kinematics|SO_Geometry|SO_RobotManipulators|SO_RobotSensors);
+            __hashrobotstructure = utils::GetMD5HashString(ss.str());
+            __hashrobotstructurelast = __hashrobotstructure;
+            __nRobotStructureDigest = digest;
+        }
     }
     return __hashrobotstructure;
 }
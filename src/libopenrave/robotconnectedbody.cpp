@@ -1152,7 +1152,7 @@ bool RobotBase::SetConnectedBodyActiveStates(const std::vector<int8_t>& activest
         bChanged |= _vecConnectedBodies[iconnectedbody]->SetActive(activestates[iconnectedbody]);
     }
     if (bChanged) {
-        __hashKinematicsGeometryDynamics.resize(0);
+        __nKinematicsGeometryDynamicsDigest = 0;
     }
     return bChanged;
 }
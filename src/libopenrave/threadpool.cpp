@@ -0,0 +1,447 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "libopenrave.h"
+
+#include <deque>
+#include <thread>
+
+namespace OpenRAVE {
+
+struct ThreadPool::Worker
+{
+    Worker() : index(0) {
+    }
+
+    /// \brief the clone of one source environment
+    struct CloneData
+    {
+        EnvironmentBaseWeakPtr wsource; ///< the source, to detect that the environment id was reused
+        EnvironmentBasePtr pclone;
+    };
+
+    int index;
+    std::thread thread;
+    std::mutex mutex; ///< protects tasks
+    std::deque<ThreadPoolTaskPtr> tasks; ///< the worker pops from the back, thieves from the front
+    std::map<std::pair<int, int>, CloneData> mapclones; ///< (source environment id, cloning options) -> clone, only accessed by the worker thread
+};
+
+/// the pool and the index of the worker the calling thread belongs to, null and -1 for threads outside of any pool
+static thread_local ThreadPool* s_pcurrentpool = NULL;
+static thread_local int s_currentworkerindex = -1;
+/// the task running on the calling thread, tasks run nested in Wait have their own scope
+static thread_local ThreadPoolTask* s_pcurrenttask = NULL;
+
+ThreadPoolTask::ThreadPoolTask(const boost::function<void()>& fn) : _fn(fn), _state(TS_Pending), _bCancelRequested(false)
+{
+}
+
+ThreadPoolTask::~ThreadPoolTask()
+{
+}
+
+void ThreadPoolTask::Cancel()
+{
+    _bCancelRequested = true;
+    int state = TS_Pending;
+    if( _state.compare_exchange_strong(state, TS_Running) ) {
+        // won against the workers, the task stays in its queue and is dropped when popped
+        _SetDone(TS_Cancelled);
+    }
+}
+
+bool ThreadPoolTask::Wait()
+{
+    if( !IsDone() && !!s_pcurrentpool ) {
+        // a worker waiting idle could starve the pool when tasks wait on their subtasks, so help with the pending tasks instead
+        while( !IsDone() ) {
+            ThreadPoolTaskPtr pothertask = s_pcurrentpool->_PopTask(s_pcurrentpool->_GetCurrentWorker());
+            if( !pothertask ) {
+                break;
+            }
+            s_pcurrentpool->_RunTask(pothertask);
+        }
+    }
+
+    if( !IsDone() ) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this]() {
+            return IsDone();
+        });
+    }
+
+    if( GetState() == TS_Failed ) {
+        std::rethrow_exception(_exception);
+    }
+    return GetState() == TS_Finished;
+}
+
+void ThreadPoolTask::_SetDone(TaskState state, std::exception_ptr exception)
+{
+    _exception = exception;
+    {
+        // state has to change under the mutex, otherwise a waiter could check it right before and miss the notification
+        std::lock_guard<std::mutex> lock(_mutex);
+        _state = state;
+    }
+    _condition.notify_all();
+    _fn.clear(); // release whatever the functor holds as soon as possible
+}
+
+ThreadPool::ThreadPool(int numthreads) : _numpending(0), _bShutdown(false), _numsubmitted(0), _numfinished(0), _numfailed(0), _numcancelled(0), _numstolen(0), _numclonescreated(0), _numclonessynchronized(0)
+{
+    if( numthreads <= 0 ) {
+        numthreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    _vworkers.resize(numthreads);
+    for(int iworker = 0; iworker < numthreads; ++iworker) {
+        _vworkers[iworker].reset(new Worker());
+        _vworkers[iworker]->index = iworker;
+    }
+    // start the threads after all the workers exist since they steal from each other
+    FOREACH(itworker, _vworkers) {
+        (*itworker)->thread = std::thread(&ThreadPool::_WorkerThread, this, itworker->get());
+    }
+    RAVELOG_DEBUG_FORMAT("started thread pool with %d threads", numthreads);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bShutdown = true;
+    }
+    _condition.notify_all();
+    CancelAll();
+    FOREACH(itworker, _vworkers) {
+        if( (*itworker)->thread.joinable() ) {
+            (*itworker)->thread.join();
+        }
+    }
+    // tasks submitted by the running tasks before they returned
+    CancelAll();
+}
+
+ThreadPoolTaskPtr ThreadPool::Submit(const boost::function<void()>& fn)
+{
+    ThreadPoolTaskPtr ptask(new ThreadPoolTask(fn));
+    _Enqueue(ptask);
+    return ptask;
+}
+
+ThreadPoolTaskPtr ThreadPool::SubmitWithEnvironment(EnvironmentBasePtr penv, int cloningoptions, const boost::function<void(EnvironmentBasePtr)>& fn, bool bSynchronize)
+{
+    OPENRAVE_ASSERT_FORMAT0(!!penv, "need a source environment", ORE_InvalidArguments);
+    // the task holds the source weakly so that queued tasks do not keep a destroyed environment alive
+    EnvironmentBaseWeakPtr wenv(penv);
+    return Submit([this, wenv, cloningoptions, fn, bSynchronize]() {
+        EnvironmentBasePtr penv = wenv.lock();
+        if( !penv ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0("source environment of the task was destroyed", ORE_InvalidState);
+        }
+        Worker* pworker = _GetCurrentWorker();
+        if( !pworker ) {
+            // run by a thread outside of the pool, it owns no clones so use a temporary one
+            EnvironmentBasePtr pclone = penv->CloneSelf(cloningoptions);
+            ++_numclonescreated;
+            try {
+                fn(pclone);
+            }
+            catch(...) {
+                pclone->Destroy();
+                throw;
+            }
+            pclone->Destroy();
+            return;
+        }
+        fn(_GetWorkerClone(pworker, penv, cloningoptions, bSynchronize));
+    });
+}
+
+void ThreadPool::ParallelFor(size_t num, const boost::function<void(size_t)>& fn, size_t grainsize)
+{
+    grainsize = std::max(grainsize, (size_t)1);
+    size_t numtasks = std::min((size_t)GetNumThreads(), (num + grainsize - 1)/grainsize);
+    if( num <= grainsize || numtasks <= 1 ) {
+        for(size_t index = 0; index < num; ++index) {
+            fn(index);
+        }
+        return;
+    }
+
+    // every task takes the next index, so uneven costs balance out without splitting into chunks up front
+    std::atomic<size_t> nextindex(0);
+    const auto fnloop = [&]() {
+        try {
+            for(size_t index = nextindex++; index < num; index = nextindex++) {
+                fn(index);
+            }
+        }
+        catch(...) {
+            nextindex = num;
+            throw;
+        }
+    };
+
+    // the calling thread is one of the tasks
+    std::vector<ThreadPoolTaskPtr> vtasks;
+    vtasks.reserve(numtasks-1);
+    for(size_t itask = 1; itask < numtasks; ++itask) {
+        vtasks.push_back(Submit(fnloop));
+    }
+    std::exception_ptr exception;
+    try {
+        fnloop();
+    }
+    catch(...) {
+        exception = std::current_exception();
+    }
+    // every index is taken once the calling thread gets here, so the tasks that did not start yet have nothing to do. drop them rather than waiting
+    // for a worker to pick them up, the workers could be blocked on a lock the caller holds
+    FOREACH(ittask, vtasks) {
+        int state = ThreadPoolTask::TS_Pending;
+        if( (*ittask)->_state.compare_exchange_strong(state, ThreadPoolTask::TS_Running) ) {
+            (*ittask)->_SetDone(ThreadPoolTask::TS_Cancelled);
+        }
+    }
+    // wait for the started ones even on failure since they reference the locals
+    FOREACH(ittask, vtasks) {
+        try {
+            (*ittask)->Wait();
+        }
+        catch(...) {
+            if( !exception ) {
+                exception = std::current_exception();
+            }
+        }
+    }
+    if( !!exception ) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::CancelAll()
+{
+    std::deque<ThreadPoolTaskPtr> vtasks;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        vtasks.swap(_queuetasks);
+    }
+    FOREACH(itworker, _vworkers) {
+        std::lock_guard<std::mutex> lock((*itworker)->mutex);
+        vtasks.insert(vtasks.end(), (*itworker)->tasks.begin(), (*itworker)->tasks.end());
+        (*itworker)->tasks.clear();
+    }
+    _numpending -= vtasks.size();
+    FOREACH(ittask, vtasks) {
+        (*ittask)->Cancel();
+        ++_numcancelled;
+    }
+}
+
+ThreadPoolStatistics ThreadPool::GetStatistics() const
+{
+    ThreadPoolStatistics stats;
+    stats.numthreads = GetNumThreads();
+    stats.numsubmitted = _numsubmitted;
+    stats.numfinished = _numfinished;
+    stats.numfailed = _numfailed;
+    stats.numcancelled = _numcancelled;
+    stats.numstolen = _numstolen;
+    stats.numpending = _numpending;
+    stats.numclonescreated = _numclonescreated;
+    stats.numclonessynchronized = _numclonessynchronized;
+    return stats;
+}
+
+bool ThreadPool::IsCancelRequested()
+{
+    return !!s_pcurrenttask && s_pcurrenttask->IsCancelRequested();
+}
+
+bool ThreadPool::IsWorkerThread()
+{
+    return !!s_pcurrentpool;
+}
+
+void ThreadPool::_Enqueue(const ThreadPoolTaskPtr& ptask)
+{
+    ++_numsubmitted;
+    Worker* pworker = _GetCurrentWorker();
+    if( !!pworker ) {
+        {
+            // count before pushing so that _numpending never drops below zero when the task is stolen right away
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_numpending;
+        }
+        // subtasks stay on the worker that spawned them, they share its caches
+        std::lock_guard<std::mutex> lock(pworker->mutex);
+        pworker->tasks.push_back(ptask);
+    }
+    else {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if( _bShutdown ) {
+            ptask->Cancel();
+            ++_numcancelled;
+            return;
+        }
+        _queuetasks.push_back(ptask);
+        ++_numpending;
+    }
+    _condition.notify_one();
+}
+
+ThreadPoolTaskPtr ThreadPool::_PopTask(Worker* pworker)
+{
+    ThreadPoolTaskPtr ptask;
+    if( !!pworker ) {
+        std::lock_guard<std::mutex> lock(pworker->mutex);
+        if( pworker->tasks.size() > 0 ) {
+            ptask = pworker->tasks.back();
+            pworker->tasks.pop_back();
+        }
+    }
+    if( !ptask ) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if( _queuetasks.size() > 0 ) {
+            ptask = _queuetasks.front();
+            _queuetasks.pop_front();
+        }
+    }
+    if( !ptask ) {
+        // start stealing at a different worker for every thief so they do not all contend on the first queue
+        int startindex = !!pworker ? pworker->index + 1 : 0;
+        for(size_t ivictim = 0; ivictim < _vworkers.size() && !ptask; ++ivictim) {
+            Worker* pvictim = _vworkers[(startindex + ivictim) % _vworkers.size()].get();
+            if( pvictim == pworker ) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(pvictim->mutex);
+            if( pvictim->tasks.size() > 0 ) {
+                ptask = pvictim->tasks.front();
+                pvictim->tasks.pop_front();
+                ++_numstolen;
+            }
+        }
+    }
+    if( !!ptask ) {
+        --_numpending;
+    }
+    return ptask;
+}
+
+void ThreadPool::_RunTask(const ThreadPoolTaskPtr& ptask)
+{
+    int state = ThreadPoolTask::TS_Pending;
+    if( !ptask->_state.compare_exchange_strong(state, ThreadPoolTask::TS_Running) ) {
+        // cancelled while queued
+        ++_numcancelled;
+        return;
+    }
+
+    ThreadPoolTask* pprevtask = s_pcurrenttask;
+    s_pcurrenttask = ptask.get();
+    try {
+        ptask->_fn();
+        s_pcurrenttask = pprevtask;
+        ++_numfinished;
+        ptask->_SetDone(ThreadPoolTask::TS_Finished);
+    }
+    catch(...) {
+        s_pcurrenttask = pprevtask;
+        ++_numfailed;
+        ptask->_SetDone(ThreadPoolTask::TS_Failed, std::current_exception());
+    }
+}
+
+void ThreadPool::_WorkerThread(Worker* pworker)
+{
+    s_pcurrentpool = this;
+    s_currentworkerindex = pworker->index;
+    while(true) {
+        ThreadPoolTaskPtr ptask = _PopTask(pworker);
+        if( !!ptask ) {
+            _RunTask(ptask);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this]() {
+            return _bShutdown || _numpending > 0;
+        });
+        if( _bShutdown ) {
+            break;
+        }
+    }
+
+    // the clones belong to this thread, destroy them here rather than in whichever thread releases the pool
+    FOREACH(itclone, pworker->mapclones) {
+        if( !!itclone->second.pclone ) {
+            itclone->second.pclone->Destroy();
+        }
+    }
+    pworker->mapclones.clear();
+    s_currentworkerindex = -1;
+    s_pcurrentpool = NULL;
+}
+
+ThreadPool::Worker* ThreadPool::_GetCurrentWorker() const
+{
+    if( s_pcurrentpool != this || s_currentworkerindex < 0 ) {
+        return NULL;
+    }
+    return _vworkers.at(s_currentworkerindex).get();
+}
+
+EnvironmentBasePtr ThreadPool::_GetWorkerClone(Worker* pworker, EnvironmentBasePtr penv, int cloningoptions, bool bSynchronize)
+{
+    OPENRAVE_ASSERT_FORMAT0(!!pworker, "only workers own clones", ORE_InvalidState);
+    Worker::CloneData& clonedata = pworker->mapclones[std::make_pair(penv->GetId(), cloningoptions)];
+    if( !!clonedata.pclone && clonedata.wsource.lock() != penv ) {
+        // the id belonged to an environment that was destroyed since
+        clonedata.pclone->Destroy();
+        clonedata.pclone.reset();
+    }
+    if( !clonedata.pclone ) {
+        // CloneSelf locks the source itself
+        clonedata.pclone = penv->CloneSelf(cloningoptions);
+        clonedata.wsource = penv;
+        ++_numclonescreated;
+    }
+    else if( bSynchronize ) {
+        EnvironmentLock lockenv(penv->GetMutex());
+        clonedata.pclone->Clone(penv, cloningoptions);
+        ++_numclonessynchronized;
+    }
+
+    // drop the clones of destroyed environments
+    std::map<std::pair<int, int>, Worker::CloneData>::iterator itclone = pworker->mapclones.begin();
+    while( itclone != pworker->mapclones.end() ) {
+        if( itclone->second.wsource.expired() ) {
+            if( !!itclone->second.pclone ) {
+                itclone->second.pclone->Destroy();
+            }
+            pworker->mapclones.erase(itclone++);
+        }
+        else {
+            ++itclone;
+        }
+    }
+    return clonedata.pclone;
+}
+
+}
@@ -66,6 +66,21 @@ std::string GetMD5HashString(const std::vector<uint8_t>&v)
     return hex_output;
 }
 
+uint64_t GetFastHash(const std::string& s, uint64_t seed)
+{
+    return GetFastHash(reinterpret_cast<const uint8_t*>(s.c_str()), s.size(), seed);
+}
+
+uint64_t GetFastHash(const uint8_t* pdata, size_t size, uint64_t seed)
+{
+    uint64_t hash = seed;
+    for(size_t i = 0; i < size; ++i) {
+        hash ^= pdata[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
 bool PairStringLengthCompare(const std::pair<std::string, std::string>&p0, const std::pair<std::string, std::string>&p1)
 {
     return p0.first.size() > p1.first.size();
@@ -281,6 +281,118 @@ class test_fcl(RunCollision):
     def __init__(self):
         RunCollision.__init__(self, 'fcl_')
 
+    def test_tieredgeometrygroup(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot = env.GetRobots()[0]
+        checker = env.GetCollisionChecker()
+        with env:
+            for body in env.GetBodies():
+                checker.SendCommand('GenerateLODGeometryGroups %s lod_'%body.GetName())
+                for link in body.GetLinks():
+                    assert(link.GetGroupNumGeometries('lod_hull') == len(link.GetGeometries()))
+            lower,upper = robot.GetDOFLimits()
+            for i in range(20):
+                robot.SetDOFValues(random.rand()*(upper-lower)+lower)
+                checker.SendCommand('SetTieredGeometryGroup')
+                expected = env.CheckCollision(robot)
+                # the hull contains the geometries, so the tiered checking has to give the same result
+                checker.SendCommand('SetTieredGeometryGroup lod_hull')
+                assert(env.CheckCollision(robot) == expected)
+            checker.SendCommand('SetTieredGeometryGroup')
+
+    def test_linkspheretrees(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot = env.GetRobots()[0]
+        checker = env.GetCollisionChecker()
+        with env:
+            lower,upper = robot.GetDOFLimits()
+            for i in range(20):
+                robot.SetDOFValues(random.rand()*(upper-lower)+lower)
+                checker.SendCommand('SetLinkSphereTrees 0')
+                expected = env.CheckCollision(robot)
+                # the spheres contain the geometries, so the screening has to give the same result
+                checker.SendCommand('SetLinkSphereTrees 8')
+                assert(env.CheckCollision(robot) == expected)
+            checker.SendCommand('SetLinkSphereTrees 0')
+
+    def test_meshsharing(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot = env.GetRobots()[0]
+        checker = env.GetCollisionChecker()
+        with env:
+            lower,upper = robot.GetDOFLimits()
+            vvalues = [random.rand()*(upper-lower)+lower for i in range(20)]
+            expected = []
+            for values in vvalues:
+                robot.SetDOFValues(values)
+                expected.append(env.CheckCollision(robot))
+            numbytes, nummeshes = [int(x) for x in checker.SendCommand('GetMeshMemoryUsage').split()]
+            self.log.info('mesh memory without sharing: %d bytes in %d models',numbytes,nummeshes)
+
+            checker.SendCommand('SetMeshSharing 1')
+            report = CollisionReport()
+            for i,values in enumerate(vvalues):
+                robot.SetDOFValues(values)
+                assert(env.CheckCollision(robot,report=report) == expected[i])
+                if expected[i]:
+                    # shared meshes still have to report the geometries
+                    assert(report.plink1 is not None and report.plink2 is not None)
+            sharedbytes, sharednummeshes = [int(x) for x in checker.SendCommand('GetMeshMemoryUsage').split()]
+            self.log.info('mesh memory with sharing: %d bytes in %d models',sharedbytes,sharednummeshes)
+            assert(sharedbytes <= numbytes and sharednummeshes <= nummeshes)
+
+        # the clone reuses the models of the original
+        env2 = env.CloneSelf(CloningOptions.Bodies)
+        try:
+            with env2:
+                checker2 = env2.GetCollisionChecker()
+                robot2 = env2.GetRobot(robot.GetName())
+                for i,values in enumerate(vvalues):
+                    robot2.SetDOFValues(values)
+                    assert(env2.CheckCollision(robot2) == expected[i])
+                assert(checker2.SendCommand('GetMeshMemoryUsage').split() == [str(sharedbytes),str(sharednummeshes)])
+        finally:
+            env2.Destroy()
+
+    def test_manygeometries(self):
+        env=self.env
+        with env:
+            # enough geometries that tessellation and the fcl geometries are built on several threads
+            infos = []
+            for i in range(300):
+                info = KinBody.Link.GeometryInfo()
+                info._type = [KinBody.Link.GeomType.Sphere, KinBody.Link.GeomType.Cylinder, KinBody.Link.GeomType.Capsule][i%3]
+                info._vGeomData = [0.02,0.04,0]
+                info._t[0:3,3] = [0.1*(i%20),0.1*(i//20),0]
+                infos.append(info)
+            starttime=time.time()
+            body = RaveCreateKinBody(env,'')
+            body.InitFromGeometries(infos)
+            body.SetName('manygeometries')
+            env.Add(body,True)
+            self.log.info('initializing and adding %d geometries took %fs',len(infos),time.time()-starttime)
+
+            geometries = body.GetLinks()[0].GetGeometries()
+            assert(len(geometries)==len(infos))
+            for i,geom in enumerate(geometries):
+                # has to match tessellating the geometry by itself
+                single = RaveCreateKinBody(env,'')
+                single.InitFromGeometries([infos[i]])
+                assert(len(geom.GetCollisionMesh().indices)==len(single.GetLinks()[0].GetGeometries()[0].GetCollisionMesh().indices))
+                assert(len(geom.GetCollisionMesh().indices)>0)
+
+            box = RaveCreateKinBody(env,'')
+            box.InitFromBoxes(array([[0,0,0,0.01,0.01,0.01]]),True)
+            box.SetName('probe')
+            env.Add(box,True)
+            box.SetTransform(matrixFromPose([1,0,0,0,0.5,0.5,0]))
+            assert(env.CheckCollision(box,body))
+            box.SetTransform(matrixFromPose([1,0,0,0,0.55,0.55,0]))
+            assert(not env.CheckCollision(box,body))
+
 # class test_bullet(RunCollision):
 #     def __init__(self):
 #         RunCollision.__init__(self, 'bullet')
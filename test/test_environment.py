@@ -14,6 +14,7 @@
 from common_test_openrave import *
 from subprocess import Popen, PIPE
 import shutil
+import tempfile
 import threading
 
 class TestEnvironment(EnvironmentSetup):
@@ -245,6 +246,65 @@ class TestEnvironment(EnvironmentSetup):
             os.chdir(oldcwd)
     
 
+    def test_scenefile(self):
+        env=self.env
+        tempdir = tempfile.mkdtemp()
+        try:
+            sourcefilename = os.path.join(tempdir,'box0.dae')
+            shutil.copyfile('testdata/box0.dae',sourcefilename)
+            scenefilename = os.path.join(tempdir,'box0.orscene')
+            assert(env.Load(sourcefilename))
+            body = env.GetBodies()[0]
+            aabb = body.ComputeAABB()
+            ntriangles = len(env.Triangulate(body).indices)
+            env.Save(scenefilename,Environment.SelectionOptions.Everything,{'source':sourcefilename})
+
+            env.Reset()
+            assert(env.Load(scenefilename))
+            assert(len(env.GetBodies())==1)
+            body2 = env.GetBodies()[0]
+            assert(body2.GetName()==body.GetName())
+            assert(transdist(body2.ComputeAABB().pos(),aabb.pos()) <= g_epsilon)
+            assert(transdist(body2.ComputeAABB().extents(),aabb.extents()) <= g_epsilon)
+            assert(len(env.Triangulate(body2).indices)==ntriangles)
+
+            # touching the source has to recompile the scene on the next load
+            compiled = open(scenefilename,'rb').read()
+            with open(sourcefilename,'a') as f:
+                f.write('\n')
+            env.Reset()
+            assert(env.Load(scenefilename))
+            assert(len(env.GetBodies())==1)
+            assert(open(scenefilename,'rb').read()!=compiled)
+
+            # a corrupted scene is rebuilt from the source passed by the caller
+            with open(scenefilename,'wb') as f:
+                f.write(b'garbage')
+            env.Reset()
+            assert(env.Load(scenefilename,{'source':sourcefilename}))
+            assert(len(env.GetBodies())==1)
+            assert(open(scenefilename,'rb').read()[:7]==b'ORSCENE')
+        finally:
+            shutil.rmtree(tempdir)
+
+        # load times of a bundled robot, compiled scene against collada
+        tempdir = tempfile.mkdtemp()
+        try:
+            scenefilename = os.path.join(tempdir,'pr2.orscene')
+            env.Reset()
+            starttime=time.time()
+            self.LoadEnv('robots/pr2-beta-static.zae')
+            colladatime=time.time()-starttime
+            env.Save(scenefilename,Environment.SelectionOptions.Everything,{'source':'robots/pr2-beta-static.zae'})
+            env.Reset()
+            starttime=time.time()
+            assert(env.Load(scenefilename))
+            scenetime=time.time()-starttime
+            self.log.info('pr2-beta-static load time: collada %fs, compiled scene %fs',colladatime,scenetime)
+            assert(len(env.GetRobots())==1)
+        finally:
+            shutil.rmtree(tempdir)
+
     def test_trylock(self):
         env=self.env
         log=self.log
@@ -262,3 +322,130 @@ class TestEnvironment(EnvironmentSetup):
         # thread is done, so should be able to lock
         assert(env.Lock(1.0))
         env.Unlock()
+
+    def test_statejournal(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        journal = RaveCreateModule(env,'StateJournal')
+        filename = 'statejournal_test.bin'
+        try:
+            assert(journal.SendCommand('Start 100 keyframeperiod 0.05 timing manual filename %s\n'%filename) is not None)
+            lower,upper = robot.GetDOFLimits()
+            nframes = 20
+            allvalues = []
+            starttime = time.time()
+            for iframe in range(nframes):
+                with env:
+                    values = lower+(upper-lower)*iframe/float(nframes)
+                    robot.SetDOFValues(values)
+                    allvalues.append(robot.GetDOFValues())
+                    journal.SendCommand('Capture %d'%(iframe*10000))
+            elapsedtime = time.time()-starttime
+            numframes,numkeyframes,numbytes,capturetime = [int(s) for s in journal.SendCommand('GetStatistics').split()]
+            journal.SendCommand('Stop')
+            self.log.info('state journal: %d frames, %d keyframes, %d bytes, capture %dus, %fs total',numframes,numkeyframes,numbytes,capturetime,elapsedtime)
+            assert(numframes == nframes)
+            assert(numbytes == os.path.getsize(filename))
+
+            replay = RaveCreateModule(env,'StateJournal')
+            assert(replay.SendCommand('Open %s'%filename) is not None)
+            starttime,endtime = [int(s) for s in replay.SendCommand('GetTimeRange').split()]
+            assert(starttime == 0 and endtime == (nframes-1)*10000)
+            with env:
+                robot.SetDOFValues(lower)
+                for iframe in [5,3,19,0,12]:
+                    replay.SendCommand('Seek %d'%(iframe*10000+5000))
+                    assert(transdist(robot.GetDOFValues(),allvalues[iframe]) <= g_epsilon)
+        finally:
+            if os.path.exists(filename):
+                os.remove(filename)
+
+    def test_textserverload(self):
+        self.log.info('latency of the epoll text server with pipelined requests from several loopback clients')
+        import socket, struct
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        robotindex = robot.GetEnvironmentBodyIndex()
+        numactivedof = robot.GetActiveDOF()
+
+        s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        s.bind(('127.0.0.1',0))
+        port = s.getsockname()[1]
+        s.close()
+        server = RaveCreateModule(env,'textserver')
+        assert(env.AddModule(server,'%d epoll numworkers 4 maxpending 8 maxqueued 32 clone 1'%port)==0)
+
+        def connect():
+            sock = socket.create_connection(('127.0.0.1',port))
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            return sock
+
+        def recvall(sock, size):
+            data = b''
+            while len(data) < size:
+                chunk = sock.recv(size-len(data))
+                assert(len(chunk) > 0)
+                data += chunk
+            return data
+
+        def recvresponse(sock):
+            size = struct.unpack('=i',recvall(sock,4))[0]
+            return recvall(sock,size).decode('utf-8')
+
+        try:
+            # a modification is seen by the following read-only request running on the clone of the connection
+            sock = connect()
+            sock.sendall(('robot_setdof %d 1 0.5 0\nrobot_getdofvalues %d 0\n'%(robotindex,robotindex)).encode('utf-8'))
+            assert(abs(float(recvresponse(sock).split()[0])-0.5) <= g_epsilon)
+            # so is a modification made outside of the server
+            with env:
+                values = robot.GetDOFValues()
+                values[0] = 0.25
+                robot.SetDOFValues(values)
+            sock.sendall(('robot_getdofvalues %d 0\n'%robotindex).encode('utf-8'))
+            assert(abs(float(recvresponse(sock).split()[0])-0.25) <= g_epsilon)
+            # and so are the commands scheduled on the worker thread of the server, e.g. a trajectory executed by a simulation step
+            with env:
+                startvalues = robot.GetActiveDOFValues()
+                lower,upper = robot.GetActiveDOFLimits()
+                goalvalues = minimum(startvalues+0.1,upper)
+            points = ' '.join('%.15e'%value for value in r_[startvalues,goalvalues])
+            sock.sendall(('robot_traj %d 2 0 0 %s\nenv_stepsimulation 100 0\nrobot_getdofvalues %d\n'%(robotindex,points,robotindex)).encode('utf-8'))
+            assert(transdist(array([float(value) for value in recvresponse(sock).split()]),goalvalues) <= g_epsilon)
+            sock.close()
+
+            numclients = 8
+            numbatches = 20
+            pipelinedepth = 16 # more than maxpending, so the server has to apply backpressure
+            request = ('robot_getdofvalues %d\n'%robotindex)*pipelinedepth
+            latencies = [[] for iclient in range(numclients)]
+            errors = []
+            def client(iclient):
+                try:
+                    sock = connect()
+                    for ibatch in range(numbatches):
+                        starttime = time.time()
+                        sock.sendall(request.encode('utf-8'))
+                        for irequest in range(pipelinedepth):
+                            response = recvresponse(sock)
+                            assert(len(response.split())==numactivedof)
+                            latencies[iclient].append(time.time()-starttime)
+                    sock.close()
+                except Exception as e:
+                    errors.append(e)
+
+            starttime = time.time()
+            threads = [threading.Thread(target=client,args=(iclient,)) for iclient in range(numclients)]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+            elapsedtime = time.time()-starttime
+            assert(len(errors)==0)
+            alllatencies = sorted(sum(latencies,[]))
+            assert(len(alllatencies)==numclients*numbatches*pipelinedepth)
+            self.log.info('%d requests in %fs, latency p50=%fms p99=%fms', len(alllatencies), elapsedtime, 1000*alllatencies[len(alllatencies)//2], 1000*alllatencies[(99*len(alllatencies))//100])
+        finally:
+            env.Remove(server)
@@ -528,6 +528,36 @@ class TestKinematics(EnvironmentSetup):
                         assert( transdist(-torquegravity, gravitypartials) < 0.1*deltastep*len(gravitypartials))
                         assert( transdist(torquegravity, testtorque_e-testtorque_e2) <= 1e-10 )
 
+    def test_inversedynamicsmodel(self):
+        self.log.info('compare the torques of the inverse dynamics model with ComputeInverseDynamics, with and without external wrenches')
+        env=self.env
+        with env:
+            for envfile in ['robots/wam7.kinbody.xml', 'robots/wam4.kinbody.xml', 'robots/puma.robot.xml']:
+                env.Reset()
+                self.LoadEnv(envfile)
+                body = [body for body in env.GetBodies() if body.GetDOF() > 0][0]
+                lower,upper = body.GetDOFLimits()
+                vellimits = body.GetDOFVelocityLimits()
+                for istate in range(10):
+                    env.GetPhysicsEngine().SetGravity(random.rand(3)*10-5)
+                    dofvalues = randlimits(lower,upper)
+                    dofvelocities = randlimits(-vellimits,vellimits)
+                    dofaccelerations = 10*random.rand(body.GetDOF())-5
+                    # the model assumes a static base link
+                    body.SetDOFValues(dofvalues)
+                    body.SetDOFVelocities(dofvelocities,[0,0,0],[0,0,0],checklimits=False)
+                    externalforcetorque = dict([(link.GetIndex(), 20*random.rand(6)-10) for link in body.GetLinks()[::2]])
+                    for forcetorque in [None, externalforcetorque]:
+                        torques = body.ComputeInverseDynamics(dofaccelerations,forcetorque)
+                        modeltorques = body.ComputeInverseDynamicsWithModel(dofvalues,dofvelocities,dofaccelerations,forcetorque)
+                        assert(transdist(torques,modeltorques) <= g_epsilon*len(torques))
+                        torques = body.ComputeInverseDynamics(None,forcetorque)
+                        modeltorques = body.ComputeInverseDynamicsWithModel(dofvalues,dofvelocities,None,forcetorque)
+                        assert(transdist(torques,modeltorques) <= g_epsilon*len(torques))
+                    # the model only reads the given state, not the one of the body
+                    body.SetDOFValues(randlimits(lower,upper))
+                    assert(transdist(modeltorques,body.ComputeInverseDynamicsWithModel(dofvalues,dofvelocities,None,externalforcetorque)) <= g_epsilon*len(modeltorques))
+
     def test_hessian(self):
         self.log.info('check the jacobian and hessian computation')
         env=self.env
@@ -690,6 +720,25 @@ class TestKinematics(EnvironmentSetup):
             
             body.SetLinkEnableStates(body.GetLinkEnableStates())
 
+    def test_incrementalfk(self):
+        env=self.env
+        self.LoadEnv('robots/pr2-beta-static.zae')
+        with env:
+            robot=env.GetRobots()[0]
+            robot.SetActiveDOFs(robot.GetManipulator('leftarm').GetArmIndices())
+            lower,upper = robot.GetActiveDOFLimits()
+            for i in range(20):
+                robot.SetActiveDOFValues(lower+random.rand(len(lower))*(upper-lower))
+                Tlinks = robot.GetLinkTransformations()
+                incollision = robot.CheckSelfCollision()
+                # SetTransform invalidates the link transforms, so the next SetDOFValues recomputes all links
+                values = robot.GetDOFValues()
+                robot.SetTransform(robot.GetTransform())
+                robot.SetDOFValues(values)
+                for T, Tfull in zip(Tlinks, robot.GetLinkTransformations()):
+                    assert(transdist(T,Tfull) <= g_epsilon)
+                assert(robot.CheckSelfCollision() == incollision)
+
     def test_geometrychange(self):
         self.log.info('change geometry and test if changes are updated')
         env=self.env
@@ -897,6 +946,24 @@ class TestKinematics(EnvironmentSetup):
             assert(not env.CheckCollision(robot) and not env.CheckCollision(link))
             robot.GetLinks()[0].Enable(True)
             assert(env.CheckCollision(link) and env.CheckCollision(robot))
+
+    def test_disabledcollisionlinkpairs(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        with env:
+            robot=env.GetRobots()[0]
+            nonadjacentlinks = robot.GetNonAdjacentLinks(KinBody.AdjacentOptions.Enabled)
+            disabledpairs = nonadjacentlinks[:len(nonadjacentlinks)//2]
+            robot.SetDisabledCollisionLinkPairs([(index1,index0) for index0,index1 in disabledpairs])
+            assert(sorted(robot.GetDisabledCollisionLinkPairs()) == sorted(disabledpairs))
+            assert(sorted(robot.GetNonAdjacentLinks(KinBody.AdjacentOptions.Enabled)) == sorted(nonadjacentlinks[len(nonadjacentlinks)//2:]))
+            robot.SetDisabledCollisionLinkPairs([])
+            assert(sorted(robot.GetNonAdjacentLinks(KinBody.AdjacentOptions.Enabled)) == sorted(nonadjacentlinks))
+
+        numdisabled = planningutils.SetDisabledCollisionLinkPairsFromSampling(robot, numsamples=200, numthreads=2, usedatabase=False)
+        with env:
+            assert(len(robot.GetDisabledCollisionLinkPairs()) == numdisabled)
+            assert(len(robot.GetNonAdjacentLinks(KinBody.AdjacentOptions.Enabled)) <= len(nonadjacentlinks))
             
     def test_inertia(self):
         env=self.env
@@ -613,6 +613,133 @@ class RunPlanning(EnvironmentSetup):
             self.RunTrajectory(robot,traj1)
             self.RunTrajectory(robot,traj2)
 
+    def _LoadLab1ArmQuery(self):
+        """loads lab1 and moves the arm to the start of the arm planning query shared by the planner benchmarks.
+
+        :return: (robot, sol, goals) where sol is the start configuration and goals are the collision free ik solutions of the goal pose
+        """
+        env = self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot = env.GetRobots()[0]
+        with env:
+            manip = robot.GetActiveManipulator()
+            robot.SetActiveDOFs(manip.GetArmIndices())
+            ikmodel = databases.inversekinematics.InverseKinematicsModel(robot, iktype=IkParameterization.Type.Transform6D)
+            if not ikmodel.load():
+                ikmodel.autogenerate()
+
+            startpose = array([  4.75570553e-01,  -3.09601285e-16,   8.79677582e-01, -5.55111505e-17,   2.80273561e-01,   1.40000001e-01, 8.88603999e-01])
+            sol = manip.FindIKSolution(startpose, IkFilterOptions.CheckEnvCollisions)
+            robot.SetActiveDOFValues(sol)
+            goalpose = array([ 0.42565319, -0.30998409,  0.60514354, -0.59710177,  0.06460554, 0.386792  ,  1.22894527])
+            goals = manip.FindIKSolutions(matrixFromPose(goalpose), IkFilterOptions.CheckEnvCollisions)
+            assert(len(goals) > 0)
+        return robot, sol, goals
+
+    def _TimePlanSeeds(self, planner, robot, sol, goals, seeds, maxiterations, extraparameters='', postprocessing=True, fnplanned=None):
+        """plans the query of _LoadLab1ArmQuery once for every seed and verifies every trajectory. The environment has to be locked.
+
+        :param postprocessing: if False, the planner returns its raw path
+        :param fnplanned: if not None, called with (seed, params, traj, starttime) after every plan
+        :return: (planningtimes, traj) where traj is the trajectory of the last seed
+        """
+        env = self.env
+        planningtimes = []
+        for seed in seeds:
+            params = Planner.PlannerParameters()
+            params.SetRobotActiveJoints(robot)
+            params.SetGoalConfig(goals.flatten())
+            params.SetMaxIterations(maxiterations)
+            params.SetRandomGeneratorSeed(seed)
+            if not postprocessing:
+                params.SetPostProcessing('', '')
+            if len(extraparameters) > 0:
+                params.SetExtraParameters(extraparameters)
+            assert(planner.InitPlan(robot,params))
+            traj = RaveCreateTrajectory(env,'')
+            starttime = time.time()
+            assert(planner.PlanPath(traj).statusCode == PlannerStatusCode.HasSolution)
+            planningtimes.append(time.time()-starttime)
+            assert(transdist(traj.GetWaypoint(0,params.GetConfigurationSpecification()),sol) <= g_epsilon)
+            planningutils.VerifyTrajectory(params,traj,samplingstep=0.002)
+            if fnplanned is not None:
+                fnplanned(seed,params,traj,starttime)
+        return planningtimes, traj
+
+    def test_parallelbirrt(self):
+        env = self.env
+        robot, sol, goals = self._LoadLab1ArmQuery()
+        with env:
+            # planning time of the same query against the number of workers
+            for numthreads in [1,2,4]:
+                planner = RaveCreatePlanner(env,'ParallelBiRRT')
+                planner.SendCommand('SetNumThreads %d'%numthreads)
+                planningtimes, traj = self._TimePlanSeeds(planner,robot,sol,goals,range(10),4000)
+                self.log.info('ParallelBiRRT lab1 with %d threads: median %fs, 95th percentile %fs',numthreads,median(planningtimes),percentile(planningtimes,95))
+            self.RunTrajectory(robot,traj)
+
+    def test_birrtlazyedgechecking(self):
+        env = self.env
+        robot, sol, goals = self._LoadLab1ArmQuery()
+        with env:
+            # constraint checks and planning time of the same queries with eager and lazy edge checking
+            planner = RaveCreatePlanner(env,'BiRRT')
+            for lazy in [0,1]:
+                edgechecks = []
+                statechecks = []
+                def CollectStatistics(seed, params, traj, starttime):
+                    numedgechecks, numstatechecks, numrejectededges = [int(s) for s in planner.SendCommand('GetConstraintCheckStatistics').split()]
+                    if not lazy:
+                        assert(numstatechecks == 0 and numrejectededges == 0)
+                    edgechecks.append(numedgechecks)
+                    statechecks.append(numstatechecks)
+                planningtimes, traj = self._TimePlanSeeds(planner,robot,sol,goals,range(10),4000,extraparameters='<lazyedgechecking>%d</lazyedgechecking>'%lazy,postprocessing=False,fnplanned=CollectStatistics)
+                self.log.info('BiRRT lab1 lazyedgechecking=%d: median %fs, median edge checks %d, median state checks %d',lazy,median(planningtimes),median(edgechecks),median(statechecks))
+
+    def test_informedrrtstar(self):
+        env = self.env
+        robot, sol, goals = self._LoadLab1ArmQuery()
+        with env:
+            def GetPathLength(traj):
+                waypoints = traj.GetWaypoints(0,traj.GetNumWaypoints(),robot.GetActiveConfigurationSpecification()).reshape((traj.GetNumWaypoints(),robot.GetActiveDOF()))
+                return sum(sqrt(sum((waypoints[1:]-waypoints[:-1])**2,1)))
+
+            # path length against planning time, and the time the smoother needs for the paths of BiRRT and InformedRRTStar
+            for plannername in ['BiRRT', 'InformedRRTStar']:
+                planner = RaveCreatePlanner(env,plannername)
+                solutions = []
+                def PlanCallback(progress):
+                    if progress._fSolutionCost >= 0 and (len(solutions) == 0 or progress._fSolutionCost < solutions[-1][1]):
+                        solutions.append((time.time(), progress._fSolutionCost))
+                    return getattr(PlannerAction,'None') # None is a keyword in python 3
+                handle = planner.RegisterPlanCallback(PlanCallback)
+                pathlengths = []
+                smoothingtimes = []
+                def SmoothPath(seed, params, traj, starttime):
+                    if plannername == 'InformedRRTStar':
+                        assert(len(solutions) > 0)
+                        self.log.info('InformedRRTStar lab1 seed %d path cost against time: %s',seed,', '.join('%.3fs: %.4f'%(solutiontime-starttime,cost) for solutiontime, cost in solutions))
+                    del solutions[:]
+                    pathlengths.append(GetPathLength(traj))
+                    smoothstarttime = time.time()
+                    assert(planningutils.SmoothActiveDOFTrajectory(traj,robot,maxvelmult=1,maxaccelmult=1,plannername='ParabolicSmoother').statusCode == PlannerStatusCode.HasSolution)
+                    smoothingtimes.append(time.time()-smoothstarttime)
+                self._TimePlanSeeds(planner,robot,sol,goals,range(5),20000,extraparameters='<_nmaxplanningtime>2000</_nmaxplanningtime>',postprocessing=False,fnplanned=SmoothPath)
+                self.log.info('%s lab1: median path length %f, median smoothing time %fs',plannername,median(pathlengths),median(smoothingtimes))
+                handle.Close()
+
+            # same seeds and iterations without a time limit, so only the sampling after the first solution differs. a single seed
+            # can go either way, but over all seeds sampling the states that can shorten the path should not end worse than plain RRT*
+            planner = RaveCreatePlanner(env,'InformedRRTStar')
+            rrtstarcosts = []
+            informedcosts = []
+            for seed in range(5):
+                for informed, costs in [(0,rrtstarcosts),(1,informedcosts)]:
+                    self._TimePlanSeeds(planner,robot,sol,goals,[seed],5000,extraparameters='<informedsampling>%d</informedsampling>'%informed,postprocessing=False)
+                    costs.append(float(planner.SendCommand('GetSolutionCost')))
+                self.log.info('lab1 seed %d: RRT* cost %f, InformedRRTStar cost %f',seed,rrtstarcosts[-1],informedcosts[-1])
+            assert(sum(informedcosts) <= sum(rrtstarcosts)*1.05)
+
     def test_jittertransform(self):
         env=self.env
         self.LoadEnv('data/lab1.env.xml')
@@ -627,6 +754,94 @@ class RunPlanning(EnvironmentSetup):
             assert(success)
             assert(not env.CheckCollision(collisionbody))
 
+    def test_jitterparallel(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        with env:
+            manip = robot.GetActiveManipulator()
+            robot.SetActiveDOFs(manip.GetArmIndices())
+            # bury the hand in a box so that the jitterer has to move it far
+            Thand = manip.GetTransform()
+            box = RaveCreateKinBody(env,'')
+            box.SetName('jitterbox')
+            box.InitFromBoxes(array([[Thand[0,3],Thand[1,3],Thand[2,3],0.08,0.08,0.08]]),True)
+            env.Add(box)
+            assert(env.CheckCollision(robot))
+            startvalues = robot.GetActiveDOFValues()
+
+            jitterer = RaveCreateSpaceSampler(env,'ConfigurationJitterer %s'%robot.GetName())
+            assert(jitterer.SendCommand('SetMaxJitter 0.5'))
+            assert(jitterer.SendCommand('SetMaxIterations 5000'))
+            assert(jitterer.SendCommand('SetMaxLinkDistThresh 0.5'))
+            # the parallel checks return what the serial ones return for the same seed, for every number of threads and batch size
+            serialvalues = []
+            for numthreads, batchsize in [(1,0),(2,0),(4,0),(4,1),(4,64)]:
+                assert(jitterer.SendCommand('SetNumThreads %d'%numthreads))
+                assert(jitterer.SendCommand('SetBatchSize %d'%batchsize))
+                jittertimes = []
+                for seed in range(5):
+                    robot.SetActiveDOFValues(startvalues)
+                    jitterer.SetSeed(seed)
+                    starttime = time.time()
+                    values = jitterer.SampleSequence(SampleDataType.Real,2)
+                    jittertimes.append(time.time()-starttime)
+                    if numthreads == 1:
+                        serialvalues.append(values)
+                    else:
+                        assert(len(values) == len(serialvalues[seed]))
+                        if len(values) > 0:
+                            assert(transdist(values,serialvalues[seed]) <= g_epsilon)
+                self.log.info('ConfigurationJitterer deep collision with %d threads, batch size %d: median %fs, max %fs',numthreads,batchsize,median(jittertimes),max(jittertimes))
+            assert(jitterer.SendCommand('SetNumThreads 1'))
+
+    def test_visibilitymap(self):
+        env=self.env
+        robot=self.LoadRobot('robots/pa10schunk.robot.xml')
+        target=env.ReadKinBodyURI('data/box_frootloops.kinbody.xml')
+        env.Add(target)
+        with env:
+            target.SetTransform(matrixFromPose([1,0,0,0,0.6,0,0.3]))
+            manip = robot.GetActiveManipulator()
+            ikmodel = databases.inversekinematics.InverseKinematicsModel(robot, iktype=IkParameterization.Type.Transform6D)
+            if not ikmodel.load():
+                ikmodel.autogenerate()
+
+            visualprob = interfaces.VisualFeedback(robot)
+            visualprob.SetCameraAndTarget(sensorname='wristcam',targetlink=target.GetLinks()[0])
+            transforms = visualprob.ProcessVisibilityExtents(sphere=[3,0.4,0.5,0.6])
+            assert(len(transforms) > 0)
+            visualprob.SetCameraTransforms(transforms=transforms)
+
+            def SampleGoals(numsamples):
+                starttime = time.time()
+                samples = visualprob.SampleVisibilityGoal(numsamples=numsamples)
+                elapsed = time.time()-starttime
+                # the rays of every goal have to reach the target when shot again
+                with robot:
+                    for sample in samples:
+                        robot.SetDOFValues(sample,manip.GetArmIndices())
+                        assert(visualprob.ComputeVisibility())
+                return len(samples)/elapsed
+
+            throughputbefore = SampleGoals(20)
+            numcells,numoccluded = visualprob.BuildVisibilityMap(numthreads=1,force=True)
+            assert(numcells == len(transforms))
+            # the parallel build computes the same cells as the serial one
+            assert(visualprob.BuildVisibilityMap(force=True) == [numcells,numoccluded])
+            throughputafter = SampleGoals(20)
+            self.log.info('visibility goal sampling over %d camera transforms (%d occluded): %f samples/s without the map, %f samples/s with it',numcells,numoccluded,throughputbefore,throughputafter)
+
+            # a body added after the map was built has to be checked with rays again
+            ab = target.ComputeAABB()
+            occluder = RaveCreateKinBody(env,'')
+            occluder.SetName('visibilityoccluder')
+            occluder.InitFromBoxes(array([[ab.pos()[0],ab.pos()[1],ab.pos()[2]+ab.extents()[2]+0.1,0.1,0.1,0.005]]),True)
+            env.Add(occluder)
+            SampleGoals(20)
+            visualprob.SetParameter(usevisibilitymap=False)
+            SampleGoals(20)
+
 #generate_classes(RunPlanning, globals(), [('ode','ode'),('bullet','bullet')])
 
 class test_ode(RunPlanning):
@@ -60,3 +60,34 @@ class TestSampling(EnvironmentSetup):
         robot.SetActiveDOFs(range(robot.GetDOF()-3),Robot.DOFAffine.X|Robot.DOFAffine.Y|Robot.DOFAffine.RotationAxis,[0,0,1])
         values = sp.SampleSequence(SampleDataType.Real,1)
         assert(len(values) == robot.GetActiveDOF())
+
+    def test_philoxstreams(self):
+        sp=RaveCreateSpaceSampler(self.env,'Philox 7 0')
+        assert(sp is not None)
+        self._runsampler('Philox')
+        sp.SetSpaceDOF(1)
+        sp.SetSeed(7)
+        sp.SendCommand('SetStream 0')
+        bulkvalues = array(sp.SampleSequence(SampleDataType.Uint32,1000)).flatten()
+        # drawing the same stream in small pieces crosses the generated blocks differently
+        sp.SetSeed(7)
+        onevalues = [array(sp.SampleSequence(SampleDataType.Uint32,1)).flatten()[0] for i in range(600)]
+        onevalues += list(array(sp.SampleSequence(SampleDataType.Uint32,400)).flatten())
+        assert(all(bulkvalues == array(onevalues)))
+        assert(sp.SendCommand('GetStream').split() == ['7','0','1000'])
+
+        sp.SendCommand('SetStream 1')
+        streamvalues = array(sp.SampleSequence(SampleDataType.Uint32,1000)).flatten()
+        assert(sum(streamvalues == bulkvalues) < 10)
+        sp2=RaveCreateSpaceSampler(self.env,'Philox 7 1')
+        assert(all(array(sp2.SampleSequence(SampleDataType.Uint32,1000)).flatten() == streamvalues))
+
+        self.LoadEnv('data/lab1.env.xml')
+        robot = self.env.GetRobots()[0]
+        values = []
+        for i in range(2):
+            robotsp=RaveCreateSpaceSampler(self.env,'RobotConfiguration %s'%robot.GetName())
+            robotsp.SendCommand('SetStream 3')
+            robotsp.SetSeed(11)
+            values.append(array(robotsp.SampleSequence(SampleDataType.Real,10)))
+        assert(all(values[0] == values[1]))
@@ -415,6 +415,36 @@ class TestTrajectory(EnvironmentSetup):
         self.RunTrajectory(robot, traj)
         assert( abs(traj.GetDuration()-1.01688888888873) < g_epsilon)
 
+    def test_toppretiming(self):
+        env=self.env
+        env.Load('robots/barrettwam.robot.xml')
+        with env:
+            robot=env.GetRobots()[0]
+            robot.SetActiveDOFs(range(7))
+            finalvalues = numpy.minimum(0.5,robot.GetActiveDOFLimits()[1])
+            traj = RaveCreateTrajectory(env,'')
+            traj.Init(robot.GetActiveConfigurationSpecification())
+            traj.Insert(0,zeros(robot.GetActiveDOF()))
+            traj.Insert(1,finalvalues)
+            parabolictraj = RaveClone(traj,0)
+            ret=planningutils.RetimeActiveDOFTrajectory(parabolictraj,robot,False,maxvelmult=1,maxaccelmult=1,plannername='ParabolicTrajectoryRetimer')
+            assert(ret.statusCode==PlannerStatusCode.HasSolution)
+
+            for plannerparameters in ['', '<torquelimitmode>1</torquelimitmode><numthreads>2</numthreads>']:
+                topptraj = RaveClone(traj,0)
+                ret=planningutils.RetimeActiveDOFTrajectory(topptraj,robot,False,maxvelmult=1,maxaccelmult=1,plannername='TOPPRetimer',plannerparameters=plannerparameters)
+                assert(ret.statusCode==PlannerStatusCode.HasSolution)
+                # parabolic retiming of a straight line is time optimal, the grid only makes it a little slower
+                assert(topptraj.GetDuration() >= parabolictraj.GetDuration()*0.99)
+                assert(topptraj.GetDuration() <= parabolictraj.GetDuration()*1.1)
+                spec = robot.GetActiveConfigurationSpecification()
+                assert(transdist(topptraj.Sample(0,spec),zeros(robot.GetActiveDOF())) <= g_epsilon)
+                assert(transdist(topptraj.Sample(topptraj.GetDuration(),spec),finalvalues) <= g_epsilon)
+                velspec = spec.ConvertToVelocitySpecification()
+                maxvelocities = robot.GetActiveDOFMaxVel()
+                for t in arange(0,topptraj.GetDuration(),0.01):
+                    assert(all(abs(topptraj.Sample(t,velspec)) <= maxvelocities*1.01))
+
     @expected_failure  # not running in testopenrave-legacy either
     def test_ikparamretiming(self):
         self.log.info('retime workspace ikparam')
@@ -626,6 +656,53 @@ class TestTrajectory(EnvironmentSetup):
         assert(traj.GetWaypoint(0,g)==55)
         assert(traj.GetWaypoint(1,ConfigurationSpecification(g))==56)
 
+    def test_insertwaypointsmsgpack(self):
+        try:
+            import msgpack
+        except ImportError:
+            raise nose.SkipTest('msgpack python module is not installed')
+        env=self.env
+        trajspec = ConfigurationSpecification()
+        trajspec.AddGroup('joint_values',7,'linear')
+        trajspec.AddGroup('deltatime',1,'linear')
+        numwaypoints = 10000
+        data = numpy.random.rand(numwaypoints*trajspec.GetDOF())
+        traj = RaveCreateTrajectory(env,'')
+        numrepeats = 10
+        roundtriptimes = {}
+
+        # typed array extension, passed to the command as a view of the input bytes
+        payload = msgpack.packb({'data': msgpack.ExtType(16, b'd'+data.astype('<f8').tobytes()), 'index': 0, 'overwrite': True}, use_bin_type=True)
+        traj.Init(trajspec)
+        starttime = time.time()
+        for irepeat in range(numrepeats):
+            output = msgpack.unpackb(traj.SendMsgPackCommand('InsertWaypoints', payload), raw=False)
+        roundtriptimes['msgpack typed array'] = (time.time()-starttime)/numrepeats
+        assert(output['numWaypoints']==numwaypoints)
+        assert(transdist(traj.GetWaypoints(0,numwaypoints),data) <= g_epsilon)
+
+        # regular msgpack array, converted to a rapidjson array
+        payload = msgpack.packb({'data': data.tolist(), 'index': 0, 'overwrite': True}, use_bin_type=True)
+        traj.Init(trajspec)
+        starttime = time.time()
+        for irepeat in range(numrepeats):
+            output = msgpack.unpackb(traj.SendMsgPackCommand('InsertWaypoints', payload), raw=False)
+        roundtriptimes['msgpack array'] = (time.time()-starttime)/numrepeats
+        assert(output['numWaypoints']==numwaypoints)
+        assert(transdist(traj.GetWaypoints(0,numwaypoints),data) <= g_epsilon)
+
+        # json
+        jsoninput = {'data': data.tolist(), 'index': 0, 'overwrite': True}
+        traj.Init(trajspec)
+        starttime = time.time()
+        for irepeat in range(numrepeats):
+            output = traj.SendJSONCommand('InsertWaypoints', jsoninput)
+        roundtriptimes['json'] = (time.time()-starttime)/numrepeats
+        assert(output['numWaypoints']==numwaypoints)
+        assert(transdist(traj.GetWaypoints(0,numwaypoints),data) <= g_epsilon)
+        for name, roundtriptime in roundtriptimes.items():
+            self.log.info('InsertWaypoints of %d waypoints with %s: %fms', numwaypoints, name, 1000*roundtriptime)
+
     @expected_failure  # not running in testopenrave-legacy either
     def test_robotdoortraj(self):
         env=self.env